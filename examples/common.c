@@ -188,61 +188,17 @@ dctool_descriptor_search (dc_descriptor_t **out, const char *name, dc_family_t f
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 
-	dc_iterator_t *iterator = NULL;
-	rc = dc_descriptor_iterator (&iterator);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR ("Error creating the device descriptor iterator.");
-		return rc;
-	}
-
-	dc_descriptor_t *descriptor = NULL, *current = NULL;
-	while ((rc = dc_iterator_next (iterator, &descriptor)) == DC_STATUS_SUCCESS) {
-		if (name) {
-			const char *vendor = dc_descriptor_get_vendor (descriptor);
-			const char *product = dc_descriptor_get_product (descriptor);
-
-			size_t n = strlen (vendor);
-			if (strncasecmp (name, vendor, n) == 0 && name[n] == ' ' &&
-				strcasecmp (name + n + 1, product) == 0)
-			{
-				current = descriptor;
-				break;
-			} else if (strcasecmp (name, product) == 0) {
-				current = descriptor;
-				break;
-			}
-		} else {
-			if (family == dc_descriptor_get_type (descriptor)) {
-				if (model == dc_descriptor_get_model (descriptor)) {
-					// Exact match found. Return immediately.
-					dc_descriptor_free (current);
-					current = descriptor;
-					break;
-				} else {
-					// Possible match found. Keep searching for an exact match.
-					// If no exact match is found, the first match is returned.
-					if (current == NULL) {
-						current = descriptor;
-						descriptor = NULL;
-					}
-				}
-			}
-		}
-
-		dc_descriptor_free (descriptor);
+	if (name) {
+		rc = dc_descriptor_find_name (out, name);
+	} else {
+		rc = dc_descriptor_find_model (out, family, model);
 	}
 
-	if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_DONE) {
-		dc_descriptor_free (current);
-		dc_iterator_free (iterator);
-		ERROR ("Error iterating the device descriptors.");
+	if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error searching the device descriptors.");
 		return rc;
 	}
 
-	dc_iterator_free (iterator);
-
-	*out = current;
-
 	return DC_STATUS_SUCCESS;
 }
 
@@ -269,14 +225,17 @@ dctool_convert_hex2bin (const char *str)
 
 	// Allocate a memory buffer.
 	dc_buffer_t *buffer = dc_buffer_new (nbytes);
+	if (buffer == NULL || !dc_buffer_resize (buffer, nbytes)) {
+		dc_buffer_free (buffer);
+		return NULL;
+	}
 
-	// Convert the hexadecimal string.
+	// Convert the hexadecimal string directly into the buffer.
+	unsigned char *data = dc_buffer_get_data (buffer);
 	for (unsigned int i = 0; i < nbytes; ++i) {
 		unsigned char msn = hex2dec (str[i * 2 + 0]);
 		unsigned char lsn = hex2dec (str[i * 2 + 1]);
-		unsigned char byte = (msn << 4) + lsn;
-
-		dc_buffer_append (buffer, &byte, 1);
+		data[i] = (msn << 4) | lsn;
 	}
 
 	return buffer;
@@ -340,3 +299,52 @@ dctool_file_read (const char *filename)
 
 	return buffer;
 }
+
+static int
+trace_cb (const dc_trace_record_t *record, void *userdata)
+{
+	FILE *fp = (FILE *) userdata;
+	unsigned char header[DCTOOL_TRACE_HEADERSIZE] = {0};
+
+	// Timestamp (64 bit, little endian).
+	for (unsigned int i = 0; i < 8; ++i)
+		header[i] = (record->timestamp >> (i * 8)) & 0xFF;
+
+	// Data size (32 bit, little endian).
+	for (unsigned int i = 0; i < 4; ++i)
+		header[8 + i] = (record->size >> (i * 8)) & 0xFF;
+
+	// Thread number (16 bit, little endian).
+	header[12] = (record->thread     ) & 0xFF;
+	header[13] = (record->thread >> 8) & 0xFF;
+
+	header[14] = record->transport;
+	header[15] = record->direction;
+
+	fwrite (header, 1, sizeof (header), fp);
+	fwrite (record->data, 1, record->size, fp);
+
+	return 1;
+}
+
+dc_status_t
+dctool_trace_export (dc_context_t *context, const char *filename)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned int dropped = 0;
+
+	FILE *fp = fopen (filename, "wb");
+	if (fp == NULL)
+		return DC_STATUS_IO;
+
+	fwrite (DCTOOL_TRACE_MAGIC, 1, sizeof (DCTOOL_TRACE_MAGIC) - 1, fp);
+
+	rc = dc_context_trace_drain (context, trace_cb, fp, &dropped);
+	if (dropped) {
+		message ("Trace buffer overflow: %u records dropped.\n", dropped);
+	}
+
+	fclose (fp);
+
+	return rc;
+}
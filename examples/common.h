@@ -30,6 +30,14 @@
 extern "C" {
 #endif /* __cplusplus */
 
+/*
+ * Trace file layout: the magic string, followed by the records. Each
+ * record has a 16 byte header (timestamp, size, thread number, transport
+ * and direction, all little endian), followed by the data bytes.
+ */
+#define DCTOOL_TRACE_MAGIC "DCTRACE1"
+#define DCTOOL_TRACE_HEADERSIZE 16
+
 const char *
 dctool_errmsg (dc_status_t status);
 
@@ -57,6 +65,9 @@ dctool_file_write (const char *filename, dc_buffer_t *buffer);
 dc_buffer_t *
 dctool_file_read (const char *filename);
 
+dc_status_t
+dctool_trace_export (dc_context_t *context, const char *filename);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -64,9 +64,14 @@ static const dctool_command_t *g_commands[] = {
 	&dctool_read,
 	&dctool_write,
 	&dctool_fwupdate,
+	&dctool_trace,
+	&dctool_archive,
+	&dctool_probe,
 	NULL
 };
 
+#define TRACESIZE (16 * 1024 * 1024)
+
 static volatile sig_atomic_t g_cancel = 0;
 
 const dctool_command_t *
@@ -109,6 +114,7 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -f, --family <family>     Device family type\n"
 			"   -m, --model <model>       Device model number\n"
 			"   -l, --logfile <logfile>   Logfile\n"
+			"   -t, --trace <tracefile>   Record a binary transport trace\n"
 			"   -q, --quiet               Quiet mode\n"
 			"   -v, --verbose             Verbose mode\n"
 #else
@@ -117,6 +123,7 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -f <family>    Family type\n"
 			"   -m <model>     Model number\n"
 			"   -l <logfile>   Logfile\n"
+			"   -t <tracefile> Record a binary transport trace\n"
 			"   -q             Quiet mode\n"
 			"   -v             Verbose mode\n"
 #endif
@@ -172,6 +179,7 @@ main (int argc, char *argv[])
 	unsigned int help = 0;
 	dc_loglevel_t loglevel = DC_LOGLEVEL_WARNING;
 	const char *logfile = NULL;
+	const char *tracefile = NULL;
 	const char *device = NULL;
 	dc_family_t family = DC_FAMILY_NULL;
 	unsigned int model = 0;
@@ -179,7 +187,7 @@ main (int argc, char *argv[])
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = NOPERMUTATION "hd:f:m:l:qv";
+	const char *optstring = NOPERMUTATION "hd:f:m:l:t:qv";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
@@ -187,6 +195,7 @@ main (int argc, char *argv[])
 		{"family",      required_argument, 0, 'f'},
 		{"model",       required_argument, 0, 'm'},
 		{"logfile",     required_argument, 0, 'l'},
+		{"trace",       required_argument, 0, 't'},
 		{"quiet",       no_argument,       0, 'q'},
 		{"verbose",     no_argument,       0, 'v'},
 		{0,             0,                 0,  0 }
@@ -213,6 +222,9 @@ main (int argc, char *argv[])
 		case 'l':
 			logfile = optarg;
 			break;
+		case 't':
+			tracefile = optarg;
+			break;
 		case 'q':
 			loglevel = DC_LOGLEVEL_NONE;
 			break;
@@ -274,6 +286,16 @@ main (int argc, char *argv[])
 	dc_context_set_loglevel (context, loglevel);
 	dc_context_set_logfunc (context, logfunc, NULL);
 
+	// Setup the transport trace.
+	if (tracefile) {
+		status = dc_context_set_trace (context, TRACESIZE);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("Failed to enable the transport trace.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
 	if (command->config & DCTOOL_CONFIG_DESCRIPTOR) {
 		// Check mandatory arguments.
 		if (device == NULL && family == DC_FAMILY_NULL) {
@@ -306,6 +328,15 @@ main (int argc, char *argv[])
 	// Execute the command.
 	exitcode = command->run (argc, argv, context, descriptor);
 
+	// Export the transport trace.
+	if (tracefile) {
+		status = dctool_trace_export (context, tracefile);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("Failed to write the trace file.\n");
+			exitcode = EXIT_FAILURE;
+		}
+	}
+
 cleanup:
 	dc_descriptor_free (descriptor);
 	dc_context_free (context);
@@ -51,6 +51,9 @@ extern const dctool_command_t dctool_parse;
 extern const dctool_command_t dctool_read;
 extern const dctool_command_t dctool_write;
 extern const dctool_command_t dctool_fwupdate;
+extern const dctool_command_t dctool_trace;
+extern const dctool_command_t dctool_archive;
+extern const dctool_command_t dctool_probe;
 
 const dctool_command_t *
 dctool_command_find (const char *name);
@@ -0,0 +1,210 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/archive.h>
+
+#include "dctool.h"
+#include "common.h"
+#include "utils.h"
+
+typedef struct export_data_t {
+	const char *dirname;
+	dc_family_t family;
+	unsigned int model;
+	unsigned int count;
+} export_data_t;
+
+static int
+export_cb (const dc_archive_entry_t *entry, void *userdata)
+{
+	export_data_t *exportdata = (export_data_t *) userdata;
+
+	if (entry->family != exportdata->family || entry->model != exportdata->model)
+		return 1;
+
+	// Generate the filename from the hash of the data.
+	char filename[1024] = {0};
+	snprintf (filename, sizeof (filename), "%s/%016llX.bin",
+		exportdata->dirname, entry->hash);
+
+	dc_buffer_t *buffer = dc_buffer_new (entry->size);
+	dc_buffer_append (buffer, entry->data, entry->size);
+	dctool_file_write (filename, buffer);
+	dc_buffer_free (buffer);
+
+	exportdata->count++;
+
+	return !dctool_cancel_cb (NULL);
+}
+
+static int
+dctool_archive_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *descriptor)
+{
+	// Default values.
+	int exitcode = EXIT_SUCCESS;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+	dc_buffer_t *buffer = NULL;
+
+	// Default option values.
+	unsigned int help = 0;
+	const char *dirname = NULL;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "he:";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"export",      required_argument, 0, 'e'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 'e':
+			dirname = optarg;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	// Show help message.
+	if (help) {
+		dctool_command_showhelp (&dctool_archive);
+		return EXIT_SUCCESS;
+	}
+
+	// Check mandatory arguments.
+	if (argc < 1) {
+		message ("No archive specified.\n");
+		return EXIT_FAILURE;
+	}
+
+	dc_family_t family = dc_descriptor_get_type (descriptor);
+	unsigned int model = dc_descriptor_get_model (descriptor);
+
+	// Open the archive.
+	status = dc_archive_open (&archive, context, argv[0]);
+	if (status != DC_STATUS_SUCCESS) {
+		message ("ERROR: %s\n", dctool_errmsg (status));
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	// Import the dives.
+	unsigned int nimported = 0;
+	for (unsigned int i = 1; i < argc; ++i) {
+		// Read the input file.
+		buffer = dctool_file_read (argv[i]);
+		if (buffer == NULL) {
+			message ("Failed to open the input file.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+
+		unsigned int added = 0;
+		status = dc_archive_add (archive, family, model,
+			dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), &added);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("ERROR: %s\n", dctool_errmsg (status));
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+
+		nimported += added;
+
+		// Cleanup.
+		dc_buffer_free (buffer);
+		buffer = NULL;
+	}
+
+	if (argc > 1) {
+		message ("Imported %u new dive(s), %u already present.\n",
+			nimported, argc - 1 - nimported);
+	}
+
+	// Export the dives.
+	if (dirname) {
+		export_data_t exportdata = {0};
+		exportdata.dirname = dirname;
+		exportdata.family = family;
+		exportdata.model = model;
+
+		status = dc_archive_foreach (archive, export_cb, &exportdata);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("ERROR: %s\n", dctool_errmsg (status));
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+
+		message ("Exported %u dive(s).\n", exportdata.count);
+	}
+
+cleanup:
+	dc_buffer_free (buffer);
+	dc_archive_close (archive);
+	return exitcode;
+}
+
+const dctool_command_t dctool_archive = {
+	dctool_archive_run,
+	DCTOOL_CONFIG_DESCRIPTOR,
+	"archive",
+	"Import dives into or export dives from an archive",
+	"Usage:\n"
+	"   dctool archive [options] <archive> [<filename> ...]\n"
+	"\n"
+	"The dives are stored under the selected family and model.\n"
+	"Dives that are already present in the archive are skipped.\n"
+	"\n"
+	"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+	"   -h, --help                 Show help message\n"
+	"   -e, --export <directory>   Export the dives to a directory\n"
+#else
+	"   -h              Show help message\n"
+	"   -e <directory>  Export the dives to a directory\n"
+#endif
+};
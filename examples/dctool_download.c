@@ -35,6 +35,7 @@
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/device.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/syncstore.h>
 
 #include "dctool.h"
 #include "common.h"
@@ -43,7 +44,10 @@
 
 typedef struct event_data_t {
 	const char *cachedir;
+	dc_syncstore_t *store;
 	dc_event_devinfo_t devinfo;
+	dc_event_clock_t clock;
+	unsigned int hasclock;
 } event_data_t;
 
 typedef struct dive_data_t {
@@ -51,8 +55,46 @@ typedef struct dive_data_t {
 	dc_buffer_t **fingerprint;
 	unsigned int number;
 	dctool_output_t *output;
+	dc_buffer_t *hashes;
 } dive_data_t;
 
+/*
+ * The 64 bit FNV-1a hash of the dive data, which is also the hash used
+ * by the dive archive.
+ */
+static unsigned long long
+dive_hash (const unsigned char data[], unsigned int size)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (unsigned int i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+/*
+ * Add the hashes of the downloaded dives to the list in the sync store,
+ * skipping the ones that are already present.
+ */
+static void
+dive_hashes_merge (dc_buffer_t *list, const dc_buffer_t *hashes)
+{
+	const unsigned char *data = dc_buffer_get_data ((dc_buffer_t *) hashes);
+	size_t size = dc_buffer_get_size ((dc_buffer_t *) hashes);
+
+	for (size_t i = 0; i + 8 <= size; i += 8) {
+		const unsigned char *current = dc_buffer_get_data (list);
+		size_t count = dc_buffer_get_size (list);
+
+		size_t j = 0;
+		while (j + 8 <= count && memcmp (current + j, data + i, 8) != 0)
+			j += 8;
+
+		if (j + 8 > count)
+			dc_buffer_append (list, data + i, 8);
+	}
+}
+
 static int
 dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
 {
@@ -76,6 +118,15 @@ dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fing
 		*divedata->fingerprint = fp;
 	}
 
+	// Keep the hash of the dive for the sync store.
+	if (divedata->hashes) {
+		unsigned long long hash = dive_hash (data, size);
+		unsigned char buffer[8];
+		for (unsigned int i = 0; i < 8; ++i)
+			buffer[i] = (hash >> (8 * i)) & 0xFF;
+		dc_buffer_append (divedata->hashes, buffer, sizeof (buffer));
+	}
+
 	// Create the parser.
 	message ("Creating the parser.\n");
 	rc = dc_parser_new (&parser, divedata->device);
@@ -109,6 +160,7 @@ static void
 event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata)
 {
 	const dc_event_devinfo_t *devinfo = (const dc_event_devinfo_t *) data;
+	const dc_event_clock_t *clock = (const dc_event_clock_t *) data;
 
 	event_data_t *eventdata = (event_data_t *) userdata;
 
@@ -117,21 +169,34 @@ event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *us
 
 	switch (event) {
 	case DC_EVENT_DEVINFO:
-		// Load the fingerprint from the cache. If there is no
-		// fingerprint present in the cache, a NULL buffer is returned,
+		// Load the fingerprint from the sync store. If there is no
+		// fingerprint present in the store, an empty buffer is returned,
 		// and the registered fingerprint will be cleared.
-		if (eventdata->cachedir) {
-			char filename[1024] = {0};
-			dc_family_t family = DC_FAMILY_NULL;
-			dc_buffer_t *fingerprint = NULL;
-
-			// Generate the fingerprint filename.
-			family = dc_device_get_type (device);
-			snprintf (filename, sizeof (filename), "%s/%s-%08X.bin",
-				eventdata->cachedir, dctool_family_name (family), devinfo->serial);
-
-			// Read the fingerprint file.
-			fingerprint = dctool_file_read (filename);
+		if (eventdata->store) {
+			dc_family_t family = dc_device_get_type (device);
+			dc_buffer_t *fingerprint = dc_buffer_new (0);
+
+			dc_syncstore_get (eventdata->store,
+				family, devinfo->model, devinfo->serial,
+				DC_SYNCSTORE_FINGERPRINT, fingerprint);
+
+			// Migrate the fingerprint file of older versions into the
+			// sync store. The file itself is left untouched.
+			if (dc_buffer_get_size (fingerprint) == 0) {
+				char filename[1024] = {0};
+				snprintf (filename, sizeof (filename), "%s/%s-%08X.bin",
+					eventdata->cachedir, dctool_family_name (family), devinfo->serial);
+
+				dc_buffer_t *legacy = dctool_file_read (filename);
+				if (legacy) {
+					dc_syncstore_set (eventdata->store,
+						family, devinfo->model, devinfo->serial,
+						DC_SYNCSTORE_FINGERPRINT,
+						dc_buffer_get_data (legacy), dc_buffer_get_size (legacy));
+					dc_buffer_free (fingerprint);
+					fingerprint = legacy;
+				}
+			}
 
 			// Register the fingerprint data.
 			dc_device_set_fingerprint (device,
@@ -142,10 +207,14 @@ event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *us
 			dc_buffer_free (fingerprint);
 		}
 
-		// Keep a copy of the event data. It will be used for generating
-		// the fingerprint filename again after a (successful) download.
+		// Keep a copy of the event data. It will be used for updating
+		// the sync store again after a (successful) download.
 		eventdata->devinfo = *devinfo;
 		break;
+	case DC_EVENT_CLOCK:
+		eventdata->clock = *clock;
+		eventdata->hasclock = 1;
+		break;
 	default:
 		break;
 	}
@@ -157,6 +226,19 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, const char *devnam
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	dc_device_t *device = NULL;
 	dc_buffer_t *ofingerprint = NULL;
+	dc_buffer_t *hashes = NULL;
+	dc_syncstore_t *store = NULL;
+
+	// Open the sync store.
+	if (cachedir) {
+		char filename[1024] = {0};
+		snprintf (filename, sizeof (filename), "%s/syncstore.bin", cachedir);
+		// Without the sync store, all dives are downloaded again.
+		if (dc_syncstore_open (&store, context, filename) != DC_STATUS_SUCCESS) {
+			WARNING ("Error opening the sync store.");
+			store = NULL;
+		}
+	}
 
 	// Open the device.
 	message ("Opening the device (%s %s, %s).\n",
@@ -171,10 +253,11 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, const char *devnam
 
 	// Initialize the event data.
 	event_data_t eventdata = {0};
+	eventdata.cachedir = cachedir;
 	if (fingerprint) {
-		eventdata.cachedir = NULL;
+		eventdata.store = NULL;
 	} else {
-		eventdata.cachedir = cachedir;
+		eventdata.store = store;
 	}
 
 	// Register the event handler.
@@ -210,32 +293,73 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, const char *devnam
 	divedata.fingerprint = &ofingerprint;
 	divedata.number = 0;
 	divedata.output = output;
+	if (store) {
+		hashes = dc_buffer_new (0);
+		divedata.hashes = hashes;
+	}
 
 	// Download the dives.
 	message ("Downloading the dives.\n");
 	rc = dc_device_foreach (device, dive_cb, &divedata);
+
+	// Show the transport statistics.
+	dc_device_stats_t stats;
+	if (dc_device_get_stats (device, &stats) == DC_STATUS_SUCCESS) {
+		message ("Statistics: in=%llu bytes, out=%llu bytes, reads=%u, writes=%u, timeouts=%u, purges=%u, read=%llu.%03llu s, sleep=%llu.%03llu s\n",
+			stats.nbytes_in, stats.nbytes_out,
+			stats.nreads, stats.nwrites,
+			stats.ntimeouts, stats.npurges,
+			stats.read_time / 1000000, (stats.read_time / 1000) % 1000,
+			stats.sleep_time / 1000000, (stats.sleep_time / 1000) % 1000);
+	}
+
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR ("Error downloading the dives.");
 		goto cleanup;
 	}
 
-	// Store the fingerprint data.
-	if (cachedir && ofingerprint) {
-		char filename[1024] = {0};
-		dc_family_t family = DC_FAMILY_NULL;
+	// Update the sync store.
+	if (store) {
+		dc_family_t family = dc_device_get_type (device);
+		unsigned int model = eventdata.devinfo.model;
+		unsigned int serial = eventdata.devinfo.serial;
+
+		if (ofingerprint) {
+			dc_syncstore_set (store, family, model, serial, DC_SYNCSTORE_FINGERPRINT,
+				dc_buffer_get_data (ofingerprint), dc_buffer_get_size (ofingerprint));
+		}
+
+		if (eventdata.hasclock) {
+			unsigned char clock[12];
+			for (unsigned int i = 0; i < 4; ++i)
+				clock[i] = (eventdata.clock.devtime >> (8 * i)) & 0xFF;
+			for (unsigned int i = 0; i < 8; ++i)
+				clock[4 + i] = ((unsigned long long) eventdata.clock.systime >> (8 * i)) & 0xFF;
+			dc_syncstore_set (store, family, model, serial, DC_SYNCSTORE_CLOCK,
+				clock, sizeof (clock));
+		}
 
-		// Generate the fingerprint filename.
-		family = dc_device_get_type (device);
-		snprintf (filename, sizeof (filename), "%s/%s-%08X.bin",
-			cachedir, dctool_family_name (family), eventdata.devinfo.serial);
+		if (hashes && dc_buffer_get_size (hashes)) {
+			dc_buffer_t *list = dc_buffer_new (0);
+			dc_syncstore_get (store, family, model, serial, DC_SYNCSTORE_HASHES, list);
+			dive_hashes_merge (list, hashes);
+			dc_syncstore_set (store, family, model, serial, DC_SYNCSTORE_HASHES,
+				dc_buffer_get_data (list), dc_buffer_get_size (list));
+			dc_buffer_free (list);
+		}
 
-		// Write the fingerprint file.
-		dctool_file_write (filename, ofingerprint);
+		rc = dc_syncstore_commit (store);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error writing the sync store.");
+			goto cleanup;
+		}
 	}
 
 cleanup:
+	dc_buffer_free (hashes);
 	dc_buffer_free (ofingerprint);
 	dc_device_close (device);
+	dc_syncstore_close (store);
 	return rc;
 }
 
@@ -316,6 +440,12 @@ dctool_download_run (int argc, char *argv[], dc_context_t *context, dc_descripto
 		output = dctool_raw_output_new (filename);
 	} else if (strcasecmp(format, "xml") == 0) {
 		output = dctool_xml_output_new (filename, units);
+	} else if (strcasecmp(format, "json") == 0) {
+		output = dctool_json_output_new (filename, units);
+	} else if (strcasecmp(format, "csv") == 0) {
+		output = dctool_csv_output_new (filename, units);
+	} else if (strcasecmp(format, "columnar") == 0) {
+		output = dctool_columnar_output_new (filename);
 	} else {
 		message ("Unknown output format: %s\n", format);
 		exitcode = EXIT_FAILURE;
@@ -372,6 +502,23 @@ const dctool_command_t dctool_download = {
 	"\n"
 	"      All dives are exported to a single xml file.\n"
 	"\n"
+	"   JSON\n"
+	"\n"
+	"      All dives are exported to a single json file, containing an\n"
+	"      array with one object per dive.\n"
+	"\n"
+	"   CSV\n"
+	"\n"
+	"      All samples are exported to a single csv file, with one row per\n"
+	"      sample. The first column contains the dive number.\n"
+	"\n"
+	"   COLUMNAR\n"
+	"\n"
+	"      All dives are exported to a single binary file, with separate\n"
+	"      dive, sample and event tables, and an index at the end of the\n"
+	"      file. The values are always in metric units. The layout is\n"
+	"      described in output_columnar.c.\n"
+	"\n"
 	"   RAW\n"
 	"\n"
 	"      Each dive is exported to a raw (binary) file. To output multiple\n"
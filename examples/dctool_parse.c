@@ -34,6 +34,7 @@
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/pipeline.h>
 
 #include "dctool.h"
 #include "output.h"
@@ -79,6 +80,88 @@ cleanup:
 	return rc;
 }
 
+typedef struct parse_result_t {
+	dc_status_t status;
+	dctool_emitter_t emitter;
+} parse_result_t;
+
+typedef struct parse_data_t {
+	dctool_output_t *output;
+	dc_status_t status;
+} parse_data_t;
+
+static void *
+parse_dive_cb (dc_parser_t *parser, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	parse_data_t *parsedata = (parse_data_t *) userdata;
+
+	parse_result_t *result = (parse_result_t *) malloc (sizeof (parse_result_t));
+	if (result == NULL)
+		return NULL;
+
+	result->status = dctool_emitter_init (&result->emitter, NULL, 4096);
+	if (result->status == DC_STATUS_SUCCESS) {
+		result->status = dctool_output_format (parsedata->output, &result->emitter, parser, data, size, fingerprint, fsize);
+	}
+
+	return result;
+}
+
+static int
+parse_result_cb (dc_status_t status, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata, void *arg)
+{
+	parse_result_t *result = (parse_result_t *) userdata;
+	parse_data_t *parsedata = (parse_data_t *) arg;
+
+	if (status == DC_STATUS_SUCCESS && result == NULL)
+		status = DC_STATUS_NOMEMORY;
+
+	// Once an error occurred, the remaining results are only released.
+	if (parsedata->status == DC_STATUS_SUCCESS) {
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR ("Error creating the parser.");
+			parsedata->status = status;
+		} else {
+			status = dctool_output_append (parsedata->output, &result->emitter);
+			if (result->status != DC_STATUS_SUCCESS)
+				status = result->status;
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR ("Error parsing the dive data.");
+				parsedata->status = status;
+			}
+		}
+	}
+
+	if (result) {
+		dctool_emitter_cleanup (&result->emitter);
+		free (result);
+	}
+
+	return parsedata->status == DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+parse_memory (dc_buffer_t *buffer, dc_context_t *context, dc_descriptor_t *descriptor, unsigned int devtime, dc_ticks_t systime, unsigned int jobs, dctool_output_t *output)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	parse_data_t parsedata = {output, DC_STATUS_SUCCESS};
+
+	// Extract and parse the dives. The dives are formatted in parallel,
+	// and written to the output in their original order.
+	message ("Parsing the memory dump.\n");
+	rc = dc_pipeline_run (context, descriptor, devtime, systime,
+		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), jobs,
+		parse_dive_cb, parse_result_cb, &parsedata);
+	if (parsedata.status != DC_STATUS_SUCCESS)
+		return parsedata.status;
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR ("Error extracting the dives.");
+		return rc;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 static int
 dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *descriptor)
 {
@@ -92,19 +175,25 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	// Default option values.
 	unsigned int help = 0;
 	const char *filename = NULL;
+	const char *format = "xml";
 	unsigned int devtime = 0;
 	dc_ticks_t systime = 0;
+	unsigned int memory = 0;
+	unsigned int jobs = 0;
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = "ho:d:s:u:";
+	const char *optstring = "ho:f:d:s:u:mj:";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
 		{"output",      required_argument, 0, 'o'},
+		{"format",      required_argument, 0, 'f'},
 		{"devtime",     required_argument, 0, 'd'},
 		{"systime",     required_argument, 0, 's'},
 		{"units",       required_argument, 0, 'u'},
+		{"memory",      no_argument,       0, 'm'},
+		{"jobs",        required_argument, 0, 'j'},
 		{0,             0,                 0,  0 }
 	};
 	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
@@ -118,6 +207,9 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 		case 'o':
 			filename = optarg;
 			break;
+		case 'f':
+			format = optarg;
+			break;
 		case 'd':
 			devtime = strtoul (optarg, NULL, 0);
 			break;
@@ -130,6 +222,12 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 			if (strcmp (optarg, "imperial") == 0)
 				units = DCTOOL_UNITS_IMPERIAL;
 			break;
+		case 'm':
+			memory = 1;
+			break;
+		case 'j':
+			jobs = strtoul (optarg, NULL, 0);
+			break;
 		default:
 			return EXIT_FAILURE;
 		}
@@ -145,7 +243,19 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	}
 
 	// Create the output.
-	output = dctool_xml_output_new (filename, units);
+	if (strcasecmp(format, "xml") == 0) {
+		output = dctool_xml_output_new (filename, units);
+	} else if (strcasecmp(format, "json") == 0) {
+		output = dctool_json_output_new (filename, units);
+	} else if (strcasecmp(format, "csv") == 0) {
+		output = dctool_csv_output_new (filename, units);
+	} else if (strcasecmp(format, "columnar") == 0) {
+		output = dctool_columnar_output_new (filename);
+	} else {
+		message ("Unknown output format: %s\n", format);
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
 	if (output == NULL) {
 		message ("Failed to create the output.\n");
 		exitcode = EXIT_FAILURE;
@@ -161,8 +271,12 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 			goto cleanup;
 		}
 
-		// Parse the dive.
-		status = parse (buffer, context, descriptor, devtime, systime, output);
+		// Parse the dive(s).
+		if (memory) {
+			status = parse_memory (buffer, context, descriptor, devtime, systime, jobs, output);
+		} else {
+			status = parse (buffer, context, descriptor, devtime, systime, output);
+		}
 		if (status != DC_STATUS_SUCCESS) {
 			message ("ERROR: %s\n", dctool_errmsg (status));
 			exitcode = EXIT_FAILURE;
@@ -192,14 +306,47 @@ const dctool_command_t dctool_parse = {
 #ifdef HAVE_GETOPT_LONG
 	"   -h, --help                 Show help message\n"
 	"   -o, --output <filename>    Output filename\n"
+	"   -f, --format <format>      Output format\n"
 	"   -d, --devtime <timestamp>  Device time\n"
 	"   -s, --systime <timestamp>  System time\n"
 	"   -u, --units <units>        Set units (metric or imperial)\n"
+	"   -m, --memory               Input files are memory dumps\n"
+	"   -j, --jobs <count>         Number of parser threads\n"
 #else
 	"   -h              Show help message\n"
 	"   -o <filename>   Output filename\n"
+	"   -f <format>     Output format\n"
 	"   -d <devtime>    Device time\n"
 	"   -s <systime>    System time\n"
 	"   -u <units>      Set units (metric or imperial)\n"
+	"   -m              Input files are memory dumps\n"
+	"   -j <count>      Number of parser threads\n"
 #endif
+	"\n"
+	"Supported output formats:\n"
+	"\n"
+	"   XML (default)\n"
+	"\n"
+	"      All dives are exported to a single xml file.\n"
+	"\n"
+	"   JSON\n"
+	"\n"
+	"      All dives are exported to a single json file, containing an\n"
+	"      array with one object per dive.\n"
+	"\n"
+	"   CSV\n"
+	"\n"
+	"      All samples are exported to a single csv file, with one row per\n"
+	"      sample. The first column contains the dive number.\n"
+	"\n"
+	"   COLUMNAR\n"
+	"\n"
+	"      All dives are exported to a single binary file, with separate\n"
+	"      dive, sample and event tables, and an index at the end of the\n"
+	"      file. The values are always in metric units. The layout is\n"
+	"      described in output_columnar.c.\n"
+	"\n"
+	"With the memory option, each input file is a memory dump from which\n"
+	"the dives are extracted first. With the jobs option, the dives are\n"
+	"then parsed in parallel, and written in their original order.\n"
 };
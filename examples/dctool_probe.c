@@ -0,0 +1,142 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/probe.h>
+
+#include "dctool.h"
+#include "common.h"
+#include "utils.h"
+
+#define MAXFAMILIES 32
+
+static int
+probe_cb (const char *name, dc_descriptor_t *descriptor, dc_probe_match_t match, void *userdata)
+{
+	printf ("%s: %s %s (%s)\n", name,
+		dc_descriptor_get_vendor (descriptor),
+		dc_descriptor_get_product (descriptor),
+		match == DC_PROBE_MODEL ? "model" : "family");
+
+	return 1;
+}
+
+static int
+dctool_probe_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *dummy)
+{
+	int exitcode = EXIT_SUCCESS;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_family_t families[MAXFAMILIES];
+	unsigned int nfamilies = 0;
+
+	// Default option values.
+	unsigned int help = 0;
+	unsigned int timeout = 5000;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "hf:t:";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"family",      required_argument, 0, 'f'},
+		{"timeout",     required_argument, 0, 't'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 'f':
+			if (nfamilies == MAXFAMILIES) {
+				message ("Too many families.\n");
+				return EXIT_FAILURE;
+			}
+			families[nfamilies] = dctool_family_type (optarg);
+			if (families[nfamilies] == DC_FAMILY_NULL) {
+				message ("Unknown family '%s'.\n", optarg);
+				return EXIT_FAILURE;
+			}
+			nfamilies++;
+			break;
+		case 't':
+			timeout = strtoul (optarg, NULL, 0);
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	// Show help message.
+	if (help) {
+		dctool_command_showhelp (&dctool_probe);
+		return EXIT_SUCCESS;
+	}
+
+	status = dc_probe_run (context, (const char **) argv, argc, families, nfamilies, timeout, probe_cb, NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		message ("ERROR: %s\n", dctool_errmsg (status));
+		exitcode = EXIT_FAILURE;
+	}
+
+	return exitcode;
+}
+
+const dctool_command_t dctool_probe = {
+	dctool_probe_run,
+	DCTOOL_CONFIG_NONE,
+	"probe",
+	"Identify the connected devices",
+	"Usage:\n"
+	"   dctool probe [options] [<devname> ...]\n"
+	"\n"
+	"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+	"   -h, --help                Show help message\n"
+	"   -f, --family <family>     Family type (repeatable)\n"
+	"   -t, --timeout <timeout>   Timeout (milliseconds)\n"
+#else
+	"   -h                Show help message\n"
+	"   -f <family>       Family type (repeatable)\n"
+	"   -t <timeout>      Timeout (milliseconds)\n"
+#endif
+	"\n"
+	"Without a device name, all serial ports are probed.\n"
+};
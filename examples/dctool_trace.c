@@ -0,0 +1,219 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+
+#include "dctool.h"
+#include "common.h"
+#include "utils.h"
+
+static const char *
+transport_name (unsigned int transport)
+{
+	switch (transport) {
+	case DC_TRANSPORT_SERIAL:
+		return "serial";
+	case DC_TRANSPORT_IRDA:
+		return "irda";
+	case DC_TRANSPORT_USB:
+		return "usb";
+	case DC_TRANSPORT_CUSTOM:
+		return "custom";
+	default:
+		return "unknown";
+	}
+}
+
+static unsigned long long
+uint_le (const unsigned char data[], unsigned int n)
+{
+	unsigned long long value = 0;
+	for (unsigned int i = 0; i < n; ++i)
+		value |= (unsigned long long) data[i] << (i * 8);
+	return value;
+}
+
+static dc_status_t
+render (dc_buffer_t *buffer, FILE *fp)
+{
+	const unsigned char *data = dc_buffer_get_data (buffer);
+	size_t size = dc_buffer_get_size (buffer);
+	size_t magic = sizeof (DCTOOL_TRACE_MAGIC) - 1;
+
+	if (size < magic || memcmp (data, DCTOOL_TRACE_MAGIC, magic) != 0) {
+		message ("Invalid trace file.\n");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	unsigned long long first = 0;
+	size_t offset = magic;
+	while (offset + DCTOOL_TRACE_HEADERSIZE <= size) {
+		const unsigned char *header = data + offset;
+		unsigned long long timestamp = uint_le (header + 0, 8);
+		unsigned int length = uint_le (header + 8, 4);
+		unsigned int thread = uint_le (header + 12, 2);
+		unsigned int transport = header[14];
+		unsigned int direction = header[15];
+
+		offset += DCTOOL_TRACE_HEADERSIZE;
+		if (length > size - offset) {
+			message ("Truncated trace record.\n");
+			return DC_STATUS_DATAFORMAT;
+		}
+
+		if (first == 0)
+			first = timestamp;
+		unsigned long long elapsed = timestamp - first;
+
+		fprintf (fp, "[%llu.%06llu] #%u %s %s: size=%u, data=",
+			elapsed / 1000000, elapsed % 1000000, thread,
+			transport_name (transport),
+			direction == DC_DIRECTION_INPUT ? "Read" : "Write",
+			length);
+		for (unsigned int i = 0; i < length; ++i)
+			fprintf (fp, "%02X", data[offset + i]);
+		fprintf (fp, "\n");
+
+		offset += length;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static int
+dctool_trace_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *descriptor)
+{
+	int exitcode = EXIT_SUCCESS;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buffer_t *buffer = NULL;
+	FILE *fp = NULL;
+
+	// Default option values.
+	unsigned int help = 0;
+	const char *filename = NULL;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "ho:";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"output",      required_argument, 0, 'o'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 'o':
+			filename = optarg;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	// Show help message.
+	if (help) {
+		dctool_command_showhelp (&dctool_trace);
+		return EXIT_SUCCESS;
+	}
+
+	// Check mandatory arguments.
+	if (argc < 1) {
+		message ("No trace file specified.\n");
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	// Read the trace file.
+	buffer = dctool_file_read (argv[0]);
+	if (buffer == NULL) {
+		message ("Failed to open the trace file.\n");
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	// Open the output file.
+	if (filename) {
+		fp = fopen (filename, "w");
+		if (fp == NULL) {
+			message ("Failed to open the output file.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	status = render (buffer, fp ? fp : stdout);
+	if (status != DC_STATUS_SUCCESS) {
+		message ("ERROR: %s\n", dctool_errmsg (status));
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+cleanup:
+	if (fp)
+		fclose (fp);
+	dc_buffer_free (buffer);
+	return exitcode;
+}
+
+const dctool_command_t dctool_trace = {
+	dctool_trace_run,
+	DCTOOL_CONFIG_NONE,
+	"trace",
+	"Render a binary transport trace",
+	"Usage:\n"
+	"   dctool trace [options] <tracefile>\n"
+	"\n"
+	"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+	"   -h, --help                 Show help message\n"
+	"   -o, --output <filename>    Output filename\n"
+#else
+	"   -h              Show help message\n"
+	"   -o <filename>   Output filename\n"
+#endif
+	"\n"
+	"Trace files are recorded with the global --trace option, for example:\n"
+	"\n"
+	"   dctool --trace download.trc -f ostc3 download /dev/ttyUSB0\n"
+};
@@ -0,0 +1,313 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "emitter.h"
+
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+#define NDIGITS 32
+
+static const char hexdigits[] = "0123456789ABCDEF";
+
+static const double powers[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+dc_status_t
+dctool_emitter_init (dctool_emitter_t *emitter, FILE *ostream, size_t capacity)
+{
+	if (capacity < NDIGITS)
+		capacity = NDIGITS;
+
+	emitter->data = (char *) malloc (capacity);
+	emitter->size = 0;
+	emitter->capacity = emitter->data ? capacity : 0;
+	emitter->ostream = ostream;
+	emitter->status = emitter->data ? DC_STATUS_SUCCESS : DC_STATUS_NOMEMORY;
+
+	return emitter->status;
+}
+
+void
+dctool_emitter_cleanup (dctool_emitter_t *emitter)
+{
+	free (emitter->data);
+	emitter->data = NULL;
+	emitter->size = 0;
+	emitter->capacity = 0;
+}
+
+dc_status_t
+dctool_emitter_flush (dctool_emitter_t *emitter)
+{
+	if (emitter->ostream && emitter->size) {
+		if (fwrite (emitter->data, 1, emitter->size, emitter->ostream) != emitter->size)
+			emitter->status = DC_STATUS_IO;
+		emitter->size = 0;
+	}
+
+	return emitter->status;
+}
+
+void
+dctool_emitter_clear (dctool_emitter_t *emitter)
+{
+	emitter->size = 0;
+	emitter->status = DC_STATUS_SUCCESS;
+}
+
+/*
+ * Make room for at least n more bytes, and return a pointer to the free
+ * space, or NULL on failure. With a stream attached, n must not exceed
+ * the capacity.
+ */
+static char *
+dctool_emitter_reserve (dctool_emitter_t *emitter, size_t n)
+{
+	if (emitter->capacity - emitter->size >= n)
+		return emitter->data + emitter->size;
+
+	if (emitter->ostream) {
+		dctool_emitter_flush (emitter);
+		if (emitter->capacity < n)
+			return NULL;
+	} else {
+		size_t capacity = emitter->capacity ? emitter->capacity : NDIGITS;
+		while (capacity - emitter->size < n)
+			capacity *= 2;
+
+		char *data = (char *) realloc (emitter->data, capacity);
+		if (data == NULL) {
+			emitter->status = DC_STATUS_NOMEMORY;
+			return NULL;
+		}
+
+		emitter->data = data;
+		emitter->capacity = capacity;
+	}
+
+	return emitter->data + emitter->size;
+}
+
+void
+dctool_emitter_mem (dctool_emitter_t *emitter, const void *data, size_t size)
+{
+	if (emitter->ostream && size > emitter->capacity) {
+		dctool_emitter_flush (emitter);
+		if (fwrite (data, 1, size, emitter->ostream) != size)
+			emitter->status = DC_STATUS_IO;
+		return;
+	}
+
+	char *p = dctool_emitter_reserve (emitter, size);
+	if (p == NULL)
+		return;
+
+	memcpy (p, data, size);
+	emitter->size += size;
+}
+
+void
+dctool_emitter_str (dctool_emitter_t *emitter, const char *str)
+{
+	dctool_emitter_mem (emitter, str, strlen (str));
+}
+
+void
+dctool_emitter_char (dctool_emitter_t *emitter, char c)
+{
+	char *p = dctool_emitter_reserve (emitter, 1);
+	if (p == NULL)
+		return;
+
+	*p = c;
+	emitter->size++;
+}
+
+/*
+ * Format the digits of an unsigned value right aligned in the buffer,
+ * padded with zeros to the minimum width, and return the number of
+ * characters.
+ */
+static size_t
+format_digits (char buffer[NDIGITS], unsigned long long value, unsigned int width)
+{
+	char *p = buffer + NDIGITS;
+
+	do {
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	if (width > NDIGITS)
+		width = NDIGITS;
+	while (p > buffer + NDIGITS - width)
+		*--p = '0';
+
+	return buffer + NDIGITS - p;
+}
+
+void
+dctool_emitter_uint (dctool_emitter_t *emitter, unsigned int value, unsigned int width)
+{
+	char buffer[NDIGITS];
+	size_t n = format_digits (buffer, value, width);
+	dctool_emitter_mem (emitter, buffer + NDIGITS - n, n);
+}
+
+void
+dctool_emitter_int (dctool_emitter_t *emitter, int value, unsigned int width)
+{
+	if (value < 0) {
+		dctool_emitter_char (emitter, '-');
+		dctool_emitter_uint (emitter, 0U - (unsigned int) value, width ? width - 1 : 0);
+	} else {
+		dctool_emitter_uint (emitter, value, width);
+	}
+}
+
+void
+dctool_emitter_fixed (dctool_emitter_t *emitter, double value, unsigned int decimals)
+{
+	if (!isfinite (value) || decimals >= C_ARRAY_SIZE (powers))
+		goto fallback;
+
+	// Scale to an integer. The fractional part decides the rounding, and
+	// only when it is too close to one half for the rounding error of the
+	// multiplication, the result may differ from the exact decimal
+	// expansion printf uses.
+	double x = fabs (value) * powers[decimals];
+	if (x >= 1e12)
+		goto fallback;
+
+	double i = floor (x);
+	double f = x - i;
+	if (fabs (f - 0.5) < 1e-3)
+		goto fallback;
+
+	unsigned long long n = (unsigned long long) i + (f > 0.5);
+	unsigned long long scale = (unsigned long long) powers[decimals];
+
+	if (signbit (value))
+		dctool_emitter_char (emitter, '-');
+
+	char buffer[NDIGITS];
+	size_t len = format_digits (buffer, n / scale, 0);
+	if (decimals) {
+		dctool_emitter_mem (emitter, buffer + NDIGITS - len, len);
+		dctool_emitter_char (emitter, '.');
+		len = format_digits (buffer, n % scale, decimals);
+	}
+	dctool_emitter_mem (emitter, buffer + NDIGITS - len, len);
+	return;
+
+fallback:
+	{
+		char buffer[512];
+		int len = snprintf (buffer, sizeof (buffer), "%.*f", (int) decimals, value);
+		if (len < 0)
+			return;
+		if ((size_t) len >= sizeof (buffer))
+			len = sizeof (buffer) - 1;
+		dctool_emitter_mem (emitter, buffer, len);
+	}
+}
+
+void
+dctool_emitter_hex (dctool_emitter_t *emitter, const unsigned char data[], size_t size)
+{
+	while (size) {
+		size_t n = size;
+		if (n > NDIGITS / 2)
+			n = NDIGITS / 2;
+
+		char *p = dctool_emitter_reserve (emitter, 2 * n);
+		if (p == NULL)
+			return;
+
+		for (size_t i = 0; i < n; ++i) {
+			p[2 * i + 0] = hexdigits[(data[i] >> 4) & 0x0F];
+			p[2 * i + 1] = hexdigits[data[i] & 0x0F];
+		}
+
+		emitter->size += 2 * n;
+		data += n;
+		size -= n;
+	}
+}
+
+void
+dctool_emitter_xml (dctool_emitter_t *emitter, const char *str)
+{
+	const char *begin = str;
+
+	for (const char *p = str; *p; ++p) {
+		const char *entity = NULL;
+		switch (*p) {
+		case '&': entity = "&amp;"; break;
+		case '<': entity = "&lt;"; break;
+		case '>': entity = "&gt;"; break;
+		case '"': entity = "&quot;"; break;
+		case '\'': entity = "&apos;"; break;
+		default: continue;
+		}
+
+		dctool_emitter_mem (emitter, begin, p - begin);
+		dctool_emitter_str (emitter, entity);
+		begin = p + 1;
+	}
+
+	dctool_emitter_str (emitter, begin);
+}
+
+void
+dctool_emitter_json (dctool_emitter_t *emitter, const char *str)
+{
+	const char *begin = str;
+
+	dctool_emitter_char (emitter, '"');
+
+	for (const unsigned char *p = (const unsigned char *) str; *p; ++p) {
+		if (*p >= 0x20 && *p != '"' && *p != '\\')
+			continue;
+
+		dctool_emitter_mem (emitter, begin, (const char *) p - begin);
+		switch (*p) {
+		case '"': dctool_emitter_str (emitter, "\\\""); break;
+		case '\\': dctool_emitter_str (emitter, "\\\\"); break;
+		case '\n': dctool_emitter_str (emitter, "\\n"); break;
+		case '\r': dctool_emitter_str (emitter, "\\r"); break;
+		case '\t': dctool_emitter_str (emitter, "\\t"); break;
+		default:
+			dctool_emitter_str (emitter, "\\u00");
+			dctool_emitter_hex (emitter, p, 1);
+			break;
+		}
+		begin = (const char *) p + 1;
+	}
+
+	dctool_emitter_str (emitter, begin);
+	dctool_emitter_char (emitter, '"');
+}
@@ -0,0 +1,101 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DCTOOL_EMITTER_H
+#define DCTOOL_EMITTER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <libdivecomputer/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A growable text buffer with a small set of formatting primitives.
+ *
+ * When a stream is attached, the buffer is written out whenever it
+ * fills up, and it never grows beyond its initial capacity. Without a
+ * stream, the buffer grows as needed and the caller takes the data.
+ *
+ * The numeric functions produce exactly the same text as the
+ * corresponding printf conversions, without going through stdio.
+ */
+typedef struct dctool_emitter_t {
+	char *data;
+	size_t size;
+	size_t capacity;
+	FILE *ostream;
+	dc_status_t status;
+} dctool_emitter_t;
+
+dc_status_t
+dctool_emitter_init (dctool_emitter_t *emitter, FILE *ostream, size_t capacity);
+
+void
+dctool_emitter_cleanup (dctool_emitter_t *emitter);
+
+dc_status_t
+dctool_emitter_flush (dctool_emitter_t *emitter);
+
+void
+dctool_emitter_clear (dctool_emitter_t *emitter);
+
+void
+dctool_emitter_mem (dctool_emitter_t *emitter, const void *data, size_t size);
+
+void
+dctool_emitter_str (dctool_emitter_t *emitter, const char *str);
+
+void
+dctool_emitter_char (dctool_emitter_t *emitter, char c);
+
+/* printf ("%0*u", width, value) */
+void
+dctool_emitter_uint (dctool_emitter_t *emitter, unsigned int value, unsigned int width);
+
+/* printf ("%0*i", width, value) */
+void
+dctool_emitter_int (dctool_emitter_t *emitter, int value, unsigned int width);
+
+/* printf ("%.*f", decimals, value) */
+void
+dctool_emitter_fixed (dctool_emitter_t *emitter, double value, unsigned int decimals);
+
+/* printf ("%02X") for every byte */
+void
+dctool_emitter_hex (dctool_emitter_t *emitter, const unsigned char data[], size_t size);
+
+/* A string with the xml special characters escaped. */
+void
+dctool_emitter_xml (dctool_emitter_t *emitter, const char *str);
+
+/* A quoted json string. */
+void
+dctool_emitter_json (dctool_emitter_t *emitter, const char *str);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DCTOOL_EMITTER_H */
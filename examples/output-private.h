@@ -36,13 +36,24 @@ typedef struct dctool_output_vtable_t dctool_output_vtable_t;
 struct dctool_output_t {
 	const dctool_output_vtable_t *vtable;
 	unsigned int number;
+	dctool_emitter_t scratch;
 };
 
+/*
+ * Text outputs implement the format and append functions instead of the
+ * write function. The format function renders the dive into a memory
+ * buffer, and the append function adds the per dive framing (with the
+ * dive number) and writes it to the output.
+ */
 struct dctool_output_vtable_t {
 	size_t size;
 
 	dc_status_t (*write) (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
 
+	dc_status_t (*format) (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+
+	dc_status_t (*append) (dctool_output_t *output, unsigned int number, const char data[], size_t size);
+
 	dc_status_t (*free) (dctool_output_t *output);
 };
 
@@ -52,6 +63,30 @@ dctool_output_allocate (const dctool_output_vtable_t *vtable);
 void
 dctool_output_deallocate (dctool_output_t *output);
 
+double
+dctool_convert_depth (double value, dctool_units_t units);
+
+double
+dctool_convert_temperature (double value, dctool_units_t units);
+
+double
+dctool_convert_pressure (double value, dctool_units_t units);
+
+double
+dctool_convert_volume (double value, dctool_units_t units);
+
+const char *
+dctool_event_name (unsigned int type);
+
+const char *
+dctool_decostop_name (unsigned int type);
+
+const char *
+dctool_divemode_name (unsigned int type);
+
+const char *
+dctool_tankvolume_name (unsigned int type);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
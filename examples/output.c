@@ -22,8 +22,29 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include <libdivecomputer/units.h>
+
 #include "output-private.h"
 
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+static const char *g_events[] = {
+	"none", "deco", "rbt", "ascent", "ceiling", "workload", "transmitter",
+	"violation", "bookmark", "surface", "safety stop", "gaschange",
+	"safety stop (voluntary)", "safety stop (mandatory)", "deepstop",
+	"ceiling (safety stop)", "floor", "divetime", "maxdepth",
+	"OLF", "PO2", "airtime", "rgbm", "heading", "tissue level warning",
+	"gaschange2"};
+
+static const char *g_decostops[] = {
+	"ndl", "safety", "deco", "deep"};
+
+static const char *g_divemodes[] = {
+	"freedive", "gauge", "oc", "cc"};
+
+static const char *g_tankvolumes[] = {
+	"none", "metric", "imperial"};
+
 dctool_output_t *
 dctool_output_allocate (const dctool_output_vtable_t *vtable)
 {
@@ -40,6 +61,11 @@ dctool_output_allocate (const dctool_output_vtable_t *vtable)
 
 	output->vtable = vtable;
 	output->number = 0;
+	output->scratch.data = NULL;
+	output->scratch.size = 0;
+	output->scratch.capacity = 0;
+	output->scratch.ostream = NULL;
+	output->scratch.status = DC_STATUS_SUCCESS;
 
 	return output;
 }
@@ -47,18 +73,67 @@ dctool_output_allocate (const dctool_output_vtable_t *vtable)
 void
 dctool_output_deallocate (dctool_output_t *output)
 {
+	if (output == NULL)
+		return;
+
+	dctool_emitter_cleanup (&output->scratch);
 	free (output);
 }
 
 dc_status_t
 dctool_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
 {
-	if (output == NULL || output->vtable->write == NULL)
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (output == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (output->vtable->write) {
+		output->number++;
+		return output->vtable->write (output, parser, data, size, fingerprint, fsize);
+	}
+
+	if (output->vtable->format == NULL)
 		return DC_STATUS_SUCCESS;
 
+	// The dive is always written, also when formatting failed halfway.
+	dctool_emitter_clear (&output->scratch);
+	status = output->vtable->format (output, &output->scratch, parser, data, size, fingerprint, fsize);
+
+	dc_status_t rc = dctool_output_append (output, &output->scratch);
+	if (status == DC_STATUS_SUCCESS)
+		status = rc;
+
+	return status;
+}
+
+dc_status_t
+dctool_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	if (output == NULL || emitter == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (output->vtable->format == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return output->vtable->format (output, emitter, parser, data, size, fingerprint, fsize);
+}
+
+dc_status_t
+dctool_output_append (dctool_output_t *output, const dctool_emitter_t *emitter)
+{
+	if (output == NULL || emitter == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (output->vtable->append == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (emitter->status != DC_STATUS_SUCCESS)
+		return emitter->status;
+
 	output->number++;
 
-	return output->vtable->write (output, parser, data, size, fingerprint, fsize);
+	return output->vtable->append (output, output->number, emitter->data, emitter->size);
 }
 
 dc_status_t
@@ -77,3 +152,79 @@ dctool_output_free (dctool_output_t *output)
 
 	return status;
 }
+
+double
+dctool_convert_depth (double value, dctool_units_t units)
+{
+	if (units == DCTOOL_UNITS_IMPERIAL) {
+		return value / FEET;
+	} else {
+		return value;
+	}
+}
+
+double
+dctool_convert_temperature (double value, dctool_units_t units)
+{
+	if (units == DCTOOL_UNITS_IMPERIAL) {
+		return value * (9.0 / 5.0) + 32.0;
+	} else {
+		return value;
+	}
+}
+
+double
+dctool_convert_pressure (double value, dctool_units_t units)
+{
+	if (units == DCTOOL_UNITS_IMPERIAL) {
+		return value * BAR / PSI;
+	} else {
+		return value;
+	}
+}
+
+double
+dctool_convert_volume (double value, dctool_units_t units)
+{
+	if (units == DCTOOL_UNITS_IMPERIAL) {
+		return value / 1000.0 / CUFT;
+	} else {
+		return value;
+	}
+}
+
+const char *
+dctool_event_name (unsigned int type)
+{
+	if (type >= C_ARRAY_SIZE (g_events))
+		return "unknown";
+
+	return g_events[type];
+}
+
+const char *
+dctool_decostop_name (unsigned int type)
+{
+	if (type >= C_ARRAY_SIZE (g_decostops))
+		return "unknown";
+
+	return g_decostops[type];
+}
+
+const char *
+dctool_divemode_name (unsigned int type)
+{
+	if (type >= C_ARRAY_SIZE (g_divemodes))
+		return "unknown";
+
+	return g_divemodes[type];
+}
+
+const char *
+dctool_tankvolume_name (unsigned int type)
+{
+	if (type >= C_ARRAY_SIZE (g_tankvolumes))
+		return "unknown";
+
+	return g_tankvolumes[type];
+}
@@ -25,6 +25,8 @@
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/parser.h>
 
+#include "emitter.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -39,12 +41,34 @@ typedef enum dctool_units_t {
 dctool_output_t *
 dctool_xml_output_new (const char *filename, dctool_units_t units);
 
+dctool_output_t *
+dctool_json_output_new (const char *filename, dctool_units_t units);
+
+dctool_output_t *
+dctool_csv_output_new (const char *filename, dctool_units_t units);
+
+dctool_output_t *
+dctool_columnar_output_new (const char *filename);
+
 dctool_output_t *
 dctool_raw_output_new (const char *template);
 
 dc_status_t
 dctool_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
 
+/*
+ * Format a single dive into the emitter, without writing anything to the
+ * output. Only the immutable settings of the output are used, so this
+ * can be called from several threads at the same time. The formatted
+ * dive is written with dctool_output_append, which also assigns the
+ * dive number. Not all outputs support this.
+ */
+dc_status_t
+dctool_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+
+dc_status_t
+dctool_output_append (dctool_output_t *output, const dctool_emitter_t *emitter);
+
 dc_status_t
 dctool_output_free (dctool_output_t *output);
 
@@ -0,0 +1,701 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "output-private.h"
+#include "utils.h"
+
+/*
+ * Columnar binary output.
+ *
+ * All values are little endian, and always in metric units. The file
+ * starts with a 16 byte header:
+ *
+ *    0  char[4]  magic "DCOL"
+ *    4  u32      version (2)
+ *    8  u8[8]    reserved (zero)
+ *
+ * The header is followed by one block per dive, and the file ends with
+ * the dive table, the event dictionary and a 32 byte trailer:
+ *
+ *    0  u64      offset of the dive table
+ *    8  u64      offset of the event dictionary
+ *   16  u32      number of dives
+ *   20  u32      number of event names
+ *   24  u32      version (2)
+ *   28  char[4]  magic "DCOL"
+ *
+ * A reader locates the trailer at the end of the file, and uses the dive
+ * table to jump directly to the block of any dive. The dive table has an
+ * 80 byte entry per dive, in the order the dives were written:
+ *
+ *    0  u64      offset of the dive block
+ *    8  u32      size of the dive block
+ *   12  u32      dive number
+ *   16  u32      size of the raw dive data
+ *   20  i32      status (zero if the dive was parsed successfully)
+ *   24  u16      year
+ *   26  u8[5]    month, day, hour, minute, second
+ *   31  u8       dive mode (0=freedive, 1=gauge, 2=oc, 3=cc, 0xFF=unknown)
+ *   32  u32      dive time (seconds)
+ *   36  i32      maximum depth (millimetres)
+ *   40  i32      minimum temperature (0.01 degrees Celsius)
+ *   44  u32      number of samples
+ *   48  u32      number of events
+ *   52  u32      size of the fingerprint
+ *   56  u8[24]   fingerprint (truncated to 24 bytes)
+ *
+ * The event dictionary contains the event names as null terminated
+ * strings, in the order they were first used, and padded with zeros to
+ * a multiple of 8 bytes. Events refer to a name by its index in the
+ * dictionary.
+ *
+ * A dive block contains the sample table and the event table:
+ *
+ *    0  u32      number of samples (n)
+ *    4  u32      number of events (m)
+ *    8  u32      size of the time column (bytes)
+ *   12  u32      size of the depth column (bytes)
+ *   16           time column
+ *                depth column
+ *                padding to a multiple of 4 bytes
+ *                13 value columns
+ *                event table
+ *                padding to a multiple of 8 bytes
+ *
+ * The time (seconds) and depth (millimetres) columns store the difference
+ * with the previous sample (starting from zero) as zigzag encoded LEB128
+ * varints. A sample without a depth repeats the previous depth.
+ *
+ * The value columns have n i32 values each, with 0x80000000 for a
+ * missing value. In order: temperature (0.01 degrees Celsius), tank
+ * pressure (0.01 bar), tank index of that pressure, remaining bottom
+ * time (minutes), heartbeat, bearing, setpoint (0.01 bar), ppO2 (0.01 bar), CNS (0.1%),
+ * gas mix index, decompression stop type (0=ndl, 1=safety, 2=deco,
+ * 3=deep), decompression stop time (seconds) and decompression stop
+ * depth (millimetres). If a sample has the pressure of several tanks,
+ * the one with the lowest tank index is stored, so a reader can select a
+ * single tank with the tank index column.
+ *
+ * The event table has a 20 byte row per event:
+ *
+ *    0  u32      sample index
+ *    4  u32      event name (index in the event dictionary)
+ *    8  u32      time
+ *   12  u32      flags
+ *   16  u32      value
+ */
+
+#define BUFFERSIZE (64 * 1024)
+
+#define VERSION    2
+#define HEADERSIZE 16
+#define ENTRYSIZE  80
+#define EVENTSIZE  20
+#define FPSIZE     24
+
+#define MISSING    ((int) 0x80000000)
+
+enum {
+	COL_TEMPERATURE,
+	COL_PRESSURE,
+	COL_TANK,
+	COL_RBT,
+	COL_HEARTBEAT,
+	COL_BEARING,
+	COL_SETPOINT,
+	COL_PPO2,
+	COL_CNS,
+	COL_GASMIX,
+	COL_DECOTYPE,
+	COL_DECOTIME,
+	COL_DECODEPTH,
+	NCOLUMNS
+};
+
+static dc_status_t dctool_columnar_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+static dc_status_t dctool_columnar_output_append (dctool_output_t *output, unsigned int number, const char data[], size_t size);
+static dc_status_t dctool_columnar_output_free (dctool_output_t *output);
+
+/*
+ * The dive summary, as passed from the format to the append function.
+ * The formatted dive consists of the summary, followed by the dive block
+ * and the (local) event names. The append function replaces the local
+ * name indexes in the event table with the indexes in the dictionary.
+ */
+typedef struct dive_summary_t {
+	unsigned long long offset;
+	unsigned int blocksize;
+	unsigned int number;
+	unsigned int size;
+	int status;
+	dc_datetime_t datetime;
+	unsigned int divemode;
+	unsigned int divetime;
+	int maxdepth;
+	int temperature;
+	unsigned int nsamples;
+	unsigned int nevents;
+	unsigned int events;
+	unsigned int nnames;
+	unsigned int fsize;
+	unsigned char fingerprint[FPSIZE];
+} dive_summary_t;
+
+typedef struct dctool_columnar_output_t {
+	dctool_output_t base;
+	FILE *ostream;
+	dctool_emitter_t emitter;
+	unsigned long long offset;
+	dive_summary_t *dives;
+	size_t ndives;
+	size_t capacity;
+	dctool_emitter_t names;
+	unsigned int nnames;
+} dctool_columnar_output_t;
+
+static const dctool_output_vtable_t columnar_vtable = {
+	sizeof(dctool_columnar_output_t), /* size */
+	NULL, /* write */
+	dctool_columnar_output_format, /* format */
+	dctool_columnar_output_append, /* append */
+	dctool_columnar_output_free, /* free */
+};
+
+typedef struct sample_data_t {
+	dctool_emitter_t time;
+	dctool_emitter_t depth;
+	dctool_emitter_t columns[NCOLUMNS];
+	dctool_emitter_t events;
+	dctool_emitter_t names;
+	unsigned int nsamples;
+	unsigned int nevents;
+	unsigned int nnames;
+	unsigned int lasttime;
+	int lastdepth;
+	unsigned int curtime;
+	int curdepth;
+	int row[NCOLUMNS];
+} sample_data_t;
+
+static void
+put_u16 (dctool_emitter_t *e, unsigned int value)
+{
+	unsigned char buffer[2] = {
+		value & 0xFF, (value >> 8) & 0xFF};
+	dctool_emitter_mem (e, buffer, sizeof (buffer));
+}
+
+static void
+put_u32 (dctool_emitter_t *e, unsigned int value)
+{
+	unsigned char buffer[4] = {
+		value & 0xFF, (value >> 8) & 0xFF,
+		(value >> 16) & 0xFF, (value >> 24) & 0xFF};
+	dctool_emitter_mem (e, buffer, sizeof (buffer));
+}
+
+static void
+put_u64 (dctool_emitter_t *e, unsigned long long value)
+{
+	put_u32 (e, value & 0xFFFFFFFF);
+	put_u32 (e, value >> 32);
+}
+
+static void
+put_varint (dctool_emitter_t *e, long long value)
+{
+	unsigned char buffer[10];
+	unsigned int n = 0;
+
+	// Zigzag encoding.
+	unsigned long long u = ((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63);
+
+	do {
+		buffer[n] = u & 0x7F;
+		u >>= 7;
+		if (u)
+			buffer[n] |= 0x80;
+		n++;
+	} while (u);
+
+	dctool_emitter_mem (e, buffer, n);
+}
+
+static void
+put_padding (dctool_emitter_t *e, size_t size, size_t alignment)
+{
+	static const unsigned char zero[8] = {0};
+	dctool_emitter_mem (e, zero, (alignment - size % alignment) % alignment);
+}
+
+static int
+scale (double value, double factor)
+{
+	double x = floor (value * factor + 0.5);
+	if (!(x > -2147483647.0 && x <= 2147483647.0))
+		return MISSING;
+
+	return (int) x;
+}
+
+static unsigned int
+sample_name (sample_data_t *sampledata, const char *name)
+{
+	const char *p = sampledata->names.data;
+	const char *end = p + sampledata->names.size;
+
+	for (unsigned int i = 0; p < end; ++i) {
+		if (strcmp (p, name) == 0)
+			return i;
+		p += strlen (p) + 1;
+	}
+
+	dctool_emitter_mem (&sampledata->names, name, strlen (name) + 1);
+
+	return sampledata->nnames++;
+}
+
+static void
+sample_flush (sample_data_t *sampledata)
+{
+	put_varint (&sampledata->time, (long long) sampledata->curtime - sampledata->lasttime);
+	put_varint (&sampledata->depth, (long long) sampledata->curdepth - sampledata->lastdepth);
+	for (unsigned int i = 0; i < NCOLUMNS; ++i) {
+		put_u32 (&sampledata->columns[i], sampledata->row[i]);
+	}
+
+	sampledata->lasttime = sampledata->curtime;
+	sampledata->lastdepth = sampledata->curdepth;
+}
+
+static void
+sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_data_t *sampledata = (sample_data_t *) userdata;
+	int *row = sampledata->row;
+
+	if (type != DC_SAMPLE_TIME && sampledata->nsamples == 0)
+		return;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (sampledata->nsamples++)
+			sample_flush (sampledata);
+		for (unsigned int i = 0; i < NCOLUMNS; ++i)
+			row[i] = MISSING;
+		sampledata->curtime = value.time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		{
+			int depth = scale (value.depth, 1000.0);
+			if (depth != MISSING)
+				sampledata->curdepth = depth;
+		}
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if (row[COL_TANK] == MISSING || value.pressure.tank < (unsigned int) row[COL_TANK]) {
+			row[COL_PRESSURE] = scale (value.pressure.value, 100.0);
+			row[COL_TANK] = value.pressure.tank;
+		}
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		row[COL_TEMPERATURE] = scale (value.temperature, 100.0);
+		break;
+	case DC_SAMPLE_EVENT:
+		{
+			const char *name = dctool_event_name (value.event.type);
+			if (value.event.type == SAMPLE_EVENT_STRING && value.event.name)
+				name = value.event.name;
+			put_u32 (&sampledata->events, sampledata->nsamples - 1);
+			put_u32 (&sampledata->events, sample_name (sampledata, name));
+			put_u32 (&sampledata->events, value.event.time);
+			put_u32 (&sampledata->events, value.event.flags);
+			put_u32 (&sampledata->events, value.event.value);
+			sampledata->nevents++;
+		}
+		break;
+	case DC_SAMPLE_RBT:
+		row[COL_RBT] = value.rbt;
+		break;
+	case DC_SAMPLE_HEARTBEAT:
+		row[COL_HEARTBEAT] = value.heartbeat;
+		break;
+	case DC_SAMPLE_BEARING:
+		row[COL_BEARING] = value.bearing;
+		break;
+	case DC_SAMPLE_SETPOINT:
+		row[COL_SETPOINT] = scale (value.setpoint, 100.0);
+		break;
+	case DC_SAMPLE_PPO2:
+		row[COL_PPO2] = scale (value.ppo2, 100.0);
+		break;
+	case DC_SAMPLE_CNS:
+		row[COL_CNS] = scale (value.cns, 1000.0);
+		break;
+	case DC_SAMPLE_DECO:
+		row[COL_DECOTYPE] = value.deco.type;
+		row[COL_DECOTIME] = value.deco.time;
+		row[COL_DECODEPTH] = scale (value.deco.depth, 1000.0);
+		break;
+	case DC_SAMPLE_GASMIX:
+		row[COL_GASMIX] = value.gasmix;
+		break;
+	default:
+		break;
+	}
+}
+
+dctool_output_t *
+dctool_columnar_output_new (const char *filename)
+{
+	dctool_columnar_output_t *output = NULL;
+
+	if (filename == NULL)
+		goto error_exit;
+
+	// Allocate memory.
+	output = (dctool_columnar_output_t *) dctool_output_allocate (&columnar_vtable);
+	if (output == NULL) {
+		goto error_exit;
+	}
+
+	// Open the output file.
+	output->ostream = fopen (filename, "wb");
+	if (output->ostream == NULL) {
+		goto error_free;
+	}
+
+	// Allocate the write buffer.
+	if (dctool_emitter_init (&output->emitter, output->ostream, BUFFERSIZE) != DC_STATUS_SUCCESS) {
+		goto error_close;
+	}
+
+	memset (&output->names, 0, sizeof (output->names));
+	output->nnames = 0;
+	output->dives = NULL;
+	output->ndives = 0;
+	output->capacity = 0;
+
+	dctool_emitter_str (&output->emitter, "DCOL");
+	put_u32 (&output->emitter, VERSION);
+	put_u64 (&output->emitter, 0);
+	output->offset = HEADERSIZE;
+
+	return (dctool_output_t *) output;
+
+error_close:
+	fclose (output->ostream);
+error_free:
+	dctool_output_deallocate ((dctool_output_t *) output);
+error_exit:
+	return NULL;
+}
+
+static dc_status_t
+dctool_columnar_output_format (dctool_output_t *abstract, dctool_emitter_t *e, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	dive_summary_t summary;
+	memset (&summary, 0, sizeof (summary));
+	summary.size = size;
+	summary.divemode = 0xFF;
+	summary.temperature = MISSING;
+	summary.fsize = fsize;
+	if (fingerprint) {
+		memcpy (summary.fingerprint, fingerprint, fsize < FPSIZE ? fsize : FPSIZE);
+	}
+
+	// Initialize the sample data.
+	sample_data_t sampledata;
+	memset (&sampledata, 0, sizeof (sampledata));
+
+	// Parse the datetime.
+	message ("Parsing the datetime.\n");
+	status = dc_parser_get_datetime (parser, &summary.datetime);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the datetime.");
+		goto cleanup;
+	}
+
+	// Parse the divetime.
+	message ("Parsing the divetime.\n");
+	status = dc_parser_get_field (parser, DC_FIELD_DIVETIME, 0, &summary.divetime);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the divetime.");
+		goto cleanup;
+	}
+
+	// Parse the maxdepth.
+	message ("Parsing the maxdepth.\n");
+	double maxdepth = 0.0;
+	status = dc_parser_get_field (parser, DC_FIELD_MAXDEPTH, 0, &maxdepth);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the maxdepth.");
+		goto cleanup;
+	}
+
+	summary.maxdepth = scale (maxdepth, 1000.0);
+
+	// Parse the temperature.
+	message ("Parsing the temperature.\n");
+	double temperature = 0.0;
+	status = dc_parser_get_field (parser, DC_FIELD_TEMPERATURE_MINIMUM, 0, &temperature);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the temperature.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		summary.temperature = scale (temperature, 100.0);
+	}
+
+	// Parse the dive mode.
+	message ("Parsing the dive mode.\n");
+	dc_divemode_t divemode = DC_DIVEMODE_OC;
+	status = dc_parser_get_field (parser, DC_FIELD_DIVEMODE, 0, &divemode);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the dive mode.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		summary.divemode = divemode;
+	}
+
+	// Parse the sample data.
+	message ("Parsing the sample data.\n");
+	status = dc_parser_samples_foreach (parser, sample_cb, &sampledata);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR ("Error parsing the sample data.");
+		goto cleanup;
+	}
+
+cleanup:
+	if (sampledata.nsamples)
+		sample_flush (&sampledata);
+
+	summary.status = status;
+	summary.nsamples = sampledata.nsamples;
+	summary.nevents = sampledata.nevents;
+	summary.nnames = sampledata.nnames;
+
+	// Sample table.
+	size_t begin = e->size;
+	dctool_emitter_mem (e, &summary, sizeof (summary));
+	put_u32 (e, sampledata.nsamples);
+	put_u32 (e, sampledata.nevents);
+	put_u32 (e, sampledata.time.size);
+	put_u32 (e, sampledata.depth.size);
+	dctool_emitter_mem (e, sampledata.time.data, sampledata.time.size);
+	dctool_emitter_mem (e, sampledata.depth.data, sampledata.depth.size);
+	put_padding (e, sampledata.time.size + sampledata.depth.size, 4);
+	for (unsigned int i = 0; i < NCOLUMNS; ++i) {
+		dctool_emitter_mem (e, sampledata.columns[i].data, sampledata.columns[i].size);
+	}
+
+	// Event table.
+	size_t events = e->size;
+	dctool_emitter_mem (e, sampledata.events.data, sampledata.events.size);
+	put_padding (e, e->size - begin - sizeof (summary), 8);
+
+	// Update the summary.
+	summary.events = events - begin - sizeof (summary);
+	summary.blocksize = e->size - begin - sizeof (summary);
+	if (e->status == DC_STATUS_SUCCESS) {
+		memcpy (e->data + begin, &summary, sizeof (summary));
+	}
+
+	// Local event names.
+	dctool_emitter_mem (e, sampledata.names.data, sampledata.names.size);
+
+	// Report allocation failures of the columns.
+	dctool_emitter_t *columns[] = {
+		&sampledata.time, &sampledata.depth,
+		&sampledata.events, &sampledata.names};
+	for (unsigned int i = 0; i < sizeof (columns) / sizeof (columns[0]); ++i) {
+		if (columns[i]->status != DC_STATUS_SUCCESS)
+			e->status = columns[i]->status;
+		dctool_emitter_cleanup (columns[i]);
+	}
+	for (unsigned int i = 0; i < NCOLUMNS; ++i) {
+		if (sampledata.columns[i].status != DC_STATUS_SUCCESS)
+			e->status = sampledata.columns[i].status;
+		dctool_emitter_cleanup (&sampledata.columns[i]);
+	}
+
+	return status;
+}
+
+static unsigned int
+dctool_columnar_output_name (dctool_columnar_output_t *output, const char *name)
+{
+	const char *p = output->names.data;
+	const char *end = p + output->names.size;
+
+	for (unsigned int i = 0; p < end; ++i) {
+		if (strcmp (p, name) == 0)
+			return i;
+		p += strlen (p) + 1;
+	}
+
+	dctool_emitter_mem (&output->names, name, strlen (name) + 1);
+
+	return output->nnames++;
+}
+
+static dc_status_t
+dctool_columnar_output_append (dctool_output_t *abstract, unsigned int number, const char data[], size_t size)
+{
+	dctool_columnar_output_t *output = (dctool_columnar_output_t *) abstract;
+	dive_summary_t summary;
+	unsigned int map[256];
+
+	if (size < sizeof (summary))
+		return DC_STATUS_INVALIDARGS;
+
+	memcpy (&summary, data, sizeof (summary));
+	data += sizeof (summary);
+	size -= sizeof (summary);
+
+	if (size < summary.blocksize || summary.events + (size_t) summary.nevents * EVENTSIZE > summary.blocksize)
+		return DC_STATUS_INVALIDARGS;
+
+	// Grow the index before anything is written, such that the offset
+	// of the dive table always matches the written blocks.
+	if (output->ndives == output->capacity) {
+		size_t capacity = output->capacity ? output->capacity * 2 : 64;
+		dive_summary_t *dives = (dive_summary_t *) realloc (output->dives, capacity * sizeof (dive_summary_t));
+		if (dives == NULL)
+			return DC_STATUS_NOMEMORY;
+
+		output->dives = dives;
+		output->capacity = capacity;
+	}
+
+	// Map the local event names to the dictionary.
+	const char *names = data + summary.blocksize;
+	const char *end = data + size;
+	unsigned int *indexes = map;
+	if (summary.nnames > sizeof (map) / sizeof (map[0])) {
+		indexes = (unsigned int *) malloc (summary.nnames * sizeof (unsigned int));
+		if (indexes == NULL)
+			return DC_STATUS_NOMEMORY;
+	}
+
+	for (unsigned int i = 0; i < summary.nnames && names < end; ++i) {
+		indexes[i] = dctool_columnar_output_name (output, names);
+		names += strlen (names) + 1;
+	}
+
+	// Sample table.
+	dctool_emitter_mem (&output->emitter, data, summary.events);
+
+	// Event table.
+	const unsigned char *row = (const unsigned char *) data + summary.events;
+	for (unsigned int i = 0; i < summary.nevents; ++i, row += EVENTSIZE) {
+		unsigned int name = row[4] | (row[5] << 8) | (row[6] << 16) | ((unsigned int) row[7] << 24);
+		dctool_emitter_mem (&output->emitter, row, 4);
+		put_u32 (&output->emitter, name < summary.nnames ? indexes[name] : 0);
+		dctool_emitter_mem (&output->emitter, row + 8, EVENTSIZE - 8);
+	}
+
+	// Padding.
+	size_t n = summary.events + (size_t) summary.nevents * EVENTSIZE;
+	dctool_emitter_mem (&output->emitter, data + n, summary.blocksize - n);
+
+	if (indexes != map)
+		free (indexes);
+
+	// Add the dive to the index.
+	summary.offset = output->offset;
+	summary.number = number;
+	output->dives[output->ndives++] = summary;
+	output->offset += summary.blocksize;
+
+	return output->emitter.status;
+}
+
+static dc_status_t
+dctool_columnar_output_free (dctool_output_t *abstract)
+{
+	dctool_columnar_output_t *output = (dctool_columnar_output_t *) abstract;
+	dctool_emitter_t *e = &output->emitter;
+
+	// Dive table.
+	unsigned long long table = output->offset;
+	for (size_t i = 0; i < output->ndives; ++i) {
+		const dive_summary_t *dive = output->dives + i;
+		unsigned char datetime[6] = {
+			dive->datetime.month, dive->datetime.day,
+			dive->datetime.hour, dive->datetime.minute,
+			dive->datetime.second, dive->divemode};
+		unsigned char fingerprint[FPSIZE] = {0};
+		memcpy (fingerprint, dive->fingerprint, dive->fsize < FPSIZE ? dive->fsize : FPSIZE);
+
+		put_u64 (e, dive->offset);
+		put_u32 (e, dive->blocksize);
+		put_u32 (e, dive->number);
+		put_u32 (e, dive->size);
+		put_u32 (e, dive->status);
+		put_u16 (e, dive->datetime.year);
+		dctool_emitter_mem (e, datetime, sizeof (datetime));
+		put_u32 (e, dive->divetime);
+		put_u32 (e, dive->maxdepth);
+		put_u32 (e, dive->temperature);
+		put_u32 (e, dive->nsamples);
+		put_u32 (e, dive->nevents);
+		put_u32 (e, dive->fsize);
+		dctool_emitter_mem (e, fingerprint, sizeof (fingerprint));
+	}
+
+	// Event dictionary.
+	unsigned long long dictionary = table + output->ndives * ENTRYSIZE;
+	dctool_emitter_mem (e, output->names.data, output->names.size);
+	put_padding (e, output->names.size, 8);
+
+	// Trailer.
+	put_u64 (e, table);
+	put_u64 (e, dictionary);
+	put_u32 (e, output->ndives);
+	put_u32 (e, output->nnames);
+	put_u32 (e, VERSION);
+	dctool_emitter_str (e, "DCOL");
+
+	dc_status_t status = dctool_emitter_flush (e);
+	if (status == DC_STATUS_SUCCESS && output->names.status != DC_STATUS_SUCCESS)
+		status = output->names.status;
+
+	dctool_emitter_cleanup (e);
+	dctool_emitter_cleanup (&output->names);
+	free (output->dives);
+
+	if (fclose (output->ostream) != 0 && status == DC_STATUS_SUCCESS)
+		status = DC_STATUS_IO;
+
+	return status;
+}
@@ -0,0 +1,319 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "output-private.h"
+#include "utils.h"
+
+#define BUFFERSIZE (64 * 1024)
+
+#define ROW_DEPTH       0x0001
+#define ROW_TEMPERATURE 0x0002
+#define ROW_PRESSURE    0x0004
+#define ROW_RBT         0x0008
+#define ROW_HEARTBEAT   0x0010
+#define ROW_BEARING     0x0020
+#define ROW_SETPOINT    0x0040
+#define ROW_PPO2        0x0080
+#define ROW_CNS         0x0100
+#define ROW_GASMIX      0x0200
+#define ROW_DECO        0x0400
+
+static dc_status_t dctool_csv_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+static dc_status_t dctool_csv_output_append (dctool_output_t *output, unsigned int number, const char data[], size_t size);
+static dc_status_t dctool_csv_output_free (dctool_output_t *output);
+
+typedef struct dctool_csv_output_t {
+	dctool_output_t base;
+	FILE *ostream;
+	dctool_emitter_t emitter;
+	dctool_units_t units;
+} dctool_csv_output_t;
+
+static const dctool_output_vtable_t csv_vtable = {
+	sizeof(dctool_csv_output_t), /* size */
+	NULL, /* write */
+	dctool_csv_output_format, /* format */
+	dctool_csv_output_append, /* append */
+	dctool_csv_output_free, /* free */
+};
+
+/*
+ * All values of a sample are collected first, and written as a single
+ * row once the next sample starts. Only the first tank pressure is kept,
+ * and the names of all events are joined with a '|' character.
+ */
+typedef struct sample_row_t {
+	unsigned int flags;
+	unsigned int time;
+	double depth;
+	double temperature;
+	double pressure;
+	unsigned int rbt;
+	unsigned int heartbeat;
+	unsigned int bearing;
+	double setpoint;
+	double ppo2;
+	double cns;
+	unsigned int gasmix;
+	unsigned int decotype;
+	unsigned int decotime;
+	double decodepth;
+} sample_row_t;
+
+typedef struct sample_data_t {
+	dctool_emitter_t *emitter;
+	dctool_emitter_t events;
+	dctool_units_t units;
+	unsigned int nsamples;
+	sample_row_t row;
+} sample_data_t;
+
+static void
+csv_double (dctool_emitter_t *e, const sample_row_t *row, unsigned int flag, double value, unsigned int decimals)
+{
+	dctool_emitter_char (e, ',');
+	if (row->flags & flag)
+		dctool_emitter_fixed (e, value, decimals);
+}
+
+static void
+csv_uint (dctool_emitter_t *e, const sample_row_t *row, unsigned int flag, unsigned int value)
+{
+	dctool_emitter_char (e, ',');
+	if (row->flags & flag)
+		dctool_emitter_uint (e, value, 0);
+}
+
+static void
+sample_flush (sample_data_t *sampledata)
+{
+	dctool_emitter_t *e = sampledata->emitter;
+	const sample_row_t *row = &sampledata->row;
+
+	dctool_emitter_uint (e, row->time, 0);
+	csv_double (e, row, ROW_DEPTH, row->depth, 2);
+	csv_double (e, row, ROW_TEMPERATURE, row->temperature, 2);
+	csv_double (e, row, ROW_PRESSURE, row->pressure, 2);
+	csv_uint (e, row, ROW_RBT, row->rbt);
+	csv_uint (e, row, ROW_HEARTBEAT, row->heartbeat);
+	csv_uint (e, row, ROW_BEARING, row->bearing);
+	csv_double (e, row, ROW_SETPOINT, row->setpoint, 2);
+	csv_double (e, row, ROW_PPO2, row->ppo2, 2);
+	csv_double (e, row, ROW_CNS, row->cns, 1);
+	csv_uint (e, row, ROW_GASMIX, row->gasmix);
+	dctool_emitter_char (e, ',');
+	if (row->flags & ROW_DECO)
+		dctool_emitter_str (e, dctool_decostop_name (row->decotype));
+	csv_uint (e, row, ROW_DECO, row->decotime);
+	csv_double (e, row, ROW_DECO, row->decodepth, 2);
+	dctool_emitter_char (e, ',');
+	dctool_emitter_mem (e, sampledata->events.data, sampledata->events.size);
+	dctool_emitter_char (e, '\n');
+
+	if (sampledata->events.status != DC_STATUS_SUCCESS)
+		e->status = sampledata->events.status;
+
+	dctool_emitter_clear (&sampledata->events);
+}
+
+static void
+sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_data_t *sampledata = (sample_data_t *) userdata;
+	sample_row_t *row = &sampledata->row;
+
+	if (type != DC_SAMPLE_TIME && sampledata->nsamples == 0)
+		return;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (sampledata->nsamples++)
+			sample_flush (sampledata);
+		row->flags = 0;
+		row->time = value.time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		row->flags |= ROW_DEPTH;
+		row->depth = dctool_convert_depth (value.depth, sampledata->units);
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if ((row->flags & ROW_PRESSURE) == 0) {
+			row->flags |= ROW_PRESSURE;
+			row->pressure = dctool_convert_pressure (value.pressure.value, sampledata->units);
+		}
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		row->flags |= ROW_TEMPERATURE;
+		row->temperature = dctool_convert_temperature (value.temperature, sampledata->units);
+		break;
+	case DC_SAMPLE_EVENT:
+		if (value.event.type != SAMPLE_EVENT_GASCHANGE && value.event.type != SAMPLE_EVENT_GASCHANGE2) {
+			if (sampledata->events.size)
+				dctool_emitter_char (&sampledata->events, '|');
+			dctool_emitter_str (&sampledata->events, dctool_event_name (value.event.type));
+		}
+		break;
+	case DC_SAMPLE_RBT:
+		row->flags |= ROW_RBT;
+		row->rbt = value.rbt;
+		break;
+	case DC_SAMPLE_HEARTBEAT:
+		row->flags |= ROW_HEARTBEAT;
+		row->heartbeat = value.heartbeat;
+		break;
+	case DC_SAMPLE_BEARING:
+		row->flags |= ROW_BEARING;
+		row->bearing = value.bearing;
+		break;
+	case DC_SAMPLE_SETPOINT:
+		row->flags |= ROW_SETPOINT;
+		row->setpoint = value.setpoint;
+		break;
+	case DC_SAMPLE_PPO2:
+		row->flags |= ROW_PPO2;
+		row->ppo2 = value.ppo2;
+		break;
+	case DC_SAMPLE_CNS:
+		row->flags |= ROW_CNS;
+		row->cns = value.cns * 100.0;
+		break;
+	case DC_SAMPLE_DECO:
+		row->flags |= ROW_DECO;
+		row->decotype = value.deco.type;
+		row->decotime = value.deco.time;
+		row->decodepth = dctool_convert_depth (value.deco.depth, sampledata->units);
+		break;
+	case DC_SAMPLE_GASMIX:
+		row->flags |= ROW_GASMIX;
+		row->gasmix = value.gasmix;
+		break;
+	default:
+		break;
+	}
+}
+
+dctool_output_t *
+dctool_csv_output_new (const char *filename, dctool_units_t units)
+{
+	dctool_csv_output_t *output = NULL;
+
+	if (filename == NULL)
+		goto error_exit;
+
+	// Allocate memory.
+	output = (dctool_csv_output_t *) dctool_output_allocate (&csv_vtable);
+	if (output == NULL) {
+		goto error_exit;
+	}
+
+	// Open the output file.
+	output->ostream = fopen (filename, "w");
+	if (output->ostream == NULL) {
+		goto error_free;
+	}
+
+	// Allocate the write buffer.
+	if (dctool_emitter_init (&output->emitter, output->ostream, BUFFERSIZE) != DC_STATUS_SUCCESS) {
+		goto error_close;
+	}
+
+	output->units = units;
+
+	dctool_emitter_str (&output->emitter,
+		"dive,time,depth,temperature,pressure,rbt,heartbeat,bearing,"
+		"setpoint,ppo2,cns,gasmix,deco,decotime,decodepth,events\n");
+
+	return (dctool_output_t *) output;
+
+error_close:
+	fclose (output->ostream);
+error_free:
+	dctool_output_deallocate ((dctool_output_t *) output);
+error_exit:
+	return NULL;
+}
+
+static dc_status_t
+dctool_csv_output_format (dctool_output_t *abstract, dctool_emitter_t *e, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dctool_csv_output_t *output = (dctool_csv_output_t *) abstract;
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	// Initialize the sample data.
+	sample_data_t sampledata = {0};
+	sampledata.nsamples = 0;
+	sampledata.emitter = e;
+	sampledata.units = output->units;
+
+	// Parse the sample data.
+	message ("Parsing the sample data.\n");
+	status = dc_parser_samples_foreach (parser, sample_cb, &sampledata);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR ("Error parsing the sample data.");
+	}
+
+	if (sampledata.nsamples)
+		sample_flush (&sampledata);
+
+	dctool_emitter_cleanup (&sampledata.events);
+
+	return status;
+}
+
+static dc_status_t
+dctool_csv_output_append (dctool_output_t *abstract, unsigned int number, const char data[], size_t size)
+{
+	dctool_csv_output_t *output = (dctool_csv_output_t *) abstract;
+
+	// Prefix every row with the dive number.
+	while (size) {
+		const char *end = (const char *) memchr (data, '\n', size);
+		size_t n = end ? (size_t) (end - data) + 1 : size;
+
+		dctool_emitter_uint (&output->emitter, number, 0);
+		dctool_emitter_char (&output->emitter, ',');
+		dctool_emitter_mem (&output->emitter, data, n);
+
+		data += n;
+		size -= n;
+	}
+
+	return output->emitter.status;
+}
+
+static dc_status_t
+dctool_csv_output_free (dctool_output_t *abstract)
+{
+	dctool_csv_output_t *output = (dctool_csv_output_t *) abstract;
+
+	dc_status_t status = dctool_emitter_flush (&output->emitter);
+	dctool_emitter_cleanup (&output->emitter);
+
+	if (fclose (output->ostream) != 0 && status == DC_STATUS_SUCCESS)
+		status = DC_STATUS_IO;
+
+	return status;
+}
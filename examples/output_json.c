@@ -0,0 +1,540 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "output-private.h"
+#include "utils.h"
+
+#define BUFFERSIZE (64 * 1024)
+
+static dc_status_t dctool_json_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+static dc_status_t dctool_json_output_append (dctool_output_t *output, unsigned int number, const char data[], size_t size);
+static dc_status_t dctool_json_output_free (dctool_output_t *output);
+
+typedef struct dctool_json_output_t {
+	dctool_output_t base;
+	FILE *ostream;
+	dctool_emitter_t emitter;
+	dctool_units_t units;
+} dctool_json_output_t;
+
+static const dctool_output_vtable_t json_vtable = {
+	sizeof(dctool_json_output_t), /* size */
+	NULL, /* write */
+	dctool_json_output_format, /* format */
+	dctool_json_output_append, /* append */
+	dctool_json_output_free, /* free */
+};
+
+/*
+ * Sample types that can occur more than once per sample are collected in
+ * separate buffers, and written as an array when the sample is complete.
+ * The buffers are reused for all samples of the dive.
+ */
+typedef struct sample_data_t {
+	dctool_emitter_t *emitter;
+	dctool_emitter_t pressures;
+	dctool_emitter_t events;
+	dctool_emitter_t vendor;
+	dctool_units_t units;
+	unsigned int nsamples;
+} sample_data_t;
+
+static void
+json_number (dctool_emitter_t *e, double value, unsigned int decimals)
+{
+	if (isfinite (value))
+		dctool_emitter_fixed (e, value, decimals);
+	else
+		dctool_emitter_str (e, "null");
+}
+
+static void
+json_array (dctool_emitter_t *e, const char *key, dctool_emitter_t *items)
+{
+	if (items->size == 0)
+		return;
+
+	dctool_emitter_str (e, key);
+	dctool_emitter_char (e, '[');
+	dctool_emitter_mem (e, items->data, items->size);
+	dctool_emitter_char (e, ']');
+
+	if (items->status != DC_STATUS_SUCCESS)
+		e->status = items->status;
+
+	dctool_emitter_clear (items);
+}
+
+static void
+json_separator (dctool_emitter_t *e)
+{
+	if (e->size)
+		dctool_emitter_char (e, ',');
+}
+
+static void
+sample_close (sample_data_t *sampledata)
+{
+	dctool_emitter_t *e = sampledata->emitter;
+
+	json_array (e, ",\"pressure\":", &sampledata->pressures);
+	json_array (e, ",\"events\":", &sampledata->events);
+	json_array (e, ",\"vendor\":", &sampledata->vendor);
+	dctool_emitter_char (e, '}');
+}
+
+static void
+sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_data_t *sampledata = (sample_data_t *) userdata;
+	dctool_emitter_t *e = sampledata->emitter;
+
+	if (type != DC_SAMPLE_TIME && sampledata->nsamples == 0)
+		return;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (sampledata->nsamples++) {
+			sample_close (sampledata);
+			dctool_emitter_str (e, ",\n{\"time\":");
+		} else {
+			dctool_emitter_str (e, ",\"samples\":[\n{\"time\":");
+		}
+		dctool_emitter_uint (e, value.time, 0);
+		break;
+	case DC_SAMPLE_DEPTH:
+		dctool_emitter_str (e, ",\"depth\":");
+		json_number (e, dctool_convert_depth (value.depth, sampledata->units), 2);
+		break;
+	case DC_SAMPLE_PRESSURE:
+		json_separator (&sampledata->pressures);
+		dctool_emitter_str (&sampledata->pressures, "{\"tank\":");
+		dctool_emitter_uint (&sampledata->pressures, value.pressure.tank, 0);
+		dctool_emitter_str (&sampledata->pressures, ",\"value\":");
+		json_number (&sampledata->pressures, dctool_convert_pressure (value.pressure.value, sampledata->units), 2);
+		dctool_emitter_char (&sampledata->pressures, '}');
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		dctool_emitter_str (e, ",\"temperature\":");
+		json_number (e, dctool_convert_temperature (value.temperature, sampledata->units), 2);
+		break;
+	case DC_SAMPLE_EVENT:
+		if (value.event.type != SAMPLE_EVENT_GASCHANGE && value.event.type != SAMPLE_EVENT_GASCHANGE2) {
+			json_separator (&sampledata->events);
+			dctool_emitter_str (&sampledata->events, "{\"type\":");
+			dctool_emitter_uint (&sampledata->events, value.event.type, 0);
+			dctool_emitter_str (&sampledata->events, ",\"time\":");
+			dctool_emitter_uint (&sampledata->events, value.event.time, 0);
+			dctool_emitter_str (&sampledata->events, ",\"flags\":");
+			dctool_emitter_uint (&sampledata->events, value.event.flags, 0);
+			dctool_emitter_str (&sampledata->events, ",\"value\":");
+			dctool_emitter_uint (&sampledata->events, value.event.value, 0);
+			dctool_emitter_str (&sampledata->events, ",\"name\":");
+			dctool_emitter_json (&sampledata->events, dctool_event_name (value.event.type));
+			dctool_emitter_char (&sampledata->events, '}');
+		}
+		break;
+	case DC_SAMPLE_RBT:
+		dctool_emitter_str (e, ",\"rbt\":");
+		dctool_emitter_uint (e, value.rbt, 0);
+		break;
+	case DC_SAMPLE_HEARTBEAT:
+		dctool_emitter_str (e, ",\"heartbeat\":");
+		dctool_emitter_uint (e, value.heartbeat, 0);
+		break;
+	case DC_SAMPLE_BEARING:
+		dctool_emitter_str (e, ",\"bearing\":");
+		dctool_emitter_uint (e, value.bearing, 0);
+		break;
+	case DC_SAMPLE_VENDOR:
+		json_separator (&sampledata->vendor);
+		dctool_emitter_str (&sampledata->vendor, "{\"type\":");
+		dctool_emitter_uint (&sampledata->vendor, value.vendor.type, 0);
+		dctool_emitter_str (&sampledata->vendor, ",\"data\":\"");
+		dctool_emitter_hex (&sampledata->vendor, (const unsigned char *) value.vendor.data, value.vendor.size);
+		dctool_emitter_str (&sampledata->vendor, "\"}");
+		break;
+	case DC_SAMPLE_SETPOINT:
+		dctool_emitter_str (e, ",\"setpoint\":");
+		json_number (e, value.setpoint, 2);
+		break;
+	case DC_SAMPLE_PPO2:
+		dctool_emitter_str (e, ",\"ppo2\":");
+		json_number (e, value.ppo2, 2);
+		break;
+	case DC_SAMPLE_CNS:
+		dctool_emitter_str (e, ",\"cns\":");
+		json_number (e, value.cns * 100.0, 1);
+		break;
+	case DC_SAMPLE_DECO:
+		dctool_emitter_str (e, ",\"deco\":{\"type\":");
+		dctool_emitter_json (e, dctool_decostop_name (value.deco.type));
+		dctool_emitter_str (e, ",\"time\":");
+		dctool_emitter_uint (e, value.deco.time, 0);
+		dctool_emitter_str (e, ",\"depth\":");
+		json_number (e, dctool_convert_depth (value.deco.depth, sampledata->units), 2);
+		dctool_emitter_char (e, '}');
+		break;
+	case DC_SAMPLE_GASMIX:
+		dctool_emitter_str (e, ",\"gasmix\":");
+		dctool_emitter_uint (e, value.gasmix, 0);
+		break;
+	default:
+		break;
+	}
+}
+
+dctool_output_t *
+dctool_json_output_new (const char *filename, dctool_units_t units)
+{
+	dctool_json_output_t *output = NULL;
+
+	if (filename == NULL)
+		goto error_exit;
+
+	// Allocate memory.
+	output = (dctool_json_output_t *) dctool_output_allocate (&json_vtable);
+	if (output == NULL) {
+		goto error_exit;
+	}
+
+	// Open the output file.
+	output->ostream = fopen (filename, "w");
+	if (output->ostream == NULL) {
+		goto error_free;
+	}
+
+	// Allocate the write buffer.
+	if (dctool_emitter_init (&output->emitter, output->ostream, BUFFERSIZE) != DC_STATUS_SUCCESS) {
+		goto error_close;
+	}
+
+	output->units = units;
+
+	dctool_emitter_char (&output->emitter, '[');
+
+	return (dctool_output_t *) output;
+
+error_close:
+	fclose (output->ostream);
+error_free:
+	dctool_output_deallocate ((dctool_output_t *) output);
+error_exit:
+	return NULL;
+}
+
+static dc_status_t
+dctool_json_output_format (dctool_output_t *abstract, dctool_emitter_t *e, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dctool_json_output_t *output = (dctool_json_output_t *) abstract;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	const char *closing = NULL;
+
+	// Initialize the sample data.
+	sample_data_t sampledata = {0};
+	sampledata.nsamples = 0;
+	sampledata.emitter = e;
+	sampledata.units = output->units;
+
+	dctool_emitter_str (e, "\"size\":");
+	dctool_emitter_uint (e, size, 0);
+
+	if (fingerprint) {
+		dctool_emitter_str (e, ",\"fingerprint\":\"");
+		dctool_emitter_hex (e, fingerprint, fsize);
+		dctool_emitter_char (e, '"');
+	}
+
+	// Parse the datetime.
+	message ("Parsing the datetime.\n");
+	dc_datetime_t dt = {0};
+	status = dc_parser_get_datetime (parser, &dt);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the datetime.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"datetime\":\"");
+		dctool_emitter_int (e, dt.year, 4);
+		dctool_emitter_char (e, '-');
+		dctool_emitter_int (e, dt.month, 2);
+		dctool_emitter_char (e, '-');
+		dctool_emitter_int (e, dt.day, 2);
+		dctool_emitter_char (e, 'T');
+		dctool_emitter_int (e, dt.hour, 2);
+		dctool_emitter_char (e, ':');
+		dctool_emitter_int (e, dt.minute, 2);
+		dctool_emitter_char (e, ':');
+		dctool_emitter_int (e, dt.second, 2);
+		dctool_emitter_char (e, '"');
+	}
+
+	// Parse the divetime.
+	message ("Parsing the divetime.\n");
+	unsigned int divetime = 0;
+	status = dc_parser_get_field (parser, DC_FIELD_DIVETIME, 0, &divetime);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the divetime.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"divetime\":");
+		dctool_emitter_uint (e, divetime, 0);
+	}
+
+	// Parse the maxdepth.
+	message ("Parsing the maxdepth.\n");
+	double maxdepth = 0.0;
+	status = dc_parser_get_field (parser, DC_FIELD_MAXDEPTH, 0, &maxdepth);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the maxdepth.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"maxdepth\":");
+		json_number (e, dctool_convert_depth (maxdepth, output->units), 2);
+	}
+
+	// Parse the temperature.
+	message ("Parsing the temperature.\n");
+	for (unsigned int i = 0; i < 3; ++i) {
+		dc_field_type_t fields[] = {DC_FIELD_TEMPERATURE_SURFACE,
+			DC_FIELD_TEMPERATURE_MINIMUM,
+			DC_FIELD_TEMPERATURE_MAXIMUM};
+		const char *names[] = {"surface", "minimum", "maximum"};
+
+		double temperature = 0.0;
+		status = dc_parser_get_field (parser, fields[i], 0, &temperature);
+		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+			ERROR ("Error parsing the temperature.");
+			goto cleanup;
+		}
+
+		if (status != DC_STATUS_UNSUPPORTED) {
+			dctool_emitter_str (e, ",\"temperature_");
+			dctool_emitter_str (e, names[i]);
+			dctool_emitter_str (e, "\":");
+			json_number (e, dctool_convert_temperature (temperature, output->units), 1);
+		}
+	}
+
+	// Parse the gas mixes.
+	message ("Parsing the gas mixes.\n");
+	unsigned int ngases = 0;
+	status = dc_parser_get_field (parser, DC_FIELD_GASMIX_COUNT, 0, &ngases);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the gas mix count.");
+		goto cleanup;
+	}
+
+	dctool_emitter_str (e, ",\"gasmixes\":[");
+	closing = "]";
+	for (unsigned int i = 0; i < ngases; ++i) {
+		dc_gasmix_t gasmix = {0};
+		status = dc_parser_get_field (parser, DC_FIELD_GASMIX, i, &gasmix);
+		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+			ERROR ("Error parsing the gas mix.");
+			goto cleanup;
+		}
+
+		dctool_emitter_str (e, i ? ",{\"he\":" : "{\"he\":");
+		json_number (e, gasmix.helium * 100.0, 1);
+		dctool_emitter_str (e, ",\"o2\":");
+		json_number (e, gasmix.oxygen * 100.0, 1);
+		dctool_emitter_str (e, ",\"n2\":");
+		json_number (e, gasmix.nitrogen * 100.0, 1);
+		dctool_emitter_char (e, '}');
+	}
+	dctool_emitter_char (e, ']');
+	closing = NULL;
+
+	// Parse the tanks.
+	message ("Parsing the tanks.\n");
+	unsigned int ntanks = 0;
+	status = dc_parser_get_field (parser, DC_FIELD_TANK_COUNT, 0, &ntanks);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the tank count.");
+		goto cleanup;
+	}
+
+	dctool_emitter_str (e, ",\"tanks\":[");
+	closing = "]";
+	for (unsigned int i = 0; i < ntanks; ++i) {
+		dc_tank_t tank = {0};
+		status = dc_parser_get_field (parser, DC_FIELD_TANK, i, &tank);
+		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+			ERROR ("Error parsing the tank.");
+			goto cleanup;
+		}
+
+		dctool_emitter_str (e, i ? ",{\"gasmix\":" : "{\"gasmix\":");
+		if (tank.gasmix != DC_GASMIX_UNKNOWN)
+			dctool_emitter_uint (e, tank.gasmix, 0);
+		else
+			dctool_emitter_str (e, "null");
+		dctool_emitter_str (e, ",\"type\":");
+		dctool_emitter_json (e, dctool_tankvolume_name (tank.type));
+		if (tank.type != DC_TANKVOLUME_NONE) {
+			dctool_emitter_str (e, ",\"volume\":");
+			json_number (e, dctool_convert_volume (tank.volume, output->units), 1);
+			dctool_emitter_str (e, ",\"workpressure\":");
+			json_number (e, dctool_convert_pressure (tank.workpressure, output->units), 2);
+		}
+		dctool_emitter_str (e, ",\"beginpressure\":");
+		json_number (e, dctool_convert_pressure (tank.beginpressure, output->units), 2);
+		dctool_emitter_str (e, ",\"endpressure\":");
+		json_number (e, dctool_convert_pressure (tank.endpressure, output->units), 2);
+		dctool_emitter_char (e, '}');
+	}
+	dctool_emitter_char (e, ']');
+	closing = NULL;
+
+	// Parse the dive mode.
+	message ("Parsing the dive mode.\n");
+	dc_divemode_t divemode = DC_DIVEMODE_OC;
+	status = dc_parser_get_field (parser, DC_FIELD_DIVEMODE, 0, &divemode);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the dive mode.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"divemode\":");
+		dctool_emitter_json (e, dctool_divemode_name (divemode));
+	}
+
+	// Parse the salinity.
+	message ("Parsing the salinity.\n");
+	dc_salinity_t salinity = {DC_WATER_FRESH, 0.0};
+	status = dc_parser_get_field (parser, DC_FIELD_SALINITY, 0, &salinity);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the salinity.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"salinity\":{\"type\":");
+		dctool_emitter_uint (e, salinity.type, 0);
+		dctool_emitter_str (e, ",\"density\":");
+		json_number (e, salinity.density, 1);
+		dctool_emitter_char (e, '}');
+	}
+
+	// Parse the atmospheric pressure.
+	message ("Parsing the atmospheric pressure.\n");
+	double atmospheric = 0.0;
+	status = dc_parser_get_field (parser, DC_FIELD_ATMOSPHERIC, 0, &atmospheric);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error parsing the atmospheric pressure.");
+		goto cleanup;
+	}
+
+	if (status != DC_STATUS_UNSUPPORTED) {
+		dctool_emitter_str (e, ",\"atmospheric\":");
+		json_number (e, dctool_convert_pressure (atmospheric, output->units), 5);
+	}
+
+	message ("Parsing strings.\n");
+	dctool_emitter_str (e, ",\"extradata\":{");
+	closing = "}";
+	for (unsigned int i = 0; i < 100; ++i) {
+		dc_field_string_t str = { NULL };
+		status = dc_parser_get_field (parser, DC_FIELD_STRING, i, &str);
+		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+			ERROR ("Error parsing strings");
+			goto cleanup;
+		}
+		if (status == DC_STATUS_UNSUPPORTED)
+			break;
+		if (!str.desc || !str.value)
+			break;
+		if (i)
+			dctool_emitter_char (e, ',');
+		dctool_emitter_json (e, str.desc);
+		dctool_emitter_char (e, ':');
+		dctool_emitter_json (e, str.value);
+	}
+	dctool_emitter_char (e, '}');
+	closing = NULL;
+
+	// Parse the sample data.
+	message ("Parsing the sample data.\n");
+	status = dc_parser_samples_foreach (parser, sample_cb, &sampledata);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR ("Error parsing the sample data.");
+		goto cleanup;
+	}
+
+cleanup:
+
+	if (closing)
+		dctool_emitter_str (e, closing);
+
+	if (sampledata.nsamples) {
+		sample_close (&sampledata);
+		dctool_emitter_char (e, ']');
+	}
+
+	dctool_emitter_cleanup (&sampledata.pressures);
+	dctool_emitter_cleanup (&sampledata.events);
+	dctool_emitter_cleanup (&sampledata.vendor);
+
+	return status;
+}
+
+static dc_status_t
+dctool_json_output_append (dctool_output_t *abstract, unsigned int number, const char data[], size_t size)
+{
+	dctool_json_output_t *output = (dctool_json_output_t *) abstract;
+
+	dctool_emitter_str (&output->emitter, number > 1 ? ",\n{\"number\":" : "\n{\"number\":");
+	dctool_emitter_uint (&output->emitter, number, 0);
+	dctool_emitter_char (&output->emitter, ',');
+	dctool_emitter_mem (&output->emitter, data, size);
+	dctool_emitter_char (&output->emitter, '}');
+
+	return output->emitter.status;
+}
+
+static dc_status_t
+dctool_json_output_free (dctool_output_t *abstract)
+{
+	dctool_json_output_t *output = (dctool_json_output_t *) abstract;
+
+	dctool_emitter_str (&output->emitter, "\n]\n");
+
+	dc_status_t status = dctool_emitter_flush (&output->emitter);
+	dctool_emitter_cleanup (&output->emitter);
+
+	if (fclose (output->ostream) != 0 && status == DC_STATUS_SUCCESS)
+		status = DC_STATUS_IO;
+
+	return status;
+}
@@ -19,149 +19,141 @@
  * MA 02110-1301 USA
  */
 
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-#include <libdivecomputer/units.h>
-
 #include "output-private.h"
 #include "utils.h"
 
-static dc_status_t dctool_xml_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+#define BUFFERSIZE (64 * 1024)
+
+static dc_status_t dctool_xml_output_format (dctool_output_t *output, dctool_emitter_t *emitter, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+static dc_status_t dctool_xml_output_append (dctool_output_t *output, unsigned int number, const char data[], size_t size);
 static dc_status_t dctool_xml_output_free (dctool_output_t *output);
 
 typedef struct dctool_xml_output_t {
 	dctool_output_t base;
 	FILE *ostream;
+	dctool_emitter_t emitter;
 	dctool_units_t units;
 } dctool_xml_output_t;
 
 static const dctool_output_vtable_t xml_vtable = {
 	sizeof(dctool_xml_output_t), /* size */
-	dctool_xml_output_write, /* write */
+	NULL, /* write */
+	dctool_xml_output_format, /* format */
+	dctool_xml_output_append, /* append */
 	dctool_xml_output_free, /* free */
 };
 
 typedef struct sample_data_t {
-	FILE *ostream;
+	dctool_emitter_t *emitter;
 	dctool_units_t units;
 	unsigned int nsamples;
 } sample_data_t;
 
-static double
-convert_depth (double value, dctool_units_t units)
-{
-	if (units == DCTOOL_UNITS_IMPERIAL) {
-		return value / FEET;
-	} else {
-		return value;
-	}
-}
-
-static double
-convert_temperature (double value, dctool_units_t units)
-{
-	if (units == DCTOOL_UNITS_IMPERIAL) {
-		return value * (9.0 / 5.0) + 32.0;
-	} else {
-		return value;
-	}
-}
-
-static double
-convert_pressure (double value, dctool_units_t units)
-{
-	if (units == DCTOOL_UNITS_IMPERIAL) {
-		return value * BAR / PSI;
-	} else {
-		return value;
-	}
-}
-
-static double
-convert_volume (double value, dctool_units_t units)
-{
-	if (units == DCTOOL_UNITS_IMPERIAL) {
-		return value / 1000.0 / CUFT;
-	} else {
-		return value;
-	}
-}
-
 static void
 sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
 {
-	static const char *events[] = {
-		"none", "deco", "rbt", "ascent", "ceiling", "workload", "transmitter",
-		"violation", "bookmark", "surface", "safety stop", "gaschange",
-		"safety stop (voluntary)", "safety stop (mandatory)", "deepstop",
-		"ceiling (safety stop)", "floor", "divetime", "maxdepth",
-		"OLF", "PO2", "airtime", "rgbm", "heading", "tissue level warning",
-		"gaschange2"};
-	static const char *decostop[] = {
-		"ndl", "safety", "deco", "deep"};
-
 	sample_data_t *sampledata = (sample_data_t *) userdata;
+	dctool_emitter_t *e = sampledata->emitter;
 
 	switch (type) {
 	case DC_SAMPLE_TIME:
 		if (sampledata->nsamples++)
-			fprintf (sampledata->ostream, "</sample>\n");
-		fprintf (sampledata->ostream, "<sample>\n");
-		fprintf (sampledata->ostream, "   <time>%02u:%02u</time>\n", value.time / 60, value.time % 60);
+			dctool_emitter_str (e, "</sample>\n");
+		dctool_emitter_str (e, "<sample>\n   <time>");
+		dctool_emitter_uint (e, value.time / 60, 2);
+		dctool_emitter_char (e, ':');
+		dctool_emitter_uint (e, value.time % 60, 2);
+		dctool_emitter_str (e, "</time>\n");
 		break;
 	case DC_SAMPLE_DEPTH:
-		fprintf (sampledata->ostream, "   <depth>%.2f</depth>\n",
-			convert_depth(value.depth, sampledata->units));
+		dctool_emitter_str (e, "   <depth>");
+		dctool_emitter_fixed (e, dctool_convert_depth (value.depth, sampledata->units), 2);
+		dctool_emitter_str (e, "</depth>\n");
 		break;
 	case DC_SAMPLE_PRESSURE:
-		fprintf (sampledata->ostream, "   <pressure tank=\"%u\">%.2f</pressure>\n",
-			value.pressure.tank,
-			convert_pressure(value.pressure.value, sampledata->units));
+		dctool_emitter_str (e, "   <pressure tank=\"");
+		dctool_emitter_uint (e, value.pressure.tank, 0);
+		dctool_emitter_str (e, "\">");
+		dctool_emitter_fixed (e, dctool_convert_pressure (value.pressure.value, sampledata->units), 2);
+		dctool_emitter_str (e, "</pressure>\n");
 		break;
 	case DC_SAMPLE_TEMPERATURE:
-		fprintf (sampledata->ostream, "   <temperature>%.2f</temperature>\n",
-			convert_temperature(value.temperature, sampledata->units));
+		dctool_emitter_str (e, "   <temperature>");
+		dctool_emitter_fixed (e, dctool_convert_temperature (value.temperature, sampledata->units), 2);
+		dctool_emitter_str (e, "</temperature>\n");
 		break;
 	case DC_SAMPLE_EVENT:
 		if (value.event.type != SAMPLE_EVENT_GASCHANGE && value.event.type != SAMPLE_EVENT_GASCHANGE2) {
-			fprintf (sampledata->ostream, "   <event type=\"%u\" time=\"%u\" flags=\"%u\" value=\"%u\">%s</event>\n",
-				value.event.type, value.event.time, value.event.flags, value.event.value, events[value.event.type]);
+			dctool_emitter_str (e, "   <event type=\"");
+			dctool_emitter_uint (e, value.event.type, 0);
+			dctool_emitter_str (e, "\" time=\"");
+			dctool_emitter_uint (e, value.event.time, 0);
+			dctool_emitter_str (e, "\" flags=\"");
+			dctool_emitter_uint (e, value.event.flags, 0);
+			dctool_emitter_str (e, "\" value=\"");
+			dctool_emitter_uint (e, value.event.value, 0);
+			dctool_emitter_str (e, "\">");
+			dctool_emitter_str (e, dctool_event_name (value.event.type));
+			dctool_emitter_str (e, "</event>\n");
 		}
 		break;
 	case DC_SAMPLE_RBT:
-		fprintf (sampledata->ostream, "   <rbt>%u</rbt>\n", value.rbt);
+		dctool_emitter_str (e, "   <rbt>");
+		dctool_emitter_uint (e, value.rbt, 0);
+		dctool_emitter_str (e, "</rbt>\n");
 		break;
 	case DC_SAMPLE_HEARTBEAT:
-		fprintf (sampledata->ostream, "   <heartbeat>%u</heartbeat>\n", value.heartbeat);
+		dctool_emitter_str (e, "   <heartbeat>");
+		dctool_emitter_uint (e, value.heartbeat, 0);
+		dctool_emitter_str (e, "</heartbeat>\n");
 		break;
 	case DC_SAMPLE_BEARING:
-		fprintf (sampledata->ostream, "   <bearing>%u</bearing>\n", value.bearing);
+		dctool_emitter_str (e, "   <bearing>");
+		dctool_emitter_uint (e, value.bearing, 0);
+		dctool_emitter_str (e, "</bearing>\n");
 		break;
 	case DC_SAMPLE_VENDOR:
-		fprintf (sampledata->ostream, "   <vendor type=\"%u\" size=\"%u\">", value.vendor.type, value.vendor.size);
-		for (unsigned int i = 0; i < value.vendor.size; ++i)
-			fprintf (sampledata->ostream, "%02X", ((unsigned char *) value.vendor.data)[i]);
-		fprintf (sampledata->ostream, "</vendor>\n");
+		dctool_emitter_str (e, "   <vendor type=\"");
+		dctool_emitter_uint (e, value.vendor.type, 0);
+		dctool_emitter_str (e, "\" size=\"");
+		dctool_emitter_uint (e, value.vendor.size, 0);
+		dctool_emitter_str (e, "\">");
+		dctool_emitter_hex (e, (const unsigned char *) value.vendor.data, value.vendor.size);
+		dctool_emitter_str (e, "</vendor>\n");
 		break;
 	case DC_SAMPLE_SETPOINT:
-		fprintf (sampledata->ostream, "   <setpoint>%.2f</setpoint>\n", value.setpoint);
+		dctool_emitter_str (e, "   <setpoint>");
+		dctool_emitter_fixed (e, value.setpoint, 2);
+		dctool_emitter_str (e, "</setpoint>\n");
 		break;
 	case DC_SAMPLE_PPO2:
-		fprintf (sampledata->ostream, "   <ppo2>%.2f</ppo2>\n", value.ppo2);
+		dctool_emitter_str (e, "   <ppo2>");
+		dctool_emitter_fixed (e, value.ppo2, 2);
+		dctool_emitter_str (e, "</ppo2>\n");
 		break;
 	case DC_SAMPLE_CNS:
-		fprintf (sampledata->ostream, "   <cns>%.1f</cns>\n", value.cns * 100.0);
+		dctool_emitter_str (e, "   <cns>");
+		dctool_emitter_fixed (e, value.cns * 100.0, 1);
+		dctool_emitter_str (e, "</cns>\n");
 		break;
 	case DC_SAMPLE_DECO:
-		fprintf (sampledata->ostream, "   <deco time=\"%u\" depth=\"%.2f\">%s</deco>\n",
-			value.deco.time,
-			convert_depth(value.deco.depth, sampledata->units),
-			decostop[value.deco.type]);
+		dctool_emitter_str (e, "   <deco time=\"");
+		dctool_emitter_uint (e, value.deco.time, 0);
+		dctool_emitter_str (e, "\" depth=\"");
+		dctool_emitter_fixed (e, dctool_convert_depth (value.deco.depth, sampledata->units), 2);
+		dctool_emitter_str (e, "\">");
+		dctool_emitter_str (e, dctool_decostop_name (value.deco.type));
+		dctool_emitter_str (e, "</deco>\n");
 		break;
 	case DC_SAMPLE_GASMIX:
-		fprintf (sampledata->ostream, "   <gasmix>%u</gasmix>\n", value.gasmix);
+		dctool_emitter_str (e, "   <gasmix>");
+		dctool_emitter_uint (e, value.gasmix, 0);
+		dctool_emitter_str (e, "</gasmix>\n");
 		break;
 	default:
 		break;
@@ -188,12 +180,19 @@ dctool_xml_output_new (const char *filename, dctool_units_t units)
 		goto error_free;
 	}
 
+	// Allocate the write buffer.
+	if (dctool_emitter_init (&output->emitter, output->ostream, BUFFERSIZE) != DC_STATUS_SUCCESS) {
+		goto error_close;
+	}
+
 	output->units = units;
 
-	fprintf (output->ostream, "<device>\n");
+	dctool_emitter_str (&output->emitter, "<device>\n");
 
 	return (dctool_output_t *) output;
 
+error_close:
+	fclose (output->ostream);
 error_free:
 	dctool_output_deallocate ((dctool_output_t *) output);
 error_exit:
@@ -201,7 +200,7 @@ error_exit:
 }
 
 static dc_status_t
-dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+dctool_xml_output_format (dctool_output_t *abstract, dctool_emitter_t *e, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
 {
 	dctool_xml_output_t *output = (dctool_xml_output_t *) abstract;
 	dc_status_t status = DC_STATUS_SUCCESS;
@@ -209,16 +208,17 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	// Initialize the sample data.
 	sample_data_t sampledata = {0};
 	sampledata.nsamples = 0;
-	sampledata.ostream = output->ostream;
+	sampledata.emitter = e;
 	sampledata.units = output->units;
 
-	fprintf (output->ostream, "<dive>\n<number>%u</number>\n<size>%u</size>\n", abstract->number, size);
+	dctool_emitter_str (e, "<size>");
+	dctool_emitter_uint (e, size, 0);
+	dctool_emitter_str (e, "</size>\n");
 
 	if (fingerprint) {
-		fprintf (output->ostream, "<fingerprint>");
-		for (unsigned int i = 0; i < fsize; ++i)
-			fprintf (output->ostream, "%02X", fingerprint[i]);
-		fprintf (output->ostream, "</fingerprint>\n");
+		dctool_emitter_str (e, "<fingerprint>");
+		dctool_emitter_hex (e, fingerprint, fsize);
+		dctool_emitter_str (e, "</fingerprint>\n");
 	}
 
 	// Parse the datetime.
@@ -230,9 +230,19 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 		goto cleanup;
 	}
 
-	fprintf (output->ostream, "<datetime>%04i-%02i-%02i %02i:%02i:%02i</datetime>\n",
-		dt.year, dt.month, dt.day,
-		dt.hour, dt.minute, dt.second);
+	dctool_emitter_str (e, "<datetime>");
+	dctool_emitter_int (e, dt.year, 4);
+	dctool_emitter_char (e, '-');
+	dctool_emitter_int (e, dt.month, 2);
+	dctool_emitter_char (e, '-');
+	dctool_emitter_int (e, dt.day, 2);
+	dctool_emitter_char (e, ' ');
+	dctool_emitter_int (e, dt.hour, 2);
+	dctool_emitter_char (e, ':');
+	dctool_emitter_int (e, dt.minute, 2);
+	dctool_emitter_char (e, ':');
+	dctool_emitter_int (e, dt.second, 2);
+	dctool_emitter_str (e, "</datetime>\n");
 
 	// Parse the divetime.
 	message ("Parsing the divetime.\n");
@@ -243,8 +253,11 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 		goto cleanup;
 	}
 
-	fprintf (output->ostream, "<divetime>%02u:%02u</divetime>\n",
-		divetime / 60, divetime % 60);
+	dctool_emitter_str (e, "<divetime>");
+	dctool_emitter_uint (e, divetime / 60, 2);
+	dctool_emitter_char (e, ':');
+	dctool_emitter_uint (e, divetime % 60, 2);
+	dctool_emitter_str (e, "</divetime>\n");
 
 	// Parse the maxdepth.
 	message ("Parsing the maxdepth.\n");
@@ -255,8 +268,9 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 		goto cleanup;
 	}
 
-	fprintf (output->ostream, "<maxdepth>%.2f</maxdepth>\n",
-		convert_depth(maxdepth, output->units));
+	dctool_emitter_str (e, "<maxdepth>");
+	dctool_emitter_fixed (e, dctool_convert_depth (maxdepth, output->units), 2);
+	dctool_emitter_str (e, "</maxdepth>\n");
 
 	// Parse the temperature.
 	message ("Parsing the temperature.\n");
@@ -274,9 +288,11 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 		}
 
 		if (status != DC_STATUS_UNSUPPORTED) {
-			fprintf (output->ostream, "<temperature type=\"%s\">%.1f</temperature>\n",
-				names[i],
-				convert_temperature(temperature, output->units));
+			dctool_emitter_str (e, "<temperature type=\"");
+			dctool_emitter_str (e, names[i]);
+			dctool_emitter_str (e, "\">");
+			dctool_emitter_fixed (e, dctool_convert_temperature (temperature, output->units), 1);
+			dctool_emitter_str (e, "</temperature>\n");
 		}
 	}
 
@@ -297,15 +313,13 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 			goto cleanup;
 		}
 
-		fprintf (output->ostream,
-			"<gasmix>\n"
-			"   <he>%.1f</he>\n"
-			"   <o2>%.1f</o2>\n"
-			"   <n2>%.1f</n2>\n"
-			"</gasmix>\n",
-			gasmix.helium * 100.0,
-			gasmix.oxygen * 100.0,
-			gasmix.nitrogen * 100.0);
+		dctool_emitter_str (e, "<gasmix>\n   <he>");
+		dctool_emitter_fixed (e, gasmix.helium * 100.0, 1);
+		dctool_emitter_str (e, "</he>\n   <o2>");
+		dctool_emitter_fixed (e, gasmix.oxygen * 100.0, 1);
+		dctool_emitter_str (e, "</o2>\n   <n2>");
+		dctool_emitter_fixed (e, gasmix.nitrogen * 100.0, 1);
+		dctool_emitter_str (e, "</n2>\n</gasmix>\n");
 	}
 
 	// Parse the tanks.
@@ -318,8 +332,6 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	}
 
 	for (unsigned int i = 0; i < ntanks; ++i) {
-		const char *names[] = {"none", "metric", "imperial"};
-
 		dc_tank_t tank = {0};
 		status = dc_parser_get_field (parser, DC_FIELD_TANK, i, &tank);
 		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
@@ -327,27 +339,26 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 			goto cleanup;
 		}
 
-		fprintf (output->ostream, "<tank>\n");
+		dctool_emitter_str (e, "<tank>\n");
 		if (tank.gasmix != DC_GASMIX_UNKNOWN) {
-			fprintf (output->ostream,
-				"   <gasmix>%u</gasmix>\n",
-				tank.gasmix);
+			dctool_emitter_str (e, "   <gasmix>");
+			dctool_emitter_uint (e, tank.gasmix, 0);
+			dctool_emitter_str (e, "</gasmix>\n");
 		}
 		if (tank.type != DC_TANKVOLUME_NONE) {
-			fprintf (output->ostream,
-				"   <type>%s</type>\n"
-				"   <volume>%.1f</volume>\n"
-				"   <workpressure>%.2f</workpressure>\n",
-				names[tank.type],
-				convert_volume(tank.volume, output->units),
-				convert_pressure(tank.workpressure, output->units));
+			dctool_emitter_str (e, "   <type>");
+			dctool_emitter_str (e, dctool_tankvolume_name (tank.type));
+			dctool_emitter_str (e, "</type>\n   <volume>");
+			dctool_emitter_fixed (e, dctool_convert_volume (tank.volume, output->units), 1);
+			dctool_emitter_str (e, "</volume>\n   <workpressure>");
+			dctool_emitter_fixed (e, dctool_convert_pressure (tank.workpressure, output->units), 2);
+			dctool_emitter_str (e, "</workpressure>\n");
 		}
-		fprintf (output->ostream,
-			"   <beginpressure>%.2f</beginpressure>\n"
-			"   <endpressure>%.2f</endpressure>\n"
-			"</tank>\n",
-			convert_pressure(tank.beginpressure, output->units),
-			convert_pressure(tank.endpressure, output->units));
+		dctool_emitter_str (e, "   <beginpressure>");
+		dctool_emitter_fixed (e, dctool_convert_pressure (tank.beginpressure, output->units), 2);
+		dctool_emitter_str (e, "</beginpressure>\n   <endpressure>");
+		dctool_emitter_fixed (e, dctool_convert_pressure (tank.endpressure, output->units), 2);
+		dctool_emitter_str (e, "</endpressure>\n</tank>\n");
 	}
 
 	// Parse the dive mode.
@@ -360,9 +371,9 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	}
 
 	if (status != DC_STATUS_UNSUPPORTED) {
-		const char *names[] = {"freedive", "gauge", "oc", "cc"};
-		fprintf (output->ostream, "<divemode>%s</divemode>\n",
-			names[divemode]);
+		dctool_emitter_str (e, "<divemode>");
+		dctool_emitter_str (e, dctool_divemode_name (divemode));
+		dctool_emitter_str (e, "</divemode>\n");
 	}
 
 	// Parse the salinity.
@@ -375,8 +386,11 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	}
 
 	if (status != DC_STATUS_UNSUPPORTED) {
-		fprintf (output->ostream, "<salinity type=\"%u\">%.1f</salinity>\n",
-			salinity.type, salinity.density);
+		dctool_emitter_str (e, "<salinity type=\"");
+		dctool_emitter_uint (e, salinity.type, 0);
+		dctool_emitter_str (e, "\">");
+		dctool_emitter_fixed (e, salinity.density, 1);
+		dctool_emitter_str (e, "</salinity>\n");
 	}
 
 	// Parse the atmospheric pressure.
@@ -389,8 +403,9 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	}
 
 	if (status != DC_STATUS_UNSUPPORTED) {
-		fprintf (output->ostream, "<atmospheric>%.5f</atmospheric>\n",
-			convert_pressure(atmospheric, output->units));
+		dctool_emitter_str (e, "<atmospheric>");
+		dctool_emitter_fixed (e, dctool_convert_pressure (atmospheric, output->units), 5);
+		dctool_emitter_str (e, "</atmospheric>\n");
 	}
 
 	message ("Parsing strings.\n");
@@ -406,9 +421,11 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 			break;
 		if (!str.desc || !str.value)
 			break;
-		fprintf (output->ostream, "<extradata key='%s' value='%s' />\n",
-			str.desc, str.value);
-
+		dctool_emitter_str (e, "<extradata key='");
+		dctool_emitter_xml (e, str.desc);
+		dctool_emitter_str (e, "' value='");
+		dctool_emitter_xml (e, str.value);
+		dctool_emitter_str (e, "' />\n");
 	}
 
 	// Parse the sample data.
@@ -422,20 +439,37 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 cleanup:
 
 	if (sampledata.nsamples)
-		fprintf (output->ostream, "</sample>\n");
-	fprintf (output->ostream, "</dive>\n");
+		dctool_emitter_str (e, "</sample>\n");
 
 	return status;
 }
 
+static dc_status_t
+dctool_xml_output_append (dctool_output_t *abstract, unsigned int number, const char data[], size_t size)
+{
+	dctool_xml_output_t *output = (dctool_xml_output_t *) abstract;
+
+	dctool_emitter_str (&output->emitter, "<dive>\n<number>");
+	dctool_emitter_uint (&output->emitter, number, 0);
+	dctool_emitter_str (&output->emitter, "</number>\n");
+	dctool_emitter_mem (&output->emitter, data, size);
+	dctool_emitter_str (&output->emitter, "</dive>\n");
+
+	return output->emitter.status;
+}
+
 static dc_status_t
 dctool_xml_output_free (dctool_output_t *abstract)
 {
 	dctool_xml_output_t *output = (dctool_xml_output_t *) abstract;
 
-	fprintf (output->ostream, "</device>\n");
+	dctool_emitter_str (&output->emitter, "</device>\n");
 
-	fclose (output->ostream);
+	dc_status_t status = dctool_emitter_flush (&output->emitter);
+	dctool_emitter_cleanup (&output->emitter);
 
-	return DC_STATUS_SUCCESS;
+	if (fclose (output->ostream) != 0 && status == DC_STATUS_SUCCESS)
+		status = DC_STATUS_IO;
+
+	return status;
 }
@@ -0,0 +1,86 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_ARCHIVE_H
+#define DC_ARCHIVE_H
+
+#include "common.h"
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A dive archive stores the raw dive data in a single file, addressed
+ * by the family, model and a hash of the data. Adding a dive that is
+ * already present is a no-op, so the same dive can be added again on
+ * every download. The dives are compressed individually.
+ */
+typedef struct dc_archive_t dc_archive_t;
+
+typedef struct dc_archive_entry_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned long long hash;
+	const unsigned char *data;
+	unsigned int size;
+} dc_archive_entry_t;
+
+typedef int (*dc_archive_callback_t) (const dc_archive_entry_t *entry, void *userdata);
+
+/*
+ * Open the archive, or create a new one if the file doesn't exist.
+ */
+dc_status_t
+dc_archive_open (dc_archive_t **archive, dc_context_t *context, const char *filename);
+
+dc_status_t
+dc_archive_close (dc_archive_t *archive);
+
+/*
+ * Add a dive to the archive. The (optional) added parameter is set to
+ * zero if the dive was already present.
+ */
+dc_status_t
+dc_archive_add (dc_archive_t *archive, dc_family_t family, unsigned int model, const unsigned char data[], unsigned int size, unsigned int *added);
+
+/*
+ * Check whether a dive is present in the archive.
+ */
+dc_status_t
+dc_archive_contains (dc_archive_t *archive, dc_family_t family, unsigned int model, const unsigned char data[], unsigned int size, unsigned int *present);
+
+unsigned int
+dc_archive_get_count (dc_archive_t *archive);
+
+/*
+ * Pass all dives to the callback function, in the order they were
+ * added. The iteration stops when the callback returns zero.
+ */
+dc_status_t
+dc_archive_foreach (dc_archive_t *archive, dc_archive_callback_t callback, void *userdata);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_ARCHIVE_H */
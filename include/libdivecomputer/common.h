@@ -94,6 +94,14 @@ typedef enum dc_family_t {
 	DC_FAMILY_COCHRAN_COMMANDER = (14 << 16),
 } dc_family_t;
 
+typedef enum dc_transport_t {
+	DC_TRANSPORT_NONE,
+	DC_TRANSPORT_SERIAL,
+	DC_TRANSPORT_USB,
+	DC_TRANSPORT_IRDA,
+	DC_TRANSPORT_CUSTOM
+} dc_transport_t;
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
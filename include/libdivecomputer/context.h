@@ -45,6 +45,17 @@ typedef enum dc_loglevel_t {
 
 typedef void (*dc_logfunc_t) (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *message, void *userdata);
 
+typedef struct dc_trace_record_t {
+	unsigned long long timestamp; /* Monotonic clock (microseconds) */
+	unsigned int thread;          /* Recording thread (sequence number) */
+	dc_transport_t transport;
+	dc_direction_t direction;
+	const unsigned char *data;
+	unsigned int size;
+} dc_trace_record_t;
+
+typedef int (*dc_trace_callback_t) (const dc_trace_record_t *record, void *userdata);
+
 dc_status_t
 dc_context_new (dc_context_t **context);
 
@@ -60,6 +71,12 @@ dc_context_set_loglevel (dc_context_t *context, dc_loglevel_t loglevel);
 dc_status_t
 dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userdata);
 
+dc_status_t
+dc_context_set_trace (dc_context_t *context, unsigned int capacity);
+
+dc_status_t
+dc_context_trace_drain (dc_context_t *context, dc_trace_callback_t callback, void *userdata, unsigned int *dropped);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
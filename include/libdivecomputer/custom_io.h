@@ -85,6 +85,11 @@ struct dc_user_device_t;
  * download context is created, before open() is even called,
  * and isn't specific to the IO routines, but to the download
  * as a whole.
+ *
+ * The packet routines are called with a copy of the structure
+ * that belongs to a single connection, such that several
+ * connections can be open at the same time. The userdata set
+ * by packet_open() is only stored in that copy.
  */
 typedef struct dc_custom_io_t
 {
@@ -29,18 +29,32 @@
 extern "C" {
 #endif /* __cplusplus */
 
-typedef enum dc_transport_t {
-	DC_TRANSPORT_NONE,
-	DC_TRANSPORT_SERIAL,
-	DC_TRANSPORT_USB,
-	DC_TRANSPORT_IRDA
-} dc_transport_t;
-
 typedef struct dc_descriptor_t dc_descriptor_t;
 
 dc_status_t
 dc_descriptor_iterator (dc_iterator_t **iterator);
 
+/*
+ * Find the descriptor with the given family and model number. If there
+ * is no exact match, the first descriptor of the family is returned.
+ */
+dc_status_t
+dc_descriptor_find_model (dc_descriptor_t **descriptor, dc_family_t family, unsigned int model);
+
+/*
+ * Find the descriptor with the given name, which is either the product
+ * name, or the vendor and product name separated with a space. The
+ * comparison ignores case and extra whitespace.
+ */
+dc_status_t
+dc_descriptor_find_name (dc_descriptor_t **descriptor, const char *name);
+
+/*
+ * Find the descriptor with the given USB vendor and product id.
+ */
+dc_status_t
+dc_descriptor_find_usb (dc_descriptor_t **descriptor, unsigned int vid, unsigned int pid);
+
 void
 dc_descriptor_free (dc_descriptor_t *descriptor);
 
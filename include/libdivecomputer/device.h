@@ -37,7 +37,8 @@ typedef enum dc_event_type_t {
 	DC_EVENT_PROGRESS = (1 << 1),
 	DC_EVENT_DEVINFO = (1 << 2),
 	DC_EVENT_CLOCK = (1 << 3),
-	DC_EVENT_VENDOR = (1 << 4)
+	DC_EVENT_VENDOR = (1 << 4),
+	DC_EVENT_PARTIAL = (1 << 5)
 } dc_event_type_t;
 
 typedef struct dc_device_t dc_device_t;
@@ -63,6 +64,33 @@ typedef struct dc_event_vendor_t {
 	unsigned int size;
 } dc_event_vendor_t;
 
+/*
+ * The data of the dive that is currently being downloaded. The data
+ * always contains all bytes received so far (in the same format that is
+ * passed to the dive callback), and is only valid during the event. The
+ * total size is zero if it is not known in advance.
+ */
+typedef struct dc_event_partial_t {
+	const unsigned char *data;
+	unsigned int size;
+	unsigned int total;
+} dc_event_partial_t;
+
+/*
+ * Transport statistics, collected from the moment the device is opened.
+ * All times are in microseconds.
+ */
+typedef struct dc_device_stats_t {
+	unsigned long long nbytes_in;   /* Number of bytes received */
+	unsigned long long nbytes_out;  /* Number of bytes sent */
+	unsigned int nreads;            /* Number of read calls */
+	unsigned int nwrites;           /* Number of write calls */
+	unsigned int ntimeouts;         /* Number of reads or writes that timed out */
+	unsigned int npurges;           /* Number of purge calls */
+	unsigned long long read_time;   /* Time blocked in read calls */
+	unsigned long long sleep_time;  /* Time spent sleeping */
+} dc_device_stats_t;
+
 typedef int (*dc_cancel_callback_t) (void *userdata);
 
 typedef void (*dc_event_callback_t) (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata);
@@ -75,6 +103,9 @@ dc_device_open (dc_device_t **out, dc_context_t *context, dc_descriptor_t *descr
 dc_family_t
 dc_device_get_type (dc_device_t *device);
 
+dc_status_t
+dc_device_get_stats (dc_device_t *device, dc_device_stats_t *stats);
+
 dc_status_t
 dc_device_set_cancel (dc_device_t *device, dc_cancel_callback_t callback, void *userdata);
 
@@ -99,6 +130,9 @@ dc_device_dump (dc_device_t *device, dc_buffer_t *buffer);
 dc_status_t
 dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userdata);
 
+dc_status_t
+dc_extract_dives (dc_context_t *context, dc_descriptor_t *descriptor, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize, dc_dive_callback_t callback, void *userdata);
+
 dc_status_t
 dc_device_close (dc_device_t *device);
 
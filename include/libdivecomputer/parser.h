@@ -49,6 +49,9 @@ typedef enum dc_sample_type_t {
 	DC_SAMPLE_GASMIX
 } dc_sample_type_t;
 
+#define DC_SAMPLE_MASK(type) (1u << (type))
+#define DC_SAMPLE_MASK_ALL 0xFFFFFFFF
+
 typedef enum dc_field_type_t {
 	DC_FIELD_DIVETIME,
 	DC_FIELD_MAXDEPTH,
@@ -264,12 +267,46 @@ dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime);
 dc_status_t
 dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask);
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+dc_status_t
+dc_parser_samples_range (dc_parser_t *parser, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata);
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser);
 
+/*
+ * Incremental parsing of a dive that is still being downloaded. The dive
+ * data is appended in chunks, and the samples are passed to the callback
+ * as soon as they can be decoded. A sample is considered complete once
+ * the parser has moved on to the next sample time. Decoding errors are
+ * ignored until the stream is finished, because they are expected for
+ * truncated data. The stream owns the data, so the parser remains valid
+ * for retrieving the fields until the stream is freed.
+ *
+ * Every append decodes all the data received so far again, so the total
+ * cost grows quadratically with the number of chunks. Backends that
+ * validate the total length of the dive reject the truncated data, and
+ * report no samples at all until the stream is finished.
+ */
+typedef struct dc_parser_stream_t dc_parser_stream_t;
+
+dc_status_t
+dc_parser_stream_new (dc_parser_stream_t **stream, dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
+
+dc_status_t
+dc_parser_stream_append (dc_parser_stream_t *stream, const unsigned char data[], unsigned int size);
+
+dc_status_t
+dc_parser_stream_finish (dc_parser_stream_t *stream);
+
+void
+dc_parser_stream_free (dc_parser_stream_t *stream);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
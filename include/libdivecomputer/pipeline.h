@@ -0,0 +1,58 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_PIPELINE_H
+#define DC_PIPELINE_H
+
+#include "common.h"
+#include "context.h"
+#include "descriptor.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Called from one of the worker threads, with a parser that is owned by
+ * that thread and already contains the dive data. The returned value is
+ * passed unmodified to the result callback.
+ */
+typedef void * (*dc_pipeline_parse_callback_t) (dc_parser_t *parser, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata);
+
+/*
+ * Called from the calling thread, in the same order as the dives are
+ * stored in the memory dump (newest first). It is called exactly once
+ * for every dive that was handed to a worker thread, also after it has
+ * returned zero to stop the pipeline, so the results can be released.
+ */
+typedef int (*dc_pipeline_result_callback_t) (dc_status_t status, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *result, void *userdata);
+
+dc_status_t
+dc_pipeline_run (dc_context_t *context, dc_descriptor_t *descriptor, unsigned int devtime, dc_ticks_t systime,
+	const unsigned char data[], unsigned int size, unsigned int nthreads,
+	dc_pipeline_parse_callback_t parse, dc_pipeline_result_callback_t result, void *userdata);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_PIPELINE_H */
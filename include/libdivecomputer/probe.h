@@ -0,0 +1,72 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_PROBE_H
+#define DC_PROBE_H
+
+#include "common.h"
+#include "context.h"
+#include "descriptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * How well a match identifies the device. With a model match, the device
+ * reported a model number that is listed for the descriptor. With a
+ * family match, the device answered the identification handshake of the
+ * family, but its model number is unknown, and the descriptor is the
+ * first one of the family.
+ */
+typedef enum dc_probe_match_t {
+	DC_PROBE_FAMILY = 1,
+	DC_PROBE_MODEL = 2
+} dc_probe_match_t;
+
+/*
+ * Called from the calling thread, after all ports have been probed, with
+ * the best matches first. Return zero to skip the remaining matches.
+ */
+typedef int (*dc_probe_callback_t) (const char *name, dc_descriptor_t *descriptor, dc_probe_match_t match, void *userdata);
+
+/*
+ * Look for dive computers on the given serial ports, or on all serial
+ * ports if no names are given. The ports are probed concurrently. On each
+ * port, the identification handshakes of the given families (or of all
+ * families that support probing) are tried in turn, until one of them
+ * answers. The handshakes only read identification data, and leave the
+ * device ready for a download.
+ *
+ * No new handshake is started once the timeout (in milliseconds) has
+ * expired, and the read timeout of a handshake never exceeds the
+ * remaining time.
+ */
+dc_status_t
+dc_probe_run (dc_context_t *context, const char *names[], unsigned int nnames,
+	const dc_family_t families[], unsigned int nfamilies, unsigned int timeout,
+	dc_probe_callback_t callback, void *userdata);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_PROBE_H */
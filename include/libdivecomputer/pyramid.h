@@ -0,0 +1,87 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_PYRAMID_H
+#define DC_PYRAMID_H
+
+#include "common.h"
+#include "buffer.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A pyramid summarizes the depth and temperature profile of a dive at
+ * several resolutions. The buckets of level zero span the base
+ * resolution (in seconds), and every next level merges two buckets of
+ * the previous level. Buckets without any samples have a zero count.
+ */
+typedef struct dc_pyramid_t dc_pyramid_t;
+
+typedef struct dc_pyramid_bucket_t {
+	unsigned int ndepths;
+	double mindepth;
+	double maxdepth;
+	double avgdepth;
+	unsigned int ntemperatures;
+	double mintemperature;
+	double maxtemperature;
+	double avgtemperature;
+} dc_pyramid_bucket_t;
+
+dc_status_t
+dc_pyramid_new (dc_pyramid_t **pyramid, unsigned int resolution, unsigned int nlevels);
+
+void
+dc_pyramid_free (dc_pyramid_t *pyramid);
+
+/*
+ * Walk the samples of the parser and rebuild the pyramid from them. The
+ * samples are passed to the (optional) callback in the same pass. A
+ * sample time beyond 48 hours is rejected with DC_STATUS_DATAFORMAT.
+ */
+dc_status_t
+dc_pyramid_samples_foreach (dc_pyramid_t *pyramid, dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
+
+unsigned int
+dc_pyramid_get_levels (dc_pyramid_t *pyramid);
+
+dc_status_t
+dc_pyramid_get_level (dc_pyramid_t *pyramid, unsigned int level, unsigned int *resolution, const dc_pyramid_bucket_t **buckets, unsigned int *count);
+
+/*
+ * The serialized form stores the buckets of level zero only, with the
+ * depth in centimeters and the temperature in tenths of a degree. The
+ * other levels are rebuilt when the pyramid is deserialized.
+ */
+dc_status_t
+dc_pyramid_serialize (dc_pyramid_t *pyramid, dc_buffer_t *buffer);
+
+dc_status_t
+dc_pyramid_deserialize (dc_pyramid_t **pyramid, const unsigned char data[], unsigned int size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_PYRAMID_H */
@@ -0,0 +1,98 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_SYNCSTORE_H
+#define DC_SYNCSTORE_H
+
+#include "common.h"
+#include "context.h"
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A sync store keeps the state of the previous download for each dive
+ * computer, identified by its family, model and serial number, in a
+ * single file. The values are stored as opaque blobs. The fields are:
+ *
+ *  - FINGERPRINT: the fingerprint of the most recent dive.
+ *  - CLOCK: the device time (4 bytes) followed by the system time
+ *    (8 bytes), both little endian, as reported by DC_EVENT_CLOCK.
+ *  - HASHES: a list with a 64 bit hash (8 bytes, little endian) of
+ *    each downloaded dive. The hash function is up to the application.
+ *
+ * The numeric values of the fields are stored in the file, and must not
+ * change.
+ */
+typedef struct dc_syncstore_t dc_syncstore_t;
+
+typedef enum dc_syncstore_field_t {
+	DC_SYNCSTORE_FINGERPRINT = 0,
+	DC_SYNCSTORE_CLOCK = 2,
+	DC_SYNCSTORE_HASHES = 3
+} dc_syncstore_field_t;
+
+/*
+ * Open the store and load its contents. A missing file results in an
+ * empty store, which is only created on disk by the first commit. A
+ * corrupt file is ignored with a warning, and also results in an empty
+ * store.
+ */
+dc_status_t
+dc_syncstore_open (dc_syncstore_t **store, dc_context_t *context, const char *filename);
+
+/*
+ * Free the store. Uncommitted changes are discarded.
+ */
+void
+dc_syncstore_close (dc_syncstore_t *store);
+
+/*
+ * Copy the value of a field into the buffer. If the field is not
+ * present, the buffer is left empty.
+ */
+dc_status_t
+dc_syncstore_get (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field, dc_buffer_t *buffer);
+
+/*
+ * Replace the value of a field. An empty value removes the field.
+ */
+dc_status_t
+dc_syncstore_set (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field, const unsigned char data[], unsigned int size);
+
+/*
+ * Write the store to disk. The file is reloaded under an exclusive
+ * lock first, so values changed by other processes are kept unless
+ * they were modified here as well. The data is written to a temporary
+ * file, which atomically replaces the old file once it has been
+ * flushed to disk. After a crash, either the old or the new contents
+ * are found, never a mix of both.
+ */
+dc_status_t
+dc_syncstore_commit (dc_syncstore_t *store);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_SYNCSTORE_H */
@@ -1,6 +1,7 @@
 /*
 
-This is an implementation of the AES128 algorithm, specifically ECB and CBC mode.
+This is an implementation of the AES128 algorithm, specifically ECB and CBC mode,
+and decryption in CFB mode.
 
 The implementation is verified against the test vectors in:
   National Institute of Standards and Technology Special Publication 800-38A 2001 ED
@@ -587,3 +588,37 @@ void AES128_CBC_decrypt_buffer(uint8_t* output, uint8_t* input, uint32_t length,
 #endif // #if defined(CBC) && CBC
 
 
+
+#if defined(CFB) && CFB
+
+// The key expansion is done only once for the entire buffer. Input and
+// output may point to the same buffer.
+void AES128_CFB_decrypt_buffer(uint8_t* output, const uint8_t* input, uint32_t length, const uint8_t* key, const uint8_t* iv)
+{
+  uint32_t i;
+  uint8_t j;
+  uint8_t keystream[KEYLEN];
+  aes_state_t state;
+
+  state.Key = key;
+  KeyExpansion(&state);
+
+  BlockCopy(keystream, (uint8_t*)iv);
+  state.state = (state_t*)keystream;
+
+  for(i = 0; i < length; i += KEYLEN)
+  {
+    Cipher(&state);
+    for(j = 0; j < KEYLEN && i + j < length; ++j)
+    {
+      uint8_t c = input[i + j];
+      output[i + j] = c ^ keystream[j];
+      keystream[j] = c;
+    }
+  }
+}
+
+
+#endif // #if defined(CFB) && CFB
+
+
@@ -0,0 +1,585 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <libdivecomputer/archive.h>
+
+#include "context-private.h"
+#include "array.h"
+
+/*
+ * The file starts with an 8 byte header (magic and version), followed by
+ * the dives. Each dive has a 32 byte header (family, model, size, stored
+ * size, method, CRC32 of the stored data and the 64 bit hash of the raw
+ * data), followed by the stored data. All numbers are little endian.
+ *
+ * The dive data is compressed with deflate at its fastest level, which
+ * works well for the highly repetitive sample data, or stored as-is if
+ * compression doesn't help. New dives are always appended, so an
+ * interrupted write can only damage the last dive. Such an incomplete
+ * dive is ignored, and cut off before the next one is appended. An
+ * invalid dive anywhere else means the archive is corrupt.
+ *
+ * The headers are indexed in memory when the archive is opened, with an
+ * open addressing hash table on the family, model and hash, so checking
+ * whether a dive is present doesn't depend on the size of the archive.
+ * Because the hash is not a cryptographic one, a matching dive is always
+ * compared byte by byte.
+ */
+#define ARCHIVE_MAGIC   0x52414344 /* "DCAR" */
+#define ARCHIVE_VERSION 1
+
+#define SZ_HEADER 8
+#define SZ_RECORD 32
+
+#define METHOD_STORE   0
+#define METHOD_DEFLATE 1
+
+/* The maximum compression ratio of deflate. */
+#define DEFLATE_RATIO 1032
+
+typedef struct dc_archive_record_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int size;
+	unsigned int csize;
+	unsigned int method;
+	unsigned int crc;
+	unsigned long long hash;
+	long offset;
+} dc_archive_record_t;
+
+struct dc_archive_t {
+	dc_context_t *context;
+	FILE *fp;
+	long end;
+	long size;
+	dc_archive_record_t *records;
+	unsigned int count;
+	unsigned int capacity;
+	/* Hash table with the index of the records plus one. */
+	unsigned int *table;
+	unsigned int tablesize;
+};
+
+static unsigned long long
+dc_archive_hash (const unsigned char data[], unsigned int size)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (unsigned int i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+static unsigned int
+dc_archive_slot (dc_family_t family, unsigned int model, unsigned long long hash)
+{
+	unsigned long long h = hash ^ ((unsigned long long) family << 32) ^ model;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return (unsigned int) h;
+}
+
+static dc_status_t
+dc_archive_reserve (dc_archive_t *archive, unsigned int count)
+{
+	if (count > archive->capacity) {
+		unsigned int capacity = archive->capacity ? archive->capacity : 64;
+		while (capacity < count)
+			capacity *= 2;
+
+		dc_archive_record_t *records = (dc_archive_record_t *) realloc (archive->records, capacity * sizeof (dc_archive_record_t));
+		if (records == NULL) {
+			ERROR (archive->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		archive->records = records;
+		archive->capacity = capacity;
+	}
+
+	// Keep the load factor of the hash table below one half.
+	if (count * 2 >= archive->tablesize) {
+		unsigned int tablesize = archive->tablesize ? archive->tablesize * 2 : 128;
+		while (tablesize <= count * 2)
+			tablesize *= 2;
+
+		unsigned int *table = (unsigned int *) calloc (tablesize, sizeof (unsigned int));
+		if (table == NULL) {
+			ERROR (archive->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		free (archive->table);
+		archive->table = table;
+		archive->tablesize = tablesize;
+
+		for (unsigned int i = 0; i < archive->count; ++i) {
+			const dc_archive_record_t *record = archive->records + i;
+			unsigned int mask = tablesize - 1;
+			unsigned int j = dc_archive_slot (record->family, record->model, record->hash) & mask;
+			while (table[j])
+				j = (j + 1) & mask;
+			table[j] = i + 1;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_append (dc_archive_t *archive, const dc_archive_record_t *record)
+{
+	dc_status_t status = dc_archive_reserve (archive, archive->count + 1);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	unsigned int mask = archive->tablesize - 1;
+	unsigned int i = dc_archive_slot (record->family, record->model, record->hash) & mask;
+	while (archive->table[i])
+		i = (i + 1) & mask;
+
+	archive->records[archive->count] = *record;
+	archive->table[i] = ++archive->count;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Read and decompress the data of a dive. The output buffer must be
+ * large enough for the raw data.
+ */
+static dc_status_t
+dc_archive_read (dc_archive_t *archive, const dc_archive_record_t *record, unsigned char output[])
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *buffer = output;
+
+	// Stored data is read directly into the output buffer, which only
+	// holds the raw size.
+	if (record->method == METHOD_STORE && record->csize != record->size) {
+		ERROR (archive->context, "Unexpected dive data size.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	if (record->method != METHOD_STORE) {
+		buffer = (unsigned char *) malloc (record->csize ? record->csize : 1);
+		if (buffer == NULL) {
+			ERROR (archive->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	if (fseek (archive->fp, record->offset, SEEK_SET) != 0 ||
+		fread (buffer, 1, record->csize, archive->fp) != record->csize) {
+		ERROR (archive->context, "Failed to read the dive data.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	if ((unsigned int) crc32 (0, buffer, record->csize) != record->crc) {
+		ERROR (archive->context, "Unexpected dive data checksum.");
+		status = DC_STATUS_DATAFORMAT;
+		goto error;
+	}
+
+	if (record->method == METHOD_DEFLATE) {
+		uLongf size = record->size;
+		int rc = uncompress (output, &size, buffer, record->csize);
+		if (rc != Z_OK || size != record->size) {
+			ERROR (archive->context, "Failed to decompress the dive data.");
+			status = DC_STATUS_DATAFORMAT;
+			goto error;
+		}
+	}
+
+error:
+	if (buffer != output)
+		free (buffer);
+	return status;
+}
+
+static dc_status_t
+dc_archive_find (dc_archive_t *archive, dc_family_t family, unsigned int model, const unsigned char data[], unsigned int size, unsigned long long hash, unsigned int *present)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *buffer = NULL;
+
+	*present = 0;
+
+	unsigned int mask = archive->tablesize - 1;
+	unsigned int i = dc_archive_slot (family, model, hash) & mask;
+	while (archive->table[i]) {
+		const dc_archive_record_t *record = archive->records + archive->table[i] - 1;
+		if (record->family == family && record->model == model &&
+			record->hash == hash && record->size == size) {
+			if (buffer == NULL) {
+				buffer = (unsigned char *) malloc (size ? size : 1);
+				if (buffer == NULL) {
+					ERROR (archive->context, "Failed to allocate memory.");
+					return DC_STATUS_NOMEMORY;
+				}
+			}
+
+			status = dc_archive_read (archive, record, buffer);
+			if (status != DC_STATUS_SUCCESS)
+				break;
+
+			if (memcmp (buffer, data, size) == 0) {
+				*present = 1;
+				break;
+			}
+		}
+		i = (i + 1) & mask;
+	}
+
+	free (buffer);
+
+	return status;
+}
+
+static dc_status_t
+dc_archive_load (dc_archive_t *archive)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char header[SZ_HEADER];
+	long filesize = 0;
+
+	if (fseek (archive->fp, 0, SEEK_END) != 0 ||
+		(filesize = ftell (archive->fp)) < 0 ||
+		fseek (archive->fp, 0, SEEK_SET) != 0) {
+		ERROR (archive->context, "Failed to get the file size.");
+		return DC_STATUS_IO;
+	}
+
+	if (fread (header, 1, sizeof (header), archive->fp) != sizeof (header) ||
+		array_uint32_le (header) != ARCHIVE_MAGIC ||
+		array_uint32_le (header + 4) != ARCHIVE_VERSION) {
+		ERROR (archive->context, "Invalid archive header.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	long offset = SZ_HEADER;
+	while (filesize - offset >= SZ_RECORD) {
+		unsigned char data[SZ_RECORD];
+		if (fseek (archive->fp, offset, SEEK_SET) != 0 ||
+			fread (data, 1, sizeof (data), archive->fp) != sizeof (data)) {
+			ERROR (archive->context, "Failed to read the dive header.");
+			return DC_STATUS_IO;
+		}
+
+		dc_archive_record_t record;
+		record.family = (dc_family_t) array_uint32_le (data);
+		record.model = array_uint32_le (data + 4);
+		record.size = array_uint32_le (data + 8);
+		record.csize = array_uint32_le (data + 12);
+		record.method = array_uint32_le (data + 16);
+		record.crc = array_uint32_le (data + 20);
+		record.hash = array_uint32_le (data + 24) | (unsigned long long) array_uint32_le (data + 28) << 32;
+		record.offset = offset + SZ_RECORD;
+
+		// A dive that extends beyond the end of the file is the
+		// result of an interrupted write.
+		if (record.csize > (unsigned long) (filesize - record.offset))
+			break;
+
+		if (record.method > METHOD_DEFLATE ||
+			(record.method == METHOD_STORE && record.csize != record.size) ||
+			(record.method == METHOD_DEFLATE && record.size > (unsigned long long) record.csize * DEFLATE_RATIO)) {
+			ERROR (archive->context, "Invalid dive header (size %u, stored size %u).", record.size, record.csize);
+			return DC_STATUS_DATAFORMAT;
+		}
+
+		status = dc_archive_append (archive, &record);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		offset = record.offset + record.csize;
+	}
+
+	if (offset != filesize) {
+		WARNING (archive->context, "Ignoring the incomplete dive at the end of the archive.");
+	}
+
+	archive->end = offset;
+	archive->size = filesize;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_open (dc_archive_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+
+	if (out == NULL || filename == NULL) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	archive = (dc_archive_t *) malloc (sizeof (dc_archive_t));
+	if (archive == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	archive->context = context;
+	archive->fp = NULL;
+	archive->end = 0;
+	archive->size = 0;
+	archive->records = NULL;
+	archive->count = 0;
+	archive->capacity = 0;
+	archive->table = NULL;
+	archive->tablesize = 0;
+
+	status = dc_archive_reserve (archive, 0);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	archive->fp = fopen (filename, "r+b");
+	if (archive->fp == NULL && errno == ENOENT) {
+		// Create a new archive.
+		unsigned char header[SZ_HEADER];
+		array_uint32_le_set (header, ARCHIVE_MAGIC);
+		array_uint32_le_set (header + 4, ARCHIVE_VERSION);
+
+		archive->fp = fopen (filename, "w+b");
+		if (archive->fp == NULL) {
+			ERROR (context, "Failed to create the file.");
+			status = DC_STATUS_IO;
+			goto error;
+		}
+
+		if (fwrite (header, 1, sizeof (header), archive->fp) != sizeof (header) ||
+			fflush (archive->fp) != 0) {
+			ERROR (context, "Failed to write the file.");
+			status = DC_STATUS_IO;
+			goto error;
+		}
+	} else if (archive->fp == NULL) {
+		ERROR (context, "Failed to open the file.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	status = dc_archive_load (archive);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	*out = archive;
+
+	return DC_STATUS_SUCCESS;
+
+error:
+	dc_archive_close (archive);
+	return status;
+}
+
+dc_status_t
+dc_archive_close (dc_archive_t *archive)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (archive == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (archive->fp && fclose (archive->fp) != 0) {
+		ERROR (archive->context, "Failed to close the file.");
+		status = DC_STATUS_IO;
+	}
+
+	free (archive->records);
+	free (archive->table);
+	free (archive);
+
+	return status;
+}
+
+dc_status_t
+dc_archive_add (dc_archive_t *archive, dc_family_t family, unsigned int model, const unsigned char data[], unsigned int size, unsigned int *added)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *buffer = NULL;
+	unsigned int present = 0;
+
+	if (added)
+		*added = 0;
+
+	if (archive == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	unsigned long long hash = dc_archive_hash (data, size);
+
+	status = dc_archive_find (archive, family, model, data, size, hash, &present);
+	if (status != DC_STATUS_SUCCESS || present)
+		return status;
+
+	// Compress the data.
+	uLongf csize = compressBound (size);
+	buffer = (unsigned char *) malloc (SZ_RECORD + csize);
+	if (buffer == NULL) {
+		ERROR (archive->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	dc_archive_record_t record;
+	record.family = family;
+	record.model = model;
+	record.size = size;
+	record.method = METHOD_DEFLATE;
+	record.hash = hash;
+	record.offset = archive->end + SZ_RECORD;
+
+	if (compress2 (buffer + SZ_RECORD, &csize, data, size, Z_BEST_SPEED) != Z_OK || csize >= size) {
+		record.method = METHOD_STORE;
+		csize = size;
+		memcpy (buffer + SZ_RECORD, data, size);
+	}
+
+	record.csize = csize;
+	record.crc = crc32 (0, buffer + SZ_RECORD, csize);
+
+	array_uint32_le_set (buffer, record.family);
+	array_uint32_le_set (buffer + 4, record.model);
+	array_uint32_le_set (buffer + 8, record.size);
+	array_uint32_le_set (buffer + 12, record.csize);
+	array_uint32_le_set (buffer + 16, record.method);
+	array_uint32_le_set (buffer + 20, record.crc);
+	array_uint32_le_set (buffer + 24, record.hash & 0xFFFFFFFF);
+	array_uint32_le_set (buffer + 28, record.hash >> 32);
+
+	// Cut off the incomplete dive at the end of the archive, such that
+	// no stale data remains after a shorter dive.
+	if (archive->size > archive->end) {
+		if (fflush (archive->fp) != 0 ||
+#ifdef _WIN32
+			_chsize (_fileno (archive->fp), archive->end) != 0) {
+#else
+			ftruncate (fileno (archive->fp), archive->end) != 0) {
+#endif
+			ERROR (archive->context, "Failed to truncate the file.");
+			status = DC_STATUS_IO;
+			goto error;
+		}
+		archive->size = archive->end;
+	}
+
+	// Append the dive to the archive.
+	if (fseek (archive->fp, archive->end, SEEK_SET) != 0 ||
+		fwrite (buffer, 1, SZ_RECORD + csize, archive->fp) != SZ_RECORD + csize ||
+		fflush (archive->fp) != 0) {
+		ERROR (archive->context, "Failed to write the dive data.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	status = dc_archive_append (archive, &record);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	archive->end = record.offset + csize;
+	archive->size = archive->end;
+
+	if (added)
+		*added = 1;
+
+error:
+	free (buffer);
+	return status;
+}
+
+dc_status_t
+dc_archive_contains (dc_archive_t *archive, dc_family_t family, unsigned int model, const unsigned char data[], unsigned int size, unsigned int *present)
+{
+	if (archive == NULL || present == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_archive_find (archive, family, model, data, size, dc_archive_hash (data, size), present);
+}
+
+unsigned int
+dc_archive_get_count (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return 0;
+
+	return archive->count;
+}
+
+dc_status_t
+dc_archive_foreach (dc_archive_t *archive, dc_archive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *buffer = NULL;
+	unsigned int capacity = 0;
+
+	if (archive == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < archive->count; ++i) {
+		const dc_archive_record_t *record = archive->records + i;
+
+		if (record->size > capacity || buffer == NULL) {
+			unsigned char *tmp = (unsigned char *) realloc (buffer, record->size ? record->size : 1);
+			if (tmp == NULL) {
+				ERROR (archive->context, "Failed to allocate memory.");
+				status = DC_STATUS_NOMEMORY;
+				break;
+			}
+			buffer = tmp;
+			capacity = record->size;
+		}
+
+		status = dc_archive_read (archive, record, buffer);
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		dc_archive_entry_t entry;
+		entry.family = record->family;
+		entry.model = record->model;
+		entry.hash = record->hash;
+		entry.data = buffer;
+		entry.size = record->size;
+
+		if (callback && !callback (&entry, userdata))
+			break;
+	}
+
+	free (buffer);
+
+	return status;
+}
@@ -64,6 +64,28 @@ array_isequal (const unsigned char data[], unsigned int size, unsigned char valu
 }
 
 
+int
+array_iszero (const unsigned char data[], unsigned int size)
+{
+	unsigned long long accumulator = 0;
+	unsigned int i = 0;
+
+	// Combine eight bytes at a time, without an early exit, such that
+	// the compiler can turn the loop into vector instructions.
+	for (; i + 8 <= size; i += 8) {
+		unsigned long long word = 0;
+		memcpy (&word, data + i, sizeof (word));
+		accumulator |= word;
+	}
+
+	for (; i < size; ++i) {
+		accumulator |= data[i];
+	}
+
+	return accumulator == 0;
+}
+
+
 const unsigned char *
 array_search_forward (const unsigned char *data, unsigned int size,
                       const unsigned char *marker, unsigned int msize)
@@ -93,25 +115,63 @@ array_search_backward (const unsigned char *data, unsigned int size,
 }
 
 
+static const unsigned char bin2hex_table[] = {
+	'0', '1', '2', '3', '4', '5', '6', '7',
+	'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+/*
+ * Conversion table from an ASCII character to the value of the
+ * hexadecimal digit. Invalid characters have the upper nibble set,
+ * such that they can be detected after the conversion, without a
+ * branch for every character.
+ */
+#define XX 0xF0
+static const unsigned char hex2bin_table[256] = {
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, XX, XX, XX, XX, XX, XX,
+	XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX};
+#undef XX
+
 int
 array_convert_bin2hex (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize)
+{
+	unsigned char checksum = 0;
+
+	return array_convert_bin2hex_add (input, isize, output, osize, &checksum);
+}
+
+
+int
+array_convert_bin2hex_add (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned char *checksum)
 {
 	if (osize != 2 * isize)
 		return -1;
 
-	const unsigned char ascii[] = {
-		'0', '1', '2', '3', '4', '5', '6', '7',
-		'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-
+	// The additive checksum of the hexadecimal output is calculated in
+	// the same pass, instead of walking the (twice as large) output
+	// again afterwards.
+	unsigned char sum = *checksum;
 	for (unsigned int i = 0; i < isize; ++i) {
-		// Set the most-significant nibble.
-		unsigned char msn = (input[i] >> 4) & 0x0F;
-		output[i * 2 + 0] = ascii[msn];
-
-		// Set the least-significant nibble.
-		unsigned char lsn = input[i] & 0x0F;
-		output[i * 2 + 1] = ascii[lsn];
+		unsigned char msn = bin2hex_table[(input[i] >> 4) & 0x0F];
+		unsigned char lsn = bin2hex_table[input[i] & 0x0F];
+		output[i * 2 + 0] = msn;
+		output[i * 2 + 1] = lsn;
+		sum += msn + lsn;
 	}
+	*checksum = sum;
 
 	return 0;
 }
@@ -119,29 +179,34 @@ array_convert_bin2hex (const unsigned char input[], unsigned int isize, unsigned
 
 int
 array_convert_hex2bin (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize)
+{
+	unsigned char checksum = 0;
+
+	return array_convert_hex2bin_add (input, isize, output, osize, &checksum);
+}
+
+
+int
+array_convert_hex2bin_add (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned char *checksum)
 {
 	if (isize != 2 * osize)
 		return -1;
 
+	// Invalid characters are accumulated and only checked at the end,
+	// to keep the loop free of branches.
+	unsigned char invalid = 0;
+	unsigned char sum = *checksum;
 	for (unsigned int i = 0; i < osize; ++i) {
-		unsigned char value = 0;
-		for (unsigned int j = 0; j < 2; ++j) {
-			unsigned char number = 0;
-			unsigned char ascii = input[i * 2 + j];
-			if (ascii >= '0' && ascii <= '9')
-				number = ascii - '0';
-			else if (ascii >= 'A' && ascii <= 'F')
-				number = 10 + ascii - 'A';
-			else if (ascii >= 'a' && ascii <= 'f')
-				number = 10 + ascii - 'a';
-			else
-				return -1; /* Invalid character */
-
-			value <<= 4;
-			value += number;
-		}
-		output[i] = value;
+		unsigned char msn = hex2bin_table[input[i * 2 + 0]];
+		unsigned char lsn = hex2bin_table[input[i * 2 + 1]];
+		output[i] = (msn << 4) | (lsn & 0x0F);
+		invalid |= msn | lsn;
+		sum += input[i * 2 + 0] + input[i * 2 + 1];
 	}
+	*checksum = sum;
+
+	if (invalid & 0xF0)
+		return -1; /* Invalid character */
 
 	return 0;
 }
@@ -243,6 +308,13 @@ array_uint16_le (const unsigned char data[])
 	return data[0] + (data[1] << 8);
 }
 
+void
+array_uint16_le_set (unsigned char data[], const unsigned short input)
+{
+	data[0] = input & 0xFF;
+	data[1] = (input >>  8) & 0xFF;
+}
+
 unsigned char
 bcd2dec (unsigned char value)
 {
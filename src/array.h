@@ -35,6 +35,9 @@ array_reverse_bits (unsigned char data[], unsigned int size);
 int
 array_isequal (const unsigned char data[], unsigned int size, unsigned char value);
 
+int
+array_iszero (const unsigned char data[], unsigned int size);
+
 const unsigned char *
 array_search_forward (const unsigned char *data, unsigned int size,
                       const unsigned char *marker, unsigned int msize);
@@ -49,6 +52,12 @@ array_convert_bin2hex (const unsigned char input[], unsigned int isize, unsigned
 int
 array_convert_hex2bin (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize);
 
+int
+array_convert_bin2hex_add (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned char *checksum);
+
+int
+array_convert_hex2bin_add (const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned char *checksum);
+
 unsigned int
 array_convert_str2num (const unsigned char data[], unsigned int size);
 
@@ -82,6 +91,9 @@ array_uint16_be (const unsigned char data[]);
 unsigned short
 array_uint16_le (const unsigned char data[]);
 
+void
+array_uint16_le_set (unsigned char data[], const unsigned short input);
+
 unsigned char
 bcd2dec (unsigned char value);
 
@@ -32,10 +32,12 @@
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &citizen_aqualand_device_vtable)
 
+#define SZ_FINGERPRINT 8
+
 typedef struct citizen_aqualand_device_t {
 	dc_device_t base;
 	dc_serial_t *port;
-	unsigned char fingerprint[8];
+	unsigned char fingerprint[SZ_FINGERPRINT];
 } citizen_aqualand_device_t;
 
 static dc_status_t citizen_aqualand_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -82,6 +84,9 @@ citizen_aqualand_device_open (dc_device_t **out, dc_context_t *context, const ch
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (4800 8N1).
 	status = dc_serial_configure (device->port, 4800, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -220,14 +225,29 @@ citizen_aqualand_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 		return rc;
 	}
 
-	unsigned char *data = dc_buffer_get_data (buffer);
-	unsigned int   size = dc_buffer_get_size (buffer);
-
-	if (callback && memcmp (data + 0x05, device->fingerprint, sizeof (device->fingerprint)) != 0) {
-		callback (data, size, data + 0x05, sizeof (device->fingerprint), userdata);
-	}
+	rc = citizen_aqualand_extract_dives (abstract->context, device->fingerprint,
+		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
 
 	return rc;
 }
+
+
+dc_status_t
+citizen_aqualand_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	// The memory contains a single dive.
+	if (size < 0x05 + SZ_FINGERPRINT) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	if (fingerprint && memcmp (data + 0x05, fingerprint, SZ_FINGERPRINT) == 0)
+		return DC_STATUS_SUCCESS;
+
+	if (callback)
+		callback (data, size, data + 0x05, SZ_FINGERPRINT, userdata);
+
+	return DC_STATUS_SUCCESS;
+}
@@ -633,6 +633,9 @@ cochran_commander_device_open (dc_device_t **out, dc_context_t *context, const c
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	status = cochran_commander_serial_setup(device);
 	if (status != DC_STATUS_SUCCESS) {
 		goto error_close;
@@ -98,6 +98,7 @@ static const dc_parser_vtable_t cochran_commander_parser_vtable = {
 	cochran_commander_parser_get_datetime, /* datetime */
 	cochran_commander_parser_get_field, /* fields */
 	cochran_commander_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_range */
 	NULL /* destroy */
 };
 
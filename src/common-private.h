@@ -31,6 +31,9 @@ extern "C" {
 void
 dc_status_set_error (dc_status_t *status, dc_status_t error);
 
+unsigned long long
+dc_clock_now (void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -22,6 +22,13 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#ifdef _WIN32
+#define NOGDI
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 #include "common-private.h"
 
 void
@@ -32,3 +39,21 @@ dc_status_set_error (dc_status_t *status, dc_status_t error)
 	if (*status == DC_STATUS_SUCCESS)
 		*status = error;
 }
+
+/*
+ * Monotonic clock, in microseconds.
+ */
+unsigned long long
+dc_clock_now (void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceCounter (&now);
+	QueryPerformanceFrequency (&frequency);
+	return (unsigned long long) now.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
@@ -28,6 +28,7 @@
 
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/custom_io.h>
+#include <libdivecomputer/device.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,8 @@ extern "C" {
 #define DEBUG(context, ...) UNUSED(context)
 #endif
 
+#define TRACE(context, transport, direction, data, size) dc_context_trace (context, transport, direction, data, size)
+
 dc_status_t
 dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *format, ...) ATTR_FORMAT_PRINTF(6, 7);
 
@@ -72,9 +75,27 @@ dc_context_syserror (dc_context_t *context, dc_loglevel_t loglevel, const char *
 dc_status_t
 dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *prefix, const unsigned char data[], unsigned int size);
 
+void
+dc_context_trace (dc_context_t *context, dc_transport_t transport, dc_direction_t direction, const unsigned char data[], unsigned int size);
+
+dc_status_t
+_dc_context_new_child (dc_context_t **context, dc_context_t *parent);
+
 dc_custom_io_t*
 _dc_context_custom_io (dc_context_t *context);
 
+void
+dc_stats_read (dc_device_stats_t *stats, size_t nbytes, dc_status_t status, unsigned long long begin);
+
+void
+dc_stats_write (dc_device_stats_t *stats, size_t nbytes, dc_status_t status);
+
+void
+dc_stats_purge (dc_device_stats_t *stats);
+
+void
+dc_stats_sleep (dc_device_stats_t *stats, unsigned long long begin);
+
 #define RETURN_IF_CUSTOM_SERIAL(context, block, function, ...)	\
 	do { \
 		dc_custom_io_t *c = _dc_context_custom_io(context); \
@@ -32,6 +32,9 @@
 #endif
 
 #include "context-private.h"
+#include "common-private.h"
+#include "trace.h"
+#include "thread.h"
 #include <libdivecomputer/custom_io.h>
 
 struct dc_context_t {
@@ -39,6 +42,7 @@ struct dc_context_t {
 	dc_logfunc_t logfunc;
 	void *userdata;
 #ifdef ENABLE_LOGGING
+	dc_mutex_t lock;
 	char msg[8192 + 32];
 #ifdef _WIN32
 	LARGE_INTEGER timestamp, frequency;
@@ -48,6 +52,8 @@ struct dc_context_t {
 #endif
 	dc_custom_io_t *custom_io;
 	dc_user_device_t *user_device;
+	dc_trace_slot_t trace;
+	dc_context_t *parent;
 };
 
 #ifdef ENABLE_LOGGING
@@ -189,6 +195,11 @@ dc_context_new (dc_context_t **out)
 	context->userdata = NULL;
 
 #ifdef ENABLE_LOGGING
+	// The message buffer is shared between all threads using the context.
+	if (dc_mutex_init (&context->lock) != DC_STATUS_SUCCESS) {
+		free (context);
+		return DC_STATUS_NOMEMORY;
+	}
 	memset (context->msg, 0, sizeof (context->msg));
 #ifdef _WIN32
 	QueryPerformanceFrequency(&context->frequency);
@@ -200,6 +211,34 @@ dc_context_new (dc_context_t **out)
 
 	context->custom_io = NULL;
 
+	context->trace.current = NULL;
+	context->trace.retired = NULL;
+	context->parent = NULL;
+
+	*out = context;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * A context for a worker thread. The log messages and trace records are
+ * passed to the parent context.
+ */
+dc_status_t
+_dc_context_new_child (dc_context_t **out, dc_context_t *parent)
+{
+	dc_context_t *context = NULL;
+
+	if (out == NULL || parent == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_status_t rc = dc_context_new (&context);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	context->custom_io = parent->custom_io;
+	context->parent = parent;
+
 	*out = context;
 
 	return DC_STATUS_SUCCESS;
@@ -208,6 +247,14 @@ dc_context_new (dc_context_t **out)
 dc_status_t
 dc_context_free (dc_context_t *context)
 {
+	if (context == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (context->parent == NULL)
+		dc_trace_slot_free (&context->trace);
+#ifdef ENABLE_LOGGING
+	dc_mutex_free (&context->lock);
+#endif
 	free (context);
 
 	return DC_STATUS_SUCCESS;
@@ -231,6 +278,49 @@ _dc_context_custom_io (dc_context_t *context)
 	return context->custom_io;
 }
 
+void
+dc_stats_read (dc_device_stats_t *stats, size_t nbytes, dc_status_t status, unsigned long long begin)
+{
+	if (stats == NULL)
+		return;
+
+	stats->nreads++;
+	stats->nbytes_in += nbytes;
+	stats->read_time += dc_clock_now () - begin;
+	if (status == DC_STATUS_TIMEOUT)
+		stats->ntimeouts++;
+}
+
+void
+dc_stats_write (dc_device_stats_t *stats, size_t nbytes, dc_status_t status)
+{
+	if (stats == NULL)
+		return;
+
+	stats->nwrites++;
+	stats->nbytes_out += nbytes;
+	if (status == DC_STATUS_TIMEOUT)
+		stats->ntimeouts++;
+}
+
+void
+dc_stats_purge (dc_device_stats_t *stats)
+{
+	if (stats == NULL)
+		return;
+
+	stats->npurges++;
+}
+
+void
+dc_stats_sleep (dc_device_stats_t *stats, unsigned long long begin)
+{
+	if (stats == NULL)
+		return;
+
+	stats->sleep_time += dc_clock_now () - begin;
+}
+
 dc_status_t
 dc_context_set_loglevel (dc_context_t *context, dc_loglevel_t loglevel)
 {
@@ -258,6 +348,59 @@ dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userd
 	return DC_STATUS_SUCCESS;
 }
 
+dc_status_t
+dc_context_set_trace (dc_context_t *context, unsigned int capacity)
+{
+	dc_trace_t *trace = NULL;
+
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (capacity) {
+		dc_status_t rc = dc_trace_new (&trace, capacity);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+	}
+
+	// The previous trace object is freed with the context, because
+	// other threads may still be recording or draining.
+	dc_trace_slot_set (&context->trace, trace);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_context_trace_drain (dc_context_t *context, dc_trace_callback_t callback, void *userdata, unsigned int *dropped)
+{
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_trace_t *trace = dc_trace_slot_get (&context->trace);
+	if (trace == NULL) {
+		if (dropped)
+			*dropped = 0;
+		return DC_STATUS_SUCCESS;
+	}
+
+	return dc_trace_drain (trace, callback, userdata, dropped);
+}
+
+void
+dc_context_trace (dc_context_t *context, dc_transport_t transport, dc_direction_t direction, const unsigned char data[], unsigned int size)
+{
+	if (context && context->parent)
+		context = context->parent;
+
+	if (context == NULL)
+		return;
+
+	dc_trace_t *trace = dc_trace_slot_get (&context->trace);
+	if (trace == NULL)
+		return;
+
+	dc_trace_write (trace, transport, direction, data, size);
+}
+
 dc_status_t
 dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *format, ...)
 {
@@ -268,6 +411,9 @@ dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file,
 	if (context == NULL)
 		return DC_STATUS_INVALIDARGS;
 
+	if (context->parent)
+		context = context->parent;
+
 #ifdef ENABLE_LOGGING
 	if (loglevel > context->loglevel)
 		return DC_STATUS_SUCCESS;
@@ -275,11 +421,15 @@ dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file,
 	if (context->logfunc == NULL)
 		return DC_STATUS_SUCCESS;
 
+	dc_mutex_lock (&context->lock);
+
 	va_start (ap, format);
 	l_vsnprintf (context->msg, sizeof (context->msg), format, ap);
 	va_end (ap);
 
 	context->logfunc (context, loglevel, file, line, function, context->msg, context->userdata);
+
+	dc_mutex_unlock (&context->lock);
 #endif
 
 	return DC_STATUS_SUCCESS;
@@ -335,6 +485,9 @@ dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *f
 	if (context == NULL || prefix == NULL)
 		return DC_STATUS_INVALIDARGS;
 
+	if (context->parent)
+		context = context->parent;
+
 #ifdef ENABLE_LOGGING
 	if (loglevel > context->loglevel)
 		return DC_STATUS_SUCCESS;
@@ -342,6 +495,8 @@ dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *f
 	if (context->logfunc == NULL)
 		return DC_STATUS_SUCCESS;
 
+	dc_mutex_lock (&context->lock);
+
 	n = l_snprintf (context->msg, sizeof (context->msg), "%s: size=%u, data=", prefix, size);
 
 	if (n >= 0) {
@@ -349,6 +504,8 @@ dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *f
 	}
 
 	context->logfunc (context, loglevel, file, line, function, context->msg, context->userdata);
+
+	dc_mutex_unlock (&context->lock);
 #endif
 
 	return DC_STATUS_SUCCESS;
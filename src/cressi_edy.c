@@ -245,6 +245,9 @@ cressi_edy_device_open (dc_device_t **out, dc_context_t *context, const char *na
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (1200 8N1).
 	status = dc_serial_configure (device->port, 1200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -421,7 +424,7 @@ cressi_edy_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 
 	// Read the logbook data.
 	unsigned char logbook[SZ_PACKET] = {0};
-	dc_status_t rc = cressi_edy_device_read (abstract, layout->rb_logbook_offset, logbook, sizeof (logbook));
+	dc_status_t rc = dc_device_read (abstract, layout->rb_logbook_offset, logbook, sizeof (logbook));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the logbook data.");
 		return rc;
@@ -551,3 +554,45 @@ cressi_edy_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+dc_status_t
+cressi_edy_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	cressi_edy_device_t *device = NULL;
+
+	const cressi_edy_layout_t *layout = &cressi_edy_layout;
+	if (model == IQ700)
+		layout = &tusa_iq700_layout;
+
+	if (size < layout->memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Allocate memory.
+	device = (cressi_edy_device_t *) dc_device_allocate (context, &cressi_edy_device_vtable);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	device->port = NULL;
+	device->layout = layout;
+	device->model = model;
+	if (fingerprint)
+		memcpy (device->fingerprint, fingerprint, sizeof (device->fingerprint));
+	else
+		memset (device->fingerprint, 0, sizeof (device->fingerprint));
+
+	// Walk the memory dump instead of the device memory.
+	device_dump_attach ((dc_device_t *) device, data, size);
+
+	status = cressi_edy_device_foreach ((dc_device_t *) device, callback, userdata);
+
+	dc_device_deallocate ((dc_device_t *) device);
+
+	return status;
+}
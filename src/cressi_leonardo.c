@@ -30,11 +30,14 @@
 #include "checksum.h"
 #include "array.h"
 #include "ringbuffer.h"
+#include "rbstream.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &cressi_leonardo_device_vtable)
 
 #define SZ_MEMORY 32000
 
+#define FP_SIZE 5
+
 #define RB_LOGBOOK_BEGIN 0x0100
 #define RB_LOGBOOK_END   0x1438
 #define RB_LOGBOOK_SIZE  0x52
@@ -70,9 +73,6 @@ static const dc_device_vtable_t cressi_leonardo_device_vtable = {
 	cressi_leonardo_device_close /* close */
 };
 
-static dc_status_t
-cressi_leonardo_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static void
 cressi_leonardo_make_ascii (const unsigned char raw[], unsigned int rsize, unsigned char ascii[], unsigned int asize)
 {
@@ -189,6 +189,9 @@ cressi_leonardo_device_open (dc_device_t **out, dc_context_t *context, const cha
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -411,40 +414,172 @@ cressi_leonardo_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 cressi_leonardo_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
-	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
-	if (buffer == NULL)
-		return DC_STATUS_NOMEMORY;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	cressi_leonardo_device_t *device = (cressi_leonardo_device_t *) abstract;
+	dc_rbstream_t *rbstream = NULL;
+	unsigned char *buffer = NULL;
 
-	dc_status_t rc = cressi_leonardo_device_dump (abstract, buffer);
-	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
-		return rc;
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = PACKETSIZE +
+		(RB_LOGBOOK_END - RB_LOGBOOK_BEGIN) +
+		(RB_PROFILE_END - RB_PROFILE_BEGIN);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Read the header data.
+	unsigned char header[PACKETSIZE] = {0};
+	status = cressi_leonardo_device_read (abstract, 0, header, sizeof (header));
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header data.");
+		return status;
 	}
 
-	unsigned char *data = dc_buffer_get_data (buffer);
+	// Update and emit a progress event.
+	progress.current += sizeof (header);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Emit a device info event.
 	dc_event_devinfo_t devinfo;
-	devinfo.model = data[0];
+	devinfo.model = header[0];
 	devinfo.firmware = 0;
-	devinfo.serial = array_uint24_le (data + 1);
+	devinfo.serial = array_uint24_le (header + 1);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = cressi_leonardo_extract_dives (abstract, dc_buffer_get_data (buffer),
-		dc_buffer_get_size (buffer), callback, userdata);
+	// Read the logbook data.
+	unsigned char logbook[RB_LOGBOOK_END - RB_LOGBOOK_BEGIN] = {0};
+	status = cressi_leonardo_device_read (abstract, RB_LOGBOOK_BEGIN, logbook, sizeof (logbook));
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the logbook data.");
+		return status;
+	}
 
-	dc_buffer_free (buffer);
+	// Update and emit a progress event.
+	progress.current += sizeof (logbook);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	return rc;
-}
+	// Locate the most recent dive.
+	unsigned int count = 0;
+	unsigned int latest = 0;
+	unsigned int maximum = 0;
+	for (unsigned int i = 0; i < RB_LOGBOOK_COUNT; ++i) {
+		unsigned int offset = i * RB_LOGBOOK_SIZE;
 
-static dc_status_t
-cressi_leonardo_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
-{
-	cressi_leonardo_device_t *device = (cressi_leonardo_device_t *) abstract;
-	dc_context_t *context = (abstract ? abstract->context : NULL);
+		// Ignore uninitialized header entries.
+		if (array_isequal (logbook + offset, RB_LOGBOOK_SIZE, 0xFF))
+			break;
 
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
+		// Get the internal dive number.
+		unsigned int current = array_uint16_le (logbook + offset);
+		if (current == 0xFFFF) {
+			WARNING (abstract->context, "Unexpected internal dive number found.");
+			break;
+		}
+		if (current > maximum) {
+			maximum = current;
+			latest = i;
+		}
 
+		count++;
+	}
+
+	buffer = (unsigned char *) malloc (RB_LOGBOOK_SIZE + RB_PROFILE_END - RB_PROFILE_BEGIN);
+	if (buffer == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// The profiles are stored back to back, with the ringbuffer pointers
+	// of the dive at both ends. Starting from the most recent dive, they
+	// are read backwards, and only until the fingerprint is found.
+	unsigned int previous = 0;
+	unsigned int remaining = RB_PROFILE_END - RB_PROFILE_BEGIN;
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned int idx = (latest + RB_LOGBOOK_COUNT - i) % RB_LOGBOOK_COUNT;
+		unsigned int offset = idx * RB_LOGBOOK_SIZE;
+
+		// Get the ringbuffer pointers.
+		unsigned int begin = array_uint16_le (logbook + offset + 2);
+		unsigned int end = array_uint16_le (logbook + offset + 4);
+		if (begin < RB_PROFILE_BEGIN || begin + 2 > RB_PROFILE_END ||
+			end < RB_PROFILE_BEGIN || end + 2 > RB_PROFILE_END)
+		{
+			ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x 0x%04x).", begin, end);
+			status = DC_STATUS_DATAFORMAT;
+			goto error_free;
+		}
+
+		if (previous && previous != end + 2) {
+			ERROR (abstract->context, "Profiles are not continuous (0x%04x 0x%04x 0x%04x).", begin, end, previous);
+			status = DC_STATUS_DATAFORMAT;
+			goto error_free;
+		}
+
+		// Check the fingerprint data.
+		if (memcmp (logbook + offset + 8, device->fingerprint, FP_SIZE) == 0)
+			break;
+
+		// Calculate the profile length.
+		unsigned int length = RB_PROFILE_DISTANCE (begin, end) - 2;
+
+		if (remaining && remaining >= length + 4) {
+			// Create the ringbuffer stream.
+			if (rbstream == NULL) {
+				status = dc_rbstream_new (&rbstream, abstract, 1, PACKETSIZE, RB_PROFILE_BEGIN, RB_PROFILE_END, end + 2);
+				if (status != DC_STATUS_SUCCESS) {
+					ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+					goto error_free;
+				}
+			}
+
+			// Read the profile data, including the ringbuffer pointers at
+			// both ends. The leading pointer is overwritten with the last
+			// bytes of the logbook entry afterwards.
+			unsigned char *profile = buffer + RB_LOGBOOK_SIZE - 2;
+			status = dc_rbstream_read (rbstream, &progress, profile, length + 4);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to read the dive.");
+				goto error_free;
+			}
+
+			// Get the same pointers from the profile.
+			unsigned int begin2 = array_uint16_le (profile + length + 2);
+			unsigned int end2 = array_uint16_le (profile);
+			if (begin2 != begin || end2 != end) {
+				ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x 0x%04x).", begin2, end2);
+				status = DC_STATUS_DATAFORMAT;
+				goto error_free;
+			}
+
+			remaining -= length + 4;
+		} else {
+			// No more profile data available!
+			remaining = 0;
+			length = 0;
+		}
+
+		// Copy the logbook entry.
+		memcpy (buffer, logbook + offset, RB_LOGBOOK_SIZE);
+
+		if (callback && !callback (buffer, RB_LOGBOOK_SIZE + length, buffer + 8, FP_SIZE, userdata)) {
+			break;
+		}
+
+		previous = begin;
+	}
+
+	// Nothing else left to download.
+	progress.maximum = progress.current;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+error_free:
+	dc_rbstream_free (rbstream);
+	free (buffer);
+	return status;
+}
+
+dc_status_t
+cressi_leonardo_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
 	if (size < SZ_MEMORY)
 		return DC_STATUS_DATAFORMAT;
 
@@ -506,7 +641,7 @@ cressi_leonardo_extract_dives (dc_device_t *abstract, const unsigned char data[]
 		}
 
 		// Check the fingerprint data.
-		if (device && memcmp (data + offset + 8, device->fingerprint, sizeof (device->fingerprint)) == 0)
+		if (fingerprint && memcmp (data + offset + 8, fingerprint, FP_SIZE) == 0)
 			break;
 
 		// Copy the logbook entry.
@@ -543,7 +678,7 @@ cressi_leonardo_extract_dives (dc_device_t *abstract, const unsigned char data[]
 			length = 0;
 		}
 
-		if (callback && !callback (buffer, RB_LOGBOOK_SIZE + length, buffer + 8, sizeof (device->fingerprint), userdata)) {
+		if (callback && !callback (buffer, RB_LOGBOOK_SIZE + length, buffer + 8, FP_SIZE, userdata)) {
 			break;
 		}
 
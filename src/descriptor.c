@@ -31,10 +31,12 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <libdivecomputer/descriptor.h>
 
 #include "iterator-private.h"
+#include "thread.h"
 
 #define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
 
@@ -44,6 +46,8 @@ struct dc_descriptor_t {
 	dc_family_t type;
 	unsigned int model;
 	unsigned int serial;
+	unsigned int vid;
+	unsigned int pid;
 };
 
 /*
@@ -88,8 +92,8 @@ static const dc_descriptor_t g_descriptors[] = {
 	{"Suunto", "Zoop Novo",  DC_FAMILY_SUUNTO_D9, 0x1E},
 	/* Suunto EON Steel */
 #ifdef USBHID
-	{"Suunto", "EON Steel", DC_FAMILY_SUUNTO_EONSTEEL, 0},
-	{"Scubapro", "G2", DC_FAMILY_SCUBAPRO_G2, 0x11},
+	{"Suunto", "EON Steel", DC_FAMILY_SUUNTO_EONSTEEL, 0, 0, 0x1493, 0x0030},
+	{"Scubapro", "G2", DC_FAMILY_SCUBAPRO_G2, 0x11, 0, 0x2e6c, 0x3201},
 #endif
 	/* Uwatec Aladin */
 	{"Uwatec", "Aladin Air Twin",     DC_FAMILY_UWATEC_ALADIN, 0x1C},
@@ -265,8 +269,8 @@ static const dc_descriptor_t g_descriptors[] = {
 	{"Scubapro", "XTender 5",  DC_FAMILY_ZEAGLE_N2ITION3, 0},
 	/* Atomic Aquatics Cobalt */
 #ifdef HAVE_LIBUSB
-	{"Atomic Aquatics", "Cobalt", DC_FAMILY_ATOMICS_COBALT, 0},
-	{"Atomic Aquatics", "Cobalt 2", DC_FAMILY_ATOMICS_COBALT, 2},
+	{"Atomic Aquatics", "Cobalt", DC_FAMILY_ATOMICS_COBALT, 0, 0, 0x0471, 0x0888},
+	{"Atomic Aquatics", "Cobalt 2", DC_FAMILY_ATOMICS_COBALT, 2, 0, 0x0471, 0x0888},
 #endif
 	/* Shearwater Predator */
 	{"Shearwater", "Predator", DC_FAMILY_SHEARWATER_PREDATOR, 2},
@@ -308,6 +312,273 @@ static const dc_descriptor_t g_descriptors[] = {
 	{"Cochran", "EMC-20H",		DC_FAMILY_COCHRAN_COMMANDER, 3},
 };
 
+/*
+ * The lookup index consists of a number of open addressing hash tables,
+ * which are filled once on first use. Each bucket contains the index of
+ * a descriptor in the table above (plus one, with zero marking an empty
+ * bucket). If multiple descriptors share the same key, the bucket refers
+ * to the first one, which is the same descriptor a linear search through
+ * the table would have found.
+ */
+
+#define NDESCRIPTORS C_ARRAY_SIZE (g_descriptors)
+
+#define NAMESIZE 64
+
+typedef unsigned short dc_descriptor_bucket_t;
+
+static dc_descriptor_bucket_t g_index_model[2 * NDESCRIPTORS];
+static dc_descriptor_bucket_t g_index_family[2 * NDESCRIPTORS];
+static dc_descriptor_bucket_t g_index_name[4 * NDESCRIPTORS];
+static dc_descriptor_bucket_t g_index_usb[2 * NDESCRIPTORS];
+
+static dc_once_t g_index_once = DC_ONCE_INIT;
+
+static unsigned int
+dc_descriptor_hash (unsigned int a, unsigned int b)
+{
+	unsigned int hash = (a * 0x9E3779B1) ^ b;
+	hash ^= hash >> 15;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+static unsigned int
+dc_descriptor_hash_name (const char *name)
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+	while (*name) {
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/*
+ * Convert a name to its canonical form: lowercase, with leading and
+ * trailing whitespace removed and any run of whitespace replaced with a
+ * single space. Returns zero if the result doesn't fit in the buffer.
+ */
+static size_t
+dc_descriptor_normalize (char buffer[], size_t size, size_t offset, const char *name)
+{
+	int space = (offset != 0);
+
+	while (*name) {
+		unsigned char c = (unsigned char) *name++;
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			space = (offset != 0);
+			continue;
+		}
+
+		if (offset + space + 1 >= size)
+			return 0;
+
+		if (space) {
+			buffer[offset++] = ' ';
+			space = 0;
+		}
+
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+
+		buffer[offset++] = c;
+	}
+
+	buffer[offset] = 0;
+
+	return offset;
+}
+
+static size_t
+dc_descriptor_name (char buffer[], size_t size, const dc_descriptor_t *descriptor, unsigned int full)
+{
+	size_t offset = 0;
+
+	if (full) {
+		offset = dc_descriptor_normalize (buffer, size, 0, descriptor->vendor);
+		if (offset == 0)
+			return 0;
+	}
+
+	return dc_descriptor_normalize (buffer, size, offset, descriptor->product);
+}
+
+typedef int (*dc_descriptor_match_t) (const dc_descriptor_t *a, const dc_descriptor_t *b);
+
+static int
+dc_descriptor_match_model (const dc_descriptor_t *a, const dc_descriptor_t *b)
+{
+	return a->type == b->type && a->model == b->model;
+}
+
+static int
+dc_descriptor_match_family (const dc_descriptor_t *a, const dc_descriptor_t *b)
+{
+	return a->type == b->type;
+}
+
+static int
+dc_descriptor_match_usb (const dc_descriptor_t *a, const dc_descriptor_t *b)
+{
+	return a->vid == b->vid && a->pid == b->pid;
+}
+
+static size_t
+dc_descriptor_probe (const dc_descriptor_bucket_t table[], size_t size, unsigned int hash, dc_descriptor_match_t match, const dc_descriptor_t *key)
+{
+	size_t i = hash % size;
+	while (table[i] && !match (&g_descriptors[table[i] - 1], key)) {
+		i = (i + 1) % size;
+	}
+
+	return i;
+}
+
+static int
+dc_descriptor_match_name (const dc_descriptor_t *descriptor, const char *name)
+{
+	char buffer[NAMESIZE];
+
+	if (dc_descriptor_name (buffer, sizeof (buffer), descriptor, 1) && strcmp (buffer, name) == 0)
+		return 1;
+
+	if (dc_descriptor_name (buffer, sizeof (buffer), descriptor, 0) && strcmp (buffer, name) == 0)
+		return 1;
+
+	return 0;
+}
+
+static size_t
+dc_descriptor_probe_name (const char *name)
+{
+	size_t size = C_ARRAY_SIZE (g_index_name);
+	size_t i = dc_descriptor_hash_name (name) % size;
+	while (g_index_name[i] && !dc_descriptor_match_name (&g_descriptors[g_index_name[i] - 1], name)) {
+		i = (i + 1) % size;
+	}
+
+	return i;
+}
+
+static void
+dc_descriptor_insert (dc_descriptor_bucket_t table[], size_t size, unsigned int hash, dc_descriptor_match_t match, unsigned int index)
+{
+	// The descriptors are inserted in table order, so an existing entry
+	// with the same key always takes precedence.
+	size_t i = dc_descriptor_probe (table, size, hash, match, &g_descriptors[index]);
+	if (table[i] == 0)
+		table[i] = index + 1;
+}
+
+static void
+dc_descriptor_insert_name (const char *name, unsigned int index)
+{
+	size_t i = dc_descriptor_probe_name (name);
+	if (g_index_name[i] == 0)
+		g_index_name[i] = index + 1;
+}
+
+static void
+dc_descriptor_index_init (void)
+{
+	char buffer[NAMESIZE];
+
+	for (unsigned int i = 0; i < NDESCRIPTORS; ++i) {
+		const dc_descriptor_t *descriptor = &g_descriptors[i];
+
+		dc_descriptor_insert (g_index_model, C_ARRAY_SIZE (g_index_model),
+			dc_descriptor_hash (descriptor->type, descriptor->model),
+			dc_descriptor_match_model, i);
+		dc_descriptor_insert (g_index_family, C_ARRAY_SIZE (g_index_family),
+			dc_descriptor_hash (descriptor->type, 0),
+			dc_descriptor_match_family, i);
+		if (descriptor->vid || descriptor->pid) {
+			dc_descriptor_insert (g_index_usb, C_ARRAY_SIZE (g_index_usb),
+				dc_descriptor_hash (descriptor->vid, descriptor->pid),
+				dc_descriptor_match_usb, i);
+		}
+
+		if (dc_descriptor_name (buffer, sizeof (buffer), descriptor, 1))
+			dc_descriptor_insert_name (buffer, i);
+		if (dc_descriptor_name (buffer, sizeof (buffer), descriptor, 0))
+			dc_descriptor_insert_name (buffer, i);
+	}
+}
+
+static dc_status_t
+dc_descriptor_lookup (dc_descriptor_t **out, unsigned int bucket)
+{
+	if (bucket == 0) {
+		*out = NULL;
+		return DC_STATUS_UNSUPPORTED;
+	}
+
+	// See dc_descriptor_iterator_next for the explicit cast.
+	*out = (dc_descriptor_t *) &g_descriptors[bucket - 1];
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_descriptor_find_model (dc_descriptor_t **out, dc_family_t family, unsigned int model)
+{
+	dc_descriptor_t key = {NULL, NULL, family, model};
+	size_t i = 0;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_once (&g_index_once, dc_descriptor_index_init);
+
+	i = dc_descriptor_probe (g_index_model, C_ARRAY_SIZE (g_index_model),
+		dc_descriptor_hash (family, model), dc_descriptor_match_model, &key);
+	if (g_index_model[i])
+		return dc_descriptor_lookup (out, g_index_model[i]);
+
+	// No exact match found. Fall back to the first descriptor of the family.
+	i = dc_descriptor_probe (g_index_family, C_ARRAY_SIZE (g_index_family),
+		dc_descriptor_hash (family, 0), dc_descriptor_match_family, &key);
+
+	return dc_descriptor_lookup (out, g_index_family[i]);
+}
+
+dc_status_t
+dc_descriptor_find_name (dc_descriptor_t **out, const char *name)
+{
+	char key[NAMESIZE];
+
+	if (out == NULL || name == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_once (&g_index_once, dc_descriptor_index_init);
+
+	// A name that doesn't fit can't match any descriptor.
+	if (dc_descriptor_normalize (key, sizeof (key), 0, name) == 0)
+		return dc_descriptor_lookup (out, 0);
+
+	return dc_descriptor_lookup (out, g_index_name[dc_descriptor_probe_name (key)]);
+}
+
+dc_status_t
+dc_descriptor_find_usb (dc_descriptor_t **out, unsigned int vid, unsigned int pid)
+{
+	dc_descriptor_t key = {NULL, NULL, DC_FAMILY_NULL, 0, 0, vid, pid};
+	size_t i = 0;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_once (&g_index_once, dc_descriptor_index_init);
+
+	i = dc_descriptor_probe (g_index_usb, C_ARRAY_SIZE (g_index_usb),
+		dc_descriptor_hash (vid, pid), dc_descriptor_match_usb, &key);
+
+	return dc_descriptor_lookup (out, g_index_usb[i]);
+}
+
 typedef struct dc_descriptor_iterator_t {
 	dc_iterator_t base;
 	size_t current;
@@ -54,6 +54,11 @@ struct dc_device_t {
 	// Cached events for the parsers.
 	dc_event_devinfo_t devinfo;
 	dc_event_clock_t clock;
+	// Transport statistics.
+	dc_device_stats_t stats;
+	// Memory dump that replaces the transport (see device_dump_attach).
+	const unsigned char *dump;
+	unsigned int dumpsize;
 };
 
 struct dc_device_vtable_t {
@@ -92,6 +97,9 @@ device_is_cancelled (dc_device_t *device);
 dc_status_t
 device_dump_read (dc_device_t *device, unsigned char data[], unsigned int size, unsigned int blocksize);
 
+void
+device_dump_attach (dc_device_t *device, const unsigned char data[], unsigned int size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
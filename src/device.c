@@ -60,6 +60,7 @@
 
 #include "device-private.h"
 #include "context-private.h"
+#include "array.h"
 
 dc_device_t *
 dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
@@ -90,12 +91,21 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 	memset (&device->devinfo, 0, sizeof (device->devinfo));
 	memset (&device->clock, 0, sizeof (device->clock));
 
+	// The transports attach to these statistics once opened.
+	memset (&device->stats, 0, sizeof (device->stats));
+
+	device->dump = NULL;
+	device->dumpsize = 0;
+
 	return device;
 }
 
 void
 dc_device_deallocate (dc_device_t *device)
 {
+	if (device == NULL)
+		return;
+
 	free (device);
 }
 
@@ -241,6 +251,18 @@ dc_device_get_type (dc_device_t *device)
 }
 
 
+dc_status_t
+dc_device_get_stats (dc_device_t *device, dc_device_stats_t *stats)
+{
+	if (device == NULL || stats == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	*stats = device->stats;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_device_set_cancel (dc_device_t *device, dc_cancel_callback_t callback, void *userdata)
 {
@@ -287,6 +309,15 @@ dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[],
 	if (device == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	if (device->dump) {
+		if (address > device->dumpsize || size > device->dumpsize - address) {
+			ERROR (device->context, "Read beyond the end of the memory dump (0x%08x %u).", address, size);
+			return DC_STATUS_DATAFORMAT;
+		}
+		memcpy (data, device->dump + address, size);
+		return DC_STATUS_SUCCESS;
+	}
+
 	if (device->vtable->read == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
@@ -357,6 +388,22 @@ device_dump_read (dc_device_t *device, unsigned char data[], unsigned int size,
 }
 
 
+/*
+ * Serve all dc_device_read calls from a memory dump. The driver's own
+ * foreach code can then extract the dives from a dump, without a
+ * connection to the device.
+ */
+void
+device_dump_attach (dc_device_t *device, const unsigned char data[], unsigned int size)
+{
+	if (device == NULL)
+		return;
+
+	device->dump = data;
+	device->dumpsize = size;
+}
+
+
 dc_status_t
 dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userdata)
 {
@@ -370,6 +417,163 @@ dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userd
 }
 
 
+/*
+ * Check whether the fingerprint is either absent, or has the expected
+ * size for the family. If valid, the pointer to the fingerprint data is
+ * returned, and NULL otherwise.
+ */
+static int
+dc_extract_fingerprint (const unsigned char fingerprint[], unsigned int fsize, unsigned int expected, const unsigned char **out)
+{
+	if (fsize == 0) {
+		*out = NULL;
+		return 1;
+	}
+
+	if (fingerprint == NULL || fsize != expected)
+		return 0;
+
+	*out = fingerprint;
+
+	return 1;
+}
+
+
+dc_status_t
+dc_extract_dives (dc_context_t *context, dc_descriptor_t *descriptor, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize, dc_dive_callback_t callback, void *userdata)
+{
+	const unsigned char *fp = NULL;
+
+	if (descriptor == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	dc_family_t family = dc_descriptor_get_type (descriptor);
+
+	// Families that use a timestamp as the fingerprint stop at the first
+	// dive that is not newer, exactly like the device would do.
+	unsigned int timestamp = 0;
+	switch (family) {
+	case DC_FAMILY_UWATEC_ALADIN:
+	case DC_FAMILY_UWATEC_MEMOMOUSE:
+	case DC_FAMILY_UWATEC_SMART:
+	case DC_FAMILY_UWATEC_MERIDIAN:
+	case DC_FAMILY_SCUBAPRO_G2:
+	case DC_FAMILY_REEFNET_SENSUS:
+	case DC_FAMILY_REEFNET_SENSUSPRO:
+	case DC_FAMILY_REEFNET_SENSUSULTRA:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 4, &fp))
+			return DC_STATUS_INVALIDARGS;
+		if (fp)
+			timestamp = array_uint32_le (fp);
+		break;
+	default:
+		break;
+	}
+
+	switch (family) {
+	case DC_FAMILY_SUUNTO_SOLUTION:
+		if (fsize)
+			return DC_STATUS_UNSUPPORTED;
+		return suunto_solution_extract_dives (context, data, size, callback, userdata);
+	case DC_FAMILY_SUUNTO_EON:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return suunto_eon_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_SUUNTO_VYPER:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return suunto_vyper_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_SUUNTO_VYPER2:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 7, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return suunto_vyper2_extract_dives (context, dc_descriptor_get_model (descriptor), fp, data, size, callback, userdata);
+	case DC_FAMILY_SUUNTO_D9:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 7, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return suunto_d9_extract_dives (context, dc_descriptor_get_model (descriptor), fp, data, size, callback, userdata);
+	case DC_FAMILY_UWATEC_ALADIN:
+		return uwatec_aladin_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_UWATEC_MEMOMOUSE:
+		return uwatec_memomouse_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_UWATEC_SMART:
+		return uwatec_smart_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_UWATEC_MERIDIAN:
+		return uwatec_meridian_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_SCUBAPRO_G2:
+		return scubapro_g2_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_REEFNET_SENSUS:
+		return reefnet_sensus_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_REEFNET_SENSUSPRO:
+		return reefnet_sensuspro_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_REEFNET_SENSUSULTRA:
+		return reefnet_sensusultra_extract_dives (context, timestamp, data, size, callback, userdata);
+	case DC_FAMILY_OCEANIC_VTPRO:
+		ERROR (context, "The Vtpro memory layout is selected from the version string, which is not part of the dump.");
+		return DC_STATUS_UNSUPPORTED;
+	case DC_FAMILY_OCEANIC_VEO250:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 8, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return oceanic_veo250_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_OCEANIC_ATOM2:
+		ERROR (context, "The Atom 2 memory layout depends on the firmware version string, which is not part of the dump.");
+		return DC_STATUS_UNSUPPORTED;
+	case DC_FAMILY_MARES_NEMO:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return mares_nemo_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_MARES_PUCK:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return mares_puck_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_MARES_DARWIN:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 6, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return mares_darwin_extract_dives (context, dc_descriptor_get_model (descriptor), fp, data, size, callback, userdata);
+	case DC_FAMILY_MARES_ICONHD:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 10, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return mares_iconhd_extract_dives (context, dc_descriptor_get_model (descriptor), fp, data, size, callback, userdata);
+	case DC_FAMILY_HW_OSTC:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return hw_ostc_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_HW_OSTC3:
+		ERROR (context, "The OSTC3 dump is the raw flash, but the dives are only available through the download commands.");
+		return DC_STATUS_UNSUPPORTED;
+	case DC_FAMILY_CRESSI_EDY:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 16, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return cressi_edy_extract_dives (context, dc_descriptor_get_model (descriptor), fp, data, size, callback, userdata);
+	case DC_FAMILY_CRESSI_LEONARDO:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 5, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return cressi_leonardo_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_ZEAGLE_N2ITION3:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 16, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return zeagle_n2ition3_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_SHEARWATER_PREDATOR:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 4, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return shearwater_predator_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_DIVERITE_NITEKQ:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 6, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return diverite_nitekq_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_CITIZEN_AQUALAND:
+		if (!dc_extract_fingerprint (fingerprint, fsize, 8, &fp))
+			return DC_STATUS_INVALIDARGS;
+		return citizen_aqualand_extract_dives (context, fp, data, size, callback, userdata);
+	case DC_FAMILY_COCHRAN_COMMANDER:
+		ERROR (context, "The Cochran config block with the dive count is read separately and is not part of the dump.");
+		return DC_STATUS_UNSUPPORTED;
+	default:
+		ERROR (context, "Dive extraction is not supported for this family.");
+		return DC_STATUS_UNSUPPORTED;
+	}
+}
+
+
 dc_status_t
 dc_device_close (dc_device_t *device)
 {
@@ -413,6 +617,9 @@ device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 	case DC_EVENT_CLOCK:
 		assert (data != NULL);
 		break;
+	case DC_EVENT_PARTIAL:
+		assert (data != NULL);
+		break;
 	default:
 		break;
 	}
@@ -72,9 +72,6 @@ static const dc_device_vtable_t diverite_nitekq_device_vtable = {
 	diverite_nitekq_device_close /* close */
 };
 
-static dc_status_t
-diverite_nitekq_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static dc_status_t
 diverite_nitekq_send (diverite_nitekq_device_t *device, unsigned char cmd)
 {
@@ -173,6 +170,9 @@ diverite_nitekq_device_open (dc_device_t **out, dc_context_t *context, const cha
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -335,6 +335,8 @@ diverite_nitekq_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 diverite_nitekq_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	diverite_nitekq_device_t *device = (diverite_nitekq_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (0);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -345,7 +347,7 @@ diverite_nitekq_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 		return rc;
 	}
 
-	rc = diverite_nitekq_extract_dives (abstract,
+	rc = diverite_nitekq_extract_dives (abstract->context, device->fingerprint,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -354,15 +356,9 @@ diverite_nitekq_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 }
 
 
-static dc_status_t
-diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+diverite_nitekq_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	diverite_nitekq_device_t *device = (diverite_nitekq_device_t *) abstract;
-	dc_context_t *context = (abstract ? abstract->context : NULL);
-
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	if (size < SZ_PACKET + SZ_MEMORY)
 		return DC_STATUS_DATAFORMAT;
 
@@ -409,7 +405,7 @@ diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[]
 		}
 
 		// Check the fingerprint data.
-		if (device && memcmp (p, device->fingerprint, sizeof (device->fingerprint)) == 0)
+		if (fingerprint && memcmp (p, fingerprint, SZ_LOGBOOK) == 0)
 			break;
 
 		// Copy the logbook entry.
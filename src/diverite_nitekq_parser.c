@@ -46,6 +46,7 @@ struct diverite_nitekq_parser_t {
 	unsigned int he[NGASMIXES];
 	unsigned int divetime;
 	double maxdepth;
+	sample_statistics_t statistics;
 };
 
 static dc_status_t diverite_nitekq_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
@@ -60,6 +61,7 @@ static const dc_parser_vtable_t diverite_nitekq_parser_vtable = {
 	diverite_nitekq_parser_get_datetime, /* datetime */
 	diverite_nitekq_parser_get_field, /* fields */
 	diverite_nitekq_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_range */
 	NULL /* destroy */
 };
 
@@ -89,6 +91,7 @@ diverite_nitekq_parser_create (dc_parser_t **out, dc_context_t *context)
 		parser->o2[i] = 0;
 		parser->he[i] = 0;
 	}
+	sample_statistics_init (&parser->statistics, NULL, NULL);
 
 	*out = (dc_parser_t*) parser;
 
@@ -99,6 +102,11 @@ diverite_nitekq_parser_create (dc_parser_t **out, dc_context_t *context)
 static dc_status_t
 diverite_nitekq_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
 {
+	diverite_nitekq_parser_t *parser = (diverite_nitekq_parser_t *) abstract;
+
+	// Reset the cache.
+	parser->cached = 0;
+
 	return DC_STATUS_SUCCESS;
 }
 
@@ -151,6 +159,8 @@ diverite_nitekq_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, u
 			else
 				*((double *) value) = parser->maxdepth * FEET / 10.0;
 			break;
+		case DC_FIELD_AVGDEPTH:
+			return sample_statistics_get_field (&parser->statistics, type, flags, value);
 		case DC_FIELD_GASMIX_COUNT:
 			*((unsigned int *) value) = parser->ngasmixes;
 			break;
@@ -179,6 +189,14 @@ diverite_nitekq_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callbac
 	const unsigned char *data = abstract->data + SZ_LOGBOOK;
 	unsigned int size = abstract->size - SZ_LOGBOOK;
 
+	// Collect the profile statistics during the first pass.
+	sample_statistics_t statistics;
+	if (!parser->cached) {
+		sample_statistics_init (&statistics, callback, userdata);
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int type = 0;
 	unsigned int metric = 0;
 	unsigned int interval = 0;
@@ -299,7 +317,10 @@ diverite_nitekq_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callbac
 	parser->maxdepth = maxdepth;
 	parser->divetime = time;
 	parser->metric = metric;
-	parser->cached = 1;
+	if (!parser->cached) {
+		parser->statistics = statistics;
+		parser->cached = 1;
+	}
 
 	return DC_STATUS_SUCCESS;
 }
@@ -38,6 +38,10 @@
 
 #define MAXRETRIES 9
 
+#define WINDOW    4
+#define MINDELAY  10
+#define MAXDELAY  400
+
 #define MAXPACKET 0xFF
 #define START     0x55
 #define ACK       0x06
@@ -60,11 +64,28 @@ typedef struct divesystem_idive_commands_t {
 	unsigned int nsamples;
 } divesystem_idive_commands_t;
 
+typedef enum divesystem_idive_state_t {
+	REQUEST_PENDING,
+	REQUEST_SENT,
+	REQUEST_DONE,
+} divesystem_idive_state_t;
+
+typedef struct divesystem_idive_request_t {
+	unsigned char command[3];
+	unsigned int csize;
+	unsigned char *answer;
+	unsigned int asize;
+	divesystem_idive_state_t state;
+	unsigned int nretries;
+} divesystem_idive_request_t;
+
 typedef struct divesystem_idive_device_t {
 	dc_device_t base;
 	dc_serial_t *port;
 	unsigned char fingerprint[4];
 	unsigned int model;
+	unsigned int window;
+	unsigned int delay;
 } divesystem_idive_device_t;
 
 static dc_status_t divesystem_idive_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -126,6 +147,8 @@ divesystem_idive_device_open (dc_device_t **out, dc_context_t *context, const ch
 	device->port = NULL;
 	memset (device->fingerprint, 0, sizeof (device->fingerprint));
 	device->model = model;
+	device->window = WINDOW;
+	device->delay = MINDELAY;
 
 	// Open the device.
 	status = dc_serial_open (&device->port, context, name);
@@ -134,6 +157,9 @@ divesystem_idive_device_open (dc_device_t **out, dc_context_t *context, const ch
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -291,80 +317,195 @@ divesystem_idive_receive (divesystem_idive_device_t *device, unsigned char answe
 
 
 static dc_status_t
-divesystem_idive_transfer (divesystem_idive_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
+divesystem_idive_answer (divesystem_idive_device_t *device, divesystem_idive_request_t *request, unsigned int *busy)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 	unsigned char packet[MAXPACKET] = {0};
 	unsigned int length = 0;
-	unsigned int nretries = 0;
-
-	while (1) {
-		// Send the command.
-		rc = divesystem_idive_send (device, command, csize);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
-
-		// Receive the answer.
-		length = sizeof(packet);
-		rc = divesystem_idive_receive (device, packet, &length);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
 
-		// Verify the command byte.
-		if (packet[0] != command[0]) {
-			ERROR (abstract->context, "Unexpected packet header.");
-			return DC_STATUS_PROTOCOL;
-		}
-
-		// Check the ACK byte.
-		if (packet[length - 1] == ACK)
-			break;
+	// Receive the answer.
+	length = sizeof(packet);
+	rc = divesystem_idive_receive (device, packet, &length);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
-		// Verify the NAK byte.
-		if (packet[length - 1] != NAK) {
-			ERROR (abstract->context, "Unexpected ACK/NAK byte.");
-			return DC_STATUS_PROTOCOL;
-		}
+	// Verify the command byte.
+	if (packet[0] != request->command[0]) {
+		ERROR (abstract->context, "Unexpected packet header.");
+		return DC_STATUS_PROTOCOL;
+	}
 
+	// Check the ACK byte.
+	if (packet[length - 1] == ACK) {
 		// Verify the length of the packet.
-		if (length != 3) {
+		if (request->asize != length - 2) {
 			ERROR (abstract->context, "Unexpected packet length.");
 			return DC_STATUS_PROTOCOL;
 		}
 
-		// Verify the error code.
-		unsigned int errcode = packet[1];
-		if (errcode != BUSY) {
-			ERROR (abstract->context, "Received NAK packet with error code %02x.", errcode);
-			return DC_STATUS_PROTOCOL;
-		}
+		memcpy(request->answer, packet + 1, length - 2);
+		*busy = 0;
 
-		// Abort if the maximum number of retries is reached.
-		if (nretries++ >= MAXRETRIES)
-			return DC_STATUS_PROTOCOL;
+		return DC_STATUS_SUCCESS;
+	}
 
-		// Delay the next attempt.
-		dc_serial_sleep(device->port, 100);
+	// Verify the NAK byte.
+	if (packet[length - 1] != NAK) {
+		ERROR (abstract->context, "Unexpected ACK/NAK byte.");
+		return DC_STATUS_PROTOCOL;
 	}
 
 	// Verify the length of the packet.
-	if (asize != length - 2) {
+	if (length != 3) {
 		ERROR (abstract->context, "Unexpected packet length.");
 		return DC_STATUS_PROTOCOL;
 	}
 
-	memcpy(answer, packet + 1, length - 2);
+	// Verify the error code.
+	unsigned int errcode = packet[1];
+	if (errcode != BUSY) {
+		ERROR (abstract->context, "Received NAK packet with error code %02x.", errcode);
+		return DC_STATUS_PROTOCOL;
+	}
+
+	*busy = 1;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Process a list of requests, keeping up to device->window of them
+ * outstanding at the same time. The device answers the requests in the
+ * order they were sent, so the answers are matched against a FIFO of
+ * the outstanding requests, and stored in the answer buffer of the
+ * corresponding request. A request rejected with a BUSY error is sent
+ * again, after a delay which grows with every consecutive BUSY error
+ * and shrinks again with every successful answer.
+ */
+static dc_status_t
+divesystem_idive_transfer_many (divesystem_idive_device_t *device, divesystem_idive_request_t requests[], unsigned int count, dc_event_progress_t *progress, unsigned int offset)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+	unsigned int queue[WINDOW];
+	unsigned int head = 0, nqueue = 0;
+	unsigned int next = 0, ndone = 0;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		requests[i].state = REQUEST_PENDING;
+		requests[i].nretries = 0;
+	}
+
+	while (ndone < count) {
+		// Send pending requests until the window is full.
+		while (nqueue < device->window && next < count) {
+			divesystem_idive_request_t *request = requests + next;
+			if (request->state == REQUEST_PENDING) {
+				rc = divesystem_idive_send (device, request->command, request->csize);
+				if (rc != DC_STATUS_SUCCESS)
+					return rc;
+
+				request->state = REQUEST_SENT;
+				queue[(head + nqueue) % WINDOW] = next;
+				nqueue++;
+			}
+			next++;
+		}
+
+		// Receive the answer to the oldest outstanding request.
+		unsigned int idx = queue[head];
+		divesystem_idive_request_t *request = requests + idx;
+		head = (head + 1) % WINDOW;
+		nqueue--;
+
+		unsigned int busy = 0;
+		rc = divesystem_idive_answer (device, request, &busy);
+		if (rc == DC_STATUS_TIMEOUT && nqueue > 0) {
+			// The device did not answer the pipelined requests. Discard
+			// everything that is still in transit, and fall back to
+			// sending one request at a time.
+			WARNING (abstract->context, "Timeout with %u pipelined requests. Disabling pipelining.", nqueue + 1);
+			request->state = REQUEST_PENDING;
+			if (next > idx)
+				next = idx;
+			while (nqueue) {
+				idx = queue[head];
+				requests[idx].state = REQUEST_PENDING;
+				if (next > idx)
+					next = idx;
+				head = (head + 1) % WINDOW;
+				nqueue--;
+			}
+			device->window = 1;
+			dc_serial_sleep (device->port, 100);
+			dc_serial_purge (device->port, DC_DIRECTION_INPUT);
+			continue;
+		} else if (rc != DC_STATUS_SUCCESS) {
+			return rc;
+		}
+
+		if (busy) {
+			// Abort if the maximum number of retries is reached.
+			if (request->nretries++ >= MAXRETRIES) {
+				ERROR (abstract->context, "Device busy, maximum number of retries reached.");
+				return DC_STATUS_PROTOCOL;
+			}
+
+			// Queue the request again.
+			request->state = REQUEST_PENDING;
+			if (next > idx)
+				next = idx;
+
+			// Delay the next attempt.
+			dc_serial_sleep (device->port, device->delay);
+			device->delay *= 2;
+			if (device->delay > MAXDELAY)
+				device->delay = MAXDELAY;
+			continue;
+		}
+
+		request->state = REQUEST_DONE;
+		ndone++;
+
+		device->delay /= 2;
+		if (device->delay < MINDELAY)
+			device->delay = MINDELAY;
+
+		// Update and emit a progress event.
+		if (progress) {
+			progress->current = offset + STEP(ndone + 1, count + 1);
+			device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
+		}
+	}
 
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+divesystem_idive_transfer (divesystem_idive_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
+{
+	divesystem_idive_request_t request;
+
+	if (csize > sizeof (request.command))
+		return DC_STATUS_INVALIDARGS;
+
+	memcpy (request.command, command, csize);
+	request.csize = csize;
+	request.answer = answer;
+	request.asize = asize;
+
+	return divesystem_idive_transfer_many (device, &request, 1, NULL, 0);
+}
+
 static dc_status_t
 divesystem_idive_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	divesystem_idive_device_t *device = (divesystem_idive_device_t *) abstract;
 	unsigned char packet[MAXPACKET - 2];
+	unsigned char headers[WINDOW][MAXPACKET - 2];
+	divesystem_idive_request_t hrequests[WINDOW];
 
 	const divesystem_idive_commands_t *commands = &idive;
 	if (device->model >= IX3M_EASY) {
@@ -426,61 +567,103 @@ divesystem_idive_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 		return DC_STATUS_NOMEMORY;
 	}
 
-	for (unsigned int i = 0; i < ndives; ++i) {
-		unsigned int number = last - i;
-		unsigned char cmd_header[] = {commands->header.cmd,
-			(number     ) & 0xFF,
-			(number >> 8) & 0xFF};
-		rc = divesystem_idive_transfer (device, cmd_header, sizeof(cmd_header), packet, commands->header.size);
+	divesystem_idive_request_t *requests = NULL;
+	unsigned int nrequests = 0;
+
+	// The size of a sample packet.
+	unsigned int packetsize = commands->sample.size * commands->nsamples;
+
+	unsigned int i = 0;
+	while (i < ndives) {
+		// Request the headers of the next batch of dives. Once the
+		// fingerprint is found, the remaining headers of the batch are
+		// simply ignored.
+		unsigned int nheaders = ndives - i;
+		if (nheaders > device->window)
+			nheaders = device->window;
+
+		for (unsigned int k = 0; k < nheaders; ++k) {
+			unsigned int number = last - (i + k);
+			hrequests[k].command[0] = commands->header.cmd;
+			hrequests[k].command[1] = (number     ) & 0xFF;
+			hrequests[k].command[2] = (number >> 8) & 0xFF;
+			hrequests[k].csize = 3;
+			hrequests[k].answer = headers[k];
+			hrequests[k].asize = commands->header.size;
+		}
+
+		rc = divesystem_idive_transfer_many (device, hrequests, nheaders, NULL, 0);
 		if (rc != DC_STATUS_SUCCESS)
-			return rc;
+			goto error_free;
 
-		if (memcmp(packet + 7, device->fingerprint, sizeof(device->fingerprint)) == 0)
-			break;
+		for (unsigned int k = 0; k < nheaders; ++k, ++i) {
+			unsigned char *header = headers[k];
 
-		unsigned int nsamples = array_uint16_le (packet + 1);
+			if (memcmp(header + 7, device->fingerprint, sizeof(device->fingerprint)) == 0)
+				goto done;
 
-		// Update and emit a progress event.
-		progress.current = i * NSTEPS + STEP(1, nsamples + 1);
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
-
-		dc_buffer_clear(buffer);
-		dc_buffer_reserve(buffer, commands->header.size + commands->sample.size * nsamples);
-		dc_buffer_append(buffer, packet, commands->header.size);
-
-		for (unsigned int j = 0; j < nsamples; j += commands->nsamples) {
-			unsigned int idx = j + 1;
-			unsigned char cmd_sample[] = {commands->sample.cmd,
-				(idx     ) & 0xFF,
-				(idx >> 8) & 0xFF};
-			rc = divesystem_idive_transfer (device, cmd_sample, sizeof(cmd_sample), packet, commands->sample.size * commands->nsamples);
-			if (rc != DC_STATUS_SUCCESS)
-				return rc;
+			unsigned int nsamples = array_uint16_le (header + 1);
 
-			// If the number of samples is not an exact multiple of the
-			// number of samples per packet, then the last packet
-			// appears to contain garbage data. Ignore those samples.
-			unsigned int n = commands->nsamples;
-			if (j + n > nsamples) {
-				n = nsamples - j;
-			}
+			// Calculate the number of sample packets.
+			unsigned int npackets = (nsamples + commands->nsamples - 1) / commands->nsamples;
 
 			// Update and emit a progress event.
-			progress.current = i * NSTEPS + STEP(j + n + 1, nsamples + 1);
+			progress.current = i * NSTEPS + STEP(1, npackets + 1);
 			device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-			dc_buffer_append(buffer, packet, commands->sample.size * n);
-		}
+			if (!dc_buffer_clear (buffer) ||
+				!dc_buffer_resize (buffer, commands->header.size + packetsize * npackets)) {
+				ERROR (abstract->context, "Insufficient buffer space available.");
+				rc = DC_STATUS_NOMEMORY;
+				goto error_free;
+			}
+
+			if (npackets > nrequests) {
+				free (requests);
+				requests = (divesystem_idive_request_t *) malloc (npackets * sizeof (divesystem_idive_request_t));
+				if (requests == NULL) {
+					ERROR (abstract->context, "Failed to allocate memory.");
+					nrequests = 0;
+					rc = DC_STATUS_NOMEMORY;
+					goto error_free;
+				}
+				nrequests = npackets;
+			}
 
-		unsigned char *data = dc_buffer_get_data(buffer);
-		unsigned int   size = dc_buffer_get_size(buffer);
-		if (callback && !callback (data, size, data + 7, sizeof(device->fingerprint), userdata)) {
-			dc_buffer_free (buffer);
-			return DC_STATUS_SUCCESS;
+			unsigned char *data = dc_buffer_get_data (buffer);
+			memcpy (data, header, commands->header.size);
+
+			// Request all sample packets. The answers are stored
+			// directly at their final location in the dive buffer.
+			for (unsigned int j = 0; j < npackets; ++j) {
+				unsigned int idx = j * commands->nsamples + 1;
+				requests[j].command[0] = commands->sample.cmd;
+				requests[j].command[1] = (idx     ) & 0xFF;
+				requests[j].command[2] = (idx >> 8) & 0xFF;
+				requests[j].csize = 3;
+				requests[j].answer = data + commands->header.size + j * packetsize;
+				requests[j].asize = packetsize;
+			}
+
+			rc = divesystem_idive_transfer_many (device, requests, npackets, &progress, i * NSTEPS);
+			if (rc != DC_STATUS_SUCCESS)
+				goto error_free;
+
+			// If the number of samples is not an exact multiple of the
+			// number of samples per packet, then the last packet
+			// appears to contain garbage data. Ignore those samples.
+			dc_buffer_resize (buffer, commands->header.size + commands->sample.size * nsamples);
+
+			unsigned int size = dc_buffer_get_size (buffer);
+			if (callback && !callback (data, size, data + 7, sizeof(device->fingerprint), userdata))
+				goto done;
 		}
 	}
 
-	dc_buffer_free(buffer);
-
-	return DC_STATUS_SUCCESS;
+done:
+	rc = DC_STATUS_SUCCESS;
+error_free:
+	free (requests);
+	dc_buffer_free (buffer);
+	return rc;
 }
@@ -64,6 +64,7 @@ struct divesystem_idive_parser_t {
 	unsigned int ngasmixes;
 	unsigned int oxygen[NGASMIXES];
 	unsigned int helium[NGASMIXES];
+	sample_statistics_t statistics;
 };
 
 static dc_status_t divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
@@ -78,6 +79,7 @@ static const dc_parser_vtable_t divesystem_idive_parser_vtable = {
 	divesystem_idive_parser_get_datetime, /* datetime */
 	divesystem_idive_parser_get_field, /* fields */
 	divesystem_idive_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_range */
 	NULL /* destroy */
 };
 
@@ -113,6 +115,7 @@ divesystem_idive_parser_create (dc_parser_t **out, dc_context_t *context, unsign
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
+	sample_statistics_init (&parser->statistics, NULL, NULL);
 
 	*out = (dc_parser_t*) parser;
 
@@ -135,6 +138,7 @@ divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *da
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
+	sample_statistics_init (&parser->statistics, NULL, NULL);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -182,6 +186,10 @@ divesystem_idive_parser_get_field (dc_parser_t *abstract, dc_field_type_t type,
 		case DC_FIELD_MAXDEPTH:
 			*((double *) value) = parser->maxdepth / 10.0;
 			break;
+		case DC_FIELD_AVGDEPTH:
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			return sample_statistics_get_field (&parser->statistics, type, flags, value);
 		case DC_FIELD_GASMIX_COUNT:
 			*((unsigned int *) value) = parser->ngasmixes;
 			break;
@@ -231,6 +239,14 @@ divesystem_idive_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callba
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
+	// Collect the profile statistics during the first pass.
+	sample_statistics_t statistics;
+	if (!parser->cached) {
+		sample_statistics_init (&statistics, callback, userdata);
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int time = 0;
 	unsigned int maxdepth = 0;
 	unsigned int ngasmixes = 0;
@@ -359,7 +375,10 @@ divesystem_idive_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callba
 	parser->maxdepth = maxdepth;
 	parser->divetime = time;
 	parser->divemode = divemode;
-	parser->cached = 1;
+	if (!parser->cached) {
+		parser->statistics = statistics;
+		parser->cached = 1;
+	}
 
 	return DC_STATUS_SUCCESS;
 }
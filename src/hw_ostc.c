@@ -41,6 +41,7 @@
 #define SZ_MD2HASH 18
 #define SZ_EEPROM 256
 #define SZ_HEADER 266
+#define FP_SIZE   5
 #define SZ_FW_190 0x8000
 #define SZ_FW_NEW 0x10000
 
@@ -83,9 +84,6 @@ static const dc_device_vtable_t hw_ostc_device_vtable = {
 	hw_ostc_device_close /* close */
 };
 
-static dc_status_t
-hw_ostc_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static dc_status_t
 hw_ostc_send (hw_ostc_device_t *device, unsigned char cmd, unsigned int echo)
 {
@@ -147,6 +145,9 @@ hw_ostc_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -313,6 +314,8 @@ hw_ostc_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 hw_ostc_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	hw_ostc_device_t *device = (hw_ostc_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (0);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -338,8 +341,8 @@ hw_ostc_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void
 		devinfo.model = 0; // OSTC
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = hw_ostc_extract_dives (abstract, dc_buffer_get_data (buffer),
-		dc_buffer_get_size (buffer), callback, userdata);
+	rc = hw_ostc_extract_dives (abstract->context, device->fingerprint,
+		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
 
@@ -634,13 +637,13 @@ hw_ostc_device_screenshot (dc_device_t *abstract, dc_buffer_t *buffer, hw_ostc_f
 }
 
 
-static dc_status_t
-hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+hw_ostc_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	hw_ostc_device_t *device = (hw_ostc_device_t *) abstract;
-
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
+	if (size < SZ_HEADER) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
 
 	const unsigned char header[2] = {0xFA, 0xFA};
 	const unsigned char footer[2] = {0xFD, 0xFD};
@@ -650,7 +653,7 @@ hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsign
 	const unsigned char *previous = data + size;
 
 	// Search the data stream for header markers.
-	while ((current = array_search_backward (data + 266, current - data - 266, header, sizeof (header))) != NULL) {
+	while ((current = array_search_backward (data + SZ_HEADER, current - data - SZ_HEADER, header, sizeof (header))) != NULL) {
 		// Move the pointer to the begin of the header.
 		current -= sizeof (header);
 
@@ -663,10 +666,10 @@ hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsign
 			// Move the pointer to the end of the footer.
 			previous += sizeof (footer);
 
-			if (device && memcmp (current + 3, device->fingerprint, sizeof (device->fingerprint)) == 0)
+			if (fingerprint && memcmp (current + 3, fingerprint, FP_SIZE) == 0)
 				return DC_STATUS_SUCCESS;
 
-			if (callback && !callback (current, previous - current, current + 3, 5, userdata))
+			if (callback && !callback (current, previous - current, current + 3, FP_SIZE, userdata))
 				return DC_STATUS_SUCCESS;
 		}
 
@@ -34,6 +34,9 @@ extern "C" {
 dc_status_t
 hw_ostc_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+hw_ostc_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 dc_status_t
 hw_ostc_parser_create (dc_parser_t **parser, dc_context_t *context, unsigned int serial, unsigned int hwos);
 
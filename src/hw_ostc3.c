@@ -30,6 +30,7 @@
 #include "serial.h"
 #include "array.h"
 #include "aes.h"
+#include "ihex.h"
 
 #ifdef _MSC_VER
 #define snprintf _snprintf
@@ -111,6 +112,7 @@ typedef struct hw_ostc3_logbook_t {
 
 typedef struct hw_ostc3_firmware_t {
 	unsigned char data[SZ_FIRMWARE];
+	unsigned char bitmap[SZ_FIRMWARE / SZ_FIRMWARE_BLOCK];
 	unsigned int checksum;
 } hw_ostc3_firmware_t;
 
@@ -281,6 +283,12 @@ hw_ostc3_transfer (hw_ostc3_device_t *device,
 			}
 
 			nbytes += len;
+
+			// Expose the partial dive data.
+			if (cmd == DIVE) {
+				dc_event_partial_t partial = {output, nbytes, osize};
+				device_event_emit ((dc_device_t *) device, DC_EVENT_PARTIAL, &partial);
+			}
 		}
 	}
 
@@ -316,8 +324,8 @@ hw_ostc3_transfer (hw_ostc3_device_t *device,
 }
 
 
-dc_status_t
-hw_ostc3_device_open (dc_device_t **out, dc_context_t *context, const char *name)
+static dc_status_t
+hw_ostc3_device_setup (dc_device_t **out, dc_context_t *context, const char *name, unsigned int timeout, unsigned int delay)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	hw_ostc3_device_t *device = NULL;
@@ -346,6 +354,9 @@ hw_ostc3_device_open (dc_device_t **out, dc_context_t *context, const char *name
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -353,15 +364,16 @@ hw_ostc3_device_open (dc_device_t **out, dc_context_t *context, const char *name
 		goto error_close;
 	}
 
-	// Set the timeout for receiving data (3000ms).
-	status = dc_serial_set_timeout (device->port, 3000);
+	// Set the timeout for receiving data.
+	status = dc_serial_set_timeout (device->port, timeout);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
 		goto error_close;
 	}
 
 	// Make sure everything is in a sane state.
-	dc_serial_sleep (device->port, 300);
+	if (delay)
+		dc_serial_sleep (device->port, delay);
 	dc_serial_purge (device->port, DC_DIRECTION_ALL);
 
 	device->state = OPEN;
@@ -378,6 +390,13 @@ error_free:
 }
 
 
+dc_status_t
+hw_ostc3_device_open (dc_device_t **out, dc_context_t *context, const char *name)
+{
+	return hw_ostc3_device_setup (out, context, name, 3000, 300);
+}
+
+
 static dc_status_t
 hw_ostc3_device_id (hw_ostc3_device_t *device, unsigned char data[], unsigned int size)
 {
@@ -516,6 +535,33 @@ hw_ostc3_device_init (hw_ostc3_device_t *device, hw_ostc3_state_t state)
 }
 
 
+dc_status_t
+hw_ostc3_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = NULL;
+
+	if (model == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	status = hw_ostc3_device_setup (&abstract, context, name, timeout, 0);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// Enter download mode and read the hardware descriptor. Closing the
+	// device sends the exit command, which returns it to normal operation.
+	hw_ostc3_device_t *device = (hw_ostc3_device_t *) abstract;
+	status = hw_ostc3_device_init (device, DOWNLOAD);
+	if (status == DC_STATUS_SUCCESS) {
+		*model = (device->hardware != UNKNOWN ? device->hardware : 0);
+	}
+
+	dc_device_close (abstract);
+
+	return status;
+}
+
+
 static dc_status_t
 hw_ostc3_device_close (dc_device_t *abstract)
 {
@@ -973,45 +1019,25 @@ hw_ostc3_firmware_checksum (const unsigned char data[], unsigned int size)
 }
 
 static dc_status_t
-hw_ostc3_firmware_readline (FILE *fp, dc_context_t *context, unsigned int addr, unsigned char data[], unsigned int size)
+hw_ostc3_firmware_readline (dc_ihex_file_t *file, dc_context_t *context, unsigned int addr, unsigned char data[], unsigned int size)
 {
-	unsigned char ascii[39];
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	const unsigned char *ascii = NULL;
 	unsigned char faddr_byte[3];
 	unsigned int faddr = 0;
-	int n = 0;
 
 	if (size > 16) {
 		ERROR (context, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	// Read the start code.
-	while (1) {
-		n = fread (ascii, 1, 1, fp);
-		if (n != 1) {
-			ERROR (context, "Failed to read the start code.");
-			return DC_STATUS_IO;
-		}
-
-		if (ascii[0] == ':')
-			break;
-
-		// Ignore CR and LF characters.
-		if (ascii[0] != '\n' && ascii[0] != '\r') {
-			ERROR (context, "Unexpected character (0x%02x).", ascii[0]);
-			return DC_STATUS_DATAFORMAT;
-		}
-	}
-
-	// Read the payload.
-	n = fread (ascii + 1, 1, 6 + size * 2, fp);
-	if (n != 6 + size * 2) {
-		ERROR (context, "Failed to read the data.");
-		return DC_STATUS_IO;
-	}
+	// Read the address and payload.
+	rc = dc_ihex_file_read_raw (file, &ascii, 6 + size * 2);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
 	// Convert the address to binary representation.
-	if (array_convert_hex2bin(ascii + 1, 6, faddr_byte, sizeof(faddr_byte)) != 0) {
+	if (array_convert_hex2bin(ascii, 6, faddr_byte, sizeof(faddr_byte)) != 0) {
 		ERROR (context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
@@ -1024,7 +1050,7 @@ hw_ostc3_firmware_readline (FILE *fp, dc_context_t *context, unsigned int addr,
 	}
 
 	// Convert the payload to binary representation.
-	if (array_convert_hex2bin (ascii + 1 + 6, size * 2, data, size) != 0) {
+	if (array_convert_hex2bin (ascii + 6, size * 2, data, size) != 0) {
 		ERROR (context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
@@ -1037,10 +1063,8 @@ static dc_status_t
 hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *context, const char *filename)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	FILE *fp = NULL;
+	dc_ihex_file_t *file = NULL;
 	unsigned char iv[16] = {0};
-	unsigned char tmpbuf[16] = {0};
-	unsigned char encrypted[16] = {0};
 	unsigned int bytes = 0, addr = 0;
 	unsigned char checksum[4];
 
@@ -1053,59 +1077,50 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 	memset (firmware->data, 0xFF, sizeof (firmware->data));
 	firmware->checksum = 0;
 
-	fp = fopen (filename, "rb");
-	if (fp == NULL) {
-		ERROR (context, "Failed to open the file.");
-		return DC_STATUS_IO;
+	rc = dc_ihex_file_open (&file, context, filename);
+	if (rc != DC_STATUS_SUCCESS) {
+		return rc;
 	}
 
-	rc = hw_ostc3_firmware_readline (fp, context, 0, iv, sizeof(iv));
+	rc = hw_ostc3_firmware_readline (file, context, 0, iv, sizeof(iv));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to parse header.");
-		fclose (fp);
-		return rc;
+		goto error;
 	}
 	bytes += 16;
 
-	// Load the iv for AES-FCB-mode
-	AES128_ECB_encrypt (iv, ostc3_key, tmpbuf);
-
+	// Collect the encrypted data.
 	for (addr = 0; addr < SZ_FIRMWARE; addr += 16, bytes += 16) {
-		rc = hw_ostc3_firmware_readline (fp, context, bytes, encrypted, sizeof(encrypted));
+		rc = hw_ostc3_firmware_readline (file, context, bytes, firmware->data + addr, 16);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to parse file data.");
-			fclose (fp);
-			return rc;
+			goto error;
 		}
-
-		// Decrypt AES-FCB data
-		for (unsigned int i = 0; i < 16; i++)
-			firmware->data[addr + i] = encrypted[i] ^ tmpbuf[i];
-
-		// Run the next round of encryption
-		AES128_ECB_encrypt (encrypted, ostc3_key, tmpbuf);
 	}
 
 	// This file format contains a tail with the checksum in
-	rc = hw_ostc3_firmware_readline (fp, context, bytes, checksum, sizeof(checksum));
+	rc = hw_ostc3_firmware_readline (file, context, bytes, checksum, sizeof(checksum));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to parse file tail.");
-		fclose (fp);
-		return rc;
+		goto error;
 	}
 
-	fclose (fp);
+	// Decrypt the AES-CFB data in place.
+	AES128_CFB_decrypt_buffer (firmware->data, firmware->data, sizeof (firmware->data), ostc3_key, iv);
 
 	unsigned int csum1 = array_uint32_le (checksum);
 	unsigned int csum2 = hw_ostc3_firmware_checksum (firmware->data, sizeof(firmware->data));
 	if (csum1 != csum2) {
 		ERROR (context, "Failed to verify file checksum.");
-		return DC_STATUS_DATAFORMAT;
+		rc = DC_STATUS_DATAFORMAT;
+		goto error;
 	}
 
 	firmware->checksum = csum1;
 
-	return DC_STATUS_SUCCESS;
+error:
+	dc_ihex_file_close (file);
+	return rc;
 }
 
 static dc_status_t
@@ -1232,11 +1247,13 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	hw_ostc3_device_t *device = (hw_ostc3_device_t *) abstract;
 	dc_context_t *context = (abstract ? abstract->context : NULL);
+	const unsigned int nblocks = SZ_FIRMWARE / SZ_FIRMWARE_BLOCK;
+	char status[SZ_DISPLAY + 1]; // Status message on the display
 
 	// Enable progress notifications.
-	// load, erase, upload FZ, verify FZ, reprogram
+	// load, compare FZ, upload FZ, verify FZ, reprogram
 	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
-	progress.maximum = 3 + SZ_FIRMWARE * 2 / SZ_FIRMWARE_BLOCK;
+	progress.maximum = 2 + nblocks * 3;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
 	// Allocate memory for the firmware data.
@@ -1249,65 +1266,108 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 	// Read the hex file.
 	rc = hw_ostc3_firmware_readfile3 (firmware, context, filename);
 	if (rc != DC_STATUS_SUCCESS) {
-		free (firmware);
-		return rc;
+		goto error;
 	}
 
 	// Device open and firmware loaded
 	progress.current++;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	hw_ostc3_device_display (abstract, " Erasing FW...");
+	// The firmware area still contains the image of the previous update.
+	// Compare it against the new image, and mark the blocks that differ.
+	hw_ostc3_device_display (abstract, " Comparing...");
 
-	rc = hw_ostc3_firmware_erase (device, FIRMWARE_AREA, SZ_FIRMWARE);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (context, "Failed to erase old firmware");
-		free (firmware);
-		return rc;
+	unsigned int nchanged = 0;
+	for (unsigned int i = 0; i < nblocks; ++i) {
+		unsigned int offset = i * SZ_FIRMWARE_BLOCK;
+		unsigned char block[SZ_FIRMWARE_BLOCK];
+
+		rc = hw_ostc3_firmware_block_read (device, FIRMWARE_AREA + offset, block, sizeof (block));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to read block.");
+			goto error;
+		}
+
+		firmware->bitmap[i] = memcmp (firmware->data + offset, block, sizeof (block)) != 0;
+		if (firmware->bitmap[i])
+			nchanged++;
+
+		// One block compared
+		progress.current++;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 	}
 
-	// Memory erased
-	progress.current++;
+	// Only the changed blocks need to be uploaded and verified.
+	progress.maximum = progress.current + nchanged * 2 + 1;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
 	hw_ostc3_device_display (abstract, " Uploading...");
 
-	for (unsigned int len = 0; len < SZ_FIRMWARE; len += SZ_FIRMWARE_BLOCK) {
-		char status[SZ_DISPLAY + 1]; // Status message on the display
-		snprintf (status, sizeof(status), " Uploading %2d%%", (100 * len) / SZ_FIRMWARE);
-		hw_ostc3_device_display (abstract, status);
+	unsigned int count = 0;
+	unsigned int index = 0;
+	while (index < nblocks) {
+		if (firmware->bitmap[index] == 0) {
+			index++;
+			continue;
+		}
 
-		rc = hw_ostc3_firmware_block_write (device, FIRMWARE_AREA + len, firmware->data + len, SZ_FIRMWARE_BLOCK);
+		// Erase the entire run of consecutive changed blocks at once.
+		unsigned int n = 1;
+		while (index + n < nblocks && firmware->bitmap[index + n])
+			n++;
+
+		rc = hw_ostc3_firmware_erase (device, FIRMWARE_AREA + index * SZ_FIRMWARE_BLOCK, n * SZ_FIRMWARE_BLOCK);
 		if (rc != DC_STATUS_SUCCESS) {
-			ERROR (context, "Failed to write block to device");
-			free(firmware);
-			return rc;
+			ERROR (context, "Failed to erase old firmware");
+			goto error;
 		}
-		// One block uploaded
-		progress.current++;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+		for (unsigned int i = index; i < index + n; ++i, ++count) {
+			unsigned int offset = i * SZ_FIRMWARE_BLOCK;
+
+			snprintf (status, sizeof(status), " Uploading %2d%%", (100 * count) / nchanged);
+			hw_ostc3_device_display (abstract, status);
+
+			rc = hw_ostc3_firmware_block_write (device, FIRMWARE_AREA + offset, firmware->data + offset, SZ_FIRMWARE_BLOCK);
+			if (rc != DC_STATUS_SUCCESS) {
+				ERROR (context, "Failed to write block to device");
+				goto error;
+			}
+
+			// One block uploaded
+			progress.current++;
+			device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		}
+
+		index += n;
 	}
 
 	hw_ostc3_device_display (abstract, " Verifying...");
 
-	for (unsigned int len = 0; len < SZ_FIRMWARE; len += SZ_FIRMWARE_BLOCK) {
+	count = 0;
+	for (unsigned int i = 0; i < nblocks; ++i) {
+		unsigned int offset = i * SZ_FIRMWARE_BLOCK;
 		unsigned char block[SZ_FIRMWARE_BLOCK];
-		char status[SZ_DISPLAY + 1]; // Status message on the display
-		snprintf (status, sizeof(status), " Verifying %2d%%", (100 * len) / SZ_FIRMWARE);
+
+		// The unchanged blocks have already been verified.
+		if (firmware->bitmap[i] == 0)
+			continue;
+
+		snprintf (status, sizeof(status), " Verifying %2d%%", (100 * count++) / nchanged);
 		hw_ostc3_device_display (abstract, status);
 
-		rc = hw_ostc3_firmware_block_read (device, FIRMWARE_AREA + len, block, sizeof (block));
+		rc = hw_ostc3_firmware_block_read (device, FIRMWARE_AREA + offset, block, sizeof (block));
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to read block.");
-			free (firmware);
-			return rc;
+			goto error;
 		}
-		if (memcmp (firmware->data + len, block, sizeof (block)) != 0) {
+		if (memcmp (firmware->data + offset, block, sizeof (block)) != 0) {
 			ERROR (context, "Failed verify.");
 			hw_ostc3_device_display (abstract, " Verify FAILED");
-			free (firmware);
-			return DC_STATUS_PROTOCOL;
+			rc = DC_STATUS_PROTOCOL;
+			goto error;
 		}
+
 		// One block verified
 		progress.current++;
 		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
@@ -1318,18 +1378,16 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 	rc = hw_ostc3_firmware_upgrade (abstract, firmware->checksum);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to start programing");
-		free (firmware);
-		return rc;
+		goto error;
 	}
 
 	// Programing done!
 	progress.current++;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
+error:
 	free (firmware);
-
-	// Finished!
-	return DC_STATUS_SUCCESS;
+	return rc;
 }
 
 static dc_status_t
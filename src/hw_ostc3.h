@@ -34,6 +34,9 @@ extern "C" {
 dc_status_t
 hw_ostc3_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+hw_ostc3_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model);
+
 dc_status_t
 hw_ostc3_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int serial, unsigned int model);
 
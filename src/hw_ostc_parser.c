@@ -96,6 +96,7 @@ typedef struct hw_ostc_layout_t {
 	unsigned int deco_info2;
 	unsigned int decomode;
         unsigned int battery_percentage;
+	sample_decoder_t decoder;
 } hw_ostc_layout_t;
 
 typedef struct hw_ostc_gasmix_t {
@@ -103,6 +104,13 @@ typedef struct hw_ostc_gasmix_t {
 	unsigned int helium;
 } hw_ostc_gasmix_t;
 
+typedef struct hw_ostc_checkpoint_t {
+	unsigned int offset;
+	unsigned int time;
+	unsigned int nsamples;
+	unsigned int gasmix;
+} hw_ostc_checkpoint_t;
+
 typedef struct hw_ostc_parser_t {
 	dc_parser_t base;
 	unsigned int hwos;
@@ -118,12 +126,18 @@ typedef struct hw_ostc_parser_t {
 	unsigned int initial;
 	unsigned int initial_setpoint;
 	hw_ostc_gasmix_t gasmix[NGASMIXES];
+	sample_statistics_t statistics;
+	sample_index_t index;
+	hw_ostc_checkpoint_t checkpoint[SAMPLE_INDEX_SIZE];
 } hw_ostc_parser_t;
 
 static dc_status_t hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
 static dc_status_t hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t hw_ostc_parser_samples_range (dc_parser_t *abstract, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata);
+static dc_status_t hw_ostc_parser_decode_ostc (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata);
+static dc_status_t hw_ostc_parser_decode_ostc3 (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	sizeof(hw_ostc_parser_t),
@@ -132,6 +146,7 @@ static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	hw_ostc_parser_get_datetime, /* datetime */
 	hw_ostc_parser_get_field, /* fields */
 	hw_ostc_parser_samples_foreach, /* samples_foreach */
+	hw_ostc_parser_samples_range, /* samples_range */
 	NULL /* destroy */
 };
 
@@ -151,6 +166,7 @@ static const hw_ostc_layout_t hw_ostc_layout_ostc = {
 	50, /* deco_info1 */
 	51, /* decomode */
         0,  /* battery percentage TBD */
+	hw_ostc_parser_decode_ostc, /* decoder */
 };
 
 static const hw_ostc_layout_t hw_ostc_layout_frog = {
@@ -169,6 +185,7 @@ static const hw_ostc_layout_t hw_ostc_layout_frog = {
 	50, /* deco_info2 */
 	51, /* decomode */
         0,  /* battery percentage TBD */
+	hw_ostc_parser_decode_ostc, /* decoder */
 };
 
 static const hw_ostc_layout_t hw_ostc_layout_ostc3 = {
@@ -187,6 +204,7 @@ static const hw_ostc_layout_t hw_ostc_layout_ostc3 = {
 	78, /* deco_info2 */
 	79, /* decomode */
         59,  /* battery percentage */
+	hw_ostc_parser_decode_ostc3, /* decoder */
 };
 
 static unsigned int
@@ -349,6 +367,8 @@ hw_ostc_parser_create_internal (dc_parser_t **out, dc_context_t *context, unsign
 		parser->gasmix[i].oxygen = 0;
 		parser->gasmix[i].helium = 0;
 	}
+	sample_statistics_init (&parser->statistics, NULL, NULL);
+	sample_index_reset (&parser->index);
 	parser->serial = serial;
 
 	*out = (dc_parser_t *) parser;
@@ -387,6 +407,8 @@ hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsig
 		parser->gasmix[i].oxygen = 0;
 		parser->gasmix[i].helium = 0;
 	}
+	sample_statistics_init (&parser->statistics, NULL, NULL);
+	sample_index_reset (&parser->index);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -518,6 +540,8 @@ hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned
 		case DC_FIELD_TEMPERATURE_MINIMUM:
 			*((double *) value) = (signed short) array_uint16_le (data + layout->temperature) / 10.0;
 			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			return sample_statistics_get_field (&parser->statistics, type, flags, value);
 		case DC_FIELD_DIVEMODE:
 			if (version == 0x21) {
 				switch (data[51]) {
@@ -654,10 +678,11 @@ hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned
 }
 
 
-static dc_status_t
-hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+SAMPLE_DECODER_INLINE dc_status_t
+hw_ostc_parser_decode (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata, const unsigned int hwos3)
 {
 	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+	const hw_ostc_checkpoint_t *start = (const hw_ostc_checkpoint_t *) checkpoint;
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
@@ -666,20 +691,27 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
-	unsigned int version = parser->version;
+	// Collect the profile statistics during the first pass.
+	sample_statistics_t statistics;
+	if (parser->cached < PROFILE && start == NULL) {
+		sample_statistics_init (&statistics, callback, userdata);
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int header = parser->header;
 	const hw_ostc_layout_t *layout = parser->layout;
 
 	// Get the sample rate.
 	unsigned int samplerate = 0;
-	if (version == 0x23 || version == 0x24)
+	if (hwos3)
 		samplerate = data[header + 3];
 	else
 		samplerate = data[36];
 
 	// Get the salinity factor.
 	unsigned int salinity = data[layout->salinity];
-	if (version == 0x23 || version == 0x24)
+	if (hwos3)
 		salinity += 100;
 	if (salinity < 100 || salinity > 104)
 		salinity = 100;
@@ -687,7 +719,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 
 	// Get the number of sample descriptors.
 	unsigned int nconfig = 0;
-	if (version == 0x23 || version == 0x24)
+	if (hwos3)
 		nconfig = data[header + 4];
 	else
 		nconfig = 6;
@@ -699,7 +731,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 	// Get the extended sample configuration.
 	hw_ostc_sample_info_t info[MAXCONFIG] = {{0}};
 	for (unsigned int i = 0; i < nconfig; ++i) {
-		if (version == 0x23 || version == 0x24) {
+		if (hwos3) {
 			info[i].type    = data[header + 5 + 3 * i + 0];
 			info[i].size    = data[header + 5 + 3 * i + 1];
 			info[i].divisor = data[header + 5 + 3 * i + 2];
@@ -744,15 +776,43 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 		firmware = array_uint16_be (data + layout->firmware);
 	}
 
+	// Due to a firmware bug, the deco/ndl info is incorrect for
+	// all OSTC4 dives with a firmware older than version 1.0.8.
+	unsigned int deco = !(parser->model == OSTC4 && firmware < 0x0810);
+
 	unsigned int time = 0;
 	unsigned int nsamples = 0;
+	unsigned int gasmix = UNDEFINED;
 
 	unsigned int offset = header;
-	if (version == 0x23 || version == 0x24)
+	if (hwos3)
 		offset += 5 + 3 * nconfig;
+
+	// Resume from a checkpoint.
+	if (start) {
+		offset = start->offset;
+		time = start->time;
+		nsamples = start->nsamples;
+		gasmix = start->gasmix;
+	}
+
 	while (offset + 3 <= size) {
 		dc_sample_value_t sample = {0};
 
+		// Stop after the end of the requested time window.
+		if (time + samplerate > end)
+			break;
+
+		// Save the decoder state at regular time intervals.
+		int slot = sample_index_add (&parser->index, time + samplerate,
+			parser->checkpoint, sizeof (parser->checkpoint[0]));
+		if (slot >= 0) {
+			parser->checkpoint[slot].offset = offset;
+			parser->checkpoint[slot].time = time;
+			parser->checkpoint[slot].nsamples = nsamples;
+			parser->checkpoint[slot].gasmix = gasmix;
+		}
+
 		nsamples++;
 
 		// Time (seconds).
@@ -760,9 +820,15 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 		sample.time = time;
 		if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
+		// Active gas mix when resuming from a checkpoint.
+		if (start && nsamples == start->nsamples + 1 && gasmix != UNDEFINED) {
+			sample.gasmix = gasmix;
+			if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
+		}
+
 		// Initial gas mix.
 		if (time == samplerate && parser->initial != UNDEFINED) {
-			sample.gasmix = parser->initial;
+			sample.gasmix = gasmix = parser->initial;
 			if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
 		}
 
@@ -792,7 +858,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 		unsigned int nbits = 0;
 		unsigned int events = 0;
 		while (data[offset - 1] & 0x80) {
-			if (nbits && version != 0x23 && version != 0x24)
+			if (nbits && !hwos3)
 				break;
 			if (length < 1) {
 				ERROR (abstract->context, "Buffer overflow detected!");
@@ -855,7 +921,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 				parser->ngasmixes = idx + 1;
 			}
 
-			sample.gasmix = idx;
+			sample.gasmix = gasmix = idx;
 			if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
 			offset += 2;
 			length -= 2;
@@ -873,13 +939,13 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 				return DC_STATUS_DATAFORMAT;
 			}
 			idx--; /* Convert to a zero based index. */
-			sample.gasmix = idx;
+			sample.gasmix = gasmix = idx;
 			if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
 			offset++;
 			length--;
 		}
 
-		if (version == 0x23 || version == 0x24) {
+		if (hwos3) {
 			// SetPoint Change
 			if (events & 0x40) {
 				if (length < 1) {
@@ -912,7 +978,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 					parser->ngasmixes = idx + 1;
 				}
 
-				sample.gasmix = idx;
+				sample.gasmix = gasmix = idx;
 				if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
 				offset += 2;
 				length -= 2;
@@ -937,9 +1003,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 					if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 					break;
 				case 1: // Deco / NDL
-					// Due to a firmware bug, the deco/ndl info is incorrect for
-					// all OSTC4 dives with a firmware older than version 1.0.8.
-					if (parser->model == OSTC4 && firmware < 0x0810)
+					if (!deco)
 						break;
 					if (data[offset]) {
 						sample.deco.type = DC_DECO_DECOSTOP;
@@ -984,7 +1048,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 			}
 		}
 
-		if (version != 0x23 && version != 0x24) {
+		if (!hwos3) {
 			// SetPoint Change
 			if (events & 0x40) {
 				if (length < 1) {
@@ -1017,7 +1081,7 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 					parser->ngasmixes = idx + 1;
 				}
 
-				sample.gasmix = idx;
+				sample.gasmix = gasmix = idx;
 				if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
 				offset += 2;
 				length -= 2;
@@ -1031,12 +1095,63 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 		offset += length;
 	}
 
+	// Stopped before the end of the profile.
+	if (offset + 3 <= size)
+		return DC_STATUS_SUCCESS;
+
 	if (offset + 2 > size || data[offset] != 0xFD || data[offset + 1] != 0xFD) {
 		ERROR (abstract->context, "Invalid end marker found!");
 		return DC_STATUS_DATAFORMAT;
 	}
 
-	parser->cached = PROFILE;
+	parser->index.complete = 1;
+
+	// Cache the profile data.
+	if (parser->cached < PROFILE && start == NULL) {
+		parser->statistics = statistics;
+		parser->cached = PROFILE;
+	}
 
 	return DC_STATUS_SUCCESS;
 }
+
+SAMPLE_DECODER (hw_ostc_parser_decode_ostc, hw_ostc_parser_decode, 0)
+SAMPLE_DECODER (hw_ostc_parser_decode_ostc3, hw_ostc_parser_decode, 1)
+
+static dc_status_t
+hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	// Cache the parser data.
+	dc_status_t rc = hw_ostc_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return parser->layout->decoder (abstract, NULL, 0xFFFFFFFF, callback, userdata);
+}
+
+static dc_status_t
+hw_ostc_parser_samples_range (dc_parser_t *abstract, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	// Cache the parser data.
+	dc_status_t rc = hw_ostc_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Build the checkpoint index.
+	if (!parser->index.complete) {
+		rc = parser->layout->decoder (abstract, NULL, 0xFFFFFFFF, NULL, NULL);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+	}
+
+	// Resume from the last checkpoint before the time window.
+	int slot = sample_index_find (&parser->index, begin);
+	if (slot < 0)
+		return DC_STATUS_SUCCESS;
+
+	return parser->layout->decoder (abstract, parser->checkpoint + slot, end, callback, userdata);
+}
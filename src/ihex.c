@@ -29,15 +29,25 @@
 #include "checksum.h"
 #include "array.h"
 
+/*
+ * The entire file is loaded into memory when it's opened. The records are
+ * parsed directly from the memory buffer, which avoids the overhead of
+ * reading the file in many small pieces.
+ */
 struct dc_ihex_file_t {
 	dc_context_t *context;
-	FILE *fp;
+	unsigned char *data;
+	size_t size;
+	size_t offset;
 };
 
 dc_status_t
 dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *filename)
 {
+	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_ihex_file_t *file = NULL;
+	FILE *fp = NULL;
+	long size = 0;
 
 	if (result == NULL || filename == NULL) {
 		ERROR (context, "Invalid arguments.");
@@ -51,64 +61,142 @@ dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *f
 	}
 
 	file->context = context;
+	file->data = NULL;
+	file->size = 0;
+	file->offset = 0;
 
-	file->fp = fopen (filename, "rb");
-	if (file->fp == NULL) {
+	fp = fopen (filename, "rb");
+	if (fp == NULL) {
 		ERROR (context, "Failed to open the file.");
-		free (file);
-		return DC_STATUS_IO;
+		status = DC_STATUS_IO;
+		goto error_free;
 	}
 
+	/* Get the file size. */
+	if (fseek (fp, 0, SEEK_END) != 0 ||
+		(size = ftell (fp)) < 0 ||
+		fseek (fp, 0, SEEK_SET) != 0) {
+		ERROR (context, "Failed to get the file size.");
+		status = DC_STATUS_IO;
+		goto error_close;
+	}
+
+	if (size) {
+		file->data = (unsigned char *) malloc (size);
+		if (file->data == NULL) {
+			ERROR (context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_close;
+		}
+
+		if (fread (file->data, 1, size, fp) != (size_t) size) {
+			ERROR (context, "Failed to read the file.");
+			status = DC_STATUS_IO;
+			goto error_close;
+		}
+	}
+
+	file->size = size;
+
+	fclose (fp);
+
 	*result = file;
 
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	fclose (fp);
+error_free:
+	free (file->data);
+	free (file);
+	return status;
+}
+
+/*
+ * Move to the next record, and return the number of characters after the
+ * start code. The record data is not interpreted in any way.
+ */
+static dc_status_t
+dc_ihex_file_start (dc_ihex_file_t *file, size_t *available)
+{
+	while (file->offset < file->size) {
+		unsigned char c = file->data[file->offset++];
+		if (c == ':') {
+			*available = file->size - file->offset;
+			return DC_STATUS_SUCCESS;
+		}
+
+		/* Ignore CR and LF characters. */
+		if (c != '\n' && c != '\r') {
+			ERROR (file->context, "Unexpected character (0x%02x).", c);
+			return DC_STATUS_DATAFORMAT;
+		}
+	}
+
+	return DC_STATUS_DONE;
+}
+
+dc_status_t
+dc_ihex_file_read_raw (dc_ihex_file_t *file, const unsigned char **data, unsigned int size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	size_t available = 0;
+
+	if (file == NULL || data == NULL) {
+		ERROR (file ? file->context : NULL, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	/* Find the start code. */
+	status = dc_ihex_file_start (file, &available);
+	if (status == DC_STATUS_DONE) {
+		ERROR (file->context, "Failed to read the start code.");
+		return DC_STATUS_IO;
+	} else if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	if (available < size) {
+		ERROR (file->context, "Failed to read the data.");
+		return DC_STATUS_IO;
+	}
+
+	*data = file->data + file->offset;
+	file->offset += size;
+
 	return DC_STATUS_SUCCESS;
 }
 
 dc_status_t
 dc_ihex_file_read (dc_ihex_file_t *file, dc_ihex_entry_t *entry)
 {
-	unsigned char ascii[9 + 2 * 255 + 2] = {0};
+	dc_status_t status = DC_STATUS_SUCCESS;
 	unsigned char data[4 + 255 + 1] = {0};
+	const unsigned char *ascii = NULL;
 	unsigned int type, length, address;
 	unsigned char csum_a, csum_b;
-	size_t n;
+	size_t available = 0;
 
 	if (file == NULL || entry == NULL) {
 		ERROR (file ? file->context : NULL, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	/* Read the start code. */
-	while (1) {
-		n = fread (ascii, 1, 1, file->fp);
-		if (n != 1) {
-			if (feof (file->fp)) {
-				return DC_STATUS_DONE;
-			} else {
-				ERROR (file->context, "Failed to read the start code.");
-				return DC_STATUS_IO;
-			}
-		}
+	/* Find the start code. */
+	status = dc_ihex_file_start (file, &available);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
 
-		if (ascii[0] == ':')
-			break;
+	ascii = file->data + file->offset;
 
-		/* Ignore CR and LF characters. */
-		if (ascii[0] != '\n' && ascii[0] != '\r') {
-			ERROR (file->context, "Unexpected character (0x%02x).", ascii[0]);
-			return DC_STATUS_DATAFORMAT;
-		}
-	}
-
-	/* Read the record length, address and type. */
-	n = fread (ascii + 1, 1, 8, file->fp);
-	if (n != 8) {
+	/* Check the record length, address and type. */
+	if (available < 8) {
 		ERROR (file->context, "Failed to read the header.");
 		return DC_STATUS_IO;
 	}
 
 	/* Convert to binary representation. */
-	if (array_convert_hex2bin (ascii + 1, 8, data, 4) != 0) {
+	if (array_convert_hex2bin (ascii, 8, data, 4) != 0) {
 		ERROR (file->context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
@@ -116,19 +204,20 @@ dc_ihex_file_read (dc_ihex_file_t *file, dc_ihex_entry_t *entry)
 	/* Get the record length. */
 	length = data[0];
 
-	/* Read the record payload. */
-	n = fread (ascii + 9, 1, 2 * length + 2, file->fp);
-	if (n != 2 * length + 2) {
+	/* Check the record payload. */
+	if (available < 8 + 2 * length + 2) {
 		ERROR (file->context, "Failed to read the data.");
 		return DC_STATUS_IO;
 	}
 
 	/* Convert to binary representation. */
-	if (array_convert_hex2bin (ascii + 9, 2 * length + 2, data + 4, length + 1) != 0) {
+	if (array_convert_hex2bin (ascii + 8, 2 * length + 2, data + 4, length + 1) != 0) {
 		ERROR (file->context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
 
+	file->offset += 8 + 2 * length + 2;
+
 	/* Verify the checksum. */
 	csum_a = data[4 + length];
 	csum_b = ~checksum_add_uint8 (data, 4 + length, 0x00) + 1;
@@ -189,7 +278,7 @@ dc_ihex_file_reset (dc_ihex_file_t *file)
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	rewind (file->fp);
+	file->offset = 0;
 
 	return DC_STATUS_SUCCESS;
 }
@@ -198,7 +287,7 @@ dc_status_t
 dc_ihex_file_close (dc_ihex_file_t *file)
 {
 	if (file) {
-		fclose (file->fp);
+		free (file->data);
 		free (file);
 	}
 
@@ -44,6 +44,14 @@ dc_ihex_file_open (dc_ihex_file_t **file, dc_context_t *context, const char *fil
 dc_status_t
 dc_ihex_file_read (dc_ihex_file_t *file, dc_ihex_entry_t *entry);
 
+/*
+ * Read the raw characters of the next record, without the start code.
+ * This allows to parse files that use the same record framing, but a
+ * different record layout.
+ */
+dc_status_t
+dc_ihex_file_read_raw (dc_ihex_file_t *file, const unsigned char **data, unsigned int size);
+
 dc_status_t
 dc_ihex_file_reset (dc_ihex_file_t *file);
 
@@ -0,0 +1,679 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy
+#include <assert.h>
+
+#include "iostream-private.h"
+#include "context-private.h"
+#include "common-private.h"
+#include "usbhid.h"
+
+dc_iostream_t *
+dc_iostream_allocate (dc_context_t *context, const dc_iostream_vtable_t *vtable)
+{
+	dc_iostream_t *iostream = NULL;
+
+	assert(vtable != NULL);
+	assert(vtable->size >= sizeof(dc_iostream_t));
+
+	// Allocate memory.
+	iostream = (dc_iostream_t *) malloc (vtable->size);
+	if (iostream == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return iostream;
+	}
+
+	iostream->vtable = vtable;
+	iostream->context = context;
+	iostream->stats = NULL;
+	iostream->packetsize = 0;
+
+	return iostream;
+}
+
+void
+dc_iostream_deallocate (dc_iostream_t *iostream)
+{
+	free (iostream);
+}
+
+dc_transport_t
+dc_iostream_get_transport (dc_iostream_t *iostream)
+{
+	if (iostream == NULL)
+		return DC_TRANSPORT_NONE;
+
+	return iostream->vtable->transport;
+}
+
+unsigned int
+dc_iostream_get_packetsize (dc_iostream_t *iostream)
+{
+	if (iostream == NULL)
+		return 0;
+
+	return iostream->packetsize;
+}
+
+dc_status_t
+dc_iostream_set_timeout (dc_iostream_t *iostream, int timeout)
+{
+	if (iostream == NULL || iostream->vtable->set_timeout == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->set_timeout (iostream, timeout);
+}
+
+dc_status_t
+dc_iostream_configure (dc_iostream_t *iostream, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	if (iostream == NULL || iostream->vtable->configure == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->configure (iostream, baudrate, databits, parity, stopbits, flowcontrol);
+}
+
+dc_status_t
+dc_iostream_get_available (dc_iostream_t *iostream, size_t *value)
+{
+	if (iostream == NULL || iostream->vtable->get_available == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->get_available (iostream, value);
+}
+
+dc_status_t
+dc_iostream_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actual)
+{
+	if (actual)
+		*actual = 0;
+
+	if (iostream == NULL || iostream->vtable->read == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->read (iostream, data, size, actual);
+}
+
+dc_status_t
+dc_iostream_write (dc_iostream_t *iostream, const void *data, size_t size, size_t *actual)
+{
+	if (actual)
+		*actual = 0;
+
+	if (iostream == NULL || iostream->vtable->write == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->write (iostream, data, size, actual);
+}
+
+dc_status_t
+dc_iostream_writev (dc_iostream_t *iostream, const dc_iovec_t iov[], unsigned int count, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char buffer[256] = {0};
+	unsigned char *packet = NULL;
+	size_t nbytes = 0;
+
+	if (actual)
+		*actual = 0;
+
+	if (iostream == NULL || iostream->vtable->write == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (iov == NULL && count != 0)
+		return DC_STATUS_INVALIDARGS;
+
+	// Gather the buffers, and send them with a single write. For packet
+	// based transports, this is required to keep them in the same packet.
+	// For byte streams, it avoids the overhead of multiple small writes.
+	size_t size = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		size += iov[i].size;
+	}
+
+	packet = buffer;
+	if (size > sizeof (buffer)) {
+		packet = (unsigned char *) malloc (size);
+		if (packet == NULL) {
+			ERROR (iostream->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	size_t offset = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		memcpy (packet + offset, iov[i].data, iov[i].size);
+		offset += iov[i].size;
+	}
+
+	status = iostream->vtable->write (iostream, packet, size, &nbytes);
+
+	if (packet != buffer)
+		free (packet);
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+dc_status_t
+dc_iostream_purge (dc_iostream_t *iostream, dc_direction_t direction)
+{
+	if (iostream == NULL || iostream->vtable->purge == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->purge (iostream, direction);
+}
+
+dc_status_t
+dc_iostream_sleep (dc_iostream_t *iostream, unsigned int milliseconds)
+{
+	if (iostream == NULL || iostream->vtable->sleep == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return iostream->vtable->sleep (iostream, milliseconds);
+}
+
+dc_status_t
+dc_iostream_close (dc_iostream_t *iostream)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (iostream == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (iostream->vtable->close)
+		status = iostream->vtable->close (iostream);
+
+	dc_iostream_deallocate (iostream);
+
+	return status;
+}
+
+void
+dc_iostream_set_stats (dc_iostream_t *iostream, dc_device_stats_t *stats)
+{
+	if (iostream == NULL)
+		return;
+
+	iostream->stats = stats;
+
+	if (iostream->vtable->set_stats)
+		iostream->vtable->set_stats (iostream, stats);
+}
+
+/*
+ * Serial transport.
+ */
+
+typedef struct dc_serial_iostream_t {
+	dc_iostream_t base;
+	dc_serial_t *port;
+} dc_serial_iostream_t;
+
+static dc_status_t
+dc_serial_iostream_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_set_timeout (iostream->port, timeout);
+}
+
+static dc_status_t
+dc_serial_iostream_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_configure (iostream->port, baudrate, databits, parity, stopbits, flowcontrol);
+}
+
+static dc_status_t
+dc_serial_iostream_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_get_available (iostream->port, value);
+}
+
+static dc_status_t
+dc_serial_iostream_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_read (iostream->port, data, size, actual);
+}
+
+static dc_status_t
+dc_serial_iostream_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_write (iostream->port, data, size, actual);
+}
+
+static dc_status_t
+dc_serial_iostream_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_purge (iostream->port, direction);
+}
+
+static dc_status_t
+dc_serial_iostream_sleep (dc_iostream_t *abstract, unsigned int milliseconds)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_sleep (iostream->port, milliseconds);
+}
+
+static dc_status_t
+dc_serial_iostream_close (dc_iostream_t *abstract)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	return dc_serial_close (iostream->port);
+}
+
+static void
+dc_serial_iostream_set_stats (dc_iostream_t *abstract, dc_device_stats_t *stats)
+{
+	dc_serial_iostream_t *iostream = (dc_serial_iostream_t *) abstract;
+
+	dc_serial_set_stats (iostream->port, stats);
+}
+
+static const dc_iostream_vtable_t dc_serial_iostream_vtable = {
+	sizeof(dc_serial_iostream_t),
+	DC_TRANSPORT_SERIAL,
+	dc_serial_iostream_set_timeout, /* set_timeout */
+	dc_serial_iostream_configure, /* configure */
+	dc_serial_iostream_get_available, /* get_available */
+	dc_serial_iostream_read, /* read */
+	dc_serial_iostream_write, /* write */
+	dc_serial_iostream_purge, /* purge */
+	dc_serial_iostream_sleep, /* sleep */
+	dc_serial_iostream_close, /* close */
+	dc_serial_iostream_set_stats /* set_stats */
+};
+
+dc_status_t
+dc_serial_iostream_open (dc_iostream_t **out, dc_context_t *context, const char *name)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_serial_iostream_t *iostream = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	iostream = (dc_serial_iostream_t *) dc_iostream_allocate (context, &dc_serial_iostream_vtable);
+	if (iostream == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	status = dc_serial_open (&iostream->port, context, name);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = (dc_iostream_t *) iostream;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) iostream);
+	return status;
+}
+
+/*
+ * IrDA transport.
+ */
+
+typedef struct dc_irda_iostream_t {
+	dc_iostream_t base;
+	dc_irda_t *socket;
+} dc_irda_iostream_t;
+
+static dc_status_t
+dc_irda_iostream_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	return dc_irda_set_timeout (iostream->socket, timeout);
+}
+
+static dc_status_t
+dc_irda_iostream_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	return dc_irda_get_available (iostream->socket, value);
+}
+
+static dc_status_t
+dc_irda_iostream_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	return dc_irda_read (iostream->socket, data, size, actual);
+}
+
+static dc_status_t
+dc_irda_iostream_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	return dc_irda_write (iostream->socket, data, size, actual);
+}
+
+static dc_status_t
+dc_irda_iostream_close (dc_iostream_t *abstract)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	return dc_irda_close (iostream->socket);
+}
+
+static void
+dc_irda_iostream_set_stats (dc_iostream_t *abstract, dc_device_stats_t *stats)
+{
+	dc_irda_iostream_t *iostream = (dc_irda_iostream_t *) abstract;
+
+	dc_irda_set_stats (iostream->socket, stats);
+}
+
+static const dc_iostream_vtable_t dc_irda_iostream_vtable = {
+	sizeof(dc_irda_iostream_t),
+	DC_TRANSPORT_IRDA,
+	dc_irda_iostream_set_timeout, /* set_timeout */
+	NULL, /* configure */
+	dc_irda_iostream_get_available, /* get_available */
+	dc_irda_iostream_read, /* read */
+	dc_irda_iostream_write, /* write */
+	NULL, /* purge */
+	NULL, /* sleep */
+	dc_irda_iostream_close, /* close */
+	dc_irda_iostream_set_stats /* set_stats */
+};
+
+dc_status_t
+dc_irda_iostream_open (dc_iostream_t **out, dc_context_t *context, dc_irda_t *irda)
+{
+	dc_irda_iostream_t *iostream = NULL;
+
+	if (out == NULL || irda == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	iostream = (dc_irda_iostream_t *) dc_iostream_allocate (context, &dc_irda_iostream_vtable);
+	if (iostream == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	iostream->socket = irda;
+
+	*out = (dc_iostream_t *) iostream;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * USB HID transport.
+ */
+
+#define USBHID_PACKETSIZE 64
+
+typedef struct dc_usbhid_iostream_t {
+	dc_iostream_t base;
+	dc_usbhid_t *usbhid;
+	int timeout;
+} dc_usbhid_iostream_t;
+
+static dc_status_t
+dc_usbhid_iostream_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	dc_status_t status = dc_usbhid_set_timeout (iostream->usbhid, timeout);
+	if (status == DC_STATUS_SUCCESS)
+		iostream->timeout = timeout;
+
+	return status;
+}
+
+static dc_status_t
+dc_usbhid_iostream_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	return dc_usbhid_read (iostream->usbhid, data, size, actual);
+}
+
+static dc_status_t
+dc_usbhid_iostream_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	return dc_usbhid_write (iostream->usbhid, data, size, actual);
+}
+
+static dc_status_t
+dc_usbhid_iostream_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	if ((direction & DC_DIRECTION_INPUT) == 0)
+		return DC_STATUS_SUCCESS;
+
+	dc_usbhid_set_timeout (iostream->usbhid, 10);
+
+	/* Get rid of any pending stale input first */
+	/* NOTE! This will cause an annoying warning from dc_usbhid_read() */
+	for (;;) {
+		size_t transferred = 0;
+		unsigned char buf[USBHID_PACKETSIZE];
+
+		dc_status_t rc = dc_usbhid_read (iostream->usbhid, buf, sizeof(buf), &transferred);
+		if (rc != DC_STATUS_SUCCESS)
+			break;
+		if (!transferred)
+			break;
+	}
+
+	return dc_usbhid_set_timeout (iostream->usbhid, iostream->timeout);
+}
+
+static dc_status_t
+dc_usbhid_iostream_close (dc_iostream_t *abstract)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	return dc_usbhid_close (iostream->usbhid);
+}
+
+static void
+dc_usbhid_iostream_set_stats (dc_iostream_t *abstract, dc_device_stats_t *stats)
+{
+	dc_usbhid_iostream_t *iostream = (dc_usbhid_iostream_t *) abstract;
+
+	dc_usbhid_set_stats (iostream->usbhid, stats);
+}
+
+static const dc_iostream_vtable_t dc_usbhid_iostream_vtable = {
+	sizeof(dc_usbhid_iostream_t),
+	DC_TRANSPORT_USB,
+	dc_usbhid_iostream_set_timeout, /* set_timeout */
+	NULL, /* configure */
+	NULL, /* get_available */
+	dc_usbhid_iostream_read, /* read */
+	dc_usbhid_iostream_write, /* write */
+	dc_usbhid_iostream_purge, /* purge */
+	NULL, /* sleep */
+	dc_usbhid_iostream_close, /* close */
+	dc_usbhid_iostream_set_stats /* set_stats */
+};
+
+dc_status_t
+dc_usbhid_iostream_open (dc_iostream_t **out, dc_context_t *context, unsigned int vid, unsigned int pid)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_usbhid_iostream_t *iostream = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	iostream = (dc_usbhid_iostream_t *) dc_iostream_allocate (context, &dc_usbhid_iostream_vtable);
+	if (iostream == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	iostream->base.packetsize = USBHID_PACKETSIZE;
+	iostream->timeout = -1;
+
+	status = dc_usbhid_open (&iostream->usbhid, context, vid, pid);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = (dc_iostream_t *) iostream;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) iostream);
+	return status;
+}
+
+/*
+ * Custom packet transport, provided by the application (e.g. BLE GATT).
+ * The custom I/O functions have no timeout or purge support, so those
+ * operations are silently ignored. Each stream keeps its own copy of
+ * the callbacks, so the userdata filled in by packet_open belongs to
+ * that connection only.
+ */
+
+typedef struct dc_custom_iostream_t {
+	dc_iostream_t base;
+	dc_custom_io_t io;
+} dc_custom_iostream_t;
+
+static dc_status_t
+dc_custom_iostream_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_custom_iostream_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_custom_iostream_t *iostream = (dc_custom_iostream_t *) abstract;
+	size_t nbytes = 0;
+
+	unsigned long long begin = dc_clock_now ();
+
+	dc_status_t status = iostream->io.packet_read (&iostream->io, data, size, &nbytes);
+
+	dc_stats_read (abstract->stats, nbytes, status, begin);
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_custom_iostream_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_custom_iostream_t *iostream = (dc_custom_iostream_t *) abstract;
+	size_t nbytes = 0;
+
+	dc_status_t status = iostream->io.packet_write (&iostream->io, data, size, &nbytes);
+
+	dc_stats_write (abstract->stats, nbytes, status);
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_custom_iostream_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_custom_iostream_close (dc_iostream_t *abstract)
+{
+	dc_custom_iostream_t *iostream = (dc_custom_iostream_t *) abstract;
+
+	if (iostream->io.packet_close == NULL)
+		return DC_STATUS_SUCCESS;
+
+	return iostream->io.packet_close (&iostream->io);
+}
+
+static const dc_iostream_vtable_t dc_custom_iostream_vtable = {
+	sizeof(dc_custom_iostream_t),
+	DC_TRANSPORT_CUSTOM,
+	dc_custom_iostream_set_timeout, /* set_timeout */
+	NULL, /* configure */
+	NULL, /* get_available */
+	dc_custom_iostream_read, /* read */
+	dc_custom_iostream_write, /* write */
+	dc_custom_iostream_purge, /* purge */
+	NULL, /* sleep */
+	dc_custom_iostream_close, /* close */
+	NULL /* set_stats */
+};
+
+dc_status_t
+dc_custom_iostream_open (dc_iostream_t **out, dc_context_t *context, const char *name)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_custom_iostream_t *iostream = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_custom_io_t *io = _dc_context_custom_io (context);
+	if (io == NULL || io->packet_open == NULL ||
+		io->packet_read == NULL || io->packet_write == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	iostream = (dc_custom_iostream_t *) dc_iostream_allocate (context, &dc_custom_iostream_vtable);
+	if (iostream == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	iostream->base.packetsize = io->packet_size > 0 ? io->packet_size : 0;
+	iostream->io = *io;
+
+	status = iostream->io.packet_open (&iostream->io, context, name);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = (dc_iostream_t *) iostream;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) iostream);
+	return status;
+}
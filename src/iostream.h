@@ -0,0 +1,193 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef DC_IOSTREAM_H
+#define DC_IOSTREAM_H
+
+#include <stddef.h>
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/device.h>
+
+#include "serial.h"
+#include "irda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Opaque object representing a single connection to a device, for
+ * any of the supported transports.
+ *
+ * Every object has its own state, so multiple connections can be
+ * open at the same time, even with the same transport.
+ */
+typedef struct dc_iostream_t dc_iostream_t;
+
+/**
+ * A memory buffer for a vectored write.
+ */
+typedef struct dc_iovec_t {
+	const void *data;
+	size_t size;
+} dc_iovec_t;
+
+/**
+ * Open a serial connection.
+ *
+ * @param[out]  iostream  A location to store the connection.
+ * @param[in]   context   A valid context object.
+ * @param[in]   name      The name of the device node.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_serial_iostream_open (dc_iostream_t **iostream, dc_context_t *context, const char *name);
+
+/**
+ * Wrap a connected IrDA socket.
+ *
+ * On success, the connection takes ownership of the socket, and closes
+ * it when the connection is closed.
+ *
+ * @param[out]  iostream  A location to store the connection.
+ * @param[in]   context   A valid context object.
+ * @param[in]   irda      A valid and connected IrDA socket.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_irda_iostream_open (dc_iostream_t **iostream, dc_context_t *context, dc_irda_t *irda);
+
+/**
+ * Open a USB HID connection.
+ *
+ * @param[out]  iostream  A location to store the connection.
+ * @param[in]   context   A valid context object.
+ * @param[in]   vid       The USB Vendor ID of the device.
+ * @param[in]   pid       The USB Product ID of the device.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_usbhid_iostream_open (dc_iostream_t **iostream, dc_context_t *context, unsigned int vid, unsigned int pid);
+
+/**
+ * Open a connection with the packet functions of the custom I/O
+ * handler that is installed in the context.
+ *
+ * @param[out]  iostream  A location to store the connection.
+ * @param[in]   context   A valid context object.
+ * @param[in]   name      The name of the device.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_custom_iostream_open (dc_iostream_t **iostream, dc_context_t *context, const char *name);
+
+/**
+ * Get the transport type of the connection.
+ */
+dc_transport_t
+dc_iostream_get_transport (dc_iostream_t *iostream);
+
+/**
+ * Get the size of a packet.
+ *
+ * For packet based transports (USB HID, BLE), every read returns a
+ * single packet, and every write sends a single packet. For byte
+ * stream transports (serial, IrDA), the packet size is zero.
+ */
+unsigned int
+dc_iostream_get_packetsize (dc_iostream_t *iostream);
+
+/**
+ * Set the read timeout (in milliseconds).
+ *
+ * See dc_serial_set_timeout() for the meaning of the different values.
+ */
+dc_status_t
+dc_iostream_set_timeout (dc_iostream_t *iostream, int timeout);
+
+/**
+ * Configure the line settings of the connection.
+ */
+dc_status_t
+dc_iostream_configure (dc_iostream_t *iostream, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+
+/**
+ * Query the number of bytes available in the input buffer.
+ */
+dc_status_t
+dc_iostream_get_available (dc_iostream_t *iostream, size_t *value);
+
+/**
+ * Read data from the connection.
+ */
+dc_status_t
+dc_iostream_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actual);
+
+/**
+ * Write data to the connection.
+ */
+dc_status_t
+dc_iostream_write (dc_iostream_t *iostream, const void *data, size_t size, size_t *actual);
+
+/**
+ * Write the data from several memory buffers to the connection.
+ *
+ * The buffers are sent with a single write, and thus for packet based
+ * transports as a single packet.
+ */
+dc_status_t
+dc_iostream_writev (dc_iostream_t *iostream, const dc_iovec_t iov[], unsigned int count, size_t *actual);
+
+/**
+ * Discard all pending data in the input and/or output buffers.
+ */
+dc_status_t
+dc_iostream_purge (dc_iostream_t *iostream, dc_direction_t direction);
+
+/**
+ * Suspend execution for the specified amount of time (in milliseconds).
+ */
+dc_status_t
+dc_iostream_sleep (dc_iostream_t *iostream, unsigned int milliseconds);
+
+/**
+ * Close the connection and free all resources.
+ */
+dc_status_t
+dc_iostream_close (dc_iostream_t *iostream);
+
+/**
+ * Attach the transport statistics of a device to the connection.
+ */
+void
+dc_iostream_set_stats (dc_iostream_t *iostream, dc_device_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_IOSTREAM_H */
@@ -78,6 +78,7 @@ typedef int s_errcode_t;
 
 struct dc_irda_t {
 	dc_context_t *context;
+	dc_device_stats_t *stats;
 #ifdef _WIN32
 	SOCKET fd;
 #else
@@ -121,6 +122,7 @@ dc_irda_open (dc_irda_t **out, dc_context_t *context)
 
 	// Library context.
 	device->context = context;
+	device->stats = NULL;
 
 	// Default to blocking reads.
 	device->timeout = -1;
@@ -202,6 +204,15 @@ dc_irda_close (dc_irda_t *device)
 	return status;
 }
 
+void
+dc_irda_set_stats (dc_irda_t *device, dc_device_stats_t *stats)
+{
+	if (device == NULL)
+		return;
+
+	device->stats = stats;
+}
+
 dc_status_t
 dc_irda_set_timeout (dc_irda_t *device, int timeout)
 {
@@ -411,6 +422,8 @@ dc_irda_read (dc_irda_t *device, void *data, size_t size, size_t *actual)
 		goto out_invalidargs;
 	}
 
+	unsigned long long begin = dc_clock_now ();
+
 	while (nbytes < size) {
 		fd_set fds;
 		FD_ZERO (&fds);
@@ -457,6 +470,8 @@ dc_irda_read (dc_irda_t *device, void *data, size_t size, size_t *actual)
 
 out:
 	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
+	TRACE (device->context, DC_TRANSPORT_IRDA, DC_DIRECTION_INPUT, (unsigned char *) data, nbytes);
+	dc_stats_read (device->stats, nbytes, status, begin);
 
 out_invalidargs:
 	if (actual)
@@ -514,6 +529,8 @@ dc_irda_write (dc_irda_t *device, const void *data, size_t size, size_t *actual)
 
 out:
 	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Write", (unsigned char *) data, nbytes);
+	TRACE (device->context, DC_TRANSPORT_IRDA, DC_DIRECTION_OUTPUT, (unsigned char *) data, nbytes);
+	dc_stats_write (device->stats, nbytes, status);
 
 out_invalidargs:
 	if (actual)
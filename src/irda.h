@@ -24,6 +24,7 @@
 
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/context.h>
+#include <libdivecomputer/device.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +67,15 @@ dc_irda_open (dc_irda_t **irda, dc_context_t *context);
 dc_status_t
 dc_irda_close (dc_irda_t *irda);
 
+/**
+ * Attach the transport statistics of a device to the connection.
+ *
+ * @param[in]  irda   A valid IrDA connection.
+ * @param[in]  stats  The statistics to update, or NULL to stop counting.
+ */
+void
+dc_irda_set_stats (dc_irda_t *irda, dc_device_stats_t *stats);
+
 /**
  * Set the read timeout.
  *
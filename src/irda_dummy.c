@@ -35,6 +35,11 @@ dc_irda_close (dc_irda_t *device)
 	return DC_STATUS_UNSUPPORTED;
 }
 
+void
+dc_irda_set_stats (dc_irda_t *device, dc_device_stats_t *stats)
+{
+}
+
 dc_status_t
 dc_irda_set_timeout (dc_irda_t *device, int timeout)
 {
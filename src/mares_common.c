@@ -25,7 +25,7 @@
 
 #include "context-private.h"
 #include "mares_common.h"
-#include "checksum.h"
+#include "rbstream.h"
 #include "array.h"
 
 #define MAXRETRIES 4
@@ -66,11 +66,9 @@ mares_common_make_ascii (const unsigned char raw[], unsigned int rsize, unsigned
 	// Header
 	ascii[0] = '<';
 
-	// Data
-	array_convert_bin2hex (raw, rsize, ascii + 1, 2 * rsize);
-
-	// Checksum
-	unsigned char checksum = checksum_add_uint8 (ascii + 1, 2 * rsize, 0x00);
+	// Data and checksum
+	unsigned char checksum = 0x00;
+	array_convert_bin2hex_add (raw, rsize, ascii + 1, 2 * rsize, &checksum);
 	array_convert_bin2hex (&checksum, 1, ascii + 1 + 2 * rsize, 2);
 
 	// Trailer
@@ -79,7 +77,7 @@ mares_common_make_ascii (const unsigned char raw[], unsigned int rsize, unsigned
 
 
 static dc_status_t
-mares_common_packet (mares_common_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
+mares_common_packet (mares_common_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize, unsigned char data[], unsigned int size)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
@@ -126,10 +124,16 @@ mares_common_packet (mares_common_device_t *device, const unsigned char command[
 		return DC_STATUS_PROTOCOL;
 	}
 
-	// Verify the checksum of the packet.
+	// Convert the data, and calculate the checksum in the same pass.
 	unsigned char crc = 0;
-	unsigned char ccrc = checksum_add_uint8 (answer + 1, asize - 4, 0x00);
-	array_convert_hex2bin (answer + asize - 3, 2, &crc, 1);
+	unsigned char ccrc = 0x00;
+	if (array_convert_hex2bin_add (answer + 1, asize - 4, data, size, &ccrc) != 0 ||
+		array_convert_hex2bin (answer + asize - 3, 2, &crc, 1) != 0) {
+		ERROR (abstract->context, "Unexpected answer data.");
+		return DC_STATUS_PROTOCOL;
+	}
+
+	// Verify the checksum of the packet.
 	if (crc != ccrc) {
 		ERROR (abstract->context, "Unexpected answer checksum.");
 		return DC_STATUS_PROTOCOL;
@@ -140,11 +144,11 @@ mares_common_packet (mares_common_device_t *device, const unsigned char command[
 
 
 static dc_status_t
-mares_common_transfer (mares_common_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
+mares_common_transfer (mares_common_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize, unsigned char data[], unsigned int size)
 {
 	unsigned int nretries = 0;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	while ((rc = mares_common_packet (device, command, csize, answer, asize)) != DC_STATUS_SUCCESS) {
+	while ((rc = mares_common_packet (device, command, csize, answer, asize, data, size)) != DC_STATUS_SUCCESS) {
 		// Automatically discard a corrupted packet,
 		// and request a new one.
 		if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
@@ -185,15 +189,12 @@ mares_common_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		unsigned char command[2 * (sizeof (raw) + 2)] = {0};
 		mares_common_make_ascii (raw, sizeof (raw), command, sizeof (command));
 
-		// Send the command and receive the answer.
+		// Send the command, receive the answer and extract the raw data.
 		unsigned char answer[2 * (PACKETSIZE + 2)] = {0};
-		dc_status_t rc = mares_common_transfer (device, command, sizeof (command), answer, 2 * (len + 2));
+		dc_status_t rc = mares_common_transfer (device, command, sizeof (command), answer, 2 * (len + 2), data, len);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
 
-		// Extract the raw data from the packet.
-		array_convert_hex2bin (answer + 1, 2 * len, data, len);
-
 		nbytes += len;
 		address += len;
 		data += len;
@@ -360,3 +361,213 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+static dc_status_t
+mares_common_rbstream_fill (dc_rbstream_t *rbstream, dc_event_progress_t *progress, unsigned char buffer[], unsigned int *available, unsigned int offset)
+{
+	// Read all bytes between the requested offset and the bytes that
+	// are already available. The ringbuffer stream is read backwards,
+	// so the available data always extends up to the end of the buffer.
+	if (offset < *available) {
+		dc_status_t rc = dc_rbstream_read (rbstream, progress, buffer + offset, *available - offset);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		*available = offset;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+mares_common_device_profile (dc_device_t *abstract, const mares_common_layout_t *layout, const unsigned char header[], const unsigned char fingerprint[], dc_event_progress_t *progress, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_rbstream_t *rbstream = NULL;
+	unsigned char *buffer = NULL;
+	unsigned char *freedives = NULL;
+
+	assert (layout != NULL);
+	assert (progress != NULL);
+
+	// Get the freedive mode for this model.
+	unsigned int model = header[1];
+	unsigned int freedive = FREEDIVE;
+	if (model == NEMOWIDE || model == NEMOAIR || model == PUCK || model == PUCKAIR)
+		freedive = GAUGE;
+
+	// Get the end of the profile ring buffer.
+	unsigned int eop = array_uint16_le (header + 0x6B);
+	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
+		ERROR (abstract->context, "Ringbuffer pointer out of range (0x%04x).", eop);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Create the ringbuffer stream.
+	status = dc_rbstream_new (&rbstream, abstract, 1, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, eop);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+		return status;
+	}
+
+	// The profile data is read backwards, and only as far as needed. The
+	// data is stored at the same position as in the linear ringbuffer of
+	// mares_common_extract_dives, including the extra space for the
+	// profile data of the freedives.
+	buffer = (unsigned char *) malloc (
+		layout->rb_profile_end - layout->rb_profile_begin +
+		layout->rb_freedives_end - layout->rb_freedives_begin);
+	if (buffer == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	unsigned int nfreedives = 0;
+
+	unsigned int offset = layout->rb_profile_end - layout->rb_profile_begin;
+	unsigned int available = offset;
+	while (offset >= 3) {
+		// Check for the presence of extra header bytes.
+		status = mares_common_rbstream_fill (rbstream, progress, buffer, &available, offset - 3);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_read;
+
+		unsigned int extra = 0;
+		const unsigned char marker[3] = {0xAA, 0xBB, 0xCC};
+		if (memcmp (buffer + offset - 3, marker, sizeof (marker)) == 0) {
+			if (model == PUCKAIR)
+				extra = 7;
+			else
+				extra = 12;
+		}
+
+		// Check for overflows due to incomplete dives.
+		if (offset < extra + 3)
+			break;
+
+		status = mares_common_rbstream_fill (rbstream, progress, buffer, &available, offset - extra - 3);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_read;
+
+		// Check the dive mode of the logbook entry.
+		unsigned int mode = buffer[offset - extra - 1];
+		if (mode == 0xFF)
+			break;
+
+		unsigned int header_size = 53;
+		unsigned int sample_size = 2;
+		if (extra) {
+			if (model == PUCKAIR)
+				sample_size = 3;
+			else
+				sample_size = 5;
+		}
+		if (mode == freedive) {
+			header_size = 28;
+			sample_size = 6;
+			nfreedives++;
+		}
+
+		// Get the number of samples in the profile data.
+		unsigned int nsamples = array_uint16_le (buffer + offset - extra - 3);
+
+		// Calculate the total number of bytes for this dive.
+		unsigned int nbytes = 2 + nsamples * sample_size + header_size + extra;
+		if (offset < nbytes)
+			break;
+
+		// Check the fingerprint, before downloading the rest of the dive.
+		unsigned int fp_offset = offset - extra - FP_OFFSET;
+		status = mares_common_rbstream_fill (rbstream, progress, buffer, &available, fp_offset);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_read;
+
+		if (fingerprint && memcmp (buffer + fp_offset, fingerprint, FP_SIZE) == 0)
+			break;
+
+		// Move to the start of the dive.
+		offset -= nbytes;
+
+		status = mares_common_rbstream_fill (rbstream, progress, buffer, &available, offset);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_read;
+
+		// Verify that the length that is stored in the profile data
+		// equals the calculated length.
+		unsigned int length = array_uint16_le (buffer + offset);
+		if (length != nbytes) {
+			ERROR (abstract->context, "Calculated and stored size are not equal (%u %u).", length, nbytes);
+			status = DC_STATUS_DATAFORMAT;
+			goto error_free;
+		}
+
+		// Process the profile data for the most recent freedive entry.
+		if (mode == freedive && nfreedives == 1) {
+			unsigned int size = layout->rb_freedives_end - layout->rb_freedives_begin;
+
+			// Read the freedive profile data.
+			if (size) {
+				freedives = (unsigned char *) malloc (size);
+				if (freedives == NULL) {
+					ERROR (abstract->context, "Failed to allocate memory.");
+					status = DC_STATUS_NOMEMORY;
+					goto error_free;
+				}
+
+				status = dc_device_read (abstract, layout->rb_freedives_begin, freedives, size);
+				if (status != DC_STATUS_SUCCESS) {
+					ERROR (abstract->context, "Failed to read the freedive data.");
+					goto error_free;
+				}
+
+				// Update and emit a progress event.
+				progress->current += size;
+				device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
+			}
+
+			// Count the number of freedives in the profile data.
+			unsigned int count = 0;
+			unsigned int idx = 0;
+			while (idx + 2 <= size && count != nsamples) {
+				// Each freedive in the session ends with a zero sample.
+				unsigned int sample = array_uint16_le (freedives + idx);
+				if (sample == 0)
+					count++;
+
+				// Move to the next sample.
+				idx += 2;
+			}
+
+			// Verify that the number of freedive entries in the session
+			// equals the number of freedives in the profile data.
+			if (count != nsamples) {
+				ERROR (abstract->context, "Unexpected number of freedive sessions (%u %u).", count, nsamples);
+				status = DC_STATUS_DATAFORMAT;
+				goto error_free;
+			}
+
+			// Append the profile data to the main logbook entry.
+			memcpy (buffer + offset + nbytes, freedives, idx);
+			nbytes += idx;
+		}
+
+		if (callback && !callback (buffer + offset, nbytes, buffer + fp_offset, FP_SIZE, userdata))
+			break;
+	}
+
+	free (freedives);
+	free (buffer);
+	dc_rbstream_free (rbstream);
+	return DC_STATUS_SUCCESS;
+
+error_read:
+	ERROR (abstract->context, "Failed to read the dive.");
+error_free:
+	free (freedives);
+	free (buffer);
+	dc_rbstream_free (rbstream);
+	return status;
+}
@@ -29,6 +29,7 @@
 #include "mares_common.h"
 #include "context-private.h"
 #include "device-private.h"
+#include "rbstream.h"
 #include "array.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &mares_darwin_device_vtable)
@@ -36,6 +37,8 @@
 #define DARWIN    0
 #define DARWINAIR 1
 
+#define FP_SIZE 6
+
 typedef struct mares_darwin_layout_t {
 	// Memory size.
 	unsigned int memsize;
@@ -93,9 +96,6 @@ static const mares_darwin_layout_t mares_darwinair_layout = {
 	3       /* samplesize */
 };
 
-static dc_status_t
-mares_darwin_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 mares_darwin_device_open (dc_device_t **out, dc_context_t *context, const char *name, unsigned int model)
 {
@@ -130,6 +130,9 @@ mares_darwin_device_open (dc_device_t **out, dc_context_t *context, const char *
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->base.port, &device->base.base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->base.port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -233,67 +236,155 @@ mares_darwin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 mares_darwin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	dc_status_t status = DC_STATUS_SUCCESS;
 	mares_darwin_device_t *device = (mares_darwin_device_t *) abstract;
-
-	assert (device->layout != NULL);
-
-	dc_buffer_t *buffer = dc_buffer_new (device->layout->memsize);
-	if (buffer == NULL)
-		return DC_STATUS_NOMEMORY;
-
-	dc_status_t rc = mares_darwin_device_dump (abstract, buffer);
-	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
-		return rc;
+	const mares_darwin_layout_t *layout = device->layout;
+	dc_rbstream_t *rbstream = NULL;
+	unsigned char *buffer = NULL;
+
+	assert (layout != NULL);
+
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = layout->rb_logbook_offset +
+		layout->rb_logbook_count * layout->rb_logbook_size +
+		(layout->rb_profile_end - layout->rb_profile_begin);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Read the header data.
+	unsigned char header[0x100] = {0};
+	assert (layout->rb_logbook_offset <= sizeof (header));
+	status = mares_common_device_read (abstract, 0, header, layout->rb_logbook_offset);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header data.");
+		return status;
 	}
 
+	// Update and emit a progress event.
+	progress.current += layout->rb_logbook_offset;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
 	// Emit a device info event.
-	unsigned char *data = dc_buffer_get_data (buffer);
 	dc_event_devinfo_t devinfo;
 	devinfo.model = device->model;
 	devinfo.firmware = 0;
-	devinfo.serial = array_uint16_be (data + 8);
+	devinfo.serial = array_uint16_be (header + 8);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = mares_darwin_extract_dives (abstract, dc_buffer_get_data (buffer),
-		dc_buffer_get_size (buffer), callback, userdata);
+	// Get the profile pointer.
+	unsigned int eop = array_uint16_be (header + 0x8A);
+	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
+		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x).", eop);
+		return DC_STATUS_DATAFORMAT;
+	}
 
-	dc_buffer_free (buffer);
+	// Get the logbook index.
+	unsigned int last = header[0x8C];
+	if (last >= layout->rb_logbook_count) {
+		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%02x).", last);
+		return DC_STATUS_DATAFORMAT;
+	}
 
-	return rc;
-}
+	// Create the ringbuffer stream.
+	status = dc_rbstream_new (&rbstream, abstract, 1, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, eop);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+		return status;
+	}
 
+	// Allocate memory for the largest possible dive.
+	buffer = (unsigned char *) malloc (layout->rb_logbook_size + layout->rb_profile_end - layout->rb_profile_begin);
+	if (buffer == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
 
-static dc_status_t
-mares_darwin_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
-{
-	mares_darwin_device_t *device = (mares_darwin_device_t *) abstract;
+	// Only the logbook entries of the new dives, and the entry with the
+	// fingerprint, are downloaded. The profile data is read backwards
+	// from the end of profile pointer, and only for the new dives.
+	unsigned int remaining = layout->rb_profile_end - layout->rb_profile_begin;
+	for (unsigned int i = 0; i < layout->rb_logbook_count; ++i) {
+		// Get the offset to the current logbook entry in the ringbuffer.
+		unsigned int idx = (layout->rb_logbook_count + last - i) % layout->rb_logbook_count;
+		unsigned int offset = layout->rb_logbook_offset + idx * layout->rb_logbook_size;
 
-	if (!ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
+		// Read the logbook entry.
+		status = mares_common_device_read (abstract, offset, buffer, layout->rb_logbook_size);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the logbook entry.");
+			goto error_free;
+		}
 
-	assert (device->layout != NULL);
+		// Update and emit a progress event.
+		progress.current += layout->rb_logbook_size;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	const mares_darwin_layout_t *layout = device->layout;
+		// Get the length of the current dive.
+		unsigned int nsamples = array_uint16_be (buffer + 6);
+		unsigned int length = nsamples * layout->samplesize;
+		if (nsamples == 0xFFFF || length > remaining)
+			break;
+
+		if (memcmp (buffer, device->fingerprint, FP_SIZE) == 0)
+			break;
+
+		// Read the profile data.
+		status = dc_rbstream_read (rbstream, &progress, buffer + layout->rb_logbook_size, length);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the dive.");
+			goto error_free;
+		}
+
+		if (callback && !callback (buffer, layout->rb_logbook_size + length, buffer, FP_SIZE, userdata))
+			break;
+
+		remaining -= length;
+	}
+
+	// Nothing else left to download.
+	progress.maximum = progress.current;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+error_free:
+	free (buffer);
+	dc_rbstream_free (rbstream);
+	return status;
+}
+
+
+dc_status_t
+mares_darwin_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	const mares_darwin_layout_t *layout = NULL;
+	if (model == DARWINAIR)
+		layout = &mares_darwinair_layout;
+	else
+		layout = &mares_darwin_layout;
+
+	if (size < layout->memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
 
 	// Get the profile pointer.
 	unsigned int eop = array_uint16_be (data + 0x8A);
 	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
-		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x).", eop);
+		ERROR (context, "Invalid ringbuffer pointer detected (0x%04x).", eop);
 		return DC_STATUS_DATAFORMAT;
 	}
 
 	// Get the logbook index.
 	unsigned int last = data[0x8C];
 	if (last >= layout->rb_logbook_count) {
-		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%02x).", last);
+		ERROR (context, "Invalid ringbuffer pointer detected (0x%02x).", last);
 		return DC_STATUS_DATAFORMAT;
 	}
 
 	// Allocate memory for the largest possible dive.
 	unsigned char *buffer = (unsigned char *) malloc (layout->rb_logbook_size + layout->rb_profile_end - layout->rb_profile_begin);
 	if (buffer == NULL) {
-		ERROR (abstract->context, "Failed to allocate memory.");
+		ERROR (context, "Failed to allocate memory.");
 		return DC_STATUS_NOMEMORY;
 	}
 
@@ -330,12 +421,12 @@ mares_darwin_extract_dives (dc_device_t *abstract, const unsigned char data[], u
 			current -= length;
 		}
 
-		if (device && memcmp (buffer, device->fingerprint, sizeof (device->fingerprint)) == 0) {
+		if (fingerprint && memcmp (buffer, fingerprint, FP_SIZE) == 0) {
 			free (buffer);
 			return DC_STATUS_SUCCESS;
 		}
 
-		if (callback && !callback (buffer, layout->rb_logbook_size + length, buffer, 6, userdata)) {
+		if (callback && !callback (buffer, layout->rb_logbook_size + length, buffer, FP_SIZE, userdata)) {
 			free (buffer);
 			return DC_STATUS_SUCCESS;
 		}
@@ -210,8 +210,37 @@ mares_iconhd_transfer (mares_iconhd_device_t *device,
 }
 
 
-dc_status_t
-mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, const char *name)
+static void
+mares_iconhd_set_layout (mares_iconhd_device_t *device)
+{
+	switch (device->model) {
+	case MATRIX:
+		device->layout = &mares_matrix_layout;
+		device->packetsize = 256;
+		break;
+	case PUCKPRO:
+	case PUCK2:
+	case NEMOWIDE2:
+	case SMART:
+	case SMARTAPNEA:
+	case QUAD:
+		device->layout = &mares_nemowide2_layout;
+		device->packetsize = 256;
+		break;
+	case ICONHDNET:
+		device->layout = &mares_iconhdnet_layout;
+		device->packetsize = 4096;
+		break;
+	case ICONHD:
+	default:
+		device->layout = &mares_iconhd_layout;
+		device->packetsize = 4096;
+		break;
+	}
+}
+
+static dc_status_t
+mares_iconhd_device_setup (dc_device_t **out, dc_context_t *context, const char *name, unsigned int timeout)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	mares_iconhd_device_t *device = NULL;
@@ -241,6 +270,9 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, const char *
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8E1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_EVEN, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -248,8 +280,8 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, const char *
 		goto error_close;
 	}
 
-	// Set the timeout for receiving data (1000 ms).
-	status = dc_serial_set_timeout (device->port, 1000);
+	// Set the timeout for receiving data.
+	status = dc_serial_set_timeout (device->port, timeout);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
 		goto error_close;
@@ -284,30 +316,7 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, const char *
 	device->model = mares_iconhd_get_model (device);
 
 	// Load the correct memory layout.
-	switch (device->model) {
-	case MATRIX:
-		device->layout = &mares_matrix_layout;
-		device->packetsize = 256;
-		break;
-	case PUCKPRO:
-	case PUCK2:
-	case NEMOWIDE2:
-	case SMART:
-	case SMARTAPNEA:
-	case QUAD:
-		device->layout = &mares_nemowide2_layout;
-		device->packetsize = 256;
-		break;
-	case ICONHDNET:
-		device->layout = &mares_iconhdnet_layout;
-		device->packetsize = 4096;
-		break;
-	case ICONHD:
-	default:
-		device->layout = &mares_iconhd_layout;
-		device->packetsize = 4096;
-		break;
-	}
+	mares_iconhd_set_layout (device);
 
 	*out = (dc_device_t *) device;
 
@@ -321,6 +330,36 @@ error_free:
 }
 
 
+dc_status_t
+mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, const char *name)
+{
+	return mares_iconhd_device_setup (out, context, name, 1000);
+}
+
+
+dc_status_t
+mares_iconhd_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = NULL;
+
+	if (model == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Opening the device already reads the version packet.
+	status = mares_iconhd_device_setup (&abstract, context, name, timeout);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	mares_iconhd_device_t *device = (mares_iconhd_device_t *) abstract;
+	*model = device->model;
+
+	dc_device_close (abstract);
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 mares_iconhd_device_close (dc_device_t *abstract)
 {
@@ -438,7 +477,7 @@ mares_iconhd_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 
 	// Read the serial number.
 	unsigned char serial[4] = {0};
-	rc = mares_iconhd_device_read (abstract, 0x0C, serial, sizeof (serial));
+	rc = dc_device_read (abstract, 0x0C, serial, sizeof (serial));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the memory.");
 		return rc;
@@ -473,7 +512,7 @@ mares_iconhd_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 	for (unsigned int i = 0; i < sizeof (config) / sizeof (*config); ++i) {
 		// Read the pointer.
 		unsigned char pointer[4] = {0};
-		rc = mares_iconhd_device_read (abstract, config[i], pointer, sizeof (pointer));
+		rc = dc_device_read (abstract, config[i], pointer, sizeof (pointer));
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to read the memory.");
 			return rc;
@@ -622,3 +661,45 @@ mares_iconhd_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 
 	return rc;
 }
+
+
+dc_status_t
+mares_iconhd_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	mares_iconhd_device_t *device = NULL;
+
+	// Allocate memory.
+	device = (mares_iconhd_device_t *) dc_device_allocate (context, &mares_iconhd_device_vtable);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	device->port = NULL;
+	memset (device->version, 0, sizeof (device->version));
+	device->model = model;
+	if (fingerprint)
+		memcpy (device->fingerprint, fingerprint, sizeof (device->fingerprint));
+	else
+		memset (device->fingerprint, 0, sizeof (device->fingerprint));
+
+	// Load the correct memory layout.
+	mares_iconhd_set_layout (device);
+
+	if (size < device->layout->memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		dc_device_deallocate ((dc_device_t *) device);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Walk the memory dump instead of the device memory.
+	device_dump_attach ((dc_device_t *) device, data, size);
+
+	status = mares_iconhd_device_foreach ((dc_device_t *) device, callback, userdata);
+
+	dc_device_deallocate ((dc_device_t *) device);
+
+	return status;
+}
@@ -33,6 +33,12 @@ extern "C" {
 dc_status_t
 mares_iconhd_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+mares_iconhd_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model);
+
+dc_status_t
+mares_iconhd_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 dc_status_t
 mares_iconhd_parser_create (dc_parser_t **parser, dc_context_t *context, unsigned int model);
 
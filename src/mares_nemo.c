@@ -109,6 +109,9 @@ mares_nemo_device_open (dc_device_t **out, dc_context_t *context, const char *na
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -302,6 +305,23 @@ mares_nemo_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 	devinfo.serial = array_uint16_be (data + 8);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
+	rc = mares_nemo_extract_dives (abstract->context, device->fingerprint,
+		data, dc_buffer_get_size (buffer), callback, userdata);
+
+	dc_buffer_free (buffer);
+
+	return rc;
+}
+
+
+dc_status_t
+mares_nemo_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	if (size < MEMORYSIZE) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
 	const mares_common_layout_t *layout = NULL;
 	switch (data[1]) {
 	case NEMO:
@@ -312,14 +332,10 @@ mares_nemo_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 		layout = &mares_nemo_apneist_layout;
 		break;
 	default: // Unknown, try nemo
-		WARNING (abstract->context, "Unsupported model %02x detected!", data[1]);
+		WARNING (context, "Unsupported model %02x detected!", data[1]);
 		layout = &mares_nemo_layout;
 		break;
 	}
 
-	rc = mares_common_extract_dives (abstract->context, layout, device->fingerprint, data, callback, userdata);
-
-	dc_buffer_free (buffer);
-
-	return rc;
+	return mares_common_extract_dives (context, layout, fingerprint, data, callback, userdata);
 }
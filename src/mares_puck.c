@@ -85,6 +85,23 @@ static const mares_common_layout_t mares_nemowide_layout = {
 };
 
 
+static const mares_common_layout_t *
+mares_puck_get_layout (unsigned int model)
+{
+	switch (model) {
+	case NEMOWIDE:
+		return &mares_nemowide_layout;
+	case NEMOAIR:
+	case PUCKAIR:
+		return &mares_nemoair_layout;
+	case PUCK:
+		return &mares_puck_layout;
+	default: // Unknown, try puck
+		return &mares_puck_layout;
+	}
+}
+
+
 dc_status_t
 mares_puck_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -115,6 +132,9 @@ mares_puck_device_open (dc_device_t **out, dc_context_t *context, const char *na
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->base.port, &device->base.base.stats);
+
 	// Set the serial communication protocol (38400 8N1).
 	status = dc_serial_configure (device->base.port, 38400, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -154,21 +174,7 @@ mares_puck_device_open (dc_device_t **out, dc_context_t *context, const char *na
 	}
 
 	// Override the base class values.
-	switch (header[1]) {
-	case NEMOWIDE:
-		device->layout = &mares_nemowide_layout;
-		break;
-	case NEMOAIR:
-	case PUCKAIR:
-		device->layout = &mares_nemoair_layout;
-		break;
-	case PUCK:
-		device->layout = &mares_puck_layout;
-		break;
-	default: // Unknown, try puck
-		device->layout = &mares_puck_layout;
-		break;
-	}
+	device->layout = mares_puck_get_layout (header[1]);
 
 	*out = (dc_device_t*) device;
 
@@ -239,30 +245,62 @@ static dc_status_t
 mares_puck_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
 	mares_puck_device_t *device = (mares_puck_device_t *) abstract;
+	const mares_common_layout_t *layout = device->layout;
 
-	assert (device->layout != NULL);
+	assert (layout != NULL);
 
-	dc_buffer_t *buffer = dc_buffer_new (device->layout->memsize);
-	if (buffer == NULL)
-		return DC_STATUS_NOMEMORY;
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = layout->rb_profile_begin +
+		(layout->rb_profile_end - layout->rb_profile_begin) +
+		(layout->rb_freedives_end - layout->rb_freedives_begin);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	dc_status_t rc = mares_puck_device_dump (abstract, buffer);
+	// Read the header data.
+	unsigned char header[0x70] = {0};
+	assert (layout->rb_profile_begin <= sizeof (header));
+	dc_status_t rc = mares_common_device_read (abstract, 0, header, layout->rb_profile_begin);
 	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
+		ERROR (abstract->context, "Failed to read the header data.");
 		return rc;
 	}
 
+	// Update and emit a progress event.
+	progress.current += layout->rb_profile_begin;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
 	// Emit a device info event.
-	unsigned char *data = dc_buffer_get_data (buffer);
 	dc_event_devinfo_t devinfo;
-	devinfo.model = data[1];
+	devinfo.model = header[1];
 	devinfo.firmware = 0;
-	devinfo.serial = array_uint16_be (data + 8);
+	devinfo.serial = array_uint16_be (header + 8);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = mares_common_extract_dives (abstract->context, device->layout, device->fingerprint, data, callback, userdata);
+	rc = mares_common_device_profile (abstract, layout, header, device->fingerprint, &progress, callback, userdata);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Nothing else left to download.
+	progress.maximum = progress.current;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	dc_buffer_free (buffer);
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+mares_puck_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	if (size < 2) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	const mares_common_layout_t *layout = mares_puck_get_layout (data[1]);
+	if (size < layout->memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
 
-	return rc;
+	return mares_common_extract_dives (context, layout, fingerprint, data, callback, userdata);
 }
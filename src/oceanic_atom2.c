@@ -604,6 +604,9 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, const char
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Get the correct baudrate.
 	unsigned int baudrate = 38400;
 	if (model == VTX || model == I750TC) {
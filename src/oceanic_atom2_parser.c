@@ -112,8 +112,7 @@ struct oceanic_atom2_parser_t {
 	unsigned int ngasmixes;
 	unsigned int oxygen[NGASMIXES];
 	unsigned int helium[NGASMIXES];
-	unsigned int divetime;
-	double maxdepth;
+	sample_statistics_t statistics;
 };
 
 static dc_status_t oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
@@ -128,6 +127,7 @@ static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	oceanic_atom2_parser_get_datetime, /* datetime */
 	oceanic_atom2_parser_get_field, /* fields */
 	oceanic_atom2_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_range */
 	NULL /* destroy */
 };
 
@@ -187,8 +187,7 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
+	sample_statistics_init (&parser->statistics, NULL, NULL);
 
 	*out = (dc_parser_t*) parser;
 
@@ -211,8 +210,7 @@ oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
+	sample_statistics_init (&parser->statistics, NULL, NULL);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -489,15 +487,9 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 
 	// Cache the profile data.
 	if (parser->cached < PROFILE) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		status = oceanic_atom2_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+		status = oceanic_atom2_parser_samples_foreach (abstract, NULL, NULL);
 		if (status != DC_STATUS_SUCCESS)
 			return status;
-
-		parser->cached = PROFILE;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
@@ -514,7 +506,7 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
 				*((unsigned int *) value) = bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
 			else
-				*((unsigned int *) value) = parser->divetime;
+				*((unsigned int *) value) = parser->statistics.divetime;
 			break;
 		case DC_FIELD_MAXDEPTH:
 			if (parser->model == F10A || parser->model == F10B ||
@@ -524,6 +516,12 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 			else
 				*((double *) value) = (array_uint16_le (data + parser->footer + 4) & 0x0FFF) / 16.0 * FEET;
 			break;
+		case DC_FIELD_AVGDEPTH:
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+		case DC_FIELD_TANK_COUNT:
+		case DC_FIELD_TANK:
+			return sample_statistics_get_field (&parser->statistics, type, flags, value);
 		case DC_FIELD_GASMIX_COUNT:
 			*((unsigned int *) value) = parser->ngasmixes;
 			break;
@@ -629,6 +627,14 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
+	// Collect the profile statistics during the first pass.
+	sample_statistics_t statistics;
+	if (parser->cached < PROFILE) {
+		sample_statistics_init (&statistics, callback, userdata);
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int extratime = 0;
 	unsigned int time = 0;
 	unsigned int interval = 1;
@@ -1009,5 +1015,11 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		offset += length;
 	}
 
+	// Cache the profile data.
+	if (parser->cached < PROFILE) {
+		parser->statistics = statistics;
+		parser->cached = PROFILE;
+	}
+
 	return DC_STATUS_SUCCESS;
 }
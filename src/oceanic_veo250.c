@@ -257,6 +257,9 @@ oceanic_veo250_device_open (dc_device_t **out, dc_context_t *context, const char
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -462,3 +465,45 @@ oceanic_veo250_device_read (dc_device_t *abstract, unsigned int address, unsigne
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+dc_status_t
+oceanic_veo250_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	oceanic_veo250_device_t *device = NULL;
+
+	if (size < oceanic_veo250_layout.memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Allocate memory.
+	device = (oceanic_veo250_device_t *) dc_device_allocate (context, &oceanic_veo250_device_vtable.base);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Initialize the base class.
+	oceanic_common_device_init (&device->base);
+
+	// Override the base class values.
+	device->base.multipage = MULTIPAGE;
+	device->base.layout = &oceanic_veo250_layout;
+	if (fingerprint)
+		memcpy (device->base.fingerprint, fingerprint, oceanic_veo250_layout.rb_logbook_entry_size);
+
+	// Set the default values.
+	device->port = NULL;
+	device->last = 0;
+
+	// Walk the memory dump instead of the device memory.
+	device_dump_attach ((dc_device_t *) device, data, size);
+
+	status = oceanic_common_device_foreach ((dc_device_t *) device, callback, userdata);
+
+	dc_device_deallocate ((dc_device_t *) device);
+
+	return status;
+}
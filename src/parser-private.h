@@ -39,8 +39,16 @@ struct dc_parser_t {
 	dc_context_t *context;
 	const unsigned char *data;
 	unsigned int size;
+	unsigned int samplemask;
 };
 
+/*
+ * Check whether the application is interested in a sample type. Parsers
+ * can use this to skip decoding channels that would be discarded anyway,
+ * but only for work that does not affect any of the cached fields.
+ */
+#define SAMPLE_WANTED(parser,type) (((dc_parser_t *) (parser))->samplemask & DC_SAMPLE_MASK(type))
+
 struct dc_parser_vtable_t {
 	size_t size;
 
@@ -54,6 +62,8 @@ struct dc_parser_vtable_t {
 
 	dc_status_t (*samples_foreach) (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+	dc_status_t (*samples_range) (dc_parser_t *parser, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata);
+
 	dc_status_t (*destroy) (dc_parser_t *parser);
 };
 
@@ -66,16 +76,98 @@ dc_parser_deallocate (dc_parser_t *parser);
 int
 dc_parser_isinstance (dc_parser_t *parser, const dc_parser_vtable_t *vtable);
 
+#define SAMPLE_STATISTICS_NTANKS 16
+
+/*
+ * Summary of the profile, collected while walking the samples. A parser
+ * can fill it during the first call to its samples_foreach function, and
+ * answer all the profile based fields afterwards without another pass.
+ */
 typedef struct sample_statistics_t {
 	unsigned int divetime;
 	double maxdepth;
+	// Time weighted depth.
+	unsigned int time;
+	double depth;
+	double depthsum;
+	// Temperature range.
+	unsigned int ntemperatures;
+	double mintemperature;
+	double maxtemperature;
+	// Tank pressures.
+	unsigned int ntanks;
+	unsigned int tanks;
+	double beginpressure[SAMPLE_STATISTICS_NTANKS];
+	double endpressure[SAMPLE_STATISTICS_NTANKS];
+	// Chained sample callback.
+	dc_sample_callback_t callback;
+	void *userdata;
 } sample_statistics_t;
 
-#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0}
+#define SAMPLE_STATISTICS_INITIALIZER {0}
+
+void
+sample_statistics_init (sample_statistics_t *statistics, dc_sample_callback_t callback, void *userdata);
 
 void
 sample_statistics_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata);
 
+dc_status_t
+sample_statistics_get_field (const sample_statistics_t *statistics, dc_field_type_t type, unsigned int flags, void *value);
+
+#define SAMPLE_INDEX_SIZE 64
+#define SAMPLE_INDEX_INTERVAL 60
+
+/*
+ * Sparse index of checkpoints into the profile data. The decoder state
+ * at each checkpoint is stored by the parser itself, in an array with
+ * SAMPLE_INDEX_SIZE elements. When the index is full, every other
+ * checkpoint is dropped and the interval is doubled, so the number of
+ * checkpoints stays bounded for long dives.
+ */
+typedef struct sample_index_t {
+	unsigned int complete;
+	unsigned int count;
+	unsigned int interval;
+	unsigned int next;
+	unsigned int time[SAMPLE_INDEX_SIZE];
+} sample_index_t;
+
+void
+sample_index_reset (sample_index_t *index);
+
+int
+sample_index_add (sample_index_t *index, unsigned int time, void *states, size_t size);
+
+int
+sample_index_find (const sample_index_t *index, unsigned int time);
+
+/*
+ * Specialized sample decoders. A backend supporting several data layouts
+ * writes its sample loop once, as a SAMPLE_DECODER_INLINE function that
+ * takes the layout as its last argument, and generates one decoder per
+ * layout with SAMPLE_DECODER. Because the layout is a constant in each
+ * decoder, all the layout tests inside the loop are folded away. The
+ * decoder is selected once, when the parser is created (or when the
+ * layout is only known from the data, when the data is cached).
+ */
+typedef dc_status_t (*sample_decoder_t) (dc_parser_t *parser, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata);
+
+#if defined(_MSC_VER)
+#define SAMPLE_DECODER_INLINE static __forceinline
+#elif defined(__GNUC__)
+#define SAMPLE_DECODER_INLINE static inline __attribute__((always_inline))
+#else
+#define SAMPLE_DECODER_INLINE static inline
+#endif
+
+#define SAMPLE_DECODER(name,decode,layout) \
+	static dc_status_t \
+	name (dc_parser_t *parser, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata) \
+	{ \
+		return decode (parser, checkpoint, end, callback, userdata, layout); \
+	}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
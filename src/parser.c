@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "suunto_d9.h"
@@ -57,6 +58,8 @@
 #include "divesystem_idive.h"
 #include "cochran_commander.h"
 
+#include <libdivecomputer/buffer.h>
+
 #include "context-private.h"
 #include "parser-private.h"
 #include "device-private.h"
@@ -221,6 +224,7 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable)
 	parser->context = context;
 	parser->data = NULL;
 	parser->size = 0;
+	parser->samplemask = DC_SAMPLE_MASK_ALL;
 
 	return parser;
 }
@@ -292,6 +296,34 @@ dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int fla
 }
 
 
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	parser->samplemask = mask;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+typedef struct sample_filter_t {
+	unsigned int mask;
+	dc_sample_callback_t callback;
+	void *userdata;
+} sample_filter_t;
+
+static void
+sample_filter_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_filter_t *filter = (sample_filter_t *) userdata;
+
+	if (filter->mask & DC_SAMPLE_MASK(type))
+		filter->callback (type, value, filter->userdata);
+}
+
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
 {
@@ -301,10 +333,311 @@ dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, v
 	if (parser->vtable->samples_foreach == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	// Suppress the sample types the application is not interested in.
+	if (callback && parser->samplemask != DC_SAMPLE_MASK_ALL) {
+		sample_filter_t filter = {parser->samplemask, callback, userdata};
+		return parser->vtable->samples_foreach (parser, sample_filter_cb, &filter);
+	}
+
 	return parser->vtable->samples_foreach (parser, callback, userdata);
 }
 
 
+typedef struct sample_range_t {
+	unsigned int begin;
+	unsigned int end;
+	unsigned int before;
+	unsigned int inside;
+	unsigned int entered;
+	unsigned int gasmix;
+	unsigned int have_gasmix;
+	unsigned int pending;
+	unsigned int mask;
+	dc_sample_callback_t callback;
+	void *userdata;
+} sample_range_t;
+
+static void
+sample_range_flush (sample_range_t *range)
+{
+	if (range->pending) {
+		dc_sample_value_t value = {0};
+		value.gasmix = range->gasmix;
+		range->callback (DC_SAMPLE_GASMIX, value, range->userdata);
+		range->pending = 0;
+	}
+}
+
+static void
+sample_range_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_range_t *range = (sample_range_t *) userdata;
+
+	if (type == DC_SAMPLE_TIME) {
+		// The gas mix of the first sample is complete now.
+		sample_range_flush (range);
+
+		range->before = value.time < range->begin;
+		range->inside = value.time >= range->begin && value.time <= range->end;
+
+		// Re-emit the gas mix that was active before the window,
+		// unless the first sample switches to another one.
+		if (range->inside && !range->entered) {
+			range->entered = 1;
+			range->pending = range->have_gasmix &&
+				(range->mask & DC_SAMPLE_MASK(DC_SAMPLE_GASMIX));
+		}
+	}
+
+	if (type == DC_SAMPLE_GASMIX) {
+		if (range->before) {
+			range->gasmix = value.gasmix;
+			range->have_gasmix = 1;
+		} else if (range->inside) {
+			range->pending = 0;
+		}
+	}
+
+	if (range->inside && (range->mask & DC_SAMPLE_MASK(type)))
+		range->callback (type, value, range->userdata);
+}
+
+
+dc_status_t
+dc_parser_samples_range (dc_parser_t *parser, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (begin > end)
+		return DC_STATUS_INVALIDARGS;
+
+	if (callback == NULL)
+		return DC_STATUS_SUCCESS;
+
+	// Only the samples inside the time window are passed to the
+	// application. Backends with a checkpoint index start decoding
+	// near the beginning of the window and stop after the end. The
+	// others decode the entire profile. The gas mix that is active at
+	// the start of the window is reported with the first sample.
+	dc_status_t status = DC_STATUS_SUCCESS;
+	sample_range_t range = {begin, end, 1, 0, 0, 0, 0, 0, parser->samplemask, callback, userdata};
+	if (parser->vtable->samples_range) {
+		status = parser->vtable->samples_range (parser, begin, end, sample_range_cb, &range);
+	} else if (parser->vtable->samples_foreach) {
+		status = parser->vtable->samples_foreach (parser, sample_range_cb, &range);
+	} else {
+		return DC_STATUS_UNSUPPORTED;
+	}
+
+	if (status == DC_STATUS_SUCCESS)
+		sample_range_flush (&range);
+
+	return status;
+}
+
+
+typedef struct dc_parser_pending_t {
+	dc_sample_type_t type;
+	dc_sample_value_t value;
+} dc_parser_pending_t;
+
+struct dc_parser_stream_t {
+	dc_parser_t *parser;
+	dc_buffer_t *buffer;
+	dc_sample_callback_t callback;
+	void *userdata;
+	// Last emitted sample time.
+	unsigned int emitted;
+	unsigned int time;
+	unsigned int preamble;
+	// Samples of the current sample time.
+	unsigned int started;
+	unsigned int current;
+	unsigned int timed;
+	unsigned int newtime;
+	dc_parser_pending_t *pending;
+	unsigned int npending;
+	unsigned int capacity;
+	dc_status_t status;
+};
+
+dc_status_t
+dc_parser_stream_new (dc_parser_stream_t **out, dc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
+{
+	dc_parser_stream_t *stream = NULL;
+
+	if (out == NULL || parser == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	stream = (dc_parser_stream_t *) malloc (sizeof (dc_parser_stream_t));
+	if (stream == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	stream->buffer = dc_buffer_new (0);
+	if (stream->buffer == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		free (stream);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	stream->parser = parser;
+	stream->callback = callback;
+	stream->userdata = userdata;
+	stream->emitted = 0;
+	stream->time = 0;
+	stream->preamble = 0;
+	stream->started = 0;
+	stream->current = 0;
+	stream->timed = 0;
+	stream->newtime = 0;
+	stream->pending = NULL;
+	stream->npending = 0;
+	stream->capacity = 0;
+	stream->status = DC_STATUS_SUCCESS;
+
+	*out = stream;
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_parser_stream_free (dc_parser_stream_t *stream)
+{
+	if (stream == NULL)
+		return;
+
+	dc_buffer_free (stream->buffer);
+	free (stream->pending);
+	free (stream);
+}
+
+static void
+dc_parser_stream_flush (dc_parser_stream_t *stream)
+{
+	if (stream->current && stream->npending) {
+		for (unsigned int i = 0; i < stream->npending; ++i) {
+			if (stream->callback)
+				stream->callback (stream->pending[i].type, stream->pending[i].value, stream->userdata);
+		}
+
+		if (stream->timed) {
+			stream->emitted = 1;
+			stream->time = stream->newtime;
+		} else {
+			stream->preamble = 1;
+		}
+	}
+
+	stream->current = 0;
+	stream->npending = 0;
+}
+
+static void
+dc_parser_stream_sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	dc_parser_stream_t *stream = (dc_parser_stream_t *) userdata;
+
+	if (type == DC_SAMPLE_TIME) {
+		// The previous sample time is complete now.
+		dc_parser_stream_flush (stream);
+
+		// Only samples newer than the ones already passed to the
+		// application are collected.
+		stream->current = !stream->emitted || value.time > stream->time;
+		stream->timed = 1;
+		stream->newtime = value.time;
+		stream->started = 1;
+	} else if (!stream->started) {
+		// Samples before the first sample time.
+		stream->current = !stream->preamble && !stream->emitted;
+		stream->timed = 0;
+		stream->started = 1;
+	}
+
+	if (!stream->current)
+		return;
+
+	if (stream->npending == stream->capacity) {
+		unsigned int capacity = stream->capacity ? stream->capacity * 2 : 16;
+		dc_parser_pending_t *pending = (dc_parser_pending_t *) realloc (stream->pending, capacity * sizeof (dc_parser_pending_t));
+		if (pending == NULL) {
+			stream->status = DC_STATUS_NOMEMORY;
+			return;
+		}
+		stream->pending = pending;
+		stream->capacity = capacity;
+	}
+
+	stream->pending[stream->npending].type = type;
+	stream->pending[stream->npending].value = value;
+	stream->npending++;
+}
+
+static dc_status_t
+dc_parser_stream_decode (dc_parser_stream_t *stream, int final)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	// Decode all the data received so far.
+	rc = dc_parser_set_data (stream->parser,
+		dc_buffer_get_data (stream->buffer),
+		dc_buffer_get_size (stream->buffer));
+	if (rc == DC_STATUS_SUCCESS) {
+		stream->started = 0;
+		stream->current = 0;
+		stream->npending = 0;
+		stream->status = DC_STATUS_SUCCESS;
+		rc = dc_parser_samples_foreach (stream->parser, dc_parser_stream_sample_cb, stream);
+		if (rc == DC_STATUS_SUCCESS)
+			rc = stream->status;
+	}
+
+	// The samples of the last sample time can only be considered
+	// complete at the end of the dive.
+	if (final) {
+		if (rc == DC_STATUS_SUCCESS)
+			dc_parser_stream_flush (stream);
+		return rc;
+	}
+
+	stream->npending = 0;
+
+	if (rc == DC_STATUS_NOMEMORY)
+		return rc;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_parser_stream_append (dc_parser_stream_t *stream, const unsigned char data[], unsigned int size)
+{
+	if (stream == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	if (size == 0)
+		return DC_STATUS_SUCCESS;
+
+	if (!dc_buffer_append (stream->buffer, data, size)) {
+		ERROR (stream->parser->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	return dc_parser_stream_decode (stream, 0);
+}
+
+dc_status_t
+dc_parser_stream_finish (dc_parser_stream_t *stream)
+{
+	if (stream == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_parser_stream_decode (stream, 1);
+}
+
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser)
 {
@@ -323,6 +656,14 @@ dc_parser_destroy (dc_parser_t *parser)
 }
 
 
+void
+sample_statistics_init (sample_statistics_t *statistics, dc_sample_callback_t callback, void *userdata)
+{
+	memset (statistics, 0, sizeof (*statistics));
+	statistics->callback = callback;
+	statistics->userdata = userdata;
+}
+
 void
 sample_statistics_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
 {
@@ -335,8 +676,142 @@ sample_statistics_cb (dc_sample_type_t type, dc_sample_value_t value, void *user
 	case DC_SAMPLE_DEPTH:
 		if (statistics->maxdepth < value.depth)
 			statistics->maxdepth = value.depth;
+		// Integrate the depth over time (trapezoidal rule).
+		if (statistics->divetime > statistics->time) {
+			statistics->depthsum += (statistics->depth + value.depth) / 2.0 *
+				(statistics->divetime - statistics->time);
+			statistics->time = statistics->divetime;
+		}
+		statistics->depth = value.depth;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		if (statistics->ntemperatures == 0 || statistics->mintemperature > value.temperature)
+			statistics->mintemperature = value.temperature;
+		if (statistics->ntemperatures == 0 || statistics->maxtemperature < value.temperature)
+			statistics->maxtemperature = value.temperature;
+		statistics->ntemperatures++;
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if (value.pressure.tank < SAMPLE_STATISTICS_NTANKS) {
+			unsigned int mask = 1u << value.pressure.tank;
+			if ((statistics->tanks & mask) == 0) {
+				statistics->beginpressure[value.pressure.tank] = value.pressure.value;
+				statistics->tanks |= mask;
+			}
+			statistics->endpressure[value.pressure.tank] = value.pressure.value;
+			if (statistics->ntanks <= value.pressure.tank)
+				statistics->ntanks = value.pressure.tank + 1;
+		}
 		break;
 	default:
 		break;
 	}
+
+	if (statistics->callback)
+		statistics->callback (type, value, statistics->userdata);
+}
+
+void
+sample_index_reset (sample_index_t *index)
+{
+	index->complete = 0;
+	index->count = 0;
+	index->interval = SAMPLE_INDEX_INTERVAL;
+	index->next = 0;
+}
+
+int
+sample_index_add (sample_index_t *index, unsigned int time, void *states, size_t size)
+{
+	unsigned char *p = (unsigned char *) states;
+
+	if (index->count && time < index->next)
+		return -1;
+
+	if (index->count == SAMPLE_INDEX_SIZE) {
+		// Drop every other checkpoint and double the interval.
+		for (unsigned int i = 1; i < SAMPLE_INDEX_SIZE / 2; ++i) {
+			index->time[i] = index->time[2 * i];
+			memcpy (p + i * size, p + 2 * i * size, size);
+		}
+		index->count = SAMPLE_INDEX_SIZE / 2;
+		index->interval *= 2;
+		index->next = index->time[index->count - 1] + index->interval;
+		if (time < index->next)
+			return -1;
+	}
+
+	unsigned int n = index->count++;
+	index->time[n] = time;
+	index->next = time + index->interval;
+
+	return n;
+}
+
+int
+sample_index_find (const sample_index_t *index, unsigned int time)
+{
+	if (index->count == 0)
+		return -1;
+
+	// Binary search for the last checkpoint at or before the given time.
+	unsigned int lo = 0, hi = index->count;
+	while (hi - lo > 1) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (index->time[mid] <= time)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+dc_status_t
+sample_statistics_get_field (const sample_statistics_t *statistics, dc_field_type_t type, unsigned int flags, void *value)
+{
+	dc_tank_t *tank = (dc_tank_t *) value;
+
+	switch (type) {
+	case DC_FIELD_DIVETIME:
+		*((unsigned int *) value) = statistics->divetime;
+		break;
+	case DC_FIELD_MAXDEPTH:
+		*((double *) value) = statistics->maxdepth;
+		break;
+	case DC_FIELD_AVGDEPTH:
+		if (statistics->time == 0)
+			return DC_STATUS_UNSUPPORTED;
+		*((double *) value) = statistics->depthsum / statistics->time;
+		break;
+	case DC_FIELD_TEMPERATURE_MINIMUM:
+		if (statistics->ntemperatures == 0)
+			return DC_STATUS_UNSUPPORTED;
+		*((double *) value) = statistics->mintemperature;
+		break;
+	case DC_FIELD_TEMPERATURE_MAXIMUM:
+		if (statistics->ntemperatures == 0)
+			return DC_STATUS_UNSUPPORTED;
+		*((double *) value) = statistics->maxtemperature;
+		break;
+	case DC_FIELD_TANK_COUNT:
+		if (statistics->ntanks == 0)
+			return DC_STATUS_UNSUPPORTED;
+		*((unsigned int *) value) = statistics->ntanks;
+		break;
+	case DC_FIELD_TANK:
+		if (flags >= statistics->ntanks)
+			return DC_STATUS_INVALIDARGS;
+		tank->type = DC_TANKVOLUME_NONE;
+		tank->volume = 0.0;
+		tank->workpressure = 0.0;
+		tank->beginpressure = statistics->beginpressure[flags];
+		tank->endpressure = statistics->endpressure[flags];
+		tank->gasmix = DC_GASMIX_UNKNOWN;
+		break;
+	default:
+		return DC_STATUS_UNSUPPORTED;
+	}
+
+	return DC_STATUS_SUCCESS;
 }
@@ -0,0 +1,285 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h> // malloc, realloc, free
+
+#include <libdivecomputer/pipeline.h>
+
+#include "context-private.h"
+#include "common-private.h"
+#include "thread.h"
+
+#define MAXTHREADS 64
+
+/*
+ * The memory dump is processed in two stages. First, the dive boundaries
+ * are located with dc_extract_dives, and the dives are copied into a
+ * single buffer. Next, the dives are distributed over the worker threads,
+ * each with its own parser. The results are delivered by the calling
+ * thread, in the original order.
+ */
+
+typedef struct dc_pipeline_dive_t {
+	size_t offset;
+	unsigned int size;
+	unsigned int fsize;
+	dc_status_t status;
+	void *result;
+	int done;
+} dc_pipeline_dive_t;
+
+typedef struct dc_pipeline_t {
+	dc_context_t *context;
+	dc_descriptor_t *descriptor;
+	unsigned int devtime;
+	dc_ticks_t systime;
+	dc_pipeline_parse_callback_t parse;
+	void *userdata;
+	// Extracted dives.
+	dc_buffer_t *buffer;
+	dc_status_t status;
+	dc_pipeline_dive_t *dives;
+	unsigned int ndives;
+	unsigned int capacity;
+	// Scheduling (protected by the lock).
+	unsigned int next;
+	int stop;
+	dc_mutex_t lock;
+	dc_cond_t cond;
+} dc_pipeline_t;
+
+static int
+dc_pipeline_collect (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	dc_pipeline_t *pipeline = (dc_pipeline_t *) userdata;
+
+	if (pipeline->ndives == pipeline->capacity) {
+		unsigned int capacity = pipeline->capacity ? pipeline->capacity * 2 : 64;
+		dc_pipeline_dive_t *dives = (dc_pipeline_dive_t *) realloc (pipeline->dives, capacity * sizeof (dc_pipeline_dive_t));
+		if (dives == NULL) {
+			ERROR (pipeline->context, "Failed to allocate memory.");
+			pipeline->status = DC_STATUS_NOMEMORY;
+			return 0;
+		}
+
+		pipeline->dives = dives;
+		pipeline->capacity = capacity;
+	}
+
+	// The data is copied, because some families pass a temporary buffer.
+	size_t offset = dc_buffer_get_size (pipeline->buffer);
+	if (!dc_buffer_append (pipeline->buffer, data, size) ||
+		!dc_buffer_append (pipeline->buffer, fingerprint, fsize))
+	{
+		ERROR (pipeline->context, "Failed to allocate memory.");
+		pipeline->status = DC_STATUS_NOMEMORY;
+		return 0;
+	}
+
+	dc_pipeline_dive_t *dive = pipeline->dives + pipeline->ndives++;
+	dive->offset = offset;
+	dive->size = size;
+	dive->fsize = fsize;
+	dive->status = DC_STATUS_SUCCESS;
+	dive->result = NULL;
+	dive->done = 0;
+
+	return 1;
+}
+
+static void
+dc_pipeline_parse (dc_pipeline_t *pipeline, dc_parser_t *parser, dc_status_t status, dc_pipeline_dive_t *dive)
+{
+	const unsigned char *data = dc_buffer_get_data (pipeline->buffer) + dive->offset;
+
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_parser_set_data (parser, data, dive->size);
+
+	if (status == DC_STATUS_SUCCESS && pipeline->parse) {
+		dive->result = pipeline->parse (parser, data, dive->size,
+			data + dive->size, dive->fsize, pipeline->userdata);
+	}
+
+	dive->status = status;
+}
+
+static void
+dc_pipeline_worker (void *userdata)
+{
+	dc_pipeline_t *pipeline = (dc_pipeline_t *) userdata;
+	dc_parser_t *parser = NULL;
+
+	// Each thread has its own parser. A failure is reported for each dive.
+	dc_status_t status = dc_parser_new2 (&parser, pipeline->context,
+		pipeline->descriptor, pipeline->devtime, pipeline->systime);
+
+	dc_mutex_lock (&pipeline->lock);
+	while (!pipeline->stop && pipeline->next < pipeline->ndives) {
+		dc_pipeline_dive_t *dive = pipeline->dives + pipeline->next++;
+		dc_mutex_unlock (&pipeline->lock);
+
+		dc_pipeline_parse (pipeline, parser, status, dive);
+
+		dc_mutex_lock (&pipeline->lock);
+		dive->done = 1;
+		dc_cond_broadcast (&pipeline->cond);
+	}
+	dc_mutex_unlock (&pipeline->lock);
+
+	dc_parser_destroy (parser);
+}
+
+static int
+dc_pipeline_deliver (dc_pipeline_t *pipeline, dc_pipeline_dive_t *dive, dc_pipeline_result_callback_t callback)
+{
+	const unsigned char *data = dc_buffer_get_data (pipeline->buffer) + dive->offset;
+
+	if (callback == NULL)
+		return 1;
+
+	return callback (dive->status, data, dive->size,
+		data + dive->size, dive->fsize, dive->result, pipeline->userdata);
+}
+
+dc_status_t
+dc_pipeline_run (dc_context_t *context, dc_descriptor_t *descriptor, unsigned int devtime, dc_ticks_t systime,
+	const unsigned char data[], unsigned int size, unsigned int nthreads,
+	dc_pipeline_parse_callback_t parse, dc_pipeline_result_callback_t result, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_pipeline_t pipeline;
+	dc_thread_t threads[MAXTHREADS];
+	unsigned int nstarted = 0;
+
+	if (descriptor == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	if (nthreads > MAXTHREADS)
+		nthreads = MAXTHREADS;
+
+	pipeline.context = context;
+	pipeline.descriptor = descriptor;
+	pipeline.devtime = devtime;
+	pipeline.systime = systime;
+	pipeline.parse = parse;
+	pipeline.userdata = userdata;
+	pipeline.status = DC_STATUS_SUCCESS;
+	pipeline.dives = NULL;
+	pipeline.ndives = 0;
+	pipeline.capacity = 0;
+	pipeline.next = 0;
+	pipeline.stop = 0;
+
+	pipeline.buffer = dc_buffer_new (size);
+	if (pipeline.buffer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Locate all dives. On failure, the dives found so far are still
+	// processed, just like the foreach function of the device would do.
+	dc_status_t rc = dc_extract_dives (context, descriptor, data, size, NULL, 0, dc_pipeline_collect, &pipeline);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_status_set_error (&status, rc);
+	}
+	if (pipeline.status != DC_STATUS_SUCCESS) {
+		dc_status_set_error (&status, pipeline.status);
+	}
+
+	if (nthreads == 0) {
+		// Process all dives in the calling thread.
+		dc_parser_t *parser = NULL;
+		rc = dc_parser_new2 (&parser, context, descriptor, devtime, systime);
+		for (unsigned int i = 0; i < pipeline.ndives; ++i) {
+			dc_pipeline_parse (&pipeline, parser, rc, pipeline.dives + i);
+			if (!dc_pipeline_deliver (&pipeline, pipeline.dives + i, result))
+				break;
+		}
+		dc_parser_destroy (parser);
+		goto error_free;
+	}
+
+	rc = dc_mutex_init (&pipeline.lock);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create the lock.");
+		status = rc;
+		goto error_free;
+	}
+
+	rc = dc_cond_init (&pipeline.cond);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create the condition variable.");
+		status = rc;
+		goto error_mutex_free;
+	}
+
+	if (nthreads > pipeline.ndives)
+		nthreads = pipeline.ndives;
+
+	for (nstarted = 0; nstarted < nthreads; ++nstarted) {
+		rc = dc_thread_create (&threads[nstarted], dc_pipeline_worker, &pipeline);
+		if (rc != DC_STATUS_SUCCESS) {
+			// Continue with the threads that are already running.
+			WARNING (context, "Failed to create worker thread %u.", nstarted);
+			break;
+		}
+	}
+
+	if (nstarted == 0 && pipeline.ndives) {
+		ERROR (context, "Failed to create the worker threads.");
+		status = rc;
+		goto error_cond_free;
+	}
+
+	// Deliver the results in order.
+	for (unsigned int i = 0; i < pipeline.ndives; ++i) {
+		dc_pipeline_dive_t *dive = pipeline.dives + i;
+
+		dc_mutex_lock (&pipeline.lock);
+		while (!dive->done && !(pipeline.stop && i >= pipeline.next)) {
+			dc_cond_wait (&pipeline.cond, &pipeline.lock);
+		}
+		dc_mutex_unlock (&pipeline.lock);
+
+		if (!dive->done)
+			break;
+
+		if (!dc_pipeline_deliver (&pipeline, dive, result) && !pipeline.stop) {
+			dc_mutex_lock (&pipeline.lock);
+			pipeline.stop = 1;
+			dc_mutex_unlock (&pipeline.lock);
+		}
+	}
+
+	for (unsigned int i = 0; i < nstarted; ++i) {
+		dc_thread_join (&threads[i]);
+	}
+
+error_cond_free:
+	dc_cond_free (&pipeline.cond);
+error_mutex_free:
+	dc_mutex_free (&pipeline.lock);
+error_free:
+	free (pipeline.dives);
+	dc_buffer_free (pipeline.buffer);
+	return status;
+}
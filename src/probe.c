@@ -0,0 +1,380 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h> // malloc, realloc, free, qsort
+#include <string.h> // strdup
+
+#include <libdivecomputer/probe.h>
+
+#include "context-private.h"
+#include "common-private.h"
+#include "serial.h"
+#include "thread.h"
+
+#include "hw_ostc3.h"
+#include "mares_iconhd.h"
+#include "shearwater_petrel.h"
+#include "suunto_d9.h"
+
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+#define MAXTHREADS 16
+#define MAXTIMEOUT 1000
+
+/*
+ * Every port is handled by a single worker thread, because a port can only
+ * be opened once. The workers take the next port from a shared index, and
+ * try the identification handshakes one after the other. Each worker has
+ * its own child context, because the devices opened in the handshakes
+ * register their transport statistics in the context.
+ */
+
+typedef dc_status_t (*dc_probe_func_t) (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model);
+
+typedef struct dc_probe_family_t {
+	dc_family_t family;
+	dc_probe_func_t probe;
+} dc_probe_family_t;
+
+/*
+ * Families sharing the same handshake are listed together. The handshake
+ * is tried only once, and the reported model number selects the family.
+ */
+static const dc_probe_family_t g_families[] = {
+	{DC_FAMILY_HW_OSTC3,            hw_ostc3_device_probe},
+	{DC_FAMILY_SHEARWATER_PETREL,   shearwater_petrel_device_probe},
+	{DC_FAMILY_SHEARWATER_PREDATOR, shearwater_petrel_device_probe},
+	{DC_FAMILY_MARES_ICONHD,        mares_iconhd_device_probe},
+	{DC_FAMILY_SUUNTO_D9,           suunto_d9_device_probe},
+};
+
+typedef struct dc_probe_port_t {
+	const char *name;
+	unsigned int index;
+	dc_descriptor_t *descriptor;
+	dc_probe_match_t match;
+} dc_probe_port_t;
+
+typedef struct dc_probe_t {
+	dc_context_t *context;
+	unsigned long long deadline;
+	// Candidate families, in the order they are tried.
+	dc_probe_family_t families[C_ARRAY_SIZE (g_families)];
+	unsigned int nfamilies;
+	// Ports.
+	dc_probe_port_t *ports;
+	unsigned int nports;
+	unsigned int capacity;
+	char **names;
+	unsigned int nnames;
+	dc_status_t status;
+	// Scheduling (protected by the lock).
+	unsigned int next;
+	dc_mutex_t lock;
+} dc_probe_t;
+
+static dc_probe_func_t
+dc_probe_lookup (dc_family_t family)
+{
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_families); ++i) {
+		if (g_families[i].family == family)
+			return g_families[i].probe;
+	}
+
+	return NULL;
+}
+
+static void
+dc_probe_add_family (dc_probe_t *probe, dc_family_t family)
+{
+	dc_probe_func_t func = dc_probe_lookup (family);
+	if (func == NULL) {
+		WARNING (probe->context, "Probing is not supported for family %08x.", family);
+		return;
+	}
+
+	for (unsigned int i = 0; i < probe->nfamilies; ++i) {
+		if (probe->families[i].family == family)
+			return;
+	}
+
+	probe->families[probe->nfamilies].family = family;
+	probe->families[probe->nfamilies].probe = func;
+	probe->nfamilies++;
+}
+
+static void
+dc_probe_add_port (const char *name, void *userdata)
+{
+	dc_probe_t *probe = (dc_probe_t *) userdata;
+
+	if (probe->status != DC_STATUS_SUCCESS)
+		return;
+
+	if (probe->nnames == probe->capacity) {
+		unsigned int capacity = probe->capacity ? probe->capacity * 2 : 16;
+		char **names = (char **) realloc (probe->names, capacity * sizeof (char *));
+		if (names == NULL) {
+			probe->status = DC_STATUS_NOMEMORY;
+			return;
+		}
+
+		probe->names = names;
+		probe->capacity = capacity;
+	}
+
+	char *copy = strdup (name);
+	if (copy == NULL) {
+		probe->status = DC_STATUS_NOMEMORY;
+		return;
+	}
+
+	probe->names[probe->nnames++] = copy;
+}
+
+/*
+ * Convert the model number reported by a handshake into a descriptor,
+ * preferring an exact match in any of the families sharing the handshake.
+ */
+static void
+dc_probe_identify (dc_probe_t *probe, dc_probe_port_t *port, dc_probe_func_t func, unsigned int model)
+{
+	dc_descriptor_t *descriptor = NULL;
+
+	for (unsigned int i = 0; i < probe->nfamilies; ++i) {
+		if (probe->families[i].probe != func)
+			continue;
+
+		if (dc_descriptor_find_model (&descriptor, probe->families[i].family, model) != DC_STATUS_SUCCESS)
+			continue;
+
+		if (dc_descriptor_get_model (descriptor) == model) {
+			port->descriptor = descriptor;
+			port->match = DC_PROBE_MODEL;
+			return;
+		}
+
+		if (port->descriptor == NULL) {
+			port->descriptor = descriptor;
+			port->match = DC_PROBE_FAMILY;
+		}
+	}
+}
+
+static void
+dc_probe_port (dc_probe_t *probe, dc_context_t *context, dc_probe_port_t *port)
+{
+	for (unsigned int i = 0; i < probe->nfamilies; ++i) {
+		dc_probe_func_t func = probe->families[i].probe;
+
+		// Skip a handshake that was already tried for another family.
+		unsigned int tried = 0;
+		for (unsigned int j = 0; j < i; ++j) {
+			if (probe->families[j].probe == func)
+				tried = 1;
+		}
+		if (tried)
+			continue;
+
+		unsigned long long now = dc_clock_now ();
+		if (now >= probe->deadline)
+			break;
+
+		unsigned int timeout = (probe->deadline - now + 999) / 1000;
+		if (timeout > MAXTIMEOUT)
+			timeout = MAXTIMEOUT;
+
+		unsigned int model = 0;
+		dc_status_t rc = func (context, port->name, timeout, &model);
+		if (rc == DC_STATUS_SUCCESS) {
+			INFO (context, "Probe: name=%s, family=%08x, model=%u", port->name, probe->families[i].family, model);
+			dc_probe_identify (probe, port, func, model);
+			break;
+		}
+
+		// There is no point in trying the other families if the port
+		// itself can't be opened.
+		if (rc == DC_STATUS_NODEVICE || rc == DC_STATUS_NOACCESS)
+			break;
+	}
+}
+
+static void
+dc_probe_worker (void *userdata)
+{
+	dc_probe_t *probe = (dc_probe_t *) userdata;
+	dc_context_t *context = NULL;
+
+	// Fall back to the shared context if no child context is available.
+	if (_dc_context_new_child (&context, probe->context) != DC_STATUS_SUCCESS)
+		context = NULL;
+
+	dc_mutex_lock (&probe->lock);
+	while (probe->next < probe->nports) {
+		dc_probe_port_t *port = probe->ports + probe->next++;
+		dc_mutex_unlock (&probe->lock);
+
+		dc_probe_port (probe, context ? context : probe->context, port);
+
+		dc_mutex_lock (&probe->lock);
+	}
+	dc_mutex_unlock (&probe->lock);
+
+	dc_context_free (context);
+}
+
+static int
+dc_probe_compare (const void *a, const void *b)
+{
+	const dc_probe_port_t *pa = (const dc_probe_port_t *) a;
+	const dc_probe_port_t *pb = (const dc_probe_port_t *) b;
+
+	// Ports without a match sort last.
+	unsigned int ma = pa->descriptor ? pa->match : 0;
+	unsigned int mb = pb->descriptor ? pb->match : 0;
+	if (ma != mb)
+		return ma > mb ? -1 : 1;
+
+	return pa->index < pb->index ? -1 : (pa->index > pb->index);
+}
+
+dc_status_t
+dc_probe_run (dc_context_t *context, const char *names[], unsigned int nnames,
+	const dc_family_t families[], unsigned int nfamilies, unsigned int timeout,
+	dc_probe_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_probe_t probe;
+	dc_thread_t threads[MAXTHREADS];
+	unsigned int nthreads = 0, nstarted = 0;
+
+	if ((names == NULL && nnames) || (families == NULL && nfamilies))
+		return DC_STATUS_INVALIDARGS;
+
+	probe.context = context;
+	probe.deadline = dc_clock_now () + timeout * 1000ULL;
+	probe.nfamilies = 0;
+	probe.ports = NULL;
+	probe.nports = 0;
+	probe.capacity = 0;
+	probe.names = NULL;
+	probe.nnames = 0;
+	probe.status = DC_STATUS_SUCCESS;
+	probe.next = 0;
+
+	// Select the candidate families.
+	if (nfamilies) {
+		for (unsigned int i = 0; i < nfamilies; ++i) {
+			dc_probe_add_family (&probe, families[i]);
+		}
+	} else {
+		for (unsigned int i = 0; i < C_ARRAY_SIZE (g_families); ++i) {
+			dc_probe_add_family (&probe, g_families[i].family);
+		}
+	}
+
+	// Enumerate the serial ports if none are given.
+	if (nnames == 0) {
+		status = dc_serial_enumerate (dc_probe_add_port, &probe);
+		if (status == DC_STATUS_SUCCESS)
+			status = probe.status;
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to enumerate the serial ports.");
+			goto error_free;
+		}
+
+		names = (const char **) probe.names;
+		nnames = probe.nnames;
+	}
+
+	if (nnames == 0 || probe.nfamilies == 0)
+		goto error_free;
+
+	probe.ports = (dc_probe_port_t *) malloc (nnames * sizeof (dc_probe_port_t));
+	if (probe.ports == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	for (unsigned int i = 0; i < nnames; ++i) {
+		probe.ports[i].name = names[i];
+		probe.ports[i].index = i;
+		probe.ports[i].descriptor = NULL;
+		probe.ports[i].match = DC_PROBE_FAMILY;
+	}
+	probe.nports = nnames;
+
+	status = dc_mutex_init (&probe.lock);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create the lock.");
+		goto error_free;
+	}
+
+	// With custom I/O, all ports end up at the same transport.
+	nthreads = probe.nports;
+	if (_dc_context_custom_io (context))
+		nthreads = 1;
+	if (nthreads > MAXTHREADS)
+		nthreads = MAXTHREADS;
+
+	for (nstarted = 0; nstarted < nthreads; ++nstarted) {
+		dc_status_t rc = dc_thread_create (&threads[nstarted], dc_probe_worker, &probe);
+		if (rc != DC_STATUS_SUCCESS) {
+			// Continue with the threads that are already running.
+			WARNING (context, "Failed to create worker thread %u.", nstarted);
+			break;
+		}
+	}
+
+	// Probe in the calling thread if no worker thread could be created.
+	if (nstarted == 0) {
+		for (unsigned int i = 0; i < probe.nports; ++i) {
+			dc_probe_port (&probe, context, probe.ports + i);
+		}
+	}
+
+	for (unsigned int i = 0; i < nstarted; ++i) {
+		dc_thread_join (&threads[i]);
+	}
+
+	dc_mutex_free (&probe.lock);
+
+	// Report the matches, best first.
+	qsort (probe.ports, probe.nports, sizeof (dc_probe_port_t), dc_probe_compare);
+	for (unsigned int i = 0; i < probe.nports; ++i) {
+		dc_probe_port_t *port = probe.ports + i;
+		if (port->descriptor == NULL)
+			break;
+
+		if (callback && !callback (port->name, port->descriptor, port->match, userdata))
+			break;
+	}
+
+error_free:
+	for (unsigned int i = 0; i < probe.nnames; ++i) {
+		free (probe.names[i]);
+	}
+	free (probe.names);
+	free (probe.ports);
+	return status;
+}
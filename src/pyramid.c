@@ -0,0 +1,402 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // memset
+#include <limits.h> // UINT_MAX
+
+#include <libdivecomputer/pyramid.h>
+
+#include "array.h"
+
+#define MAXLEVELS 16
+
+/* Samples beyond the maximum dive duration (seconds) are corrupt data. */
+#define MAXDURATION (48 * 3600)
+
+#define VERSION     1
+#define SZ_HEADER   8
+#define SZ_BUCKET   16
+
+typedef struct dc_pyramid_level_t {
+	dc_pyramid_bucket_t *buckets;
+	unsigned int count;
+	unsigned int capacity;
+} dc_pyramid_level_t;
+
+struct dc_pyramid_t {
+	unsigned int resolution;
+	unsigned int nlevels;
+	dc_pyramid_level_t levels[MAXLEVELS];
+	// Sample walk state.
+	dc_status_t status;
+	unsigned int time;
+	dc_sample_callback_t callback;
+	void *userdata;
+};
+
+dc_status_t
+dc_pyramid_new (dc_pyramid_t **out, unsigned int resolution, unsigned int nlevels)
+{
+	dc_pyramid_t *pyramid = NULL;
+
+	if (out == NULL || resolution == 0 || resolution > 0xFFFF ||
+		nlevels == 0 || nlevels > MAXLEVELS)
+		return DC_STATUS_INVALIDARGS;
+
+	pyramid = (dc_pyramid_t *) malloc (sizeof (dc_pyramid_t));
+	if (pyramid == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	memset (pyramid, 0, sizeof (dc_pyramid_t));
+	pyramid->resolution = resolution;
+	pyramid->nlevels = nlevels;
+
+	*out = pyramid;
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_pyramid_free (dc_pyramid_t *pyramid)
+{
+	if (pyramid == NULL)
+		return;
+
+	for (unsigned int i = 0; i < MAXLEVELS; ++i) {
+		free (pyramid->levels[i].buckets);
+	}
+
+	free (pyramid);
+}
+
+static void
+dc_pyramid_clear (dc_pyramid_t *pyramid)
+{
+	for (unsigned int i = 0; i < pyramid->nlevels; ++i) {
+		pyramid->levels[i].count = 0;
+	}
+}
+
+static dc_status_t
+dc_pyramid_resize (dc_pyramid_level_t *level, unsigned int count)
+{
+	if (count > level->capacity) {
+		// Grow the array exponentially.
+		unsigned int capacity = level->capacity ? level->capacity : 64;
+		while (capacity < count) {
+			if (capacity > UINT_MAX / 2 / sizeof (dc_pyramid_bucket_t))
+				return DC_STATUS_NOMEMORY;
+			capacity *= 2;
+		}
+
+		dc_pyramid_bucket_t *buckets = (dc_pyramid_bucket_t *) realloc (level->buckets, capacity * sizeof (dc_pyramid_bucket_t));
+		if (buckets == NULL)
+			return DC_STATUS_NOMEMORY;
+
+		level->buckets = buckets;
+		level->capacity = capacity;
+	}
+
+	// Initialize the new buckets.
+	if (count > level->count) {
+		memset (level->buckets + level->count, 0, (count - level->count) * sizeof (dc_pyramid_bucket_t));
+	}
+
+	level->count = count;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_pyramid_bucket_t *
+dc_pyramid_bucket (dc_pyramid_t *pyramid)
+{
+	dc_pyramid_level_t *level = &pyramid->levels[0];
+
+	if (pyramid->time > MAXDURATION) {
+		pyramid->status = DC_STATUS_DATAFORMAT;
+		return NULL;
+	}
+
+	unsigned int idx = pyramid->time / pyramid->resolution;
+	if (idx >= level->count) {
+		dc_status_t rc = dc_pyramid_resize (level, idx + 1);
+		if (rc != DC_STATUS_SUCCESS) {
+			pyramid->status = rc;
+			return NULL;
+		}
+	}
+
+	return level->buckets + idx;
+}
+
+static void
+dc_pyramid_sample_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	dc_pyramid_t *pyramid = (dc_pyramid_t *) userdata;
+	dc_pyramid_bucket_t *bucket = NULL;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		pyramid->time = value.time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		bucket = dc_pyramid_bucket (pyramid);
+		if (bucket == NULL)
+			break;
+		if (bucket->ndepths == 0 || bucket->mindepth > value.depth)
+			bucket->mindepth = value.depth;
+		if (bucket->ndepths == 0 || bucket->maxdepth < value.depth)
+			bucket->maxdepth = value.depth;
+		bucket->avgdepth += value.depth;
+		bucket->ndepths++;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		bucket = dc_pyramid_bucket (pyramid);
+		if (bucket == NULL)
+			break;
+		if (bucket->ntemperatures == 0 || bucket->mintemperature > value.temperature)
+			bucket->mintemperature = value.temperature;
+		if (bucket->ntemperatures == 0 || bucket->maxtemperature < value.temperature)
+			bucket->maxtemperature = value.temperature;
+		bucket->avgtemperature += value.temperature;
+		bucket->ntemperatures++;
+		break;
+	default:
+		break;
+	}
+
+	if (pyramid->callback)
+		pyramid->callback (type, value, pyramid->userdata);
+}
+
+static void
+dc_pyramid_merge (dc_pyramid_bucket_t *out, const dc_pyramid_bucket_t *a, const dc_pyramid_bucket_t *b)
+{
+	*out = *a;
+
+	if (b == NULL)
+		return;
+
+	if (b->ndepths) {
+		if (out->ndepths == 0 || out->mindepth > b->mindepth)
+			out->mindepth = b->mindepth;
+		if (out->ndepths == 0 || out->maxdepth < b->maxdepth)
+			out->maxdepth = b->maxdepth;
+		out->avgdepth = (out->avgdepth * out->ndepths + b->avgdepth * b->ndepths) / (out->ndepths + b->ndepths);
+		out->ndepths += b->ndepths;
+	}
+
+	if (b->ntemperatures) {
+		if (out->ntemperatures == 0 || out->mintemperature > b->mintemperature)
+			out->mintemperature = b->mintemperature;
+		if (out->ntemperatures == 0 || out->maxtemperature < b->maxtemperature)
+			out->maxtemperature = b->maxtemperature;
+		out->avgtemperature = (out->avgtemperature * out->ntemperatures + b->avgtemperature * b->ntemperatures) / (out->ntemperatures + b->ntemperatures);
+		out->ntemperatures += b->ntemperatures;
+	}
+}
+
+static dc_status_t
+dc_pyramid_build (dc_pyramid_t *pyramid)
+{
+	for (unsigned int i = 1; i < pyramid->nlevels; ++i) {
+		dc_pyramid_level_t *prev = &pyramid->levels[i - 1];
+		dc_pyramid_level_t *level = &pyramid->levels[i];
+
+		level->count = 0;
+		dc_status_t rc = dc_pyramid_resize (level, (prev->count + 1) / 2);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		for (unsigned int j = 0; j < level->count; ++j) {
+			const dc_pyramid_bucket_t *a = prev->buckets + 2 * j;
+			const dc_pyramid_bucket_t *b = 2 * j + 1 < prev->count ? a + 1 : NULL;
+			dc_pyramid_merge (level->buckets + j, a, b);
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_pyramid_samples_foreach (dc_pyramid_t *pyramid, dc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	if (pyramid == NULL || parser == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_pyramid_clear (pyramid);
+	pyramid->status = DC_STATUS_SUCCESS;
+	pyramid->time = 0;
+	pyramid->callback = callback;
+	pyramid->userdata = userdata;
+
+	rc = dc_parser_samples_foreach (parser, dc_pyramid_sample_cb, pyramid);
+	if (rc == DC_STATUS_SUCCESS)
+		rc = pyramid->status;
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_pyramid_clear (pyramid);
+		return rc;
+	}
+
+	// Convert the sums into averages.
+	dc_pyramid_level_t *level = &pyramid->levels[0];
+	for (unsigned int i = 0; i < level->count; ++i) {
+		dc_pyramid_bucket_t *bucket = level->buckets + i;
+		if (bucket->ndepths)
+			bucket->avgdepth /= bucket->ndepths;
+		if (bucket->ntemperatures)
+			bucket->avgtemperature /= bucket->ntemperatures;
+	}
+
+	return dc_pyramid_build (pyramid);
+}
+
+unsigned int
+dc_pyramid_get_levels (dc_pyramid_t *pyramid)
+{
+	if (pyramid == NULL)
+		return 0;
+
+	return pyramid->nlevels;
+}
+
+dc_status_t
+dc_pyramid_get_level (dc_pyramid_t *pyramid, unsigned int level, unsigned int *resolution, const dc_pyramid_bucket_t **buckets, unsigned int *count)
+{
+	if (pyramid == NULL || level >= pyramid->nlevels)
+		return DC_STATUS_INVALIDARGS;
+
+	if (resolution)
+		*resolution = pyramid->resolution << level;
+
+	if (buckets)
+		*buckets = pyramid->levels[level].buckets;
+
+	if (count)
+		*count = pyramid->levels[level].count;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static unsigned int
+dc_pyramid_encode (double value, double scale, int offset)
+{
+	double x = value * scale + offset;
+	if (x < 0)
+		return 0;
+	if (x > 0xFFFF)
+		return 0xFFFF;
+	return (unsigned int) (x + 0.5);
+}
+
+dc_status_t
+dc_pyramid_serialize (dc_pyramid_t *pyramid, dc_buffer_t *buffer)
+{
+	if (pyramid == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	const dc_pyramid_level_t *level = &pyramid->levels[0];
+
+	if (!dc_buffer_resize (buffer, SZ_HEADER + level->count * SZ_BUCKET))
+		return DC_STATUS_NOMEMORY;
+
+	unsigned char *data = dc_buffer_get_data (buffer);
+
+	data[0] = VERSION;
+	data[1] = pyramid->nlevels;
+	array_uint16_le_set (data + 2, pyramid->resolution);
+	array_uint32_le_set (data + 4, level->count);
+
+	// Temperatures are stored with an offset of 100 degrees, to allow
+	// negative values. The counts saturate.
+	for (unsigned int i = 0; i < level->count; ++i) {
+		const dc_pyramid_bucket_t *bucket = level->buckets + i;
+		unsigned char *p = data + SZ_HEADER + i * SZ_BUCKET;
+		array_uint16_le_set (p +  0, bucket->ndepths > 0xFFFF ? 0xFFFF : bucket->ndepths);
+		array_uint16_le_set (p +  2, dc_pyramid_encode (bucket->mindepth, 100.0, 0));
+		array_uint16_le_set (p +  4, dc_pyramid_encode (bucket->maxdepth, 100.0, 0));
+		array_uint16_le_set (p +  6, dc_pyramid_encode (bucket->avgdepth, 100.0, 0));
+		array_uint16_le_set (p +  8, bucket->ntemperatures > 0xFFFF ? 0xFFFF : bucket->ntemperatures);
+		array_uint16_le_set (p + 10, dc_pyramid_encode (bucket->mintemperature, 10.0, 1000));
+		array_uint16_le_set (p + 12, dc_pyramid_encode (bucket->maxtemperature, 10.0, 1000));
+		array_uint16_le_set (p + 14, dc_pyramid_encode (bucket->avgtemperature, 10.0, 1000));
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_pyramid_deserialize (dc_pyramid_t **out, const unsigned char data[], unsigned int size)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_pyramid_t *pyramid = NULL;
+
+	if (out == NULL || data == NULL || size < SZ_HEADER)
+		return DC_STATUS_INVALIDARGS;
+
+	if (data[0] != VERSION)
+		return DC_STATUS_DATAFORMAT;
+
+	unsigned int count = array_uint32_le (data + 4);
+	if (count > (size - SZ_HEADER) / SZ_BUCKET || size != SZ_HEADER + count * SZ_BUCKET ||
+		count > MAXDURATION + 1)
+		return DC_STATUS_DATAFORMAT;
+
+	rc = dc_pyramid_new (&pyramid, array_uint16_le (data + 2), data[1]);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc == DC_STATUS_INVALIDARGS ? DC_STATUS_DATAFORMAT : rc;
+
+	dc_pyramid_level_t *level = &pyramid->levels[0];
+	rc = dc_pyramid_resize (level, count);
+	if (rc != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_pyramid_bucket_t *bucket = level->buckets + i;
+		const unsigned char *p = data + SZ_HEADER + i * SZ_BUCKET;
+		bucket->ndepths = array_uint16_le (p + 0);
+		bucket->mindepth = array_uint16_le (p + 2) / 100.0;
+		bucket->maxdepth = array_uint16_le (p + 4) / 100.0;
+		bucket->avgdepth = array_uint16_le (p + 6) / 100.0;
+		bucket->ntemperatures = array_uint16_le (p + 8);
+		if (bucket->ntemperatures) {
+			bucket->mintemperature = (array_uint16_le (p + 10) - 1000) / 10.0;
+			bucket->maxtemperature = (array_uint16_le (p + 12) - 1000) / 10.0;
+			bucket->avgtemperature = (array_uint16_le (p + 14) - 1000) / 10.0;
+		}
+	}
+
+	rc = dc_pyramid_build (pyramid);
+	if (rc != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = pyramid;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_pyramid_free (pyramid);
+	return rc;
+}
@@ -60,9 +60,6 @@ static const dc_device_vtable_t reefnet_sensus_device_vtable = {
 	reefnet_sensus_device_close /* close */
 };
 
-static dc_status_t
-reefnet_sensus_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static dc_status_t
 reefnet_sensus_cancel (reefnet_sensus_device_t *device)
 {
@@ -115,6 +112,9 @@ reefnet_sensus_device_open (dc_device_t **out, dc_context_t *context, const char
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (19200 8N1).
 	status = dc_serial_configure (device->port, 19200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -351,6 +351,8 @@ reefnet_sensus_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 reefnet_sensus_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	reefnet_sensus_device_t *device = (reefnet_sensus_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -361,7 +363,7 @@ reefnet_sensus_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 		return rc;
 	}
 
-	rc = reefnet_sensus_extract_dives (abstract,
+	rc = reefnet_sensus_extract_dives (abstract->context, device->timestamp,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -370,15 +372,9 @@ reefnet_sensus_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 }
 
 
-static dc_status_t
-reefnet_sensus_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+reefnet_sensus_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	reefnet_sensus_device_t *device = (reefnet_sensus_device_t*) abstract;
-	dc_context_t *context = (abstract ? abstract->context : NULL);
-
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	// Search the entire data stream for start markers.
 	unsigned int previous = size;
 	unsigned int current = (size >= 7 ? size - 7 : 0);
@@ -425,8 +421,7 @@ reefnet_sensus_extract_dives (dc_device_t *abstract, const unsigned char data[],
 			}
 
 			// Automatically abort when a dive is older than the provided timestamp.
-			unsigned int timestamp = array_uint32_le (data + current + 2);
-			if (device && timestamp <= device->timestamp)
+			if (array_uint32_le (data + current + 2) <= timestamp)
 				return DC_STATUS_SUCCESS;
 
 			if (callback && !callback (data + current, offset - current, data + current + 2, 4, userdata))
@@ -59,9 +59,6 @@ static const dc_device_vtable_t reefnet_sensuspro_device_vtable = {
 	reefnet_sensuspro_device_close /* close */
 };
 
-static dc_status_t
-reefnet_sensuspro_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 reefnet_sensuspro_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -92,6 +89,9 @@ reefnet_sensuspro_device_open (dc_device_t **out, dc_context_t *context, const c
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (19200 8N1).
 	status = dc_serial_configure (device->port, 19200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -315,6 +315,8 @@ reefnet_sensuspro_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 reefnet_sensuspro_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	reefnet_sensuspro_device_t *device = (reefnet_sensuspro_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -325,7 +327,7 @@ reefnet_sensuspro_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 		return rc;
 	}
 
-	rc = reefnet_sensuspro_extract_dives (abstract,
+	rc = reefnet_sensuspro_extract_dives (abstract->context, device->timestamp,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -363,14 +365,9 @@ reefnet_sensuspro_device_write_interval (dc_device_t *abstract, unsigned char in
 }
 
 
-static dc_status_t
-reefnet_sensuspro_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+reefnet_sensuspro_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	reefnet_sensuspro_device_t *device = (reefnet_sensuspro_device_t*) abstract;
-
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	const unsigned char header[4] = {0x00, 0x00, 0x00, 0x00};
 	const unsigned char footer[2] = {0xFF, 0xFF};
 
@@ -399,8 +396,7 @@ reefnet_sensuspro_extract_dives (dc_device_t *abstract, const unsigned char data
 				return DC_STATUS_DATAFORMAT;
 
 			// Automatically abort when a dive is older than the provided timestamp.
-			unsigned int timestamp = array_uint32_le (data + current + 6);
-			if (device && timestamp <= device->timestamp)
+			if (array_uint32_le (data + current + 6) <= timestamp)
 				return DC_STATUS_SUCCESS;
 
 			if (callback && !callback (data + current, offset + 2 - current, data + current + 6, 4, userdata))
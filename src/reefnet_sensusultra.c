@@ -99,6 +99,9 @@ reefnet_sensusultra_device_open (dc_device_t **out, dc_context_t *context, const
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -379,12 +382,17 @@ reefnet_sensusultra_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	reefnet_sensusultra_device_t *device = (reefnet_sensusultra_device_t*) abstract;
 
 	// Erase the current contents of the buffer and
-	// pre-allocate the required amount of memory.
-	if (!dc_buffer_clear (buffer) || !dc_buffer_reserve (buffer, SZ_MEMORY)) {
+	// allocate the required amount of memory.
+	if (!dc_buffer_clear (buffer) || !dc_buffer_resize (buffer, SZ_MEMORY)) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
 		return DC_STATUS_NOMEMORY;
 	}
 
+	// The pages are received in reverse order, starting with the most recent
+	// data at the end of the memory. Each page is stored directly at its final
+	// position, filling the buffer from the end towards the start.
+	unsigned char *data = dc_buffer_get_data (buffer);
+
 	// Enable progress notifications.
 	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
 	progress.maximum = SZ_MEMORY;
@@ -408,11 +416,8 @@ reefnet_sensusultra_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		progress.current += SZ_PACKET;
 		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-		// Prepend the packet to the buffer.
-		if (!dc_buffer_prepend (buffer, packet + 2, SZ_PACKET)) {
-			ERROR (abstract->context, "Insufficient buffer space available.");
-			return DC_STATUS_NOMEMORY;
-		}
+		// Store the packet in front of the previous one.
+		memcpy (data + SZ_MEMORY - nbytes - SZ_PACKET, packet + 2, SZ_PACKET);
 
 		// Accept the packet.
 		rc = reefnet_sensusultra_send_uchar (device, ACCEPT);
@@ -598,7 +603,7 @@ reefnet_sensusultra_device_sense (dc_device_t *abstract, unsigned char *data, un
 
 
 static dc_status_t
-reefnet_sensusultra_parse (reefnet_sensusultra_device_t *device,
+reefnet_sensusultra_parse (unsigned int timestamp,
 	const unsigned char data[], unsigned int *premaining, unsigned int *pprevious,
 	int *aborted, dc_dive_callback_t callback, void *userdata)
 {
@@ -634,8 +639,7 @@ reefnet_sensusultra_parse (reefnet_sensusultra_device_t *device,
 			previous += sizeof (footer);
 
 			// Automatically abort when a dive is older than the provided timestamp.
-			unsigned int timestamp = array_uint32_le (current + 4);
-			if (device && timestamp <= device->timestamp) {
+			if (array_uint32_le (current + 4) <= timestamp) {
 				if (aborted)
 					*aborted = 1;
 				return DC_STATUS_SUCCESS;
@@ -672,8 +676,11 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 {
 	reefnet_sensusultra_device_t *device = (reefnet_sensusultra_device_t*) abstract;
 
-	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
-	if (buffer == NULL) {
+	// The pages are stored in reverse order, filling the memory from the end
+	// towards the start. The part that has been received so far is always
+	// contiguous, and can be parsed in place.
+	unsigned char *data = (unsigned char *) malloc (SZ_MEMORY);
+	if (data == NULL) {
 		ERROR (abstract->context, "Failed to allocate memory.");
 		return DC_STATUS_NOMEMORY;
 	}
@@ -686,7 +693,7 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 	// Wake-up the device and send the instruction code.
 	dc_status_t rc = reefnet_sensusultra_send (device, 0xB421);
 	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
+		free (data);
 		return rc;
 	}
 
@@ -701,7 +708,7 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 		unsigned char packet[SZ_PACKET + 4] = {0};
 		rc = reefnet_sensusultra_page (device, packet, sizeof (packet), npages);
 		if (rc != DC_STATUS_SUCCESS) {
-			dc_buffer_free (buffer);
+			free (data);
 			return rc;
 		}
 
@@ -713,11 +720,8 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 		if (array_isequal (packet + 2, SZ_PACKET, 0xFF) && nbytes != 0)
 			break;
 
-		// Prepend the packet to the buffer.
-		if (!dc_buffer_prepend (buffer, packet + 2, SZ_PACKET)) {
-			ERROR (abstract->context, "Insufficient buffer space available.");
-			return DC_STATUS_NOMEMORY;
-		}
+		// Store the packet in front of the previous one.
+		memcpy (data + SZ_MEMORY - nbytes - SZ_PACKET, packet + 2, SZ_PACKET);
 
 		// Update the parser state.
 		remaining += SZ_PACKET;
@@ -725,10 +729,10 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 
 		// Parse the page data.
 		int aborted = 0;
-		rc = reefnet_sensusultra_parse (device, dc_buffer_get_data (buffer),
+		rc = reefnet_sensusultra_parse (device->timestamp, data + SZ_MEMORY - nbytes - SZ_PACKET,
 			&remaining, &previous, &aborted, callback, userdata);
 		if (rc != DC_STATUS_SUCCESS) {
-			dc_buffer_free (buffer);
+			free (data);
 			return rc;
 		}
 		if (aborted)
@@ -737,7 +741,7 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 		// Accept the packet.
 		rc = reefnet_sensusultra_send_uchar (device, ACCEPT);
 		if (rc != DC_STATUS_SUCCESS) {
-			dc_buffer_free (buffer);
+			free (data);
 			return rc;
 		}
 
@@ -745,7 +749,17 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 		npages++;
 	}
 
-	dc_buffer_free (buffer);
+	free (data);
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+dc_status_t
+reefnet_sensusultra_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	unsigned int remaining = size;
+	unsigned int previous = size;
+
+	return reefnet_sensusultra_parse (timestamp, data, &remaining, &previous, NULL, callback, userdata);
+}
@@ -27,12 +27,13 @@
 #include "context-private.h"
 #include "device-private.h"
 #include "array.h"
-#include "usbhid.h"
+#include "iostream.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &scubapro_g2_device_vtable)
 
 typedef struct scubapro_g2_device_t {
 	dc_device_t base;
+	dc_iostream_t *iostream;
 	unsigned int timestamp;
 	unsigned int devtime;
 	dc_ticks_t systime;
@@ -54,25 +55,22 @@ static const dc_device_vtable_t scubapro_g2_device_vtable = {
 	scubapro_g2_device_close /* close */
 };
 
-static dc_status_t
-scubapro_g2_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 #define PACKET_SIZE 64
 static int receive_data(scubapro_g2_device_t *g2, unsigned char *buffer, int size, dc_event_progress_t *progress)
 {
-	dc_custom_io_t *io = _dc_context_custom_io(g2->base.context);
+	unsigned int packetsize = dc_iostream_get_packetsize(g2->iostream);
 	while (size) {
 		unsigned char buf[PACKET_SIZE] = { 0 };
 		size_t transferred = 0;
 		dc_status_t rc;
 		int len;
 
-		rc = io->packet_read(io, buf, PACKET_SIZE, &transferred);
+		rc = dc_iostream_read(g2->iostream, buf, PACKET_SIZE, &transferred);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR(g2->base.context, "read interrupt transfer failed");
 			return -1;
 		}
-		if (io->packet_size == PACKET_SIZE && transferred != PACKET_SIZE) {
+		if (packetsize == PACKET_SIZE && transferred != PACKET_SIZE) {
 			ERROR(g2->base.context, "incomplete read interrupt transfer (got %zu, expected %d)", transferred, PACKET_SIZE);
 			return -1;
 		}
@@ -106,8 +104,7 @@ static int receive_data(scubapro_g2_device_t *g2, unsigned char *buffer, int siz
 static dc_status_t
 scubapro_g2_transfer(scubapro_g2_device_t *g2, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
 {
-	dc_custom_io_t *io = _dc_context_custom_io(g2->base.context);
-	unsigned char buf[PACKET_SIZE];
+	unsigned char len = csize;
 	dc_status_t status = DC_STATUS_SUCCESS;
 	size_t transferred = 0;
 
@@ -118,9 +115,12 @@ scubapro_g2_transfer(scubapro_g2_device_t *g2, const unsigned char command[], un
 
 	HEXDUMP (g2->base.context, DC_LOGLEVEL_DEBUG, "cmd", command, csize);
 
-	buf[0] = csize;
-	memcpy(buf+1, command, csize);
-	status = io->packet_write(io, buf, csize+1, &transferred);
+	// Length byte, followed by the command.
+	dc_iovec_t iov[2] = {
+		{&len, 1},
+		{command, csize},
+	};
+	status = dc_iostream_writev(g2->iostream, iov, 2, &transferred);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR(g2->base.context, "Failed to send the command.");
 		return status;
@@ -190,21 +190,31 @@ scubapro_g2_device_open(dc_device_t **out, dc_context_t *context, const char *na
 
 
 	// Set the default values.
+	device->iostream = NULL;
 	device->timestamp = 0;
 	device->systime = (dc_ticks_t) -1;
 	device->devtime = 0;
 
 	dc_custom_io_t *io = _dc_context_custom_io(context);
 	if (io && io->packet_open)
-		status = io->packet_open(io, context, name);
+		status = dc_custom_iostream_open(&device->iostream, context, name);
 	else
-		status = dc_usbhid_custom_io(context, 0x2e6c, 0x3201);
+		status = dc_usbhid_iostream_open(&device->iostream, context, 0x2e6c, 0x3201);
 
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to open Scubapro G2 device");
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_iostream_set_stats (device->iostream, &device->base.stats);
+
+	// Set the timeout for receiving data.
+	dc_iostream_set_timeout(device->iostream, 5000);
+
+	// Discard any stale input.
+	dc_iostream_purge(device->iostream, DC_DIRECTION_INPUT);
+
 	// Perform the handshaking.
 	status = scubapro_g2_handshake(device);
 	if (status != DC_STATUS_SUCCESS) {
@@ -227,9 +237,9 @@ error_free:
 static dc_status_t
 scubapro_g2_device_close (dc_device_t *abstract)
 {
-	dc_custom_io_t *io = _dc_context_custom_io(abstract->context);
+	scubapro_g2_device_t *device = (scubapro_g2_device_t*) abstract;
 
-	return io->packet_close(io);
+	return dc_iostream_close(device->iostream);
 }
 
 
@@ -383,7 +393,7 @@ scubapro_g2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 		return rc;
 	}
 
-	rc = scubapro_g2_extract_dives (abstract,
+	rc = scubapro_g2_extract_dives (abstract->context, 0,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -392,12 +402,9 @@ scubapro_g2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 }
 
 
-static dc_status_t
-scubapro_g2_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+scubapro_g2_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	const unsigned char header[4] = {0xa5, 0xa5, 0x5a, 0x5a};
 
 	// Search the data stream for start markers.
@@ -413,6 +420,10 @@ scubapro_g2_extract_dives (dc_device_t *abstract, const unsigned char data[], un
 			if (current + len > previous)
 				return DC_STATUS_DATAFORMAT;
 
+			// Automatically abort when a dive is older than the provided timestamp.
+			if (timestamp && array_uint32_le (data + current + 8) <= timestamp)
+				return DC_STATUS_SUCCESS;
+
 			if (callback && !callback (data + current, len, data + current + 8, 4, userdata))
 				return DC_STATUS_SUCCESS;
 
@@ -33,6 +33,10 @@ extern "C" {
 dc_status_t
 scubapro_g2_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+scubapro_g2_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -24,6 +24,7 @@
 
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/context.h>
+#include <libdivecomputer/device.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -126,6 +127,15 @@ dc_serial_open (dc_serial_t **serial, dc_context_t *context, const char *name);
 dc_status_t
 dc_serial_close (dc_serial_t *serial);
 
+/**
+ * Attach the transport statistics of a device to the connection.
+ *
+ * @param[in]  serial  A valid serial connection.
+ * @param[in]  stats   The statistics to update, or NULL to stop counting.
+ */
+void
+dc_serial_set_stats (dc_serial_t *serial, dc_device_stats_t *stats);
+
 /**
  * Configure the serial line settings of the connection.
  *
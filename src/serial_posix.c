@@ -60,6 +60,8 @@
 struct dc_serial_t {
 	/* Library context. */
 	dc_context_t *context;
+	/* Transport statistics. */
+	dc_device_stats_t *stats;
 	/*
 	 * The file descriptor corresponding to the serial port.
 	 */
@@ -158,6 +160,7 @@ dc_serial_open (dc_serial_t **out, dc_context_t *context, const char *name)
 
 	// Library context.
 	device->context = context;
+	device->stats = NULL;
 
 	// Default to blocking reads.
 	device->timeout = -1;
@@ -246,6 +249,15 @@ dc_serial_close (dc_serial_t *device)
 	return status;
 }
 
+void
+dc_serial_set_stats (dc_serial_t *device, dc_device_stats_t *stats)
+{
+	if (device == NULL)
+		return;
+
+	device->stats = stats;
+}
+
 dc_status_t
 dc_serial_configure (dc_serial_t *device, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
 {
@@ -585,9 +597,13 @@ dc_serial_read (dc_serial_t *device, void *data, size_t size, size_t *actual)
 		goto out_invalidargs;
 	}
 
+	unsigned long long begin = dc_clock_now ();
+
 	RETURN_IF_CUSTOM_SERIAL(device->context,
 			{
 				HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Custom Read", (unsigned char *) data, nbytes);
+				TRACE (device->context, DC_TRANSPORT_CUSTOM, DC_DIRECTION_INPUT, (unsigned char *) data, nbytes);
+				dc_stats_read (device->stats, nbytes, _rc, begin);
 				if (actual)
 					*actual = nbytes;
 			},
@@ -666,6 +682,8 @@ dc_serial_read (dc_serial_t *device, void *data, size_t size, size_t *actual)
 
 out:
 	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
+	TRACE (device->context, DC_TRANSPORT_SERIAL, DC_DIRECTION_INPUT, (unsigned char *) data, nbytes);
+	dc_stats_read (device->stats, nbytes, status, begin);
 
 out_invalidargs:
 	if (actual)
@@ -688,6 +706,8 @@ dc_serial_write (dc_serial_t *device, const void *data, size_t size, size_t *act
 	RETURN_IF_CUSTOM_SERIAL(device->context,
 			{
 				HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Custom Write", (unsigned char *) data, nbytes);
+				TRACE (device->context, DC_TRANSPORT_CUSTOM, DC_DIRECTION_OUTPUT, (unsigned char *) data, nbytes);
+				dc_stats_write (device->stats, nbytes, _rc);
 				if (actual)
 					*actual = nbytes;
 			},
@@ -782,6 +802,8 @@ dc_serial_write (dc_serial_t *device, const void *data, size_t size, size_t *act
 
 out:
 	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Write", (unsigned char *) data, nbytes);
+	TRACE (device->context, DC_TRANSPORT_SERIAL, DC_DIRECTION_OUTPUT, (unsigned char *) data, nbytes);
+	dc_stats_write (device->stats, nbytes, status);
 
 out_invalidargs:
 	if (actual)
@@ -798,6 +820,8 @@ dc_serial_purge (dc_serial_t *device, dc_direction_t direction)
 
 	INFO (device->context, "Purge: direction=%u", direction);
 
+	dc_stats_purge (device->stats);
+
 	RETURN_IF_CUSTOM_SERIAL(device->context, , purge, direction);
 
 	int flags = 0;
@@ -960,6 +984,8 @@ dc_serial_sleep (dc_serial_t *device, unsigned int timeout)
 
 	INFO (device->context, "Sleep: value=%u", timeout);
 
+	unsigned long long begin = dc_clock_now ();
+
 	struct timespec ts;
 	ts.tv_sec  = (timeout / 1000);
 	ts.tv_nsec = (timeout % 1000) * 1000000;
@@ -972,5 +998,7 @@ dc_serial_sleep (dc_serial_t *device, unsigned int timeout)
 		}
 	}
 
+	dc_stats_sleep (device->stats, begin);
+
 	return DC_STATUS_SUCCESS;
 }
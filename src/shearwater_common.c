@@ -36,7 +36,7 @@
 #define ESC_ESC   0xDD
 
 dc_status_t
-shearwater_common_open (shearwater_common_device_t *device, dc_context_t *context, const char *name)
+shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *context, const char *name, unsigned int timeout, unsigned int delay)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 
@@ -47,6 +47,9 @@ shearwater_common_open (shearwater_common_device_t *device, dc_context_t *contex
 		return status;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_serial_configure (device->port, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -54,8 +57,8 @@ shearwater_common_open (shearwater_common_device_t *device, dc_context_t *contex
 		goto error_close;
 	}
 
-	// Set the timeout for receiving data (3000ms).
-	status = dc_serial_set_timeout (device->port, 3000);
+	// Set the timeout for receiving data.
+	status = dc_serial_set_timeout (device->port, timeout);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
 		status = DC_STATUS_IO;
@@ -63,7 +66,8 @@ shearwater_common_open (shearwater_common_device_t *device, dc_context_t *contex
 	}
 
 	// Make sure everything is in a sane state.
-	dc_serial_sleep (device->port, 300);
+	if (delay)
+		dc_serial_sleep (device->port, delay);
 	dc_serial_purge (device->port, DC_DIRECTION_ALL);
 
 	return DC_STATUS_SUCCESS;
@@ -74,6 +78,13 @@ error_close:
 }
 
 
+dc_status_t
+shearwater_common_open (shearwater_common_device_t *device, dc_context_t *context, const char *name)
+{
+	return shearwater_common_setup (device, context, name, 3000, 300);
+}
+
+
 dc_status_t
 shearwater_common_close (shearwater_common_device_t *device)
 {
@@ -45,6 +45,9 @@ typedef struct shearwater_common_device_t {
 	dc_serial_t *port;
 } shearwater_common_device_t;
 
+dc_status_t
+shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *context, const char *name, unsigned int timeout, unsigned int delay);
+
 dc_status_t
 shearwater_common_open (shearwater_common_device_t *device, dc_context_t *context, const char *name);
 
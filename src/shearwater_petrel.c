@@ -75,6 +75,35 @@ str2num (unsigned char data[], unsigned int size, unsigned int offset)
 }
 
 
+static unsigned int
+shearwater_petrel_get_model (unsigned int code)
+{
+	switch (code) {
+	case 0x0101:
+	case 0x0202:
+		return PREDATOR;
+	case 0x0606:
+	case 0x0A0A:
+		return NERD;
+	case 0x0404:
+	case 0x0909:
+	case 0x0B0B:
+		return PETREL;
+	case 0x0505:
+	case 0x0808:
+		return PETREL2;
+	case 0x0707: // documentation list 0C0D for both Perdix and Perdix AI :-(
+		return PERDIX;
+	case 0x0C0C:
+	case 0x0C0D:
+	case 0x0D0D:
+		return PERDIXAI;
+	default:
+		return 0;
+	}
+}
+
+
 dc_status_t
 shearwater_petrel_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -110,6 +139,56 @@ error_free:
 }
 
 
+dc_status_t
+shearwater_petrel_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	shearwater_petrel_device_t *device = NULL;
+	dc_buffer_t *buffer = NULL;
+
+	if (model == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	device = (shearwater_petrel_device_t *) dc_device_allocate (context, &shearwater_petrel_device_vtable);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		ERROR (context, "Insufficient buffer space available.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	// Open the device.
+	status = shearwater_common_setup (&device->base, context, name, timeout, 0);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_free;
+	}
+
+	// Read the hardware type. The Predator answers this request too.
+	status = shearwater_common_identifier (&device->base, buffer, ID_HARDWARE_TYPE);
+	if (status == DC_STATUS_SUCCESS) {
+		if (dc_buffer_get_size (buffer) == 2)
+			*model = shearwater_petrel_get_model (array_uint16_be (dc_buffer_get_data (buffer)));
+		else
+			*model = 0;
+	}
+
+	// Close the port without the shutdown request, so the device stays
+	// ready for the download that follows.
+	shearwater_common_close (&device->base);
+
+error_free:
+	dc_buffer_free (buffer);
+	dc_device_deallocate ((dc_device_t *) device);
+	return status;
+}
+
+
 static dc_status_t
 shearwater_petrel_device_close (dc_device_t *abstract)
 {
@@ -212,33 +291,8 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 	dc_event_devinfo_t devinfo;
 	if (dc_buffer_get_size (buffer) == 2) {
 		unsigned short model_code = array_uint16_be(dc_buffer_get_data (buffer));
-		switch (model_code) {
-		case 0x0101:
-		case 0x0202:
-			devinfo.model = PREDATOR;
-			break;
-		case 0x0606:
-		case 0x0A0A:
-			devinfo.model = NERD;
-			break;
-		case 0x0404:
-		case 0x0909:
-		case 0x0B0B:
-			devinfo.model = PETREL;
-			break;
-		case 0x0505:
-		case 0x0808:
-			devinfo.model = PETREL2;
-			break;
-		case 0x0707: // documentation list 0C0D for both Perdix and Perdix AI :-(
-			devinfo.model = PERDIX;
-			break;
-		case 0x0C0C:
-		case 0x0C0D:
-		case 0x0D0D:
-			devinfo.model = PERDIXAI;
-			break;
-		default:
+		devinfo.model = shearwater_petrel_get_model (model_code);
+		if (devinfo.model == 0) {
 			devinfo.model = PETREL;
 			ERROR (abstract->context, "Unknown model code - assuming Petrel.");
 		}
@@ -33,6 +33,9 @@ extern "C" {
 dc_status_t
 shearwater_petrel_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+shearwater_petrel_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model);
+
 dc_status_t
 shearwater_petrel_parser_create (dc_parser_t **parser, dc_context_t *context, unsigned int model, unsigned int serial);
 
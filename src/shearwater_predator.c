@@ -33,6 +33,8 @@
 #define PREDATOR 2
 #define PETREL   3
 
+#define FP_SIZE    4
+
 #define SZ_BLOCK   0x80
 #define SZ_MEMORY  0x20080
 
@@ -60,9 +62,6 @@ static const dc_device_vtable_t shearwater_predator_device_vtable = {
 	shearwater_predator_device_close /* close */
 };
 
-static dc_status_t
-shearwater_predator_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 shearwater_predator_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -142,6 +141,8 @@ shearwater_predator_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 shearwater_predator_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	shearwater_predator_device_t *device = (shearwater_predator_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -160,7 +161,7 @@ shearwater_predator_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 	devinfo.serial = array_uint32_be (data + 0x20002);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = shearwater_predator_extract_dives (abstract, data, SZ_MEMORY, callback, userdata);
+	rc = shearwater_predator_extract_dives (abstract->context, device->fingerprint, data, SZ_MEMORY, callback, userdata);
 
 	dc_buffer_free (buffer);
 
@@ -169,11 +170,8 @@ shearwater_predator_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 
 
 static dc_status_t
-shearwater_predator_extract_predator (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+shearwater_predator_extract_predator (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	shearwater_predator_device_t *device = (shearwater_predator_device_t*) abstract;
-	dc_context_t *context = (abstract ? abstract->context : NULL);
-
 	// Locate the most recent dive.
 	// The device maintains an internal counter which is incremented for every
 	// dive, and the current value at the time of the dive is stored in the
@@ -258,10 +256,10 @@ shearwater_predator_extract_predator (dc_device_t *abstract, const unsigned char
 			memcpy (buffer + offset + length, data + SZ_MEMORY - SZ_BLOCK, SZ_BLOCK);
 
 			// Check the fingerprint data.
-			if (device && memcmp (buffer + offset + 12, device->fingerprint, sizeof (device->fingerprint)) == 0)
+			if (fingerprint && memcmp (buffer + offset + 12, fingerprint, FP_SIZE) == 0)
 				break;
 
-			if (callback && !callback (buffer + offset, length + SZ_BLOCK, buffer + offset + 12, sizeof (device->fingerprint), userdata))
+			if (callback && !callback (buffer + offset, length + SZ_BLOCK, buffer + offset + 12, FP_SIZE, userdata))
 				break;
 
 			have_footer = 0;
@@ -278,11 +276,8 @@ shearwater_predator_extract_predator (dc_device_t *abstract, const unsigned char
 
 
 static dc_status_t
-shearwater_predator_extract_petrel (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+shearwater_predator_extract_petrel (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	shearwater_predator_device_t *device = (shearwater_predator_device_t*) abstract;
-	dc_context_t *context = (abstract ? abstract->context : NULL);
-
 	// Allocate memory for the profiles.
 	unsigned char *buffer = (unsigned char *) malloc (RB_PROFILE_END - RB_PROFILE_BEGIN + SZ_BLOCK);
 	if (buffer == NULL) {
@@ -320,10 +315,10 @@ shearwater_predator_extract_petrel (dc_device_t *abstract, const unsigned char d
 			memcpy (buffer + length, data + SZ_MEMORY - SZ_BLOCK, SZ_BLOCK);
 
 			// Check the fingerprint data.
-			if (device && memcmp (buffer + 12, device->fingerprint, sizeof (device->fingerprint)) == 0)
+			if (fingerprint && memcmp (buffer + 12, fingerprint, FP_SIZE) == 0)
 				break;
 
-			if (callback && !callback (buffer, length + SZ_BLOCK, buffer + 12, sizeof (device->fingerprint), userdata))
+			if (callback && !callback (buffer, length + SZ_BLOCK, buffer + 12, FP_SIZE, userdata))
 				break;
 
 			// Reset the header marker.
@@ -339,20 +334,17 @@ shearwater_predator_extract_petrel (dc_device_t *abstract, const unsigned char d
 }
 
 
-static dc_status_t
-shearwater_predator_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+shearwater_predator_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	if (size < SZ_MEMORY)
 		return DC_STATUS_DATAFORMAT;
 
 	unsigned int model = data[0x2000D];
 
 	if (model == PETREL) {
-		return shearwater_predator_extract_petrel (abstract, data, size, callback, userdata);
+		return shearwater_predator_extract_petrel (context, fingerprint, data, size, callback, userdata);
 	} else {
-		return shearwater_predator_extract_predator (abstract, data, size, callback, userdata);
+		return shearwater_predator_extract_predator (context, fingerprint, data, size, callback, userdata);
 	}
 }
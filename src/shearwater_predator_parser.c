@@ -57,6 +57,17 @@
 #define PREDATOR 2
 #define PETREL   3
 
+#define UNDEFINED 0xFFFFFFFF
+
+/* The non-empty samples, decoded into one column per field. */
+typedef struct shearwater_predator_columns_t {
+	unsigned int *offset;
+	unsigned int *gasmix;
+	unsigned short *depth;
+	unsigned char *status;
+	signed char *temperature;
+} shearwater_predator_columns_t;
+
 typedef struct shearwater_predator_parser_t shearwater_predator_parser_t;
 
 struct shearwater_predator_parser_t {
@@ -71,6 +82,8 @@ struct shearwater_predator_parser_t {
 	unsigned int ngasmixes;
 	unsigned int oxygen[NGASMIXES];
 	unsigned int helium[NGASMIXES];
+	unsigned int nrecords;
+	shearwater_predator_columns_t columns;
 	double calibration[3];
 	unsigned int serial;
 	dc_divemode_t mode;
@@ -82,6 +95,7 @@ static dc_status_t shearwater_predator_parser_set_data (dc_parser_t *abstract, c
 static dc_status_t shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t shearwater_predator_parser_destroy (dc_parser_t *abstract);
 
 static const dc_parser_vtable_t shearwater_predator_parser_vtable = {
 	sizeof(shearwater_predator_parser_t),
@@ -90,7 +104,8 @@ static const dc_parser_vtable_t shearwater_predator_parser_vtable = {
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	NULL, /* samples_range */
+	shearwater_predator_parser_destroy /* destroy */
 };
 
 static const dc_parser_vtable_t shearwater_petrel_parser_vtable = {
@@ -100,24 +115,11 @@ static const dc_parser_vtable_t shearwater_petrel_parser_vtable = {
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	NULL, /* samples_range */
+	shearwater_predator_parser_destroy /* destroy */
 };
 
 
-static unsigned int
-shearwater_predator_find_gasmix (shearwater_predator_parser_t *parser, unsigned int o2, unsigned int he)
-{
-	unsigned int i = 0;
-	while (i < parser->ngasmixes) {
-		if (o2 == parser->oxygen[i] && he == parser->helium[i])
-			break;
-		i++;
-	}
-
-	return i;
-}
-
-
 static dc_status_t
 shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int model, unsigned int serial, unsigned int petrel)
 {
@@ -158,6 +160,8 @@ shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, unsig
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
+	parser->nrecords = 0;
+	memset (&parser->columns, 0, sizeof (parser->columns));
 	parser->mode = DC_DIVEMODE_OC;
 
 	*out = (dc_parser_t *) parser;
@@ -194,12 +198,26 @@ shearwater_predator_parser_set_data (dc_parser_t *abstract, const unsigned char
 		parser->oxygen[i] = 0;
 		parser->helium[i] = 0;
 	}
+	free (parser->columns.offset);
+	parser->nrecords = 0;
+	memset (&parser->columns, 0, sizeof (parser->columns));
 	parser->mode = DC_DIVEMODE_OC;
 
 	return DC_STATUS_SUCCESS;
 }
 
 
+static dc_status_t
+shearwater_predator_parser_destroy (dc_parser_t *abstract)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	free (parser->columns.offset);
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
@@ -263,20 +281,60 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 	unsigned int helium[NGASMIXES] = {0};
 	unsigned int o2_previous = 0, he_previous = 0;
 
+	// Allocate the sample columns. All the samples have a fixed size, so
+	// the profile is decoded once into a column per field, with the gas
+	// mix change (if any) and the offset for the remaining fields. The
+	// columns share a single allocation, which starts with the offsets.
 	unsigned int offset = headersize;
 	unsigned int length = size - footersize;
+	unsigned int nrecords = 0;
+	unsigned int maxrecords = (length - offset + parser->samplesize - 1) / parser->samplesize;
+	shearwater_predator_columns_t columns = {0};
+	if (maxrecords) {
+		unsigned char *block = (unsigned char *) malloc (maxrecords *
+			(2 * sizeof (unsigned int) + sizeof (unsigned short) + 2 * sizeof (unsigned char)));
+		if (block == NULL) {
+			ERROR (abstract->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+		columns.offset = (unsigned int *) block;
+		columns.gasmix = columns.offset + maxrecords;
+		columns.depth = (unsigned short *) (columns.gasmix + maxrecords);
+		columns.status = (unsigned char *) (columns.depth + maxrecords);
+		columns.temperature = (signed char *) (columns.status + maxrecords);
+	}
+
 	while (offset < length) {
 		// Ignore empty samples.
-		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
+		if (array_iszero (data + offset, parser->samplesize)) {
 			offset += parser->samplesize;
 			continue;
 		}
 
+		unsigned int n = nrecords++;
+		columns.offset[n] = offset;
+		columns.gasmix[n] = UNDEFINED;
+
+		// Depth (1/10 m or ft).
+		columns.depth[n] = array_uint16_be (data + offset);
+
+		// Temperature (°C or °F).
+		int temperature = (signed char) data[offset + 13];
+		if (temperature < 0) {
+			// Fix negative temperatures.
+			temperature += 102;
+			if (temperature > 0) {
+				temperature = 0;
+			}
+		}
+		columns.temperature[n] = temperature;
+
 		// Status flags.
 		unsigned int status = data[offset + 11];
 		if ((status & OC) == 0) {
 			mode = DC_DIVEMODE_CC;
 		}
+		columns.status[n] = status;
 
 		// Gaschange.
 		unsigned int o2 = data[offset + 7];
@@ -294,6 +352,7 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 			if (idx >= ngasmixes) {
 				if (idx >= NGASMIXES) {
 					ERROR (abstract->context, "Maximum number of gas mixes reached.");
+					free (columns.offset);
 					return DC_STATUS_NOMEMORY;
 				}
 				oxygen[idx] = o2;
@@ -301,6 +360,7 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 				ngasmixes = idx + 1;
 			}
 
+			columns.gasmix[n] = idx;
 			o2_previous = o2;
 			he_previous = he;
 		}
@@ -330,6 +390,9 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 		parser->oxygen[i] = oxygen[i];
 		parser->helium[i] = helium[i];
 	}
+	free (parser->columns.offset);
+	parser->nrecords = nrecords;
+	parser->columns = columns;
 	parser->mode = mode;
 	parser->cached = 1;
 
@@ -486,34 +549,29 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
 
 	const unsigned char *data = abstract->data;
-	unsigned int size = abstract->size;
 
 	// Cache the parser data.
 	dc_status_t rc = shearwater_predator_parser_cache (parser);
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
-	// Get the unit system.
-	unsigned int units = data[8];
-
-	// Previous gas mix.
-	unsigned int o2_previous = 0, he_previous = 0;
+	// Get the unit system. The conversion factors are resolved once,
+	// to avoid testing the unit system for every sample.
+	double length_unit = 1.0, temperature_offset = 0.0, temperature_scale = 1.0;
+	if (data[8] == IMPERIAL) {
+		length_unit = FEET;
+		temperature_offset = 32.0;
+		temperature_scale = 5.0 / 9.0;
+	}
 
 	unsigned int time = 0;
-	unsigned int offset = parser->headersize;
-	unsigned int length = size - parser->footersize;
 
 	// initialize sensors as not paired
 	parser->tstate[1] = parser->tstate[0] = 0xF;
 
 	dc_sample_value_t sample = {0};
-	while (offset < length) {
-
-		// Ignore empty samples.
-		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
-			offset += parser->samplesize;
-			continue;
-		}
+	for (unsigned int i = 0; i < parser->nrecords; ++i) {
+		unsigned int offset = parser->columns.offset[i];
 
 		// Time (seconds).
 		time += 10;
@@ -521,30 +579,17 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 		if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 		// Depth (1/10 m or ft).
-		unsigned int depth = array_uint16_be (data + offset);
-		if (units == IMPERIAL)
-			sample.depth = depth * FEET / 10.0;
-		else
-			sample.depth = depth / 10.0;
+		sample.depth = parser->columns.depth[i] * length_unit / 10.0;
 		if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
 		// Temperature (°C or °F).
-		int temperature = (signed char) data[offset + 13];
-		if (temperature < 0) {
-			// Fix negative temperatures.
-			temperature += 102;
-			if (temperature > 0) {
-				temperature = 0;
-			}
+		if (SAMPLE_WANTED (parser, DC_SAMPLE_TEMPERATURE)) {
+			sample.temperature = (parser->columns.temperature[i] - temperature_offset) * temperature_scale;
+			if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 		}
-		if (units == IMPERIAL)
-			sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-		else
-			sample.temperature = temperature;
-		if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 
 		// Status flags.
-		unsigned int status = data[offset + 11];
+		unsigned int status = parser->columns.status[i];
 
 		if ((status & OC) == 0) {
 			// PPO2
@@ -552,7 +597,7 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			sample.ppo2 = data[offset + 6] / 100.0;
 			if (callback) callback (DC_SAMPLE_PPO2, sample, userdata);
 #else
-			if ((status & PPO2_EXTERNAL) == 0) {
+			if ((status & PPO2_EXTERNAL) == 0 && SAMPLE_WANTED (parser, DC_SAMPLE_PPO2)) {
 				sample.ppo2 = data[offset + 12] * parser->calibration[0];
 				if (callback && (data[86] & 0x01)) callback (DC_SAMPLE_PPO2, sample, userdata);
 
@@ -565,58 +610,50 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 #endif
 
 			// Setpoint
-			if (parser->petrel) {
-				sample.setpoint = data[offset + 18] / 100.0;
-			} else {
-				if (status & SETPOINT_HIGH) {
-					sample.setpoint = data[18] / 100.0;
+			if (SAMPLE_WANTED (parser, DC_SAMPLE_SETPOINT)) {
+				if (parser->petrel) {
+					sample.setpoint = data[offset + 18] / 100.0;
 				} else {
-					sample.setpoint = data[17] / 100.0;
+					if (status & SETPOINT_HIGH) {
+						sample.setpoint = data[18] / 100.0;
+					} else {
+						sample.setpoint = data[17] / 100.0;
+					}
 				}
+				if (callback) callback (DC_SAMPLE_SETPOINT, sample, userdata);
 			}
-			if (callback) callback (DC_SAMPLE_SETPOINT, sample, userdata);
 		}
 
 		// CNS
-		if (parser->petrel) {
+		if (parser->petrel && SAMPLE_WANTED (parser, DC_SAMPLE_CNS)) {
 			sample.cns = data[offset + 22] / 100.0;
 			if (callback) callback (DC_SAMPLE_CNS, sample, userdata);
 		}
 
 		// Gaschange.
-		unsigned int o2 = data[offset + 7];
-		unsigned int he = data[offset + 8];
-		if (o2 != o2_previous || he != he_previous) {
-			unsigned int idx = shearwater_predator_find_gasmix (parser, o2, he);
-			if (idx >= parser->ngasmixes) {
-				ERROR (abstract->context, "Invalid gas mix.");
-				return DC_STATUS_DATAFORMAT;
-			}
-
-			sample.gasmix = idx;
+		if (parser->columns.gasmix[i] != UNDEFINED) {
+			sample.gasmix = parser->columns.gasmix[i];
 			if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
-			o2_previous = o2;
-			he_previous = he;
 		}
 
 		// Deco stop / NDL.
-		unsigned int decostop = array_uint16_be (data + offset + 2);
-		if (decostop) {
-			sample.deco.type = DC_DECO_DECOSTOP;
-			if (units == IMPERIAL)
-				sample.deco.depth = decostop * FEET;
-			else
-				sample.deco.depth = decostop;
-		} else {
-			sample.deco.type = DC_DECO_NDL;
-			sample.deco.depth = 0.0;
+		if (SAMPLE_WANTED (parser, DC_SAMPLE_DECO)) {
+			unsigned int decostop = array_uint16_be (data + offset + 2);
+			if (decostop) {
+				sample.deco.type = DC_DECO_DECOSTOP;
+				sample.deco.depth = decostop * length_unit;
+			} else {
+				sample.deco.type = DC_DECO_NDL;
+				sample.deco.depth = 0.0;
+			}
+			sample.deco.time = data[offset + 9] * 60;
+			if (callback) callback (DC_SAMPLE_DECO, sample, userdata);
 		}
-		sample.deco.time = data[offset + 9] * 60;
-		if (callback) callback (DC_SAMPLE_DECO, sample, userdata);
 
 		// for logversion 7 and newer (introduced for Perdix AI)
 		// detect tank pressure
-		if (parser->logversion >= 7) {
+		if (parser->logversion >= 7 && (SAMPLE_WANTED (parser, DC_SAMPLE_PRESSURE) ||
+			SAMPLE_WANTED (parser, DC_SAMPLE_RBT) || SAMPLE_WANTED (parser, DC_SAMPLE_VENDOR))) {
 			// Pressure (2 psi).
 			// 0xFFFF is not paired / no coms for 90 seconds
 			// 0xFFFE no coms for 30 seconds
@@ -644,10 +681,9 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 				if (callback) callback (DC_SAMPLE_RBT, sample, userdata);
 			}
 		}
-
-		offset += parser->samplesize;
 	}
-	if (parser->logversion >= 7 && (parser->tstate[0] != 0xf || parser->tstate[1] != 0xf)) {
+	if (parser->logversion >= 7 && (parser->tstate[0] != 0xf || parser->tstate[1] != 0xf) &&
+		SAMPLE_WANTED (parser, DC_SAMPLE_VENDOR)) {
 		sample.vendor.type = SAMPLE_VENDOR_SHEARWATER_TRANSMITTERDATA;
 		sample.vendor.size = 2;
 		sample.vendor.data = parser->tstate;
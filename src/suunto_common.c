@@ -27,6 +27,8 @@
 #include "ringbuffer.h"
 #include "array.h"
 
+#define FP_SIZE 5
+
 #define RB_PROFILE_DISTANCE(a,b,l)	ringbuffer_distance (a, b, 0, l->rb_profile_begin, l->rb_profile_end)
 #define RB_PROFILE_PEEK(a,l)		ringbuffer_decrement (a, l->peek, l->rb_profile_begin, l->rb_profile_end)
 
@@ -60,7 +62,7 @@ suunto_common_device_set_fingerprint (dc_device_t *abstract, const unsigned char
 
 
 dc_status_t
-suunto_common_extract_dives (suunto_common_device_t *device, const suunto_common_layout_t *layout, const unsigned char data[], dc_dive_callback_t callback, void *userdata)
+suunto_common_extract_dives (const suunto_common_layout_t *layout, const unsigned char fingerprint[], const unsigned char data[], dc_dive_callback_t callback, void *userdata)
 {
 	assert (layout != NULL);
 
@@ -119,12 +121,12 @@ suunto_common_extract_dives (suunto_common_device_t *device, const suunto_common
 				memcpy (buffer, data + current, len);
 			}
 
-			if (device && memcmp (buffer + layout->fp_offset, device->fingerprint, sizeof (device->fingerprint)) == 0) {
+			if (fingerprint && memcmp (buffer + layout->fp_offset, fingerprint, FP_SIZE) == 0) {
 				free (buffer);
 				return DC_STATUS_SUCCESS;
 			}
 
-			if (callback && !callback (buffer, len, buffer + layout->fp_offset, sizeof (device->fingerprint), userdata)) {
+			if (callback && !callback (buffer, len, buffer + layout->fp_offset, FP_SIZE, userdata)) {
 				free (buffer);
 				return DC_STATUS_SUCCESS;
 			}
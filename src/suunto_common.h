@@ -52,7 +52,7 @@ dc_status_t
 suunto_common_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsigned int size);
 
 dc_status_t
-suunto_common_extract_dives (suunto_common_device_t *device, const suunto_common_layout_t *layout, const unsigned char data[], dc_dive_callback_t callback, void *userdata);
+suunto_common_extract_dives (const suunto_common_layout_t *layout, const unsigned char fingerprint[], const unsigned char data[], dc_dive_callback_t callback, void *userdata);
 
 #ifdef __cplusplus
 }
@@ -250,7 +250,7 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 
 	// Read the serial number.
 	unsigned char serial[SZ_MINIMUM > 4 ? SZ_MINIMUM : 4] = {0};
-	dc_status_t rc = suunto_common2_device_read (abstract, layout->serial, serial, sizeof (serial));
+	dc_status_t rc = dc_device_read (abstract, layout->serial, serial, sizeof (serial));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the memory header.");
 		return rc;
@@ -273,7 +273,7 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 
 	// Read the header bytes.
 	unsigned char header[8] = {0};
-	rc = suunto_common2_device_read (abstract, 0x0190, header, sizeof (header));
+	rc = dc_device_read (abstract, 0x0190, header, sizeof (header));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the memory header.");
 		return rc;
@@ -395,3 +395,39 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 
 	return status;
 }
+
+
+dc_status_t
+suunto_common2_extract_dives (dc_context_t *context, const suunto_common2_device_vtable_t *vtable, const suunto_common2_layout_t *layout, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	suunto_common2_device_t *device = NULL;
+
+	if (size < layout->memsize) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Allocate memory.
+	device = (suunto_common2_device_t *) dc_device_allocate (context, &vtable->base);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	suunto_common2_device_init (device);
+	device->layout = layout;
+	device->version[0] = model;
+	if (fingerprint)
+		memcpy (device->fingerprint, fingerprint, sizeof (device->fingerprint));
+
+	// Walk the memory dump instead of the device memory.
+	device_dump_attach ((dc_device_t *) device, data, size);
+
+	status = suunto_common2_device_foreach ((dc_device_t *) device, callback, userdata);
+
+	dc_device_deallocate ((dc_device_t *) device);
+
+	return status;
+}
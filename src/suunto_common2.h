@@ -76,6 +76,9 @@ suunto_common2_device_foreach (dc_device_t *device, dc_dive_callback_t callback,
 dc_status_t
 suunto_common2_device_reset_maxdepth (dc_device_t *device);
 
+dc_status_t
+suunto_common2_extract_dives (dc_context_t *context, const suunto_common2_device_vtable_t *vtable, const suunto_common2_layout_t *layout, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
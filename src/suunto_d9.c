@@ -88,6 +88,19 @@ static const suunto_common2_layout_t suunto_dx_layout = {
 };
 
 
+static const suunto_common2_layout_t *
+suunto_d9_get_layout (unsigned int model)
+{
+	if (model == D4i || model == D6i || model == D9tx ||
+		model == VYPERNOVO || model == ZOOPNOVO)
+		return &suunto_d9tx_layout;
+	else if (model == DX)
+		return &suunto_dx_layout;
+	else
+		return &suunto_d9_layout;
+}
+
+
 static dc_status_t
 suunto_d9_device_autodetect (suunto_d9_device_t *device, unsigned int model)
 {
@@ -124,8 +137,8 @@ suunto_d9_device_autodetect (suunto_d9_device_t *device, unsigned int model)
 }
 
 
-dc_status_t
-suunto_d9_device_open (dc_device_t **out, dc_context_t *context, const char *name, unsigned int model)
+static dc_status_t
+suunto_d9_device_setup (dc_device_t **out, dc_context_t *context, const char *name, unsigned int model, unsigned int timeout)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	suunto_d9_device_t *device = NULL;
@@ -153,6 +166,9 @@ suunto_d9_device_open (dc_device_t **out, dc_context_t *context, const char *nam
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -160,8 +176,8 @@ suunto_d9_device_open (dc_device_t **out, dc_context_t *context, const char *nam
 		goto error_close;
 	}
 
-	// Set the timeout for receiving data (3000 ms).
-	status = dc_serial_set_timeout (device->port, 3000);
+	// Set the timeout for receiving data.
+	status = dc_serial_set_timeout (device->port, timeout);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
 		goto error_close;
@@ -188,14 +204,7 @@ suunto_d9_device_open (dc_device_t **out, dc_context_t *context, const char *nam
 	}
 
 	// Override the base class values.
-	model = device->base.version[0];
-	if (model == D4i || model == D6i || model == D9tx ||
-		model == VYPERNOVO || model == ZOOPNOVO)
-		device->base.layout = &suunto_d9tx_layout;
-	else if (model == DX)
-		device->base.layout = &suunto_dx_layout;
-	else
-		device->base.layout = &suunto_d9_layout;
+	device->base.layout = suunto_d9_get_layout (device->base.version[0]);
 
 	*out = (dc_device_t*) device;
 
@@ -209,6 +218,36 @@ error_free:
 }
 
 
+dc_status_t
+suunto_d9_device_open (dc_device_t **out, dc_context_t *context, const char *name, unsigned int model)
+{
+	return suunto_d9_device_setup (out, context, name, model, 3000);
+}
+
+
+dc_status_t
+suunto_d9_device_probe (dc_context_t *context, const char *name, unsigned int timeout, unsigned int *model)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = NULL;
+
+	if (model == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Opening the device already reads the version info.
+	status = suunto_d9_device_setup (&abstract, context, name, 0, timeout);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	suunto_d9_device_t *device = (suunto_d9_device_t *) abstract;
+	*model = device->base.version[0];
+
+	dc_device_close (abstract);
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 suunto_d9_device_close (dc_device_t *abstract)
 {
@@ -318,3 +357,11 @@ suunto_d9_device_reset_maxdepth (dc_device_t *abstract)
 
 	return suunto_common2_device_reset_maxdepth (abstract);
 }
+
+
+dc_status_t
+suunto_d9_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	return suunto_common2_extract_dives (context, &suunto_d9_device_vtable, suunto_d9_get_layout (model),
+		model, fingerprint, data, size, callback, userdata);
+}
@@ -92,6 +92,9 @@ suunto_eon_device_open (dc_device_t **out, dc_context_t *context, const char *na
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Set the serial communication protocol (1200 8N2).
 	status = dc_serial_configure (device->port, 1200, 8, DC_PARITY_NONE, DC_STOPBITS_TWO, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -240,7 +243,7 @@ suunto_eon_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 	}
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = suunto_common_extract_dives (device, &suunto_eon_layout, data, callback, userdata);
+	rc = suunto_common_extract_dives (&suunto_eon_layout, device->fingerprint, data, callback, userdata);
 
 	dc_buffer_free (buffer);
 
@@ -248,6 +251,18 @@ suunto_eon_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 }
 
 
+dc_status_t
+suunto_eon_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	if (size < SZ_MEMORY) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	return suunto_common_extract_dives (&suunto_eon_layout, fingerprint, data, callback, userdata);
+}
+
+
 dc_status_t
 suunto_eon_device_write_name (dc_device_t *abstract, unsigned char data[], unsigned int size)
 {
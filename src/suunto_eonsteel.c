@@ -28,18 +28,28 @@
 #include "context-private.h"
 #include "device-private.h"
 #include "array.h"
-#include "usbhid.h"
+#include "iostream.h"
 
 #ifdef _MSC_VER
 #define snprintf _snprintf
 #endif
 
+#define HDRSIZE 12
+#define MAXDATA 2048
+#define CRCSIZE 4
+
 typedef struct suunto_eonsteel_device_t {
 	dc_device_t base;
+	dc_iostream_t *iostream;
 	unsigned int magic;
 	unsigned short seq;
 	unsigned char version[0x30];
 	unsigned char fingerprint[4];
+	// Reassembled BLE GATT reply
+	struct {
+		unsigned int len, offset;
+		unsigned char buffer[HDRSIZE + MAXDATA + CRCSIZE];
+	} ble_data;
 } suunto_eonsteel_device_t;
 
 // The EON Steel implements a small filesystem
@@ -126,14 +136,14 @@ static void put_le32(unsigned int val, unsigned char *p)
  * The maximum payload is 62 bytes.
  */
 #define PACKET_SIZE 64
-static int receive_usbhid_packet(dc_custom_io_t *io, suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
+static int receive_usbhid_packet(suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
 {
 	unsigned char buf[64];
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	size_t transferred = 0;
 	int len;
 
-	rc = io->packet_read(io, buf, PACKET_SIZE, &transferred);
+	rc = dc_iostream_read(eon->iostream, buf, PACKET_SIZE, &transferred);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR(eon->base.context, "read interrupt transfer failed");
 		return -1;
@@ -160,7 +170,7 @@ static int receive_usbhid_packet(dc_custom_io_t *io, suunto_eonsteel_device_t *e
 	return len;
 }
 
-static int fill_ble_buffer(dc_custom_io_t *io, suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
+static int fill_ble_buffer(suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
 {
 	int state = 0;
 	int bytes = 0;
@@ -172,7 +182,7 @@ static int fill_ble_buffer(dc_custom_io_t *io, suunto_eonsteel_device_t *eon, un
 		size_t transferred = 0;
 		int i;
 
-		rc = io->packet_read(io, packet, sizeof(packet), &transferred);
+		rc = dc_iostream_read(eon->iostream, packet, sizeof(packet), &transferred);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR(eon->base.context, "BLE GATT read transfer failed");
 			return -1;
@@ -236,45 +246,36 @@ done:
 	return bytes;
 }
 
-#define HDRSIZE 12
-#define MAXDATA 2048
-#define CRCSIZE 4
-
-static struct {
-	unsigned int len, offset;
-	unsigned char buffer[HDRSIZE + MAXDATA + CRCSIZE];
-} ble_data;
-
-static void fill_ble_data(dc_custom_io_t *io, suunto_eonsteel_device_t *eon)
+static void fill_ble_data(suunto_eonsteel_device_t *eon)
 {
 	int received;
 
-	received = fill_ble_buffer(io, eon, ble_data.buffer, sizeof(ble_data.buffer));
+	received = fill_ble_buffer(eon, eon->ble_data.buffer, sizeof(eon->ble_data.buffer));
 	if (received < 0)
 		received = 0;
-	ble_data.offset = 0;
-	ble_data.len = received;
+	eon->ble_data.offset = 0;
+	eon->ble_data.len = received;
 }
 
-static int receive_ble_packet(dc_custom_io_t *io, suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
+static int receive_ble_packet(suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
 {
 	int maxsize;
 
-	if (ble_data.offset >= ble_data.len)
+	if (eon->ble_data.offset >= eon->ble_data.len)
 		return 0;
-	maxsize = ble_data.len - ble_data.offset;
+	maxsize = eon->ble_data.len - eon->ble_data.offset;
 	if (size > maxsize)
 		size = maxsize;
-	memcpy(buffer, ble_data.buffer + ble_data.offset, size);
-	ble_data.offset += size;
+	memcpy(buffer, eon->ble_data.buffer + eon->ble_data.offset, size);
+	eon->ble_data.offset += size;
 	return size;
 }
 
-static int receive_packet(dc_custom_io_t *io, suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
+static int receive_packet(suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
 {
-	if (io->packet_size < 64)
-		return receive_ble_packet(io, eon, buffer, size);
-	return receive_usbhid_packet(io, eon, buffer, size);
+	if (dc_iostream_get_packetsize(eon->iostream) < 64)
+		return receive_ble_packet(eon, buffer, size);
+	return receive_usbhid_packet(eon, buffer, size);
 }
 
 static int add_hdlc(unsigned char *dst, unsigned char val)
@@ -321,7 +322,7 @@ static int send_cmd(suunto_eonsteel_device_t *eon,
 	unsigned char buf[64];
 	unsigned short seq = eon->seq;
 	unsigned int magic = eon->magic;
-	dc_custom_io_t *io = _dc_context_custom_io(eon->base.context);
+	int packetsize = dc_iostream_get_packetsize(eon->iostream);
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	size_t transferred = 0;
 
@@ -354,7 +355,7 @@ static int send_cmd(suunto_eonsteel_device_t *eon,
 	}
 
 	// BLE GATT protocol?
-	if (io->packet_size < 64) {
+	if (packetsize < 64) {
 		int hdlc_len;
 		unsigned char hdlc[2+2*(62+4)]; /* start/stop + escaping*(maxbuf+crc32) */
 		unsigned char *ptr;
@@ -365,16 +366,16 @@ static int send_cmd(suunto_eonsteel_device_t *eon,
 		do {
 			int len = hdlc_len;
 
-			if (len > io->packet_size)
-				len = io->packet_size;
-			rc = io->packet_write(io, ptr, len, &transferred);
+			if (len > packetsize)
+				len = packetsize;
+			rc = dc_iostream_write(eon->iostream, ptr, len, &transferred);
 			if (rc != DC_STATUS_SUCCESS)
 				break;
 			ptr += len;
 			hdlc_len -= len;
 		} while (hdlc_len);
 	} else {
-		rc = io->packet_write(io, buf, sizeof(buf), &transferred);
+		rc = dc_iostream_write(eon->iostream, buf, sizeof(buf), &transferred);
 	}
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR(eon->base.context, "write interrupt transfer failed");
@@ -397,11 +398,10 @@ static int receive_header(suunto_eonsteel_device_t *eon, struct eon_hdr *hdr, un
 {
 	int ret;
 	unsigned char header[64];
-	dc_custom_io_t *io = _dc_context_custom_io(eon->base.context);
 
-	if (io->packet_size < 64)
-		fill_ble_data(io, eon);
-	ret = receive_packet(io, eon, header, sizeof(header));
+	if (dc_iostream_get_packetsize(eon->iostream) < 64)
+		fill_ble_data(eon);
+	ret = receive_packet(eon, header, sizeof(header));
 	if (ret < 0)
 		return -1;
 	if (ret < 12) {
@@ -427,12 +427,11 @@ static int receive_header(suunto_eonsteel_device_t *eon, struct eon_hdr *hdr, un
 static int receive_data(suunto_eonsteel_device_t *eon, unsigned char *buffer, int size)
 {
 	int ret = 0;
-	dc_custom_io_t *io = _dc_context_custom_io(eon->base.context);
 
 	while (size > 0) {
 		int len;
 
-		len = receive_packet(io, eon, buffer + ret, size);
+		len = receive_packet(eon, buffer + ret, size);
 		if (len < 0)
 			return -1;
 
@@ -517,7 +516,8 @@ static int read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buf
 {
 	unsigned char result[2560];
 	unsigned char cmdbuf[64];
-	unsigned int size, offset;
+	dc_event_partial_t partial;
+	unsigned int size, offset, total;
 	int rc, len;
 
 	memset(cmdbuf, 0, sizeof(cmdbuf));
@@ -547,6 +547,7 @@ static int read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buf
 
 	size = array_uint32_le(result+4);
 	offset = 0;
+	total = dc_buffer_get_size(buf) + size;
 
 	while (size > 0) {
 		unsigned int ask, got, at;
@@ -589,6 +590,12 @@ static int read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buf
 		dc_buffer_append(buf, result+8, got);
 		offset += got;
 		size -= got;
+
+		// Expose the partial dive data
+		partial.data = dc_buffer_get_data(buf);
+		partial.size = dc_buffer_get_size(buf);
+		partial.total = total;
+		device_event_emit(&eon->base, DC_EVENT_PARTIAL, &partial);
 	}
 
 	rc = send_receive(eon, FILE_CLOSE_CMD,
@@ -725,20 +732,32 @@ suunto_eonsteel_device_open(dc_device_t **out, dc_context_t *context, const char
 	// Set up the magic handshake fields
 	eon->magic = INIT_MAGIC;
 	eon->seq = INIT_SEQ;
+	eon->iostream = NULL;
+	eon->ble_data.len = 0;
+	eon->ble_data.offset = 0;
 	memset (eon->version, 0, sizeof (eon->version));
 	memset (eon->fingerprint, 0, sizeof (eon->fingerprint));
 
-	dc_custom_io_t *io = _dc_context_custom_io(eon->base.context);
+	dc_custom_io_t *io = _dc_context_custom_io(context);
 	if (io && io->packet_open)
-		status = io->packet_open(io, context, name);
+		status = dc_custom_iostream_open(&eon->iostream, context, name);
 	else
-		status = dc_usbhid_custom_io(context, 0x1493, 0x0030);
+		status = dc_usbhid_iostream_open(&eon->iostream, context, 0x1493, 0x0030);
 
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR(context, "unable to open device");
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_iostream_set_stats (eon->iostream, &eon->base.stats);
+
+	// Set the timeout for receiving data.
+	dc_iostream_set_timeout(eon->iostream, 5000);
+
+	// Discard any stale input.
+	dc_iostream_purge(eon->iostream, DC_DIRECTION_INPUT);
+
 	if (initialize_eonsteel(eon) < 0) {
 		ERROR(context, "unable to initialize device");
 		status = DC_STATUS_IO;
@@ -872,7 +891,7 @@ suunto_eonsteel_device_foreach(dc_device_t *abstract, dc_dive_callback_t callbac
 static dc_status_t
 suunto_eonsteel_device_close(dc_device_t *abstract)
 {
-	dc_custom_io_t *io = _dc_context_custom_io(abstract->context);
+	suunto_eonsteel_device_t *eon = (suunto_eonsteel_device_t *) abstract;
 
-	return io->packet_close(io);
+	return dc_iostream_close(eon->iostream);
 }
@@ -1551,6 +1551,7 @@ static const dc_parser_vtable_t suunto_eonsteel_parser_vtable = {
 	suunto_eonsteel_parser_get_datetime, /* datetime */
 	suunto_eonsteel_parser_get_field, /* fields */
 	suunto_eonsteel_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_range */
 	suunto_eonsteel_parser_destroy /* destroy */
 };
 
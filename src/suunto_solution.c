@@ -57,9 +57,6 @@ static const dc_device_vtable_t suunto_solution_device_vtable = {
 	suunto_solution_device_close /* close */
 };
 
-static dc_status_t
-suunto_solution_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 suunto_solution_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -86,6 +83,9 @@ suunto_solution_device_open (dc_device_t **out, dc_context_t *context, const cha
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (1200 8N2).
 	status = dc_serial_configure (device->port, 1200, 8, DC_PARITY_NONE, DC_STOPBITS_TWO, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -274,7 +274,7 @@ suunto_solution_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 	}
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = suunto_solution_extract_dives (abstract,
+	rc = suunto_solution_extract_dives (abstract->context,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -283,12 +283,9 @@ suunto_solution_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 }
 
 
-static dc_status_t
-suunto_solution_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+suunto_solution_extract_dives (dc_context_t *context, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	if (size < SZ_MEMORY)
 		return DC_STATUS_DATAFORMAT;
 
@@ -112,6 +112,9 @@ suunto_vyper_device_open (dc_device_t **out, dc_context_t *context, const char *
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Set the serial communication protocol (2400 8O1).
 	status = dc_serial_configure (device->port, 2400, 8, DC_PARITY_ODD, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -543,3 +546,20 @@ suunto_vyper_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 
 	return rc;
 }
+
+
+dc_status_t
+suunto_vyper_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	if (size < SZ_MEMORY) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Identify a Vyper or a Spyder, exactly like the download does.
+	const suunto_common_layout_t *layout = &suunto_vyper_layout;
+	if (data[HDR_DEVINFO_VYPER] == 20 || data[HDR_DEVINFO_VYPER] == 30 || data[HDR_DEVINFO_VYPER] == 60)
+		layout = &suunto_spyder_layout;
+
+	return suunto_common_extract_dives (layout, fingerprint, data, callback, userdata);
+}
@@ -72,6 +72,16 @@ static const suunto_common2_layout_t suunto_helo2_layout = {
 };
 
 
+static const suunto_common2_layout_t *
+suunto_vyper2_get_layout (unsigned int model)
+{
+	if (model == HELO2)
+		return &suunto_helo2_layout;
+	else
+		return &suunto_vyper2_layout;
+}
+
+
 dc_status_t
 suunto_vyper2_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -101,6 +111,9 @@ suunto_vyper2_device_open (dc_device_t **out, dc_context_t *context, const char
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -139,11 +152,7 @@ suunto_vyper2_device_open (dc_device_t **out, dc_context_t *context, const char
 	}
 
 	// Override the base class values.
-	unsigned int model = device->base.version[0];
-	if (model == HELO2)
-		device->base.layout = &suunto_helo2_layout;
-	else
-		device->base.layout = &suunto_vyper2_layout;
+	device->base.layout = suunto_vyper2_get_layout (device->base.version[0]);
 
 	*out = (dc_device_t*) device;
 
@@ -253,3 +262,11 @@ suunto_vyper2_device_reset_maxdepth (dc_device_t *abstract)
 
 	return suunto_common2_device_reset_maxdepth (abstract);
 }
+
+
+dc_status_t
+suunto_vyper2_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	return suunto_common2_extract_dives (context, &suunto_vyper2_device_vtable, suunto_vyper2_get_layout (model),
+		model, fingerprint, data, size, callback, userdata);
+}
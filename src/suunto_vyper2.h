@@ -33,6 +33,9 @@ extern "C" {
 dc_status_t
 suunto_vyper2_device_open (dc_device_t **device, dc_context_t *context, const char *name);
 
+dc_status_t
+suunto_vyper2_extract_dives (dc_context_t *context, unsigned int model, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,770 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <zlib.h>	/* For crc32() */
+
+#ifdef _WIN32
+#define NOGDI
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#include <libdivecomputer/syncstore.h>
+
+#include "context-private.h"
+#include "array.h"
+
+/*
+ * The file starts with a 16 byte header (magic, version, number of
+ * records and a CRC32 of the records), followed by the records. Each
+ * record has a 20 byte header (family, model, serial, field and size)
+ * followed by the value. All numbers are little endian.
+ *
+ * In memory, the records are kept in an array, with an open addressing
+ * hash table on top, so a lookup takes constant time.
+ *
+ * Concurrent commits are serialized with an advisory lock on a separate
+ * lock file, because the store itself is replaced on every commit.
+ */
+#define SYNCSTORE_MAGIC   0x53534344 /* "DCSS" */
+#define SYNCSTORE_VERSION 1
+
+#define SZ_HEADER 16
+#define SZ_RECORD 20
+
+typedef struct dc_syncstore_entry_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int serial;
+	dc_syncstore_field_t field;
+	unsigned char *data;
+	unsigned int size;
+	/* Modified since the last commit. */
+	unsigned int dirty;
+} dc_syncstore_entry_t;
+
+struct dc_syncstore_t {
+	dc_context_t *context;
+	char *filename;
+	dc_syncstore_entry_t *entries;
+	unsigned int count;
+	unsigned int capacity;
+	/* Hash table with the index of the entries plus one. */
+	unsigned int *table;
+	unsigned int tablesize;
+};
+
+#ifdef _WIN32
+typedef HANDLE dc_syncstore_lock_t;
+#else
+typedef int dc_syncstore_lock_t;
+#endif
+
+static unsigned int
+dc_syncstore_hash (dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field)
+{
+	unsigned int hash = 2166136261u;
+	unsigned int values[] = {family, model, serial, field};
+	for (unsigned int i = 0; i < sizeof (values) / sizeof (values[0]); ++i) {
+		hash = (hash ^ values[i]) * 16777619u;
+		hash ^= hash >> 15;
+	}
+	return hash;
+}
+
+static unsigned int *
+dc_syncstore_lookup (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field)
+{
+	unsigned int mask = store->tablesize - 1;
+	unsigned int i = dc_syncstore_hash (family, model, serial, field) & mask;
+	while (store->table[i]) {
+		const dc_syncstore_entry_t *entry = store->entries + store->table[i] - 1;
+		if (entry->family == family && entry->model == model &&
+			entry->serial == serial && entry->field == field)
+			break;
+		i = (i + 1) & mask;
+	}
+	return store->table + i;
+}
+
+static dc_status_t
+dc_syncstore_reserve (dc_syncstore_t *store, unsigned int count)
+{
+	if (count > store->capacity) {
+		unsigned int capacity = store->capacity ? store->capacity : 16;
+		while (capacity < count)
+			capacity *= 2;
+
+		dc_syncstore_entry_t *entries = (dc_syncstore_entry_t *) realloc (store->entries, capacity * sizeof (dc_syncstore_entry_t));
+		if (entries == NULL) {
+			ERROR (store->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		store->entries = entries;
+		store->capacity = capacity;
+	}
+
+	// Keep the load factor of the hash table below one half.
+	if (count * 2 >= store->tablesize) {
+		unsigned int tablesize = store->tablesize ? store->tablesize * 2 : 32;
+		while (tablesize <= count * 2)
+			tablesize *= 2;
+
+		unsigned int *table = (unsigned int *) calloc (tablesize, sizeof (unsigned int));
+		if (table == NULL) {
+			ERROR (store->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		free (store->table);
+		store->table = table;
+		store->tablesize = tablesize;
+
+		for (unsigned int i = 0; i < store->count; ++i) {
+			const dc_syncstore_entry_t *entry = store->entries + i;
+			*dc_syncstore_lookup (store, entry->family, entry->model, entry->serial, entry->field) = i + 1;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_syncstore_insert (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field, const unsigned char data[], unsigned int size, unsigned int dirty)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *value = NULL;
+
+	if (size) {
+		value = (unsigned char *) malloc (size);
+		if (value == NULL) {
+			ERROR (store->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+		memcpy (value, data, size);
+	}
+
+	status = dc_syncstore_reserve (store, store->count + 1);
+	if (status != DC_STATUS_SUCCESS) {
+		free (value);
+		return status;
+	}
+
+	unsigned int *slot = dc_syncstore_lookup (store, family, model, serial, field);
+	if (*slot) {
+		// Replace the existing value. An empty value is kept in the
+		// array, but it is skipped when the store is written to disk.
+		dc_syncstore_entry_t *entry = store->entries + *slot - 1;
+		free (entry->data);
+		entry->data = value;
+		entry->size = size;
+		entry->dirty = dirty;
+	} else if (size || dirty) {
+		dc_syncstore_entry_t *entry = store->entries + store->count;
+		entry->family = family;
+		entry->model = model;
+		entry->serial = serial;
+		entry->field = field;
+		entry->data = value;
+		entry->size = size;
+		entry->dirty = dirty;
+		*slot = ++store->count;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_syncstore_load (dc_syncstore_t *store, const unsigned char data[], size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (size < SZ_HEADER ||
+		array_uint32_le (data) != SYNCSTORE_MAGIC ||
+		array_uint32_le (data + 4) != SYNCSTORE_VERSION) {
+		ERROR (store->context, "Invalid sync store header.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	unsigned int count = array_uint32_le (data + 8);
+	unsigned int crc = array_uint32_le (data + 12);
+	if (crc != (unsigned int) crc32 (0, data + SZ_HEADER, size - SZ_HEADER)) {
+		ERROR (store->context, "Unexpected sync store checksum.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	if (count > (size - SZ_HEADER) / SZ_RECORD) {
+		ERROR (store->context, "Unexpected number of records (%u).", count);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	status = dc_syncstore_reserve (store, count);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	size_t offset = SZ_HEADER;
+	for (unsigned int i = 0; i < count; ++i) {
+		if (offset + SZ_RECORD > size) {
+			ERROR (store->context, "Unexpected end of the sync store.");
+			return DC_STATUS_DATAFORMAT;
+		}
+
+		const unsigned char *record = data + offset;
+		unsigned int length = array_uint32_le (record + 16);
+		if (length > size - offset - SZ_RECORD) {
+			ERROR (store->context, "Unexpected end of the sync store.");
+			return DC_STATUS_DATAFORMAT;
+		}
+
+		status = dc_syncstore_insert (store,
+			(dc_family_t) array_uint32_le (record),
+			array_uint32_le (record + 4),
+			array_uint32_le (record + 8),
+			(dc_syncstore_field_t) array_uint32_le (record + 12),
+			record + SZ_RECORD, length, 0);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		offset += SZ_RECORD + length;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+dc_syncstore_reset (dc_syncstore_t *store)
+{
+	for (unsigned int i = 0; i < store->count; ++i) {
+		free (store->entries[i].data);
+	}
+	store->count = 0;
+
+	memset (store->table, 0, store->tablesize * sizeof (unsigned int));
+}
+
+static dc_status_t
+dc_syncstore_read (dc_syncstore_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned char *data = NULL;
+	FILE *fp = NULL;
+	long size = 0;
+
+	fp = fopen (store->filename, "rb");
+	if (fp == NULL) {
+		if (errno == ENOENT) {
+			// The store doesn't exist yet.
+			return DC_STATUS_SUCCESS;
+		}
+		ERROR (store->context, "Failed to open the file.");
+		return DC_STATUS_IO;
+	}
+
+	/* Get the file size. */
+	if (fseek (fp, 0, SEEK_END) != 0 ||
+		(size = ftell (fp)) < 0 ||
+		fseek (fp, 0, SEEK_SET) != 0) {
+		ERROR (store->context, "Failed to get the file size.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	data = (unsigned char *) malloc (size ? size : 1);
+	if (data == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error;
+	}
+
+	if (fread (data, 1, size, fp) != (size_t) size) {
+		ERROR (store->context, "Failed to read the file.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	status = dc_syncstore_load (store, data, size);
+	if (status == DC_STATUS_DATAFORMAT) {
+		// A corrupt store only costs a full download, so continue with
+		// an empty store. The file is replaced on the next commit.
+		WARNING (store->context, "Ignoring the corrupt sync store.");
+		dc_syncstore_reset (store);
+		status = DC_STATUS_SUCCESS;
+	}
+
+error:
+	free (data);
+	fclose (fp);
+	return status;
+}
+
+dc_status_t
+dc_syncstore_open (dc_syncstore_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_syncstore_t *store = NULL;
+
+	if (out == NULL || filename == NULL) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	store = (dc_syncstore_t *) malloc (sizeof (dc_syncstore_t));
+	if (store == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	store->context = context;
+	store->entries = NULL;
+	store->count = 0;
+	store->capacity = 0;
+	store->table = NULL;
+	store->tablesize = 0;
+
+	store->filename = (char *) malloc (strlen (filename) + 1);
+	if (store->filename == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+	strcpy (store->filename, filename);
+
+	status = dc_syncstore_reserve (store, 0);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	status = dc_syncstore_read (store);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = store;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_syncstore_close (store);
+	return status;
+}
+
+void
+dc_syncstore_close (dc_syncstore_t *store)
+{
+	if (store == NULL)
+		return;
+
+	for (unsigned int i = 0; i < store->count; ++i) {
+		free (store->entries[i].data);
+	}
+
+	free (store->entries);
+	free (store->table);
+	free (store->filename);
+	free (store);
+}
+
+dc_status_t
+dc_syncstore_get (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field, dc_buffer_t *buffer)
+{
+	if (store == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (!dc_buffer_clear (buffer))
+		return DC_STATUS_NOMEMORY;
+
+	unsigned int *slot = dc_syncstore_lookup (store, family, model, serial, field);
+	if (*slot) {
+		const dc_syncstore_entry_t *entry = store->entries + *slot - 1;
+		if (!dc_buffer_append (buffer, entry->data, entry->size)) {
+			ERROR (store->context, "Insufficient buffer space available.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_syncstore_set (dc_syncstore_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_syncstore_field_t field, const unsigned char data[], unsigned int size)
+{
+	if (store == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_syncstore_insert (store, family, model, serial, field, data, size, 1);
+}
+
+static int
+dc_syncstore_sync (FILE *fp)
+{
+	if (fflush (fp) != 0)
+		return -1;
+
+#ifdef _WIN32
+	return _commit (_fileno (fp));
+#else
+	return fsync (fileno (fp));
+#endif
+}
+
+static int
+dc_syncstore_replace (const char *oldname, const char *newname)
+{
+#ifdef _WIN32
+	if (!MoveFileExA (oldname, newname, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		return -1;
+	return 0;
+#else
+	return rename (oldname, newname);
+#endif
+}
+
+/*
+ * Flush the directory containing the file, so the rename survives a
+ * crash. On Windows, MOVEFILE_WRITE_THROUGH already takes care of this.
+ */
+static int
+dc_syncstore_syncdir (const char *filename)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	const char *slash = strrchr (filename, '/');
+	size_t length = slash ? (size_t) (slash - filename) : 0;
+
+	char *dirname = (char *) malloc (length + 2);
+	if (dirname == NULL)
+		return -1;
+
+	if (slash == NULL) {
+		strcpy (dirname, ".");
+	} else if (length == 0) {
+		strcpy (dirname, "/");
+	} else {
+		memcpy (dirname, filename, length);
+		dirname[length] = 0;
+	}
+
+	int fd = open (dirname, O_RDONLY);
+	free (dirname);
+	if (fd < 0)
+		return -1;
+
+	// Not all filesystems support syncing a directory.
+	int rc = fsync (fd);
+	if (rc != 0 && errno == EINVAL)
+		rc = 0;
+
+	close (fd);
+
+	return rc;
+#endif
+}
+
+/*
+ * Create a temporary file with a unique name next to the store.
+ */
+static FILE *
+dc_syncstore_mkstemp (const char *filename, char **tmpname)
+{
+	size_t length = strlen (filename);
+	char *name = (char *) malloc (length + 32);
+	if (name == NULL)
+		return NULL;
+
+#ifdef _WIN32
+	int fd = -1;
+	for (unsigned int i = 0; i < 100 && fd < 0; ++i) {
+		snprintf (name, length + 32, "%s.%lu-%u.tmp", filename, GetCurrentProcessId (), i);
+		fd = _open (name, _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+		if (fd < 0 && errno != EEXIST)
+			break;
+	}
+#else
+	memcpy (name, filename, length);
+	memcpy (name + length, ".XXXXXX", 8);
+	int fd = mkstemp (name);
+#endif
+	if (fd < 0) {
+		free (name);
+		return NULL;
+	}
+
+#ifdef _WIN32
+	FILE *fp = _fdopen (fd, "wb");
+#else
+	FILE *fp = fdopen (fd, "wb");
+#endif
+	if (fp == NULL) {
+#ifdef _WIN32
+		_close (fd);
+#else
+		close (fd);
+#endif
+		remove (name);
+		free (name);
+		return NULL;
+	}
+
+	*tmpname = name;
+
+	return fp;
+}
+
+static dc_status_t
+dc_syncstore_lock (dc_syncstore_t *store, dc_syncstore_lock_t *out)
+{
+	size_t length = strlen (store->filename);
+	char *lockname = (char *) malloc (length + 6);
+	if (lockname == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+	memcpy (lockname, store->filename, length);
+	memcpy (lockname + length, ".lock", 6);
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA (lockname,
+		GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	free (lockname);
+	if (handle == INVALID_HANDLE_VALUE) {
+		ERROR (store->context, "Failed to open the lock file.");
+		return DC_STATUS_IO;
+	}
+
+	OVERLAPPED overlapped;
+	memset (&overlapped, 0, sizeof (overlapped));
+	if (!LockFileEx (handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)) {
+		ERROR (store->context, "Failed to lock the file.");
+		CloseHandle (handle);
+		return DC_STATUS_IO;
+	}
+#else
+	int handle = open (lockname, O_RDWR | O_CREAT, 0666);
+	free (lockname);
+	if (handle < 0) {
+		ERROR (store->context, "Failed to open the lock file.");
+		return DC_STATUS_IO;
+	}
+
+	struct flock lock;
+	memset (&lock, 0, sizeof (lock));
+	lock.l_type = F_WRLCK;
+	lock.l_whence = SEEK_SET;
+
+	int rc = 0;
+	while ((rc = fcntl (handle, F_SETLKW, &lock)) != 0 && errno == EINTR)
+		;
+	if (rc != 0) {
+		ERROR (store->context, "Failed to lock the file.");
+		close (handle);
+		return DC_STATUS_IO;
+	}
+#endif
+
+	*out = handle;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+dc_syncstore_unlock (dc_syncstore_lock_t lock)
+{
+#ifdef _WIN32
+	OVERLAPPED overlapped;
+	memset (&overlapped, 0, sizeof (overlapped));
+	UnlockFileEx (lock, 0, 1, 0, &overlapped);
+	CloseHandle (lock);
+#else
+	// Closing the descriptor releases the lock.
+	close (lock);
+#endif
+}
+
+/*
+ * Reload the file and merge the changes of other processes. Modified
+ * values take precedence, all other values are taken from the file.
+ */
+static dc_status_t
+dc_syncstore_merge (dc_syncstore_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_syncstore_t current;
+
+	current.context = store->context;
+	current.filename = store->filename;
+	current.entries = NULL;
+	current.count = 0;
+	current.capacity = 0;
+	current.table = NULL;
+	current.tablesize = 0;
+
+	status = dc_syncstore_reserve (&current, 0);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	status = dc_syncstore_read (&current);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	for (unsigned int i = 0; i < store->count; ++i) {
+		dc_syncstore_entry_t *entry = store->entries + i;
+		if (!entry->dirty) {
+			free (entry->data);
+			entry->data = NULL;
+			entry->size = 0;
+		}
+	}
+
+	for (unsigned int i = 0; i < current.count; ++i) {
+		const dc_syncstore_entry_t *entry = current.entries + i;
+		unsigned int *slot = dc_syncstore_lookup (store, entry->family, entry->model, entry->serial, entry->field);
+		if (*slot && store->entries[*slot - 1].dirty)
+			continue;
+
+		status = dc_syncstore_insert (store, entry->family, entry->model, entry->serial, entry->field, entry->data, entry->size, 0);
+		if (status != DC_STATUS_SUCCESS)
+			goto error;
+	}
+
+error:
+	for (unsigned int i = 0; i < current.count; ++i) {
+		free (current.entries[i].data);
+	}
+	free (current.entries);
+	free (current.table);
+	return status;
+}
+
+dc_status_t
+dc_syncstore_commit (dc_syncstore_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_syncstore_lock_t lock;
+	dc_buffer_t *buffer = NULL;
+	char *tmpname = NULL;
+	FILE *fp = NULL;
+
+	if (store == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_syncstore_lock (store, &lock);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_syncstore_merge (store);
+	if (status != DC_STATUS_SUCCESS)
+		goto error;
+
+	// Serialize the records.
+	buffer = dc_buffer_new (SZ_HEADER);
+	if (buffer == NULL || !dc_buffer_resize (buffer, SZ_HEADER)) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error;
+	}
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < store->count; ++i) {
+		const dc_syncstore_entry_t *entry = store->entries + i;
+		if (entry->size == 0)
+			continue;
+
+		unsigned char record[SZ_RECORD];
+		array_uint32_le_set (record, entry->family);
+		array_uint32_le_set (record + 4, entry->model);
+		array_uint32_le_set (record + 8, entry->serial);
+		array_uint32_le_set (record + 12, entry->field);
+		array_uint32_le_set (record + 16, entry->size);
+		if (!dc_buffer_append (buffer, record, sizeof (record)) ||
+			!dc_buffer_append (buffer, entry->data, entry->size)) {
+			ERROR (store->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error;
+		}
+
+		count++;
+	}
+
+	unsigned char *data = dc_buffer_get_data (buffer);
+	size_t size = dc_buffer_get_size (buffer);
+	array_uint32_le_set (data, SYNCSTORE_MAGIC);
+	array_uint32_le_set (data + 4, SYNCSTORE_VERSION);
+	array_uint32_le_set (data + 8, count);
+	array_uint32_le_set (data + 12, crc32 (0, data + SZ_HEADER, size - SZ_HEADER));
+
+	// Write a temporary file next to the store.
+	fp = dc_syncstore_mkstemp (store->filename, &tmpname);
+	if (fp == NULL) {
+		ERROR (store->context, "Failed to create the file.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	if (fwrite (data, 1, size, fp) != size || dc_syncstore_sync (fp) != 0) {
+		ERROR (store->context, "Failed to write the file.");
+		fclose (fp);
+		remove (tmpname);
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	if (fclose (fp) != 0) {
+		ERROR (store->context, "Failed to write the file.");
+		remove (tmpname);
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	// Atomically replace the old store.
+	if (dc_syncstore_replace (tmpname, store->filename) != 0) {
+		ERROR (store->context, "Failed to replace the file.");
+		remove (tmpname);
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	if (dc_syncstore_syncdir (store->filename) != 0) {
+		ERROR (store->context, "Failed to flush the directory.");
+		status = DC_STATUS_IO;
+		goto error;
+	}
+
+	for (unsigned int i = 0; i < store->count; ++i) {
+		store->entries[i].dirty = 0;
+	}
+
+error:
+	dc_syncstore_unlock (lock);
+	free (tmpname);
+	dc_buffer_free (buffer);
+	return status;
+}
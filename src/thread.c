@@ -0,0 +1,194 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h> // malloc, free
+
+#include "thread.h"
+
+typedef struct dc_thread_start_t {
+	dc_thread_func_t func;
+	void *userdata;
+} dc_thread_start_t;
+
+#ifdef _WIN32
+static DWORD WINAPI
+dc_thread_start (LPVOID arg)
+#else
+static void *
+dc_thread_start (void *arg)
+#endif
+{
+	dc_thread_start_t start = *(dc_thread_start_t *) arg;
+
+	free (arg);
+
+	start.func (start.userdata);
+
+	return 0;
+}
+
+dc_status_t
+dc_thread_create (dc_thread_t *thread, dc_thread_func_t func, void *userdata)
+{
+	if (thread == NULL || func == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_thread_start_t *start = (dc_thread_start_t *) malloc (sizeof (dc_thread_start_t));
+	if (start == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	start->func = func;
+	start->userdata = userdata;
+
+#ifdef _WIN32
+	*thread = CreateThread (NULL, 0, dc_thread_start, start, 0, NULL);
+	if (*thread == NULL) {
+		free (start);
+		return DC_STATUS_IO;
+	}
+#else
+	if (pthread_create (thread, NULL, dc_thread_start, start) != 0) {
+		free (start);
+		return DC_STATUS_IO;
+	}
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_thread_join (dc_thread_t *thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject (*thread, INFINITE);
+	CloseHandle (*thread);
+#else
+	pthread_join (*thread, NULL);
+#endif
+}
+
+dc_status_t
+dc_mutex_init (dc_mutex_t *mutex)
+{
+#ifdef _WIN32
+	InitializeCriticalSection (mutex);
+#else
+	if (pthread_mutex_init (mutex, NULL) != 0)
+		return DC_STATUS_IO;
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_mutex_free (dc_mutex_t *mutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection (mutex);
+#else
+	pthread_mutex_destroy (mutex);
+#endif
+}
+
+void
+dc_mutex_lock (dc_mutex_t *mutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection (mutex);
+#else
+	pthread_mutex_lock (mutex);
+#endif
+}
+
+void
+dc_mutex_unlock (dc_mutex_t *mutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection (mutex);
+#else
+	pthread_mutex_unlock (mutex);
+#endif
+}
+
+dc_status_t
+dc_cond_init (dc_cond_t *cond)
+{
+#ifdef _WIN32
+	InitializeConditionVariable (cond);
+#else
+	if (pthread_cond_init (cond, NULL) != 0)
+		return DC_STATUS_IO;
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_cond_free (dc_cond_t *cond)
+{
+#ifdef _WIN32
+	// Condition variables don't need to be destroyed.
+#else
+	pthread_cond_destroy (cond);
+#endif
+}
+
+void
+dc_cond_wait (dc_cond_t *cond, dc_mutex_t *mutex)
+{
+#ifdef _WIN32
+	SleepConditionVariableCS (cond, mutex, INFINITE);
+#else
+	pthread_cond_wait (cond, mutex);
+#endif
+}
+
+void
+dc_cond_broadcast (dc_cond_t *cond)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable (cond);
+#else
+	pthread_cond_broadcast (cond);
+#endif
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK
+dc_once_start (PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+	dc_once_func_t func = *(dc_once_func_t *) parameter;
+
+	func ();
+
+	return TRUE;
+}
+#endif
+
+void
+dc_once (dc_once_t *once, dc_once_func_t func)
+{
+#ifdef _WIN32
+	InitOnceExecuteOnce (once, dc_once_start, &func, NULL);
+#else
+	pthread_once (once, func);
+#endif
+}
@@ -0,0 +1,92 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_THREAD_H
+#define DC_THREAD_H
+
+#ifdef _WIN32
+#define NOGDI
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <libdivecomputer/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifdef _WIN32
+typedef HANDLE dc_thread_t;
+typedef CRITICAL_SECTION dc_mutex_t;
+typedef CONDITION_VARIABLE dc_cond_t;
+typedef INIT_ONCE dc_once_t;
+#define DC_ONCE_INIT INIT_ONCE_STATIC_INIT
+#else
+typedef pthread_t dc_thread_t;
+typedef pthread_mutex_t dc_mutex_t;
+typedef pthread_cond_t dc_cond_t;
+typedef pthread_once_t dc_once_t;
+#define DC_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+
+typedef void (*dc_thread_func_t) (void *userdata);
+
+typedef void (*dc_once_func_t) (void);
+
+dc_status_t
+dc_thread_create (dc_thread_t *thread, dc_thread_func_t func, void *userdata);
+
+void
+dc_thread_join (dc_thread_t *thread);
+
+dc_status_t
+dc_mutex_init (dc_mutex_t *mutex);
+
+void
+dc_mutex_free (dc_mutex_t *mutex);
+
+void
+dc_mutex_lock (dc_mutex_t *mutex);
+
+void
+dc_mutex_unlock (dc_mutex_t *mutex);
+
+dc_status_t
+dc_cond_init (dc_cond_t *cond);
+
+void
+dc_cond_free (dc_cond_t *cond);
+
+void
+dc_cond_wait (dc_cond_t *cond, dc_mutex_t *mutex);
+
+void
+dc_cond_broadcast (dc_cond_t *cond);
+
+void
+dc_once (dc_once_t *once, dc_once_func_t func);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_THREAD_H */
@@ -0,0 +1,448 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy
+
+#ifdef _WIN32
+#define NOGDI
+#include <windows.h>
+#endif
+
+#include "trace.h"
+#include "common-private.h"
+
+/*
+ * Every thread that records data gets its own ring buffer, with a single
+ * producer (the owning thread) and a single consumer (the draining
+ * thread). The producer only writes the head index, the consumer only
+ * writes the tail index, so no locking is required. The ring buffers
+ * are kept in a singly linked list, which only grows by atomically
+ * prepending a new node, and is freed together with the trace object.
+ */
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define ALIGNMENT 8
+#define ALIGN(x) (((x) + ALIGNMENT - 1) & ~(size_t) (ALIGNMENT - 1))
+
+#define HEADERSIZE 16
+
+typedef struct dc_trace_ring_t {
+	struct dc_trace_ring_t *next;
+	const void *owner;
+	unsigned int id;
+	size_t mask;
+	volatile size_t head;
+	volatile size_t tail;
+	size_t limit;
+	volatile unsigned int dropped;
+	unsigned char *data;
+} dc_trace_ring_t;
+
+struct dc_trace_t {
+	dc_trace_ring_t * volatile rings;
+	volatile unsigned int nrings;
+	/* Records dropped because no ring buffer could be allocated. */
+	volatile unsigned int dropped;
+	/* Next trace object in the list of retired objects. */
+	struct dc_trace_t *retired;
+	unsigned int serial;
+	size_t capacity;
+	unsigned char *scratch;
+};
+
+typedef struct dc_trace_cache_t {
+	const dc_trace_t *trace;
+	unsigned int serial;
+	dc_trace_ring_t *ring;
+} dc_trace_cache_t;
+
+static THREAD_LOCAL dc_trace_cache_t g_cache;
+
+static volatile unsigned int g_serial = 0;
+
+#if defined(_MSC_VER)
+static size_t
+load_acquire (volatile size_t *p)
+{
+	size_t value = *p;
+	MemoryBarrier ();
+	return value;
+}
+
+static void
+store_release (volatile size_t *p, size_t value)
+{
+	MemoryBarrier ();
+	*p = value;
+}
+
+static unsigned int
+fetch_add (volatile unsigned int *p, unsigned int value)
+{
+	return InterlockedExchangeAdd ((volatile LONG *) p, value);
+}
+
+static unsigned int
+exchange (volatile unsigned int *p, unsigned int value)
+{
+	return InterlockedExchange ((volatile LONG *) p, value);
+}
+
+static int
+compare_exchange (dc_trace_ring_t * volatile *p, dc_trace_ring_t *expected, dc_trace_ring_t *desired)
+{
+	return InterlockedCompareExchangePointer ((PVOID volatile *) p, desired, expected) == expected;
+}
+
+static dc_trace_t *
+load_trace (dc_trace_t * volatile *p)
+{
+	dc_trace_t *value = *p;
+	MemoryBarrier ();
+	return value;
+}
+
+static dc_trace_t *
+exchange_trace (dc_trace_t * volatile *p, dc_trace_t *value)
+{
+	return (dc_trace_t *) InterlockedExchangePointer ((PVOID volatile *) p, value);
+}
+
+static int
+compare_exchange_trace (dc_trace_t * volatile *p, dc_trace_t *expected, dc_trace_t *desired)
+{
+	return InterlockedCompareExchangePointer ((PVOID volatile *) p, desired, expected) == expected;
+}
+#else
+static size_t
+load_acquire (volatile size_t *p)
+{
+	return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+static void
+store_release (volatile size_t *p, size_t value)
+{
+	__atomic_store_n (p, value, __ATOMIC_RELEASE);
+}
+
+static unsigned int
+fetch_add (volatile unsigned int *p, unsigned int value)
+{
+	return __atomic_fetch_add (p, value, __ATOMIC_RELAXED);
+}
+
+static unsigned int
+exchange (volatile unsigned int *p, unsigned int value)
+{
+	return __atomic_exchange_n (p, value, __ATOMIC_RELAXED);
+}
+
+static int
+compare_exchange (dc_trace_ring_t * volatile *p, dc_trace_ring_t *expected, dc_trace_ring_t *desired)
+{
+	return __atomic_compare_exchange_n (p, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE);
+}
+
+static dc_trace_t *
+load_trace (dc_trace_t * volatile *p)
+{
+	return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+static dc_trace_t *
+exchange_trace (dc_trace_t * volatile *p, dc_trace_t *value)
+{
+	return __atomic_exchange_n (p, value, __ATOMIC_ACQ_REL);
+}
+
+static int
+compare_exchange_trace (dc_trace_t * volatile *p, dc_trace_t *expected, dc_trace_t *desired)
+{
+	return __atomic_compare_exchange_n (p, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+#endif
+
+static void
+dc_trace_ring_put (dc_trace_ring_t *ring, size_t offset, const unsigned char data[], size_t size)
+{
+	size_t capacity = ring->mask + 1;
+	size_t index = offset & ring->mask;
+	size_t n = capacity - index;
+	if (n > size)
+		n = size;
+
+	memcpy (ring->data + index, data, n);
+	memcpy (ring->data, data + n, size - n);
+}
+
+static void
+dc_trace_ring_get (dc_trace_ring_t *ring, size_t offset, unsigned char data[], size_t size)
+{
+	size_t capacity = ring->mask + 1;
+	size_t index = offset & ring->mask;
+	size_t n = capacity - index;
+	if (n > size)
+		n = size;
+
+	memcpy (data, ring->data + index, n);
+	memcpy (data + n, ring->data, size - n);
+}
+
+static dc_trace_ring_t *
+dc_trace_ring_find (dc_trace_t *trace)
+{
+	// Fast path: the ring buffer of the most recently used trace object.
+	if (g_cache.trace == trace && g_cache.serial == trace->serial)
+		return g_cache.ring;
+
+	// The address of a thread local variable is unique for each thread.
+	const void *owner = &g_cache;
+
+	dc_trace_ring_t *ring = trace->rings;
+	while (ring != NULL && ring->owner != owner) {
+		ring = ring->next;
+	}
+
+	if (ring == NULL) {
+		ring = (dc_trace_ring_t *) malloc (sizeof (dc_trace_ring_t));
+		if (ring == NULL)
+			return NULL;
+
+		ring->data = (unsigned char *) malloc (trace->capacity);
+		if (ring->data == NULL) {
+			free (ring);
+			return NULL;
+		}
+
+		ring->owner = owner;
+		ring->id = fetch_add (&trace->nrings, 1);
+		ring->mask = trace->capacity - 1;
+		ring->head = 0;
+		ring->tail = 0;
+		ring->limit = 0;
+		ring->dropped = 0;
+
+		// Publish the new ring buffer.
+		do {
+			ring->next = trace->rings;
+		} while (!compare_exchange (&trace->rings, ring->next, ring));
+	}
+
+	g_cache.trace = trace;
+	g_cache.serial = trace->serial;
+	g_cache.ring = ring;
+
+	return ring;
+}
+
+dc_status_t
+dc_trace_new (dc_trace_t **out, unsigned int capacity)
+{
+	dc_trace_t *trace = NULL;
+
+	if (out == NULL || capacity < 2 * HEADERSIZE)
+		return DC_STATUS_INVALIDARGS;
+
+	trace = (dc_trace_t *) malloc (sizeof (dc_trace_t));
+	if (trace == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	// Round up to the next power of two.
+	size_t n = 2 * HEADERSIZE;
+	while (n < capacity)
+		n *= 2;
+
+	trace->scratch = (unsigned char *) malloc (n);
+	if (trace->scratch == NULL) {
+		free (trace);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	trace->rings = NULL;
+	trace->nrings = 0;
+	trace->dropped = 0;
+	trace->retired = NULL;
+	trace->serial = fetch_add (&g_serial, 1) + 1;
+	trace->capacity = n;
+
+	*out = trace;
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_trace_free (dc_trace_t *trace)
+{
+	if (trace == NULL)
+		return;
+
+	dc_trace_ring_t *ring = trace->rings;
+	while (ring) {
+		dc_trace_ring_t *next = ring->next;
+		free (ring->data);
+		free (ring);
+		ring = next;
+	}
+
+	free (trace->scratch);
+	free (trace);
+}
+
+void
+dc_trace_write (dc_trace_t *trace, dc_transport_t transport, dc_direction_t direction, const unsigned char data[], unsigned int size)
+{
+	if (trace == NULL)
+		return;
+
+	unsigned long long timestamp = dc_clock_now ();
+
+	dc_trace_ring_t *ring = dc_trace_ring_find (trace);
+	if (ring == NULL) {
+		fetch_add (&trace->dropped, 1);
+		return;
+	}
+
+	size_t head = ring->head;
+	size_t tail = load_acquire (&ring->tail);
+	size_t length = HEADERSIZE + ALIGN (size);
+	if (length > ring->mask + 1 - (head - tail)) {
+		fetch_add (&ring->dropped, 1);
+		return;
+	}
+
+	unsigned char header[HEADERSIZE] = {0};
+	memcpy (header + 0, &timestamp, sizeof (timestamp));
+	memcpy (header + 8, &size, sizeof (size));
+	header[12] = transport;
+	header[13] = direction;
+
+	dc_trace_ring_put (ring, head, header, sizeof (header));
+	dc_trace_ring_put (ring, head + HEADERSIZE, data, size);
+
+	// Publish the new record.
+	store_release (&ring->head, head + length);
+}
+
+dc_status_t
+dc_trace_drain (dc_trace_t *trace, dc_trace_callback_t callback, void *userdata, unsigned int *dropped)
+{
+	if (trace == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Take a snapshot of the head index of each ring buffer. Records
+	// added after this point are left for the next call.
+	dc_trace_ring_t *rings = trace->rings;
+	unsigned int ndropped = exchange (&trace->dropped, 0);
+	for (dc_trace_ring_t *ring = rings; ring != NULL; ring = ring->next) {
+		ring->limit = load_acquire (&ring->head);
+		ndropped += exchange (&ring->dropped, 0);
+	}
+
+	while (1) {
+		// Find the oldest pending record.
+		dc_trace_ring_t *oldest = NULL;
+		unsigned long long timestamp = 0;
+		unsigned char header[HEADERSIZE];
+		for (dc_trace_ring_t *ring = rings; ring != NULL; ring = ring->next) {
+			if (ring->tail == ring->limit)
+				continue;
+
+			unsigned char h[HEADERSIZE];
+			unsigned long long t = 0;
+			dc_trace_ring_get (ring, ring->tail, h, sizeof (h));
+			memcpy (&t, h, sizeof (t));
+			if (oldest == NULL || t < timestamp) {
+				oldest = ring;
+				timestamp = t;
+				memcpy (header, h, sizeof (header));
+			}
+		}
+
+		if (oldest == NULL)
+			break;
+
+		dc_trace_record_t record;
+		unsigned int size = 0;
+		memcpy (&size, header + 8, sizeof (size));
+		dc_trace_ring_get (oldest, oldest->tail + HEADERSIZE, trace->scratch, size);
+
+		record.timestamp = timestamp;
+		record.thread = oldest->id;
+		record.transport = (dc_transport_t) header[12];
+		record.direction = (dc_direction_t) header[13];
+		record.data = trace->scratch;
+		record.size = size;
+
+		// Release the space in the ring buffer.
+		store_release (&oldest->tail, oldest->tail + HEADERSIZE + ALIGN (size));
+
+		if (callback && !callback (&record, userdata))
+			break;
+	}
+
+	if (dropped)
+		*dropped = ndropped;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_trace_t *
+dc_trace_slot_get (dc_trace_slot_t *slot)
+{
+	return load_trace (&slot->current);
+}
+
+void
+dc_trace_slot_set (dc_trace_slot_t *slot, dc_trace_t *trace)
+{
+	dc_trace_t *previous = exchange_trace (&slot->current, trace);
+	if (previous == NULL)
+		return;
+
+	// Other threads may still be using the previous trace object, so it
+	// is only retired here, and freed together with the slot.
+	do {
+		previous->retired = slot->retired;
+	} while (!compare_exchange_trace (&slot->retired, previous->retired, previous));
+}
+
+void
+dc_trace_slot_free (dc_trace_slot_t *slot)
+{
+	dc_trace_free (slot->current);
+
+	dc_trace_t *trace = slot->retired;
+	while (trace) {
+		dc_trace_t *next = trace->retired;
+		dc_trace_free (trace);
+		trace = next;
+	}
+
+	slot->current = NULL;
+	slot->retired = NULL;
+}
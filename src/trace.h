@@ -0,0 +1,140 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_TRACE_H
+#define DC_TRACE_H
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Opaque object representing a set of per-thread trace buffers.
+ */
+typedef struct dc_trace_t dc_trace_t;
+
+/**
+ * A shared reference to a trace object, which can be replaced while
+ * other threads are still recording. A replaced trace object is kept
+ * alive until the slot itself is freed, so reading the slot needs no
+ * more than a single load.
+ */
+typedef struct dc_trace_slot_t {
+	dc_trace_t * volatile current;
+	dc_trace_t * volatile retired;
+} dc_trace_slot_t;
+
+/**
+ * Create a new trace object.
+ *
+ * @param[out]  trace     A location to store the trace object.
+ * @param[in]   capacity  The capacity of each per-thread ring buffer
+ *                        (in bytes).
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_trace_new (dc_trace_t **trace, unsigned int capacity);
+
+/**
+ * Destroy the trace object and free all resources.
+ *
+ * The caller is responsible for ensuring no other thread is still
+ * recording or draining.
+ *
+ * @param[in]  trace  A valid trace object.
+ */
+void
+dc_trace_free (dc_trace_t *trace);
+
+/**
+ * Record a data transfer in the ring buffer of the calling thread.
+ *
+ * This function never blocks and never formats anything. If there is
+ * not enough free space in the ring buffer, or no ring buffer could be
+ * allocated for the calling thread, the record is dropped and counted.
+ *
+ * @param[in]  trace      A valid trace object.
+ * @param[in]  transport  The transport type.
+ * @param[in]  direction  The direction of the transfer.
+ * @param[in]  data       The transferred data.
+ * @param[in]  size       The number of bytes transferred.
+ */
+void
+dc_trace_write (dc_trace_t *trace, dc_transport_t transport, dc_direction_t direction, const unsigned char data[], unsigned int size);
+
+/**
+ * Remove all records from the ring buffers and pass them to the
+ * callback function, merged in timestamp order.
+ *
+ * Only a single thread may drain at the same time, but recording
+ * threads are never blocked.
+ *
+ * @param[in]  trace     A valid trace object.
+ * @param[in]  callback  The callback function to call.
+ * @param[in]  userdata  User data to pass to the callback function.
+ * @param[out] dropped   An (optional) location to store the number of
+ *                       dropped records since the previous call.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_trace_drain (dc_trace_t *trace, dc_trace_callback_t callback, void *userdata, unsigned int *dropped);
+
+/**
+ * Get the current trace object from the slot. The object remains valid
+ * until the slot is freed.
+ *
+ * @param[in]  slot  A valid trace slot.
+ * @returns The trace object, or NULL if tracing is disabled.
+ */
+dc_trace_t *
+dc_trace_slot_get (dc_trace_slot_t *slot);
+
+/**
+ * Replace the trace object in the slot. The slot takes ownership of the
+ * new trace object. The previous one is retired, because other threads
+ * may still be using it.
+ *
+ * @param[in]  slot   A valid trace slot.
+ * @param[in]  trace  The new trace object (or NULL).
+ */
+void
+dc_trace_slot_set (dc_trace_slot_t *slot, dc_trace_t *trace);
+
+/**
+ * Free the current and all retired trace objects.
+ *
+ * The caller is responsible for ensuring no other thread is still
+ * using the slot.
+ *
+ * @param[in]  slot  A valid trace slot.
+ */
+void
+dc_trace_slot_free (dc_trace_slot_t *slot);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_TRACE_H */
@@ -24,6 +24,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
 #define USBHID
@@ -40,9 +41,29 @@
 #include "common-private.h"
 #include "context-private.h"
 
+#if defined(HAVE_LIBUSB) && !defined(__APPLE__)
+/*
+ * The input reports are received with a number of asynchronous transfers,
+ * which are kept queued on the interrupt endpoint all the time. Thus the
+ * host controller can poll the device in every interval, instead of only
+ * while a synchronous read is in progress. The received reports are
+ * stored in a ring buffer, until they are consumed by dc_usbhid_read.
+ */
+#define NTRANSFERS 4
+#define NREPORTS   32
+#define NRETRIES   50
+
+typedef struct dc_usbhid_report_t {
+	dc_status_t status;
+	unsigned int size;
+} dc_usbhid_report_t;
+#endif
+
 struct dc_usbhid_t {
 	/* Library context. */
 	dc_context_t *context;
+	/* Transport statistics. */
+	dc_device_stats_t *stats;
 	/* Internal state. */
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
 	libusb_context *ctx;
@@ -50,7 +71,19 @@ struct dc_usbhid_t {
 	int interface;
 	unsigned char endpoint_in;
 	unsigned char endpoint_out;
+	unsigned int packetsize;
 	unsigned int timeout;
+	/* Asynchronous input transfers. */
+	struct libusb_transfer *transfers[NTRANSFERS];
+	struct libusb_transfer *idle[NTRANSFERS];
+	unsigned int nidle;
+	unsigned int npending;
+	dc_status_t error;
+	/* Ring buffer with the received reports. */
+	dc_usbhid_report_t reports[NREPORTS];
+	unsigned char *buffer;
+	unsigned int head;
+	unsigned int count;
 #elif defined(HAVE_HIDAPI)
 	hid_device *handle;
 	int timeout;
@@ -78,68 +111,108 @@ syserror(int errcode)
 		return DC_STATUS_IO;
 	}
 }
-#endif
 
 static dc_status_t
-usbhid_packet_close(dc_custom_io_t *io)
+transfer_status (enum libusb_transfer_status status)
 {
-	dc_usbhid_t *usbhid = (dc_usbhid_t *)io->userdata;
-	return dc_usbhid_close(usbhid);
+	switch (status) {
+	case LIBUSB_TRANSFER_COMPLETED:
+		return DC_STATUS_SUCCESS;
+	case LIBUSB_TRANSFER_TIMED_OUT:
+		return DC_STATUS_TIMEOUT;
+	case LIBUSB_TRANSFER_NO_DEVICE:
+		return DC_STATUS_NODEVICE;
+	default:
+		return DC_STATUS_IO;
+	}
 }
 
-static dc_status_t
-usbhid_packet_read(dc_custom_io_t *io, void* data, size_t size, size_t *actual)
+static void
+dc_usbhid_submit (dc_usbhid_t *usbhid)
 {
-	dc_usbhid_t *usbhid = (dc_usbhid_t *)io->userdata;
-	return dc_usbhid_read(usbhid, data, size, actual);
-}
+	// Submit the idle transfers, but only as long as there is enough free
+	// space in the ring buffer to store the reports of all pending transfers.
+	while (usbhid->nidle && usbhid->error == DC_STATUS_SUCCESS &&
+		usbhid->count + usbhid->npending < NREPORTS) {
+		struct libusb_transfer *transfer = usbhid->idle[usbhid->nidle - 1];
+
+		int rc = libusb_submit_transfer (transfer);
+		if (rc != LIBUSB_SUCCESS) {
+			ERROR (usbhid->context, "Failed to submit the usb transfer (%s).",
+				libusb_error_name (rc));
+			usbhid->error = syserror (rc);
+			break;
+		}
 
-static dc_status_t
-usbhid_packet_write(dc_custom_io_t *io, const void* data, size_t size, size_t *actual)
-{
-	dc_usbhid_t *usbhid = (dc_usbhid_t *)io->userdata;
-	return dc_usbhid_write(usbhid, data, size, actual);
+		usbhid->nidle--;
+		usbhid->npending++;
+	}
 }
 
-dc_status_t
-dc_usbhid_custom_io (dc_context_t *context, unsigned int vid, unsigned int pid)
+static void LIBUSB_CALL
+dc_usbhid_callback (struct libusb_transfer *transfer)
 {
-	dc_usbhid_t *usbhid;
-	dc_status_t status;
+	dc_usbhid_t *usbhid = (dc_usbhid_t *) transfer->user_data;
 
-	static dc_custom_io_t custom = {
-		.packet_size = 64,
-		.packet_close = usbhid_packet_close,
-		.packet_read  = usbhid_packet_read,
-		.packet_write = usbhid_packet_write,
-	};
+	usbhid->idle[usbhid->nidle++] = transfer;
+	usbhid->npending--;
 
-	status = dc_usbhid_open(&usbhid, context, vid, pid);
-	if (status != DC_STATUS_SUCCESS)
-		return status;
+	if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+		return;
 
-	custom.userdata = (void *)usbhid;
-	dc_context_set_custom_io(context, &custom, NULL);
+	// Append the report to the ring buffer.
+	unsigned int index = (usbhid->head + usbhid->count) % NREPORTS;
+	usbhid->reports[index].status = transfer_status (transfer->status);
+	usbhid->reports[index].size = transfer->actual_length;
+	memcpy (usbhid->buffer + index * usbhid->packetsize, transfer->buffer, transfer->actual_length);
+	usbhid->count++;
 
-	dc_usbhid_set_timeout(usbhid, 10);
+	// Queue the transfer again. After a failure, this is postponed until
+	// the error has been reported by dc_usbhid_read.
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+		dc_usbhid_submit (usbhid);
+}
 
-	/* Get rid of any pending stale input first */
-	/* NOTE! This will cause an annoying warning from dc_usbhid_read() */
-	for (;;) {
-		size_t transferred = 0;
-		unsigned char buf[64];
+/*
+ * Cancel the pending transfers and wait until libusb has returned them.
+ * Returns the number of transfers that are still pending afterwards.
+ */
+static unsigned int
+dc_usbhid_cancel (dc_usbhid_t *usbhid)
+{
+	for (unsigned int i = 0; i < NTRANSFERS; ++i) {
+		if (usbhid->transfers[i])
+			libusb_cancel_transfer (usbhid->transfers[i]);
+	}
 
-		dc_status_t rc = dc_usbhid_read(usbhid, buf, sizeof(buf), &transferred);
-		if (rc != DC_STATUS_SUCCESS)
-			break;
-		if (!transferred)
-			break;
+	// Wait until all the cancelled transfers have completed. Errors are
+	// retried, because libusb still owns the pending transfers.
+	unsigned int nretries = 0;
+	while (usbhid->npending && nretries < NRETRIES) {
+		struct timeval tv = {0, 100000};
+		int rc = libusb_handle_events_timeout (usbhid->ctx, &tv);
+		if (rc != LIBUSB_SUCCESS && rc != LIBUSB_ERROR_INTERRUPTED) {
+			WARNING (usbhid->context, "Failed to handle the usb events (%s).",
+				libusb_error_name (rc));
+		}
+		nretries++;
 	}
 
-	dc_usbhid_set_timeout(usbhid, 5000);
+	return usbhid->npending;
+}
 
-	return DC_STATUS_SUCCESS;
+static void
+dc_usbhid_free_transfers (dc_usbhid_t *usbhid)
+{
+	for (unsigned int i = 0; i < NTRANSFERS; ++i) {
+		libusb_free_transfer (usbhid->transfers[i]);
+		usbhid->transfers[i] = NULL;
+	}
+
+	free (usbhid->buffer);
+	usbhid->buffer = NULL;
 }
+#endif
 
 dc_status_t
 dc_usbhid_open (dc_usbhid_t **out, dc_context_t *context, unsigned int vid, unsigned int pid)
@@ -163,6 +236,7 @@ dc_usbhid_open (dc_usbhid_t **out, dc_context_t *context, unsigned int vid, unsi
 
 	// Library context.
 	usbhid->context = context;
+	usbhid->stats = NULL;
 
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
 	struct libusb_device **devices = NULL;
@@ -266,7 +340,17 @@ dc_usbhid_open (dc_usbhid_t **out, dc_context_t *context, unsigned int vid, unsi
 	usbhid->interface = interface->bInterfaceNumber;
 	usbhid->endpoint_in = ep_in->bEndpointAddress;
 	usbhid->endpoint_out = ep_out->bEndpointAddress;
+	usbhid->packetsize = ep_in->wMaxPacketSize;
 	usbhid->timeout = 0;
+	usbhid->nidle = 0;
+	usbhid->npending = 0;
+	usbhid->error = DC_STATUS_SUCCESS;
+	usbhid->buffer = NULL;
+	usbhid->head = 0;
+	usbhid->count = 0;
+	for (unsigned int i = 0; i < NTRANSFERS; ++i) {
+		usbhid->transfers[i] = NULL;
+	}
 
 	INFO (context, "Open: interface=%u, endpoints=%02x,%02x",
 		usbhid->interface, usbhid->endpoint_in, usbhid->endpoint_out);
@@ -293,6 +377,34 @@ dc_usbhid_open (dc_usbhid_t **out, dc_context_t *context, unsigned int vid, unsi
 		goto error_usb_close;
 	}
 
+	// Allocate the ring buffer and the input transfers.
+	usbhid->buffer = (unsigned char *) malloc (NREPORTS * usbhid->packetsize);
+	if (usbhid->buffer == NULL) {
+		ERROR (context, "Out of memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_usb_release;
+	}
+
+	for (unsigned int i = 0; i < NTRANSFERS; ++i) {
+		struct libusb_transfer *transfer = libusb_alloc_transfer (0);
+		unsigned char *buffer = (unsigned char *) malloc (usbhid->packetsize);
+		if (transfer == NULL || buffer == NULL) {
+			ERROR (context, "Out of memory.");
+			libusb_free_transfer (transfer);
+			free (buffer);
+			status = DC_STATUS_NOMEMORY;
+			goto error_usb_free_transfers;
+		}
+
+		libusb_fill_interrupt_transfer (transfer, usbhid->handle,
+			usbhid->endpoint_in, buffer, usbhid->packetsize,
+			dc_usbhid_callback, usbhid, 0);
+		transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+
+		usbhid->transfers[i] = transfer;
+		usbhid->idle[usbhid->nidle++] = transfer;
+	}
+
 	libusb_free_config_descriptor (config);
 	libusb_free_device_list (devices, 1);
 
@@ -322,6 +434,10 @@ dc_usbhid_open (dc_usbhid_t **out, dc_context_t *context, unsigned int vid, unsi
 	return DC_STATUS_SUCCESS;
 
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
+error_usb_free_transfers:
+	dc_usbhid_free_transfers (usbhid);
+error_usb_release:
+	libusb_release_interface (usbhid->handle, usbhid->interface);
 error_usb_close:
 	libusb_close (usbhid->handle);
 error_usb_free_config:
@@ -352,6 +468,13 @@ dc_usbhid_close (dc_usbhid_t *usbhid)
 		return DC_STATUS_SUCCESS;
 
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
+	if (dc_usbhid_cancel (usbhid)) {
+		// The completion callbacks of the pending transfers still
+		// write into the object, so it's leaked instead of freed.
+		ERROR (usbhid->context, "Failed to cancel the pending transfers.");
+		return DC_STATUS_IO;
+	}
+	dc_usbhid_free_transfers (usbhid);
 	libusb_release_interface (usbhid->handle, usbhid->interface);
 	libusb_close (usbhid->handle);
 	libusb_exit (usbhid->ctx);
@@ -367,6 +490,15 @@ dc_usbhid_close (dc_usbhid_t *usbhid)
 #endif
 }
 
+void
+dc_usbhid_set_stats (dc_usbhid_t *usbhid, dc_device_stats_t *stats)
+{
+	if (usbhid == NULL)
+		return;
+
+	usbhid->stats = stats;
+}
+
 dc_status_t
 dc_usbhid_set_timeout (dc_usbhid_t *usbhid, int timeout)
 {
@@ -410,12 +542,63 @@ dc_usbhid_read (dc_usbhid_t *usbhid, void *data, size_t size, size_t *actual)
 		goto out_invalidargs;
 	}
 
+	unsigned long long begin = dc_clock_now ();
+
 #if defined(HAVE_LIBUSB) && !defined(__APPLE__)
-	int rc = libusb_interrupt_transfer (usbhid->handle, usbhid->endpoint_in, data, size, &nbytes, usbhid->timeout);
-	if (rc != LIBUSB_SUCCESS) {
-		ERROR (usbhid->context, "Usb read interrupt transfer failed (%s).",
-			libusb_error_name (rc));
-		status = syserror (rc);
+	unsigned long long deadline = begin + usbhid->timeout * 1000ULL;
+
+	// Make sure the input transfers are queued.
+	dc_usbhid_submit (usbhid);
+
+	// Wait for a report to arrive.
+	while (usbhid->count == 0) {
+		if (usbhid->error != DC_STATUS_SUCCESS) {
+			// Report the error only once.
+			status = usbhid->error;
+			usbhid->error = DC_STATUS_SUCCESS;
+			goto out;
+		}
+
+		int rc = LIBUSB_SUCCESS;
+		if (usbhid->timeout == 0) {
+			rc = libusb_handle_events (usbhid->ctx);
+		} else {
+			unsigned long long now = dc_clock_now ();
+			if (now >= deadline) {
+				ERROR (usbhid->context, "Usb read interrupt transfer failed (%s).",
+					libusb_error_name (LIBUSB_ERROR_TIMEOUT));
+				status = DC_STATUS_TIMEOUT;
+				goto out;
+			}
+
+			struct timeval tv;
+			tv.tv_sec = (deadline - now) / 1000000;
+			tv.tv_usec = (deadline - now) % 1000000;
+			rc = libusb_handle_events_timeout (usbhid->ctx, &tv);
+		}
+		if (rc != LIBUSB_SUCCESS && rc != LIBUSB_ERROR_INTERRUPTED) {
+			ERROR (usbhid->context, "Failed to handle the usb events (%s).",
+				libusb_error_name (rc));
+			status = syserror (rc);
+			goto out;
+		}
+	}
+
+	// Remove the oldest report from the ring buffer.
+	dc_usbhid_report_t *report = &usbhid->reports[usbhid->head];
+	nbytes = report->size;
+	if (nbytes > size)
+		nbytes = size;
+	memcpy (data, usbhid->buffer + usbhid->head * usbhid->packetsize, nbytes);
+	status = report->status;
+	usbhid->head = (usbhid->head + 1) % NREPORTS;
+	usbhid->count--;
+
+	// Queue the transfers that were waiting for free space.
+	dc_usbhid_submit (usbhid);
+
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (usbhid->context, "Usb read interrupt transfer failed.");
 		goto out;
 	}
 #elif defined(HAVE_HIDAPI)
@@ -429,6 +612,8 @@ dc_usbhid_read (dc_usbhid_t *usbhid, void *data, size_t size, size_t *actual)
 
 out:
 	HEXDUMP (usbhid->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
+	TRACE (usbhid->context, DC_TRANSPORT_USB, DC_DIRECTION_INPUT, (unsigned char *) data, nbytes);
+	dc_stats_read (usbhid->stats, nbytes, status, begin);
 
 out_invalidargs:
 	if (actual)
@@ -471,6 +656,8 @@ dc_usbhid_write (dc_usbhid_t *usbhid, const void *data, size_t size, size_t *act
 
 out:
 	HEXDUMP (usbhid->context, DC_LOGLEVEL_INFO, "Write", (unsigned char *) data, nbytes);
+	TRACE (usbhid->context, DC_TRANSPORT_USB, DC_DIRECTION_OUTPUT, (unsigned char *) data, nbytes);
+	dc_stats_write (usbhid->stats, nbytes, status);
 
 out_invalidargs:
 	if (actual)
@@ -24,6 +24,7 @@
 
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/context.h>
+#include <libdivecomputer/device.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +58,15 @@ dc_usbhid_open (dc_usbhid_t **usbhid, dc_context_t *context, unsigned int vid, u
 dc_status_t
 dc_usbhid_close (dc_usbhid_t *usbhid);
 
+/**
+ * Attach the transport statistics of a device to the connection.
+ *
+ * @param[in]  usbhid  A valid USB HID connection.
+ * @param[in]  stats   The statistics to update, or NULL to stop counting.
+ */
+void
+dc_usbhid_set_stats (dc_usbhid_t *usbhid, dc_device_stats_t *stats);
+
 /**
  * Set the read timeout.
  *
@@ -116,10 +126,6 @@ dc_usbhid_read (dc_usbhid_t *usbhid, void *data, size_t size, size_t *actual);
 dc_status_t
 dc_usbhid_write (dc_usbhid_t *usbhid, const void *data, size_t size, size_t *actual);
 
-/* Create a dc_custom_io_t that uses usbhid for packet transfer */
-dc_status_t
-dc_usbhid_custom_io(dc_context_t *context, unsigned int vid, unsigned int pid);
-
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
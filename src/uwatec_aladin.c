@@ -65,9 +65,6 @@ static const dc_device_vtable_t uwatec_aladin_device_vtable = {
 	uwatec_aladin_device_close /* close */
 };
 
-static dc_status_t
-uwatec_aladin_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 uwatec_aladin_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -97,6 +94,9 @@ uwatec_aladin_device_open (dc_device_t **out, dc_context_t *context, const char
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (19200 8N1).
 	status = dc_serial_configure (device->port, 19200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -257,6 +257,8 @@ uwatec_aladin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 uwatec_aladin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	uwatec_aladin_device_t *device = (uwatec_aladin_device_t *) abstract;
+
 	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
@@ -275,7 +277,7 @@ uwatec_aladin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback
 	devinfo.serial = array_uint24_be (data + HEADER + 0x7ed);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = uwatec_aladin_extract_dives (abstract,
+	rc = uwatec_aladin_extract_dives (abstract->context, device->timestamp,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -284,14 +286,9 @@ uwatec_aladin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback
 }
 
 
-static dc_status_t
-uwatec_aladin_extract_dives (dc_device_t *abstract, const unsigned char* data, unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+uwatec_aladin_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	uwatec_aladin_device_t *device = (uwatec_aladin_device_t*) abstract;
-
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	if (size < SZ_MEMORY)
 		return DC_STATUS_DATAFORMAT;
 
@@ -384,8 +381,7 @@ uwatec_aladin_extract_dives (dc_device_t *abstract, const unsigned char* data, u
 		}
 
 		// Automatically abort when a dive is older than the provided timestamp.
-		unsigned int timestamp = array_uint32_le (buffer + 11);
-		if (device && timestamp <= device->timestamp)
+		if (array_uint32_le (buffer + 11) <= timestamp)
 			return DC_STATUS_SUCCESS;
 
 		if (callback && !callback (buffer, len + 18, buffer + 11, 4, userdata))
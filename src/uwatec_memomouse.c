@@ -61,9 +61,6 @@ static const dc_device_vtable_t uwatec_memomouse_device_vtable = {
 	uwatec_memomouse_device_close /* close */
 };
 
-static dc_status_t
-uwatec_memomouse_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 uwatec_memomouse_device_open (dc_device_t **out, dc_context_t *context, const char *name)
 {
@@ -93,6 +90,9 @@ uwatec_memomouse_device_open (dc_device_t **out, dc_context_t *context, const ch
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (9600 8N1).
 	status = dc_serial_configure (device->port, 9600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -493,8 +493,23 @@ uwatec_memomouse_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 		return rc;
 	}
 
-	rc = uwatec_memomouse_extract_dives (abstract,
-		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
+	// A memomouse can store data from several dive computers, but only
+	// the data of the connected dive computer can be transferred.
+	// Therefore, the device info will be the same for all dives, and
+	// only needs to be reported once.
+	const unsigned char *data = dc_buffer_get_data (buffer);
+	unsigned int size = dc_buffer_get_size (buffer);
+	if (size >= 5 + 18) {
+		// Emit a device info event.
+		dc_event_devinfo_t devinfo;
+		devinfo.model = data[5 + 3];
+		devinfo.firmware = 0;
+		devinfo.serial = array_uint24_be (data + 5);
+		device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+	}
+
+	rc = uwatec_memomouse_extract_dives (abstract->context, 0,
+		data, size, callback, userdata);
 
 	dc_buffer_free (buffer);
 
@@ -502,12 +517,9 @@ uwatec_memomouse_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 }
 
 
-static dc_status_t
-uwatec_memomouse_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+uwatec_memomouse_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	// Parse the data stream to find the total number of dives.
 	unsigned int ndives = 0;
 	unsigned int previous = 0;
@@ -530,19 +542,6 @@ uwatec_memomouse_extract_dives (dc_device_t *abstract, const unsigned char data[
 		if (current + len + 18 > size)
 			return DC_STATUS_DATAFORMAT;
 
-		// A memomouse can store data from several dive computers, but only
-		// the data of the connected dive computer can be transferred.
-		// Therefore, the device info will be the same for all dives, and
-		// only needs to be reported once.
-		if (abstract && ndives == 0) {
-			// Emit a device info event.
-			dc_event_devinfo_t devinfo;
-			devinfo.model = data[current + 3];
-			devinfo.firmware = 0;
-			devinfo.serial = array_uint24_be (data + current);
-			device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
-		}
-
 		// Move to the next dive.
 		previous = current;
 		current += len + 18;
@@ -568,6 +567,10 @@ uwatec_memomouse_extract_dives (dc_device_t *abstract, const unsigned char data[
 		// Get the length of the profile data.
 		unsigned int length = array_uint16_le (data + offset + 16);
 
+		// Automatically abort when a dive is older than the provided timestamp.
+		if (timestamp && array_uint32_le (data + offset + 11) <= timestamp)
+			return DC_STATUS_SUCCESS;
+
 		if (callback && !callback (data + offset, length + 18, data + offset + 11, 4, userdata))
 			return DC_STATUS_SUCCESS;
 	}
@@ -59,9 +59,6 @@ static const dc_device_vtable_t uwatec_meridian_device_vtable = {
 	uwatec_meridian_device_close /* close */
 };
 
-static dc_status_t
-uwatec_meridian_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static dc_status_t
 uwatec_meridian_transfer (uwatec_meridian_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
 {
@@ -210,6 +207,9 @@ uwatec_meridian_device_open (dc_device_t **out, dc_context_t *context, const cha
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (57600 8N1).
 	status = dc_serial_configure (device->port, 57600, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -459,7 +459,7 @@ uwatec_meridian_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 		return rc;
 	}
 
-	rc = uwatec_meridian_extract_dives (abstract,
+	rc = uwatec_meridian_extract_dives (abstract->context, 0,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -468,12 +468,9 @@ uwatec_meridian_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 }
 
 
-static dc_status_t
-uwatec_meridian_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+uwatec_meridian_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	const unsigned char header[4] = {0xa5, 0xa5, 0x5a, 0x5a};
 
 	// Search the data stream for start markers.
@@ -489,6 +486,10 @@ uwatec_meridian_extract_dives (dc_device_t *abstract, const unsigned char data[]
 			if (current + len > previous)
 				return DC_STATUS_DATAFORMAT;
 
+			// Automatically abort when a dive is older than the provided timestamp.
+			if (timestamp && array_uint32_le (data + current + 8) <= timestamp)
+				return DC_STATUS_SUCCESS;
+
 			if (callback && !callback (data + current, len, data + current + 8, 4, userdata))
 				return DC_STATUS_SUCCESS;
 
@@ -25,14 +25,14 @@
 #include "uwatec_smart.h"
 #include "context-private.h"
 #include "device-private.h"
-#include "irda.h"
+#include "iostream.h"
 #include "array.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &uwatec_smart_device_vtable)
 
 typedef struct uwatec_smart_device_t {
 	dc_device_t base;
-	dc_irda_t *socket;
+	dc_iostream_t *iostream;
 	unsigned int address;
 	unsigned int timestamp;
 	unsigned int devtime;
@@ -55,9 +55,6 @@ static const dc_device_vtable_t uwatec_smart_device_vtable = {
 	uwatec_smart_device_close /* close */
 };
 
-static dc_status_t
-uwatec_smart_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static void
 uwatec_smart_discovery (unsigned int address, const char *name, unsigned int charset, unsigned int hints, void *userdata)
 {
@@ -87,13 +84,13 @@ uwatec_smart_transfer (uwatec_smart_device_t *device, const unsigned char comman
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 
-	status = dc_irda_write (device->socket, command, csize, NULL);
+	status = dc_iostream_write (device->iostream, command, csize, NULL);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to send the command.");
 		return status;
 	}
 
-	status = dc_irda_read (device->socket, answer, asize, NULL);
+	status = dc_iostream_read (device->iostream, answer, asize, NULL);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to receive the answer.");
 		return status;
@@ -145,6 +142,7 @@ uwatec_smart_device_open (dc_device_t **out, dc_context_t *context)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	uwatec_smart_device_t *device = NULL;
+	dc_irda_t *socket = NULL;
 
 	if (out == NULL)
 		return DC_STATUS_INVALIDARGS;
@@ -157,21 +155,21 @@ uwatec_smart_device_open (dc_device_t **out, dc_context_t *context)
 	}
 
 	// Set the default values.
-	device->socket = NULL;
+	device->iostream = NULL;
 	device->address = 0;
 	device->timestamp = 0;
 	device->systime = (dc_ticks_t) -1;
 	device->devtime = 0;
 
 	// Open the irda socket.
-	status = dc_irda_open (&device->socket, context);
+	status = dc_irda_open (&socket, context);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to open the irda socket.");
 		goto error_free;
 	}
 
 	// Discover the device.
-	status = dc_irda_discover (device->socket, uwatec_smart_discovery, device);
+	status = dc_irda_discover (socket, uwatec_smart_discovery, device);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to discover the device.");
 		goto error_close;
@@ -184,12 +182,21 @@ uwatec_smart_device_open (dc_device_t **out, dc_context_t *context)
 	}
 
 	// Connect the device.
-	status = dc_irda_connect_lsap (device->socket, device->address, 1);
+	status = dc_irda_connect_lsap (socket, device->address, 1);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to connect the device.");
 		goto error_close;
 	}
 
+	// From now on, the socket is owned by the I/O stream.
+	status = dc_irda_iostream_open (&device->iostream, context, socket);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_close;
+	}
+
+	// Collect the transport statistics.
+	dc_iostream_set_stats (device->iostream, &device->base.stats);
+
 	// Perform the handshaking.
 	status = uwatec_smart_handshake (device);
 	if (status != DC_STATUS_SUCCESS) {
@@ -202,7 +209,10 @@ uwatec_smart_device_open (dc_device_t **out, dc_context_t *context)
 	return DC_STATUS_SUCCESS;
 
 error_close:
-	dc_irda_close (device->socket);
+	if (device->iostream)
+		dc_iostream_close (device->iostream);
+	else
+		dc_irda_close (socket);
 error_free:
 	dc_device_deallocate ((dc_device_t *) device);
 	return status;
@@ -217,7 +227,7 @@ uwatec_smart_device_close (dc_device_t *abstract)
 	dc_status_t rc = DC_STATUS_SUCCESS;
 
 	// Close the device.
-	rc = dc_irda_close (device->socket);
+	rc = dc_iostream_close (device->iostream);
 	if (status != DC_STATUS_SUCCESS) {
 		dc_status_set_error(&status, rc);
 	}
@@ -361,7 +371,7 @@ uwatec_smart_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 
 		// Increase the packet size if more data is immediately available.
 		size_t available = 0;
-		rc = dc_irda_get_available (device->socket, &available);
+		rc = dc_iostream_get_available (device->iostream, &available);
 		if (rc == DC_STATUS_SUCCESS && available > len)
 			len = available;
 
@@ -369,7 +379,7 @@ uwatec_smart_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		if (nbytes + len > length)
 			len = length - nbytes;
 
-		rc = dc_irda_read (device->socket, data + nbytes, len, NULL);
+		rc = dc_iostream_read (device->iostream, data + nbytes, len, NULL);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to receive the answer.");
 			return rc;
@@ -399,7 +409,7 @@ uwatec_smart_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 		return rc;
 	}
 
-	rc = uwatec_smart_extract_dives (abstract,
+	rc = uwatec_smart_extract_dives (abstract->context, 0,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
@@ -408,12 +418,9 @@ uwatec_smart_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 }
 
 
-static dc_status_t
-uwatec_smart_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+dc_status_t
+uwatec_smart_extract_dives (dc_context_t *context, unsigned int timestamp, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
-	if (abstract && !ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	const unsigned char header[4] = {0xa5, 0xa5, 0x5a, 0x5a};
 
 	// Search the data stream for start markers.
@@ -426,8 +433,14 @@ uwatec_smart_extract_dives (dc_device_t *abstract, const unsigned char data[], u
 			unsigned int len = array_uint32_le (data + current + 4);
 
 			// Check for a buffer overflow.
-			if (current + len > previous)
+			if (current + len > previous) {
+				ERROR (context, "Buffer overflow detected!");
 				return DC_STATUS_DATAFORMAT;
+			}
+
+			// Automatically abort when a dive is older than the provided timestamp.
+			if (timestamp && array_uint32_le (data + current + 8) <= timestamp)
+				return DC_STATUS_SUCCESS;
 
 			if (callback && !callback (data + current, len, data + current + 8, 4, userdata))
 				return DC_STATUS_SUCCESS;
@@ -128,6 +128,23 @@ typedef struct uwatec_smart_tank_t {
 	unsigned int gasmix;
 } uwatec_smart_tank_t;
 
+typedef struct uwatec_smart_checkpoint_t {
+	unsigned int offset;
+	unsigned int time;
+	unsigned int rbt;
+	unsigned int tank;
+	unsigned int gasmix;
+	unsigned int heartrate;
+	unsigned int bearing;
+	unsigned int bookmark;
+	int calibrated;
+	double depth, depth_calibration;
+	double temperature;
+	double pressure;
+	int have_depth, have_temperature, have_pressure, have_rbt,
+		have_heartrate, have_bearing;
+} uwatec_smart_checkpoint_t;
+
 typedef struct uwatec_smart_parser_t uwatec_smart_parser_t;
 
 struct uwatec_smart_parser_t {
@@ -141,6 +158,7 @@ struct uwatec_smart_parser_t {
 	unsigned int nsamples;
 	const uwatec_smart_event_info_t *events[NEVENTS];
 	unsigned int nevents[NEVENTS];
+	sample_decoder_t decoder;
 	// Cached fields.
 	unsigned int cached;
 	unsigned int trimix;
@@ -150,12 +168,18 @@ struct uwatec_smart_parser_t {
 	uwatec_smart_tank_t tank[NGASMIXES];
 	dc_water_t watertype;
 	dc_divemode_t divemode;
+	sample_statistics_t statistics;
+	sample_index_t index;
+	uwatec_smart_checkpoint_t checkpoint[SAMPLE_INDEX_SIZE];
 };
 
 static dc_status_t uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
 static dc_status_t uwatec_smart_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t uwatec_smart_parser_samples_range (dc_parser_t *abstract, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata);
+static dc_status_t uwatec_smart_parser_decode_smart (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata);
+static dc_status_t uwatec_smart_parser_decode_galileo (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t uwatec_smart_parser_vtable = {
 	sizeof(uwatec_smart_parser_t),
@@ -164,6 +188,7 @@ static const dc_parser_vtable_t uwatec_smart_parser_vtable = {
 	uwatec_smart_parser_get_datetime, /* datetime */
 	uwatec_smart_parser_get_field, /* fields */
 	uwatec_smart_parser_samples_foreach, /* samples_foreach */
+	uwatec_smart_parser_samples_range, /* samples_range */
 	NULL /* destroy */
 };
 
@@ -569,6 +594,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_pro_header;
 		parser->samples = uwatec_smart_pro_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_pro_samples);
+		parser->decoder = uwatec_smart_parser_decode_smart;
 		parser->events[0] = uwatec_smart_tec_events_0;
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_tec_events_0);
 		break;
@@ -582,6 +608,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_galileo_header;
 		parser->samples = uwatec_smart_galileo_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_galileo_samples);
+		parser->decoder = uwatec_smart_parser_decode_galileo;
 		parser->events[0] = uwatec_smart_galileo_events_0;
 		parser->events[1] = uwatec_smart_galileo_events_1;
 		parser->events[2] = uwatec_smart_galileo_events_2;
@@ -594,6 +621,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_aladin_tec_header;
 		parser->samples = uwatec_smart_aladin_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_aladin_samples);
+		parser->decoder = uwatec_smart_parser_decode_smart;
 		parser->events[0] = uwatec_smart_aladintec_events_0;
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_aladintec_events_0);
 		break;
@@ -602,6 +630,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_aladin_tec2g_header;
 		parser->samples = uwatec_smart_aladin_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_aladin_samples);
+		parser->decoder = uwatec_smart_parser_decode_smart;
 		parser->events[0] = uwatec_smart_aladintec2g_events_0;
 		parser->events[1] = uwatec_smart_aladintec2g_events_1;
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_aladintec2g_events_0);
@@ -612,6 +641,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_com_header;
 		parser->samples = uwatec_smart_com_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_com_samples);
+		parser->decoder = uwatec_smart_parser_decode_smart;
 		parser->events[0] = uwatec_smart_tec_events_0;
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_tec_events_0);
 		break;
@@ -621,6 +651,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 		parser->header = &uwatec_smart_tec_header;
 		parser->samples = uwatec_smart_tec_samples;
 		parser->nsamples = C_ARRAY_SIZE (uwatec_smart_tec_samples);
+		parser->decoder = uwatec_smart_parser_decode_smart;
 		parser->events[0] = uwatec_smart_tec_events_0;
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_tec_events_0);
 		break;
@@ -644,6 +675,8 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 	}
 	parser->watertype = DC_WATER_FRESH;
 	parser->divemode = DC_DIVEMODE_OC;
+	sample_statistics_init (&parser->statistics, NULL, NULL);
+	sample_index_reset (&parser->index);
 
 	*out = (dc_parser_t*) parser;
 
@@ -676,6 +709,8 @@ uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	}
 	parser->watertype = DC_WATER_FRESH;
 	parser->divemode = DC_DIVEMODE_OC;
+	sample_statistics_init (&parser->statistics, NULL, NULL);
+	sample_index_reset (&parser->index);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -750,6 +785,8 @@ uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsi
 		case DC_FIELD_MAXDEPTH:
 			*((double *) value) = array_uint16_le (data + table->maxdepth) / 100.0 / salinity;
 			break;
+		case DC_FIELD_AVGDEPTH:
+			return sample_statistics_get_field (&parser->statistics, type, flags, value);
 		case DC_FIELD_GASMIX_COUNT:
 			*((unsigned int *) value) = parser->ngasmixes;
 			break;
@@ -778,7 +815,7 @@ uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsi
 			break;
 		case DC_FIELD_TEMPERATURE_MAXIMUM:
 			if (table->temp_maximum == UNSUPPORTED)
-				return DC_STATUS_UNSUPPORTED;
+				return sample_statistics_get_field (&parser->statistics, type, flags, value);
 			*((double *) value) = (signed short) array_uint16_le (data + table->temp_maximum) / 10.0;
 			break;
 		case DC_FIELD_TEMPERATURE_SURFACE:
@@ -863,10 +900,11 @@ uwatec_smart_fixsignbit (unsigned int x, unsigned int n)
 }
 
 
-static dc_status_t
-uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+SAMPLE_DECODER_INLINE dc_status_t
+uwatec_smart_parser_decode (dc_parser_t *abstract, const void *checkpoint, unsigned int end, dc_sample_callback_t callback, void *userdata, const unsigned int galileo)
 {
-	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t*) abstract;
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
+	const uwatec_smart_checkpoint_t *start = (const uwatec_smart_checkpoint_t *) checkpoint;
 
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
@@ -876,6 +914,14 @@ uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
+	// Collect the profile statistics during the first pass.
+	sample_statistics_t statistics;
+	if (parser->cached < PROFILE && start == NULL) {
+		sample_statistics_init (&statistics, callback, userdata);
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	const uwatec_smart_sample_info_t *table = parser->samples;
 	unsigned int entries = parser->nsamples;
 	unsigned int header = parser->headersize;
@@ -921,14 +967,66 @@ uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t
 		have_heartrate = 0, have_bearing = 0;
 
 	unsigned int offset = header;
+
+	// Resume from a checkpoint.
+	if (start) {
+		offset = start->offset;
+		time = start->time;
+		rbt = start->rbt;
+		tank = start->tank;
+		gasmix = start->gasmix;
+		heartrate = start->heartrate;
+		bearing = start->bearing;
+		bookmark = start->bookmark;
+		calibrated = start->calibrated;
+		depth = start->depth;
+		depth_calibration = start->depth_calibration;
+		temperature = start->temperature;
+		pressure = start->pressure;
+		have_depth = start->have_depth;
+		have_temperature = start->have_temperature;
+		have_pressure = start->have_pressure;
+		have_rbt = start->have_rbt;
+		have_heartrate = start->have_heartrate;
+		have_bearing = start->have_bearing;
+	}
+
 	while (offset < size) {
 		dc_sample_value_t sample = {0};
 
+		// Stop after the end of the requested time window.
+		if (time > end)
+			break;
+
+		// Save the decoder state at regular time intervals.
+		int slot = sample_index_add (&parser->index, time,
+			parser->checkpoint, sizeof (parser->checkpoint[0]));
+		if (slot >= 0) {
+			uwatec_smart_checkpoint_t *checkpoint = parser->checkpoint + slot;
+			checkpoint->offset = offset;
+			checkpoint->time = time;
+			checkpoint->rbt = rbt;
+			checkpoint->tank = tank;
+			checkpoint->gasmix = gasmix;
+			checkpoint->heartrate = heartrate;
+			checkpoint->bearing = bearing;
+			checkpoint->bookmark = bookmark;
+			checkpoint->calibrated = calibrated;
+			checkpoint->depth = depth;
+			checkpoint->depth_calibration = depth_calibration;
+			checkpoint->temperature = temperature;
+			checkpoint->pressure = pressure;
+			checkpoint->have_depth = have_depth;
+			checkpoint->have_temperature = have_temperature;
+			checkpoint->have_pressure = have_pressure;
+			checkpoint->have_rbt = have_rbt;
+			checkpoint->have_heartrate = have_heartrate;
+			checkpoint->have_bearing = have_bearing;
+		}
+
 		// Process the type bits in the bitstream.
 		unsigned int id = 0;
-		if (parser->model == GALILEO || parser->model == GALILEOTRIMIX ||
-			parser->model == ALADIN2G || parser->model == MERIDIAN ||
-			parser->model == CHROMIS || parser->model == MANTIS2) {
+		if (galileo) {
 			// Uwatec Galileo
 			id = uwatec_galileo_identify (data[offset]);
 		} else {
@@ -1199,7 +1297,48 @@ uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t
 		}
 	}
 
-	parser->cached = PROFILE;
+	// Stopped before the end of the profile.
+	if (offset < size)
+		return DC_STATUS_SUCCESS;
+
+	parser->index.complete = 1;
+
+	// Cache the profile data.
+	if (parser->cached < PROFILE && start == NULL) {
+		parser->statistics = statistics;
+		parser->cached = PROFILE;
+	}
 
 	return DC_STATUS_SUCCESS;
 }
+
+SAMPLE_DECODER (uwatec_smart_parser_decode_smart, uwatec_smart_parser_decode, 0)
+SAMPLE_DECODER (uwatec_smart_parser_decode_galileo, uwatec_smart_parser_decode, 1)
+
+static dc_status_t
+uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t*) abstract;
+
+	return parser->decoder (abstract, NULL, 0xFFFFFFFF, callback, userdata);
+}
+
+static dc_status_t
+uwatec_smart_parser_samples_range (dc_parser_t *abstract, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata)
+{
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t*) abstract;
+
+	// Build the checkpoint index.
+	if (!parser->index.complete) {
+		dc_status_t rc = parser->decoder (abstract, NULL, 0xFFFFFFFF, NULL, NULL);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+	}
+
+	// Resume from the last checkpoint before the time window.
+	int slot = sample_index_find (&parser->index, begin);
+	if (slot < 0)
+		return DC_STATUS_SUCCESS;
+
+	return parser->decoder (abstract, parser->checkpoint + slot, end, callback, userdata);
+}
@@ -158,6 +158,9 @@ zeagle_n2ition3_device_open (dc_device_t **out, dc_context_t *context, const cha
 		goto error_free;
 	}
 
+	// Collect the transport statistics.
+	dc_serial_set_stats (device->port, &device->base.stats);
+
 	// Set the serial communication protocol (4800 8N1).
 	status = dc_serial_configure (device->port, 4800, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -287,7 +290,7 @@ zeagle_n2ition3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 
 	// Read the configuration data.
 	unsigned char config[(RB_LOGBOOK_END - RB_LOGBOOK_BEGIN) * 2 + 8] = {0};
-	dc_status_t rc = zeagle_n2ition3_device_read (abstract, RB_LOGBOOK_OFFSET, config, sizeof (config));
+	dc_status_t rc = dc_device_read (abstract, RB_LOGBOOK_OFFSET, config, sizeof (config));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the configuration data.");
 		return rc;
@@ -408,3 +411,39 @@ zeagle_n2ition3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+dc_status_t
+zeagle_n2ition3_extract_dives (dc_context_t *context, const unsigned char fingerprint[], const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	zeagle_n2ition3_device_t *device = NULL;
+
+	if (size < SZ_MEMORY) {
+		ERROR (context, "Invalid memory dump size (%u).", size);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Allocate memory.
+	device = (zeagle_n2ition3_device_t *) dc_device_allocate (context, &zeagle_n2ition3_device_vtable);
+	if (device == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	device->port = NULL;
+	if (fingerprint)
+		memcpy (device->fingerprint, fingerprint, sizeof (device->fingerprint));
+	else
+		memset (device->fingerprint, 0, sizeof (device->fingerprint));
+
+	// Walk the memory dump instead of the device memory.
+	device_dump_attach ((dc_device_t *) device, data, size);
+
+	status = zeagle_n2ition3_device_foreach ((dc_device_t *) device, callback, userdata);
+
+	dc_device_deallocate ((dc_device_t *) device);
+
+	return status;
+}